@@ -0,0 +1,139 @@
+/**
+ * @file bench_crc32c.c
+ * @brief CRC32C and integrity layer throughput
+ *
+ * Prints whether mram_crc32c() runs on a hardware CRC instruction, then
+ * measures checksum throughput per block size for one mram_crc32c() call
+ * per block and for mram_crc32c_batch() over the same blocks.
+ *
+ * It then compares the plain mram_read()/mram_write() path with
+ * mram_integrity_read()/mram_integrity_write() on the simulator over the
+ * same region, so the integrity cost is shown next to a bus that costs
+ * nothing but copies. Throughput is in MB/s.
+ *
+ * Usage: bench_crc32c [megabytes]
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mram_integrity.h"
+#include "mram_sim.h"
+
+#define BENCH_BUFFER (1u << 20)
+#define BENCH_REGION (256u * 1024)
+#define BENCH_IO     4096
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double bench_mbps(size_t bytes, double seconds) {
+    return (double)bytes / (1024.0 * 1024.0) / seconds;
+}
+
+// One mram_crc32c() call per block against mram_crc32c_batch()
+static void bench_checksums(const uint8_t* data, uint32_t* crcs, size_t total) {
+    static const size_t sizes[] = { 64, 256, 1024, 4096 };
+    volatile uint32_t sink = 0;
+
+    printf("%-10s %12s %12s\n", "block", "single", "batch");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t bsz = sizes[s];
+        size_t count = BENCH_BUFFER / bsz;
+        size_t rounds = total / BENCH_BUFFER;
+
+        double t0 = bench_now();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < count; i++) crcs[i] = mram_crc32c(0, data + i * bsz, bsz);
+            sink ^= crcs[r % count];
+        }
+        double single = bench_now() - t0;
+
+        t0 = bench_now();
+        for (size_t r = 0; r < rounds; r++) {
+            mram_crc32c_batch(data, bsz, count, crcs);
+            sink ^= crcs[r % count];
+        }
+        double batch = bench_now() - t0;
+
+        printf("%-10zu %12.0f %12.0f\n", bsz, bench_mbps(rounds * BENCH_BUFFER, single),
+               bench_mbps(rounds * BENCH_BUFFER, batch));
+    }
+    (void)sink;
+}
+
+// Sequential BENCH_IO transfers over the region, plain and checked
+static void bench_device(struct mram* mram, uint8_t* buf, size_t total) {
+    static const uint32_t blocks[] = { 64, 256, 1024 };
+    size_t ops = total / BENCH_IO;
+
+    double t0 = bench_now();
+    for (size_t i = 0; i < ops; i++) {
+        if (!mram_write(mram, (uint32_t)(i * BENCH_IO % BENCH_REGION), buf, BENCH_IO)) exit(1);
+    }
+    double write = bench_now() - t0;
+    t0 = bench_now();
+    for (size_t i = 0; i < ops; i++) {
+        if (!mram_read(mram, (uint32_t)(i * BENCH_IO % BENCH_REGION), buf, BENCH_IO)) exit(1);
+    }
+    double read = bench_now() - t0;
+
+    printf("\n%-10s %12s %12s\n", "path", "write", "read");
+    printf("%-10s %12.0f %12.0f\n", "plain", bench_mbps(total, write), bench_mbps(total, read));
+
+    for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+        struct mram_integrity ig;
+        struct mram_integrity_config config = {
+            .data_addr = 0,
+            .data_size = BENCH_REGION,
+            .block_size = blocks[b],
+            .meta_addr = BENCH_REGION,
+        };
+        if (!mram_integrity_init(&ig, mram, &config) || !mram_integrity_format(&ig)) exit(1);
+
+        t0 = bench_now();
+        for (size_t i = 0; i < ops; i++) {
+            if (!mram_integrity_write(&ig, (uint32_t)(i * BENCH_IO % BENCH_REGION), buf, BENCH_IO)) exit(1);
+        }
+        write = bench_now() - t0;
+        t0 = bench_now();
+        for (size_t i = 0; i < ops; i++) {
+            if (!mram_integrity_read(&ig, (uint32_t)(i * BENCH_IO % BENCH_REGION), buf, BENCH_IO)) exit(1);
+        }
+        read = bench_now() - t0;
+        mram_integrity_deinit(&ig);
+
+        char name[16];
+        snprintf(name, sizeof(name), "crc/%u", blocks[b]);
+        printf("%-10s %12.0f %12.0f\n", name, bench_mbps(total, write), bench_mbps(total, read));
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+    uint8_t* data = malloc(BENCH_BUFFER);
+    uint32_t* crcs = malloc(BENCH_BUFFER / 64 * sizeof(uint32_t));
+    struct mram mram;
+
+    if (megabytes == 0 || data == NULL || crcs == NULL || !mram_sim_init(&mram, NULL)) {
+        fprintf(stderr, "usage: %s [megabytes]\n", argv[0]);
+        return 2;
+    }
+    for (size_t i = 0; i < BENCH_BUFFER; i++) data[i] = (uint8_t)(i * 2654435761u >> 24);
+
+    printf("crc32c: %s\n\n", mram_crc32c_hw_available() ? "hardware" : "software");
+    bench_checksums(data, crcs, megabytes << 20);
+    bench_device(&mram, data, (megabytes << 20) / 8);
+
+    free(crcs);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file bench_device.cpp
+ * @brief Per-call CPU overhead of device<Transport> against the C API
+ *
+ * Runs the same operations through three paths over a transport that does
+ * no I/O, so only the driver's own work is timed:
+ *
+ *   c        mram_* functions calling the struct mram function pointers
+ *   pointer  device<pointer_transport> over the same function pointers
+ *   policy   device<null_transport>, with the transport resolved at
+ *            compile time and inlined into the frame code
+ *
+ * The transports fold the first byte of every transfer into a volatile, so
+ * the compiler can inline them but not drop them. Results are nanoseconds
+ * per call.
+ *
+ * Usage: bench_device [iterations]
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "mram_device.hpp"
+
+using namespace mram_interface;
+
+namespace {
+
+volatile uint8_t sink;
+
+bool null_gpio(uint8_t pin, uint8_t value) {
+    sink = static_cast<uint8_t>(sink + pin + value);
+    return true;
+}
+
+bool null_spi(const uint8_t* tx, uint8_t* rx, size_t len) {
+    if (tx && len) sink = static_cast<uint8_t>(sink + tx[0]);
+    if (rx && len) rx[0] = sink;
+    return true;
+}
+
+struct null_transport {
+    bool select() { return null_gpio(0, MRAM_GPIO_LOW); }
+    bool deselect() { return null_gpio(0, MRAM_GPIO_HIGH); }
+    bool transfer(const uint8_t* tx, uint8_t* rx, size_t len) { return null_spi(tx, rx, len); }
+};
+
+template <class F>
+double ns_per_call(size_t iterations, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        if (!f(static_cast<uint32_t>(i & 0xFFFF))) {
+            std::fprintf(stderr, "bench_device: call failed\n");
+            std::exit(1);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    ::mram dev;
+    if (iterations == 0 || !mram_init(&dev, null_gpio, null_spi, 0)) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+    device<pointer_transport> pointer(dev);
+    device<null_transport> policy;
+    uint8_t small[4] = { 1, 2, 3, 4 }, page[64] = {}, buf[64], status;
+    mram_iovec iov[2] = { { 0, page, 32 }, { 32, page + 32, 32 } };
+
+    std::printf("%-12s %10s %10s %10s\n", "op", "c", "pointer", "policy");
+    std::printf("%-12s %10.1f %10.1f %10.1f\n", "write 4",
+                ns_per_call(iterations, [&](uint32_t a) { return mram_write(&dev, a, small, 4); }),
+                ns_per_call(iterations, [&](uint32_t a) { return pointer.write(a, small, 4); }),
+                ns_per_call(iterations, [&](uint32_t a) { return policy.write(a, small, 4); }));
+    std::printf("%-12s %10.1f %10.1f %10.1f\n", "write 64",
+                ns_per_call(iterations, [&](uint32_t a) { return mram_write(&dev, a, page, 64); }),
+                ns_per_call(iterations, [&](uint32_t a) { return pointer.write(a, page, 64); }),
+                ns_per_call(iterations, [&](uint32_t a) { return policy.write(a, page, 64); }));
+    std::printf("%-12s %10.1f %10.1f %10.1f\n", "read 4",
+                ns_per_call(iterations, [&](uint32_t a) { return mram_read(&dev, a, buf, 4); }),
+                ns_per_call(iterations, [&](uint32_t a) { return pointer.read(a, buf, 4); }),
+                ns_per_call(iterations, [&](uint32_t a) { return policy.read(a, buf, 4); }));
+    std::printf("%-12s %10.1f %10.1f %10.1f\n", "writev 2x32",
+                ns_per_call(iterations, [&](uint32_t) { return mram_write_vector(&dev, iov, 2); }),
+                ns_per_call(iterations, [&](uint32_t) { return pointer.write_vector(iov, 2); }),
+                ns_per_call(iterations, [&](uint32_t) { return policy.write_vector(iov, 2); }));
+    std::printf("%-12s %10.1f %10.1f %10.1f\n", "rdsr",
+                ns_per_call(iterations, [&](uint32_t) { return mram_read_status_register(&dev, &status); }),
+                ns_per_call(iterations, [&](uint32_t) { return pointer.read_status_register(status); }),
+                ns_per_call(iterations, [&](uint32_t) { return policy.read_status_register(status); }));
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file bench_mt.c
+ * @brief Thread scaling of the mram_mt handle against a global mutex
+ *
+ * Runs 1, 2, 4, 8, 16 and 32 threads against the simulator. Each thread
+ * writes 64 bytes to its own slot, reads them back and polls a shared
+ * control block, for a fixed total number of operations per run. The same
+ * workload runs once with every mram_* call under one pthread mutex and
+ * once through mram_mt. The bench prints operations per second and, for
+ * mram_mt, bus calls per request and reads served by single-flight.
+ *
+ * Usage: bench_mt [operations]
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mram_mt.h"
+#include "mram_sim.h"
+
+#define BENCH_MAX_THREADS 32
+#define BENCH_SLOT        64
+#define BENCH_CONTROL     0x70000
+
+static struct mram mram;
+static struct mram_mt mt;
+static pthread_mutex_t bench_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t bench_ops;
+static bool bench_use_mt;
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static bool bench_read(uint32_t addr, uint8_t* buf, size_t len) {
+    if (bench_use_mt) return mram_mt_read(&mt, addr, buf, len);
+    pthread_mutex_lock(&bench_lock);
+    bool ok = mram_read(&mram, addr, buf, len);
+    pthread_mutex_unlock(&bench_lock);
+    return ok;
+}
+
+static bool bench_write(uint32_t addr, const uint8_t* data, size_t len) {
+    if (bench_use_mt) return mram_mt_write(&mt, addr, data, len);
+    pthread_mutex_lock(&bench_lock);
+    bool ok = mram_write(&mram, addr, data, len);
+    pthread_mutex_unlock(&bench_lock);
+    return ok;
+}
+
+static void* bench_thread(void* arg) {
+    uint32_t slot = (uint32_t)(uintptr_t)arg * BENCH_SLOT;
+    uint8_t out[BENCH_SLOT], in[BENCH_SLOT], control[16];
+
+    memset(out, (int)slot, sizeof(out));
+    for (size_t i = 0; i < bench_ops; i += 3) {
+        if (!bench_write(slot, out, sizeof(out)) || !bench_read(slot, in, sizeof(in)) ||
+            !bench_read(BENCH_CONTROL, control, sizeof(control))) {
+            fprintf(stderr, "bench_mt: call failed\n");
+            exit(1);
+        }
+    }
+    return NULL;
+}
+
+static double bench_run(size_t threads, size_t total) {
+    pthread_t tid[BENCH_MAX_THREADS];
+
+    bench_ops = total / threads / 3 * 3;
+    double t0 = bench_now();
+    for (size_t t = 0; t < threads; t++) {
+        if (pthread_create(&tid[t], NULL, bench_thread, (void*)(uintptr_t)t) != 0) exit(1);
+    }
+    for (size_t t = 0; t < threads; t++) pthread_join(tid[t], NULL);
+    return (double)(bench_ops * threads) / (bench_now() - t0);
+}
+
+int main(int argc, char** argv) {
+    size_t total = argc > 1 ? strtoul(argv[1], NULL, 10) : 3000000;
+    if (total < 3 * BENCH_MAX_THREADS || !mram_sim_init(&mram, NULL)) {
+        fprintf(stderr, "usage: %s [operations]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-8s %12s %12s %10s %10s\n", "threads", "mutex op/s", "mt op/s", "bus/req", "shared");
+    for (size_t threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+        bench_use_mt = false;
+        double mutex_rate = bench_run(threads, total);
+
+        if (!mram_mt_init(&mt, &mram, MRAM_MT_DEFAULT_CAPACITY)) return 1;
+        bench_use_mt = true;
+        double mt_rate = bench_run(threads, total);
+        double bus = (double)mt.stats.bus_calls / (double)mt.stats.requests;
+        unsigned long long shared = (unsigned long long)mt.stats.reads_saved;
+        mram_mt_deinit(&mt);
+
+        printf("%-8zu %12.0f %12.0f %10.2f %10llu\n", threads, mutex_rate, mt_rate, bus, shared);
+    }
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "mram.h"
+#include <string.h>
 #include <unistd.h>  // for usleep
 
 // Helper function to transfer a single byte
@@ -17,6 +18,19 @@ static bool mram_transfer_byte(struct mram* mram, uint8_t tx_byte, uint8_t* rx_b
     return true;
 }
 
+// Report a call to the hook, if one is installed
+static void mram_enter(struct mram* mram, struct mram_call* call) {
+    if (mram && mram->hook) mram->hook->enter(mram->hook, call);
+}
+
+static bool mram_leave(struct mram* mram, struct mram_call* call, bool ok) {
+    if (mram && mram->hook) mram->hook->leave(mram->hook, call, ok);
+    return ok;
+}
+
+static bool mram_wren(struct mram* mram);
+static bool mram_wrdi(struct mram* mram);
+
 bool mram_init(struct mram* mram, bool (*gpio_write)(uint8_t, uint8_t),
                bool (*spi_transfer)(const uint8_t*, uint8_t*, size_t),
                uint8_t cs_pin) {
@@ -28,16 +42,17 @@ bool mram_init(struct mram* mram, bool (*gpio_write)(uint8_t, uint8_t),
     mram->gpio_write = gpio_write;
     mram->spi_transfer = spi_transfer;
     mram->cs_pin = cs_pin;
+    mram->hook = NULL;
     
     // Ensure CS is high (device deselected)
     if (!mram->gpio_write(cs_pin, MRAM_GPIO_HIGH))
         return false;
     
     // Disable writing by default
-    return mram_write_disable(mram);
+    return mram_wrdi(mram);
 }
 
-bool mram_write_enable(struct mram* mram) {
+static bool mram_wren(struct mram* mram) {
     if (mram == NULL) return false;
     
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_LOW)) return false;
@@ -47,7 +62,7 @@ bool mram_write_enable(struct mram* mram) {
 }
 
 //The Write Enable Latch (WEL) is reset to 0 on power-up or when the WRDI command is completed.
-bool mram_write_disable(struct mram* mram) {
+static bool mram_wrdi(struct mram* mram) {
     if (mram == NULL) return false;
     
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_LOW)) return false;
@@ -56,8 +71,20 @@ bool mram_write_disable(struct mram* mram) {
     return true;
 }
 
+bool mram_write_enable(struct mram* mram) {
+    struct mram_call call = { .op = MRAM_OP_WRITE_ENABLE };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_wren(mram));
+}
+
+bool mram_write_disable(struct mram* mram) {
+    struct mram_call call = { .op = MRAM_OP_WRITE_DISABLE };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_wrdi(mram));
+}
+
 //You need to give me 19 bits address otherwise it will return false. Also you need to give me a buffer to store the data and the length of the data.
-bool mram_read(struct mram* mram, uint32_t addr, uint8_t* buffer, size_t len) {
+static bool mram_read_frame(struct mram* mram, uint32_t addr, uint8_t* buffer, size_t len) {
     if (mram == NULL || buffer == NULL || len == 0) {
         return false;
     }
@@ -99,8 +126,14 @@ bool mram_read(struct mram* mram, uint32_t addr, uint8_t* buffer, size_t len) {
     return true;
 }
 
+bool mram_read(struct mram* mram, uint32_t addr, uint8_t* buffer, size_t len) {
+    struct mram_call call = { .op = MRAM_OP_READ, .addr = addr, .len = len };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_read_frame(mram, addr, buffer, len));
+}
+
 //I need address and data buffer and length of the data. Address is 24 bits but only 19 bits are used. So dont give me more than 19 bits otherwise i will get rid of rest of the bits.
-bool mram_write(struct mram* mram, uint32_t addr, const uint8_t* data, size_t len) {
+static bool mram_write_frame(struct mram* mram, uint32_t addr, const uint8_t* data, size_t len) {
     if (mram == NULL || data == NULL || len == 0) {
         return false;
     }
@@ -114,7 +147,7 @@ bool mram_write(struct mram* mram, uint32_t addr, const uint8_t* data, size_t le
     addr &= MRAM_ADDRESS_MASK;
     
     // Enable writing before write operation
-    if (!mram_write_enable(mram)) return false;
+    if (!mram_wren(mram)) return false;
     
     // Command structure: CMD(1) + ADDR(3) + DATA(n)
     uint8_t tx_buf[len + 4];
@@ -139,12 +172,103 @@ bool mram_write(struct mram* mram, uint32_t addr, const uint8_t* data, size_t le
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_HIGH)) return false;
     
     // Disable writing after operation complete
-    if (!mram_write_disable(mram)) return false;
+    if (!mram_wrdi(mram)) return false;
     return true;
 }
 
+bool mram_write(struct mram* mram, uint32_t addr, const uint8_t* data, size_t len) {
+    struct mram_call call = { .op = MRAM_OP_WRITE, .addr = addr, .len = len };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_write_frame(mram, addr, data, len));
+}
+
+static bool mram_range_valid(uint32_t addr, size_t len) {
+    return len != 0 && addr <= MRAM_MAX_ADDRESS && len - 1 <= (size_t)(MRAM_MAX_ADDRESS - addr);
+}
+
+static bool mram_iovec_valid(const struct mram_iovec* iov, size_t count) {
+    if (iov == NULL || count == 0) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (iov[i].buf == NULL || !mram_range_valid(iov[i].addr, iov[i].len)) return false;
+    }
+    return true;
+}
+
+// Drive CS low and send CMD(1) + ADDR(3). CS is released again on failure.
+static bool mram_frame_begin(struct mram* mram, uint8_t cmd, uint32_t addr) {
+    addr &= MRAM_ADDRESS_MASK;
+    uint8_t header[4] = {
+        cmd,
+        (addr >> 16) & 0xFF,
+        (addr >> 8) & 0xFF,
+        addr & 0xFF
+    };
+
+    if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_LOW)) return false;
+    if (!mram->spi_transfer(header, NULL, sizeof(header))) {
+        mram->gpio_write(mram->cs_pin, MRAM_GPIO_HIGH);
+        return false;
+    }
+    return true;
+}
+
+// Send the iovec as frames of the given command, continuing the current frame
+// while segments are adjacent. Data moves straight between the segment
+// buffers and the transport, without an intermediate copy.
+static bool mram_transfer_vector(struct mram* mram, uint8_t cmd, const struct mram_iovec* iov, size_t count) {
+    bool selected = false;
+    uint32_t next_addr = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!selected || iov[i].addr != next_addr) {
+            if (selected && !mram->gpio_write(mram->cs_pin, MRAM_GPIO_HIGH)) return false;
+            selected = false;
+            if (!mram_frame_begin(mram, cmd, iov[i].addr)) return false;
+            selected = true;
+        }
+
+        bool ok;
+        if (cmd == MRAM_CMD_READ) {
+            // Clock out dummy bytes from the destination buffer itself
+            memset(iov[i].buf, 0xFF, iov[i].len);
+            ok = mram->spi_transfer(iov[i].buf, iov[i].buf, iov[i].len);
+        } else {
+            ok = mram->spi_transfer(iov[i].buf, NULL, iov[i].len);
+        }
+        if (!ok) {
+            mram->gpio_write(mram->cs_pin, MRAM_GPIO_HIGH);
+            return false;
+        }
+        next_addr = iov[i].addr + (uint32_t)iov[i].len;
+    }
+
+    return mram->gpio_write(mram->cs_pin, MRAM_GPIO_HIGH);
+}
+
+static bool mram_write_segments(struct mram* mram, const struct mram_iovec* iov, size_t count) {
+    if (mram == NULL || !mram_iovec_valid(iov, count)) return false;
+
+    // One WREN for all frames; WEL is only cleared by WRDI
+    if (!mram_wren(mram)) return false;
+    if (!mram_transfer_vector(mram, MRAM_CMD_WRITE, iov, count)) return false;
+    return mram_wrdi(mram);
+}
+
+bool mram_read_vector(struct mram* mram, const struct mram_iovec* iov, size_t count) {
+    struct mram_call call = { .op = MRAM_OP_READ_VECTOR, .iov = iov, .count = count };
+    mram_enter(mram, &call);
+    bool ok = mram != NULL && mram_iovec_valid(iov, count) && mram_transfer_vector(mram, MRAM_CMD_READ, iov, count);
+    return mram_leave(mram, &call, ok);
+}
+
+bool mram_write_vector(struct mram* mram, const struct mram_iovec* iov, size_t count) {
+    struct mram_call call = { .op = MRAM_OP_WRITE_VECTOR, .iov = iov, .count = count };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_write_segments(mram, iov, count));
+}
+
 //I work with mram instance given to me.
-bool mram_sleep(struct mram* mram) {
+static bool mram_sleep_cmd(struct mram* mram) {
     if (mram == NULL) return false;
     
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_LOW)) return false;
@@ -156,8 +280,14 @@ bool mram_sleep(struct mram* mram) {
     return true;
 }
 
+bool mram_sleep(struct mram* mram) {
+    struct mram_call call = { .op = MRAM_OP_SLEEP };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_sleep_cmd(mram));
+}
+
 //The CS pin must remain high until the tRDP period is over. WAKE must be executed after sleep mode entry and prior to any other command.
-bool mram_wake(struct mram* mram) {
+static bool mram_wake_cmd(struct mram* mram) {
     if (mram == NULL) return false;
     
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_LOW)) return false;
@@ -170,12 +300,18 @@ bool mram_wake(struct mram* mram) {
     return true;
 }
 
+bool mram_wake(struct mram* mram) {
+    struct mram_call call = { .op = MRAM_OP_WAKE };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_wake_cmd(mram));
+}
+
 /*An RDSR command cannot immediately follow a READ command. If an RDSR command immediately follows a READ com-
 mand, the output data will not be correct. Any other sequence of commands is allowed. If an RDSR command is required
 immediately following a READ command, it is necessary that another command be inserted before the RDSR is executed.
 Alternatively, two successive RDSR commands can be issued following the READ command. The second RDSR will output the
 proper state of the Status Register.*/
-bool mram_read_status_register(struct mram* mram, uint8_t* status) {
+static bool mram_rdsr(struct mram* mram, uint8_t* status) {
     if (mram == NULL || status == NULL) return false;
     uint8_t rx_byte;
     
@@ -192,11 +328,11 @@ bool mram_read_status_register(struct mram* mram, uint8_t* status) {
 }
 
 /*The Write Status Register (WRSR) command allows the Status Register to be written. The Status Register can be written to set the write enable latch bit, status register write protect bit, and block write protect bits. The WRSR command is entered by driving CS low, sending the command code, and then driving CS high. The WRSR command cannot immediately follow a READ command. If a WRSR command immediately follows a READ command, the output data will not be correct. Any other sequence of commands is allowed. If a WRSR command is required immediately following a READ command, it is necessary that another command be inserted before the WRSR is executed. Alternatively, two successive WRSR commands can be issued following the READ command. The second WRSR will output the proper state of the Status Register.*/
-bool mram_write_status_register(struct mram* mram, uint8_t status) {
+static bool mram_wrsr(struct mram* mram, uint8_t status) {
     if (mram == NULL) return false;
     
     // Enable writing before modifying status register
-    if (!mram_write_enable(mram)) return false;
+    if (!mram_wren(mram)) return false;
     
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_LOW)) return false;
     if (!mram_transfer_byte(mram, MRAM_CMD_WRSR, NULL)) return false;
@@ -204,10 +340,24 @@ bool mram_write_status_register(struct mram* mram, uint8_t status) {
     if (!mram->gpio_write(mram->cs_pin, MRAM_GPIO_HIGH)) return false;
     
     // Disable writing after operation complete
-    if (!mram_write_disable(mram)) return false;
+    if (!mram_wrdi(mram)) return false;
     return true;
 }
 
+bool mram_read_status_register(struct mram* mram, uint8_t* status) {
+    struct mram_call call = { .op = MRAM_OP_READ_STATUS };
+    mram_enter(mram, &call);
+    bool ok = mram_rdsr(mram, status);
+    if (ok) call.status = *status;
+    return mram_leave(mram, &call, ok);
+}
+
+bool mram_write_status_register(struct mram* mram, uint8_t status) {
+    struct mram_call call = { .op = MRAM_OP_WRITE_STATUS, .status = status };
+    mram_enter(mram, &call);
+    return mram_leave(mram, &call, mram_wrsr(mram, status));
+}
+
 bool mram_is_write_enabled(struct mram* mram) {
     if (mram == NULL) return false;
     uint8_t status;
@@ -113,6 +113,8 @@ static const uint8_t MRAM_CMD_WAKE = 0xAB;
 /*******************************************************************************
  * Data Structures
  ******************************************************************************/
+struct mram_hook;
+
 /**
  * @brief MRAM device interface structure
  *
@@ -126,16 +128,90 @@ struct mram {
     bool (*gpio_write)(uint8_t pin, uint8_t value);
     /** @brief SPI transfer function pointer 
      * @return true on success, false on failure
+     * @note tx_buf may be the same buffer as rx_buf for the data phase of
+     *       vectored reads; rx_buf is NULL for transmit-only transfers
      */
     bool (*spi_transfer)(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len);
     /** @brief Chip select pin number */
     uint8_t cs_pin;
+    /** @brief Observer of API calls, NULL for none (cleared by mram_init) */
+    struct mram_hook* hook;
+};
+
+/**
+ * @brief Scatter/gather segment for vectored transfers
+ *
+ * Segments whose addresses follow each other are sent in a single READ or
+ * WRITE frame; every other segment starts a new frame.
+ */
+struct mram_iovec {
+    /** @brief Device address of the segment (19-bit maximum) */
+    uint32_t addr;
+    /** @brief Segment buffer (source for writes, destination for reads) */
+    void* buf;
+    /** @brief Segment length in bytes */
+    size_t len;
+};
+
+/**
+ * @brief Public API operations, as reported to a hook
+ */
+enum mram_op {
+    MRAM_OP_WRITE_ENABLE = 1,
+    MRAM_OP_WRITE_DISABLE,
+    MRAM_OP_READ,
+    MRAM_OP_WRITE,
+    MRAM_OP_READ_VECTOR,
+    MRAM_OP_WRITE_VECTOR,
+    MRAM_OP_SLEEP,
+    MRAM_OP_WAKE,
+    MRAM_OP_READ_STATUS,
+    MRAM_OP_WRITE_STATUS,
+};
+
+/**
+ * @brief One API call, as reported to a hook
+ */
+struct mram_call {
+    /** @brief Operation (enum mram_op); the mram_is_* queries report READ_STATUS */
+    uint8_t op;
+    /** @brief Status register value written, or read once the call has completed */
+    uint8_t status;
+    /** @brief Device address of READ and WRITE */
+    uint32_t addr;
+    /** @brief Length of READ and WRITE */
+    size_t len;
+    /** @brief Segments of the vector operations (unvalidated) */
+    const struct mram_iovec* iov;
+    /** @brief Number of segments */
+    size_t count;
+    /** @brief Free for the hook, e.g. a start timestamp set in enter */
+    uint64_t cookie;
+};
+
+/**
+ * @brief Observer of the public API of one device
+ *
+ * Every public call except mram_init() reports to enter before it touches
+ * the bus and to leave with its result afterwards. Calls the driver makes
+ * internally are not reported. Embed the hook as the first member of a
+ * larger structure to carry state.
+ */
+struct mram_hook {
+    /** @brief Called when an API call starts */
+    void (*enter)(struct mram_hook* hook, struct mram_call* call);
+    /** @brief Called when an API call returns, with its result */
+    void (*leave)(struct mram_hook* hook, struct mram_call* call, bool ok);
 };
 
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @brief Initialize MRAM device interface
  *
@@ -209,6 +285,44 @@ bool mram_read(struct mram* mram, uint32_t addr, uint8_t* buffer, size_t len);
  */
 bool mram_write(struct mram* mram, uint32_t addr, const uint8_t* data, size_t len);
 
+/**
+ * @brief Read several ranges from the MRAM device
+ *
+ * Adjacent segments are merged into one READ frame, so a contiguous range
+ * split across several buffers costs a single command header.
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param iov Array of segments to read
+ * @param count Number of segments
+ * @return true if successful, false if:
+ *         - mram or iov is NULL, or count is 0
+ *         - any segment has a NULL buffer, zero length or exceeds MRAM_MAX_ADDRESS
+ *         - communication fails
+ */
+bool mram_read_vector(struct mram* mram, const struct mram_iovec* iov, size_t count);
+
+/**
+ * @brief Write several ranges to the MRAM device under one write enable
+ *
+ * Issues a single WREN, one WRITE frame per run of adjacent segments and a
+ * single WRDI. Segments are written in array order, so later segments win
+ * where ranges overlap.
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param iov Array of segments to write
+ * @param count Number of segments
+ * @return true if successful, false if:
+ *         - mram or iov is NULL, or count is 0
+ *         - any segment has a NULL buffer, zero length or exceeds MRAM_MAX_ADDRESS
+ *         - write enable fails
+ *         - communication fails
+ *
+ * @note All segments are validated before anything is sent
+ * @note The Write Enable Latch stays set across WRITE commands until WRDI,
+ *       which is what allows several frames to share one WREN
+ */
+bool mram_write_vector(struct mram* mram, const struct mram_iovec* iov, size_t count);
+
 /**
  * @brief Put the MRAM device into sleep mode
  *
@@ -299,4 +413,8 @@ bool mram_is_write_protected(struct mram* mram);
  */
 bool mram_is_block_protected(struct mram* mram, uint8_t block_number);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif //MRAM_INTERFACE_MRAM_H
@@ -0,0 +1,389 @@
+#include "mram_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    HEAP_PAGE_TAIL,   // Inside a block, not its head
+    HEAP_PAGE_FREE,   // Head of a free block
+    HEAP_PAGE_LARGE,  // Head of an allocated block
+    HEAP_PAGE_SLAB,   // Slab page
+};
+
+#define HEAP_NIL 0xFFFFu
+
+#define HEAP_FNV_OFFSET 2166136261u
+#define HEAP_FNV_PRIME  16777619u
+
+// Region layout: header copies 0 and 1, metadata copies 0 and 1, pages
+static uint32_t heap_header_addr(const struct mram_heap* heap, uint32_t copy) {
+    return heap->base + copy * (uint32_t)sizeof(struct mram_heap_header);
+}
+
+static uint32_t heap_meta_addr(const struct mram_heap* heap, uint32_t copy, uint32_t page) {
+    return heap->base + 2 * (uint32_t)sizeof(struct mram_heap_header) +
+           (copy * heap->header.pages + page) * (uint32_t)sizeof(struct mram_heap_page);
+}
+
+static uint32_t heap_fnv(uint32_t h, const void* data, size_t len) {
+    const uint8_t* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= HEAP_FNV_PRIME;
+    }
+    return h;
+}
+
+// Check over the header fields before it and the metadata copy it describes
+static uint32_t heap_check(const struct mram_heap_header* header, const struct mram_heap_page* meta) {
+    uint32_t h = heap_fnv(HEAP_FNV_OFFSET, header, offsetof(struct mram_heap_header, check));
+    return heap_fnv(h, meta, header->pages * sizeof(*meta));
+}
+
+static uint16_t heap_slot_mask(uint8_t cls) {
+    unsigned slots = MRAM_HEAP_PAGE_SIZE / (MRAM_HEAP_MIN_SLOT << cls);
+    return (uint16_t)(slots >= 16 ? 0xFFFFu : (1u << slots) - 1);
+}
+
+static void heap_mark(struct mram_heap* heap, uint32_t page) {
+    heap->dirty[page / 32] |= 1u << (page % 32);
+}
+
+// Doubly linked lists over page indices; a page is on at most one list
+static void heap_push(struct mram_heap* heap, uint16_t* list, uint16_t page) {
+    heap->prev[page] = HEAP_NIL;
+    heap->next[page] = *list;
+    if (*list != HEAP_NIL) heap->prev[*list] = page;
+    *list = page;
+}
+
+static void heap_unlink(struct mram_heap* heap, uint16_t* list, uint16_t page) {
+    if (heap->prev[page] != HEAP_NIL) {
+        heap->next[heap->prev[page]] = heap->next[page];
+    } else {
+        *list = heap->next[page];
+    }
+    if (heap->next[page] != HEAP_NIL) heap->prev[heap->next[page]] = heap->prev[page];
+}
+
+static void heap_set(struct mram_heap* heap, uint32_t page, uint8_t state, uint8_t order, uint16_t slots) {
+    heap->meta[page].state = state;
+    heap->meta[page].order = order;
+    heap->meta[page].slots = slots;
+    heap_mark(heap, page);
+}
+
+static bool heap_buddy_alloc(struct mram_heap* heap, uint8_t order, uint16_t* page) {
+    uint8_t k = order;
+    while (k <= MRAM_HEAP_MAX_ORDER && heap->free_list[k] == HEAP_NIL) k++;
+    if (k > MRAM_HEAP_MAX_ORDER) return false;
+
+    uint16_t p = heap->free_list[k];
+    heap_unlink(heap, &heap->free_list[k], p);
+    // Split down to the requested order, upper halves go back as free blocks
+    while (k > order) {
+        k--;
+        uint16_t buddy = (uint16_t)(p + (1u << k));
+        heap_set(heap, buddy, HEAP_PAGE_FREE, k, 0);
+        heap_push(heap, &heap->free_list[k], buddy);
+    }
+    *page = p;
+    return true;
+}
+
+static void heap_buddy_free(struct mram_heap* heap, uint16_t page, uint8_t order) {
+    while (order < MRAM_HEAP_MAX_ORDER) {
+        uint32_t buddy = page ^ (1u << order);
+        if (buddy + (1u << order) > heap->header.pages || heap->meta[buddy].state != HEAP_PAGE_FREE ||
+            heap->meta[buddy].order != order) {
+            break;
+        }
+        heap_unlink(heap, &heap->free_list[order], (uint16_t)buddy);
+        // The upper head disappears into the merged block
+        heap_set(heap, buddy > page ? buddy : page, HEAP_PAGE_TAIL, 0, 0);
+        if (buddy < page) page = (uint16_t)buddy;
+        order++;
+    }
+    heap_set(heap, page, HEAP_PAGE_FREE, order, 0);
+    heap_push(heap, &heap->free_list[order], page);
+}
+
+// Geometry shared by format and open: header, metadata array, page-aligned heap
+static bool heap_setup(struct mram_heap* heap, struct mram* mram, uint32_t base, uint32_t size) {
+    if (heap == NULL || mram == NULL || size == 0) return false;
+    if (base > MRAM_MAX_ADDRESS || size - 1 > MRAM_MAX_ADDRESS - base) return false;
+
+    uint32_t fixed = 2 * sizeof(struct mram_heap_header);
+    if (size <= fixed) return false;
+    uint32_t pages = (size - fixed) / (MRAM_HEAP_PAGE_SIZE + 2 * sizeof(struct mram_heap_page));
+    uint32_t heap_off = 0;
+    while (pages > 0) {
+        heap_off = fixed + 2 * pages * (uint32_t)sizeof(struct mram_heap_page);
+        heap_off = (heap_off + MRAM_HEAP_MIN_SLOT - 1) & ~(uint32_t)(MRAM_HEAP_MIN_SLOT - 1);
+        if (heap_off + pages * MRAM_HEAP_PAGE_SIZE <= size) break;
+        pages--;
+    }
+    if (pages == 0) return false;
+
+    memset(heap, 0, sizeof(*heap));
+    heap->mram = mram;
+    heap->base = base;
+    heap->heap = base + heap_off;
+    heap->header.magic = MRAM_HEAP_MAGIC;
+    heap->header.size = size;
+    heap->header.pages = pages;
+    heap->header.page_size = MRAM_HEAP_PAGE_SIZE;
+    heap->meta = calloc(pages, sizeof(*heap->meta));
+    heap->next = malloc(pages * sizeof(*heap->next));
+    heap->prev = malloc(pages * sizeof(*heap->prev));
+    heap->dirty = calloc((pages + 31) / 32, sizeof(*heap->dirty));
+    heap->stale = calloc((pages + 31) / 32, sizeof(*heap->stale));
+    // Worst case for sync: every other entry written, plus the header
+    heap->iov = malloc((pages / 2 + 2) * sizeof(*heap->iov));
+    if (heap->meta == NULL || heap->next == NULL || heap->prev == NULL || heap->dirty == NULL ||
+        heap->stale == NULL || heap->iov == NULL) {
+        mram_heap_deinit(heap);
+        return false;
+    }
+    for (unsigned k = 0; k <= MRAM_HEAP_MAX_ORDER; k++) heap->free_list[k] = HEAP_NIL;
+    for (unsigned c = 0; c < MRAM_HEAP_CLASSES; c++) heap->partial[c] = HEAP_NIL;
+    return true;
+}
+
+bool mram_heap_format(struct mram_heap* heap, struct mram* mram, uint32_t base, uint32_t size) {
+    if (!heap_setup(heap, mram, base, size)) return false;
+
+    // Cover the pages with the largest aligned power-of-two blocks
+    uint32_t page = 0;
+    while (page < heap->header.pages) {
+        uint8_t order = MRAM_HEAP_MAX_ORDER;
+        while ((page & ((1u << order) - 1)) != 0 || page + (1u << order) > heap->header.pages) order--;
+        heap_set(heap, page, HEAP_PAGE_FREE, order, 0);
+        heap_push(heap, &heap->free_list[order], (uint16_t)page);
+        page += 1u << order;
+    }
+
+    // Fill both copies, so no older heap in the region can look newer
+    memset(heap->dirty, 0xFF, ((heap->header.pages + 31) / 32) * sizeof(*heap->dirty));
+    if (!mram_heap_sync(heap) || !mram_heap_sync(heap)) {
+        mram_heap_deinit(heap);
+        return false;
+    }
+    return true;
+}
+
+// Rebuild the RAM lists by walking the block heads. Returns false if the
+// metadata does not describe a valid heap.
+static bool heap_rebuild(struct mram_heap* heap) {
+    for (unsigned k = 0; k <= MRAM_HEAP_MAX_ORDER; k++) heap->free_list[k] = HEAP_NIL;
+    for (unsigned c = 0; c < MRAM_HEAP_CLASSES; c++) heap->partial[c] = HEAP_NIL;
+
+    uint32_t page = 0;
+    while (page < heap->header.pages) {
+        const struct mram_heap_page* e = &heap->meta[page];
+        uint8_t order = e->state == HEAP_PAGE_SLAB ? 0 : e->order;
+        if (e->state == HEAP_PAGE_TAIL || e->state > HEAP_PAGE_SLAB || order > MRAM_HEAP_MAX_ORDER ||
+            page + (1u << order) > heap->header.pages || (e->state == HEAP_PAGE_SLAB && e->order >= MRAM_HEAP_CLASSES)) {
+            return false;
+        }
+        if (e->state == HEAP_PAGE_FREE) {
+            heap_push(heap, &heap->free_list[order], (uint16_t)page);
+        } else if (e->state == HEAP_PAGE_SLAB && e->slots != heap_slot_mask(e->order)) {
+            heap_push(heap, &heap->partial[e->order], (uint16_t)page);
+        }
+        page += 1u << order;
+    }
+    return true;
+}
+
+bool mram_heap_open(struct mram_heap* heap, struct mram* mram, uint32_t base, uint32_t size) {
+    if (!heap_setup(heap, mram, base, size)) return false;
+
+    uint32_t pages = heap->header.pages;
+    struct mram_heap_header headers[2];
+    struct mram_heap_page* copies[2] = { heap->meta, malloc(pages * sizeof(struct mram_heap_page)) };
+    if (copies[1] == NULL) {
+        mram_heap_deinit(heap);
+        return false;
+    }
+    struct mram_iovec iov[3] = {
+        { heap_header_addr(heap, 0), headers, sizeof(headers) },
+        { heap_meta_addr(heap, 0, 0), copies[0], pages * sizeof(struct mram_heap_page) },
+        { heap_meta_addr(heap, 1, 0), copies[1], pages * sizeof(struct mram_heap_page) },
+    };
+    bool ok = mram_read_vector(mram, iov, 3);
+
+    // A sync writes only the copy that is not current, so a torn one leaves
+    // the other intact: take the newest copy that checks out
+    bool valid[2];
+    for (uint32_t c = 0; c < 2; c++) {
+        const struct mram_heap_header* h = &headers[c];
+        valid[c] = ok && h->magic == MRAM_HEAP_MAGIC && h->size == heap->header.size && h->pages == pages &&
+                   h->page_size == MRAM_HEAP_PAGE_SIZE && h->check == heap_check(h, copies[c]);
+    }
+    uint32_t first = valid[0] && valid[1] ? (int32_t)(headers[1].seq - headers[0].seq) > 0 : valid[1];
+    ok = false;
+    for (uint32_t i = 0; i < 2 && !ok; i++) {
+        uint32_t c = first ^ i;
+        if (!valid[c]) continue;
+        heap->meta = copies[c];
+        heap->header = headers[c];
+        ok = heap_rebuild(heap);
+        if (!ok) continue;
+
+        // The next sync goes to the other copy; bring over whatever differs
+        struct mram_heap_page* other = copies[c ^ 1];
+        for (uint32_t page = 0; page < pages; page++) {
+            if (!valid[c ^ 1] || memcmp(&heap->meta[page], &other[page], sizeof(*other)) != 0) {
+                heap->stale[page / 32] |= 1u << (page % 32);
+            }
+        }
+        free(other);
+    }
+    if (!ok) {
+        heap->meta = copies[0];
+        free(copies[1]);
+        mram_heap_deinit(heap);
+        return false;
+    }
+    return true;
+}
+
+void mram_heap_deinit(struct mram_heap* heap) {
+    if (heap == NULL) return;
+    free(heap->meta);
+    free(heap->next);
+    free(heap->prev);
+    free(heap->dirty);
+    free(heap->stale);
+    free(heap->iov);
+    heap->meta = NULL;
+    heap->next = NULL;
+    heap->prev = NULL;
+    heap->dirty = NULL;
+    heap->stale = NULL;
+    heap->iov = NULL;
+}
+
+static bool heap_pending(const struct mram_heap* heap, uint32_t page) {
+    return ((heap->dirty[page / 32] | heap->stale[page / 32]) >> (page % 32)) & 1;
+}
+
+bool mram_heap_sync(struct mram_heap* heap) {
+    if (heap == NULL || heap->meta == NULL) return false;
+
+    // The target copy was current two syncs ago: it needs the entries changed
+    // since then (stale) and since the last sync (dirty)
+    uint32_t copy = (heap->header.seq + 1) & 1;
+    uint32_t words = (heap->header.pages + 31) / 32;
+    size_t n = 0;
+    uint32_t page = 0;
+    while (page < heap->header.pages) {
+        if ((heap->dirty[page / 32] | heap->stale[page / 32]) == 0) {
+            page = (page / 32 + 1) * 32;
+            continue;
+        }
+        if (!heap_pending(heap, page)) {
+            page++;
+            continue;
+        }
+        uint32_t end = page;
+        while (end < heap->header.pages && heap_pending(heap, end)) end++;
+        // A clean gap of one entry is cheaper to resend than a new frame
+        if (n > 0 && heap->iov[n - 1].addr + heap->iov[n - 1].len + sizeof(struct mram_heap_page) ==
+                         heap_meta_addr(heap, copy, page)) {
+            heap->iov[n - 1].len = heap_meta_addr(heap, copy, end) - heap->iov[n - 1].addr;
+        } else {
+            heap->iov[n].addr = heap_meta_addr(heap, copy, page);
+            heap->iov[n].buf = &heap->meta[page];
+            heap->iov[n].len = (end - page) * sizeof(struct mram_heap_page);
+            n++;
+        }
+        page = end;
+    }
+    if (n == 0) return true;
+
+    // The header goes last and its check covers the whole copy, so a torn
+    // sync never validates and open falls back to the previous version
+    struct mram_heap_header header = heap->header;
+    header.seq++;
+    header.check = heap_check(&header, heap->meta);
+    heap->iov[n].addr = heap_header_addr(heap, copy);
+    heap->iov[n].buf = &header;
+    heap->iov[n].len = sizeof(header);
+    n++;
+
+    if (!mram_write_vector(heap->mram, heap->iov, n)) return false;
+    heap->header = header;
+    memcpy(heap->stale, heap->dirty, words * sizeof(*heap->stale));
+    memset(heap->dirty, 0, words * sizeof(*heap->dirty));
+    heap->stats.syncs++;
+    heap->stats.frames += n;
+    return true;
+}
+
+bool mram_alloc(struct mram_heap* heap, size_t size, uint32_t* addr) {
+    if (heap == NULL || heap->meta == NULL || addr == NULL || size == 0) return false;
+    if (size > (size_t)heap->header.pages * MRAM_HEAP_PAGE_SIZE) return false;
+
+    uint16_t page;
+    if (size <= MRAM_HEAP_MAX_SLOT) {
+        uint8_t cls = 0;
+        while ((size_t)(MRAM_HEAP_MIN_SLOT << cls) < size) cls++;
+
+        if (heap->partial[cls] == HEAP_NIL) {
+            if (!heap_buddy_alloc(heap, 0, &page)) return false;
+            heap_set(heap, page, HEAP_PAGE_SLAB, cls, 0);
+            heap_push(heap, &heap->partial[cls], page);
+        }
+        page = heap->partial[cls];
+        struct mram_heap_page* e = &heap->meta[page];
+        unsigned slot = (unsigned)__builtin_ctz(~(unsigned)e->slots);
+        e->slots |= (uint16_t)(1u << slot);
+        heap_mark(heap, page);
+        if (e->slots == heap_slot_mask(cls)) heap_unlink(heap, &heap->partial[cls], page);
+        *addr = heap->heap + page * MRAM_HEAP_PAGE_SIZE + slot * (MRAM_HEAP_MIN_SLOT << cls);
+    } else {
+        size_t pages = (size + MRAM_HEAP_PAGE_SIZE - 1) / MRAM_HEAP_PAGE_SIZE;
+        uint8_t order = 0;
+        while (((size_t)1 << order) < pages) order++;
+        if (order > MRAM_HEAP_MAX_ORDER || !heap_buddy_alloc(heap, order, &page)) return false;
+        heap_set(heap, page, HEAP_PAGE_LARGE, order, 0);
+        *addr = heap->heap + page * MRAM_HEAP_PAGE_SIZE;
+    }
+    heap->stats.allocs++;
+    return true;
+}
+
+bool mram_free(struct mram_heap* heap, uint32_t addr) {
+    if (heap == NULL || heap->meta == NULL || addr < heap->heap) return false;
+    uint32_t off = addr - heap->heap;
+    if (off >= heap->header.pages * MRAM_HEAP_PAGE_SIZE) return false;
+
+    uint16_t page = (uint16_t)(off / MRAM_HEAP_PAGE_SIZE);
+    uint32_t in_page = off % MRAM_HEAP_PAGE_SIZE;
+    struct mram_heap_page* e = &heap->meta[page];
+
+    if (e->state == HEAP_PAGE_LARGE && in_page == 0) {
+        heap_buddy_free(heap, page, e->order);
+    } else if (e->state == HEAP_PAGE_SLAB) {
+        uint8_t cls = e->order;
+        uint32_t slot_size = MRAM_HEAP_MIN_SLOT << cls;
+        uint16_t bit = (uint16_t)(1u << (in_page / slot_size));
+        if (in_page % slot_size != 0 || !(e->slots & bit)) return false;
+
+        bool was_full = e->slots == heap_slot_mask(cls);
+        e->slots &= (uint16_t)~bit;
+        heap_mark(heap, page);
+        if (e->slots == 0) {
+            // Empty slabs go back to the buddy allocator
+            if (!was_full) heap_unlink(heap, &heap->partial[cls], page);
+            heap_buddy_free(heap, page, 0);
+        } else if (was_full) {
+            heap_push(heap, &heap->partial[cls], page);
+        }
+    } else {
+        return false;
+    }
+    heap->stats.frees++;
+    return true;
+}
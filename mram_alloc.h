@@ -0,0 +1,215 @@
+/**
+ * @file mram_alloc.h
+ * @brief Persistent heap allocator inside the MRAM address space
+ *
+ * Manages a device region as a heap of 256-byte pages. Objects up to 128
+ * bytes come from size-class slabs (16, 32, 64 and 128 bytes). A slab is
+ * one page with a slot bitmap. Larger objects get a power-of-two run of
+ * pages from a buddy allocator, which also supplies the slab pages.
+ *
+ * The only persistent metadata is one 4-byte entry per page: the state and
+ * order of each block head, and the slot bitmap of each slab. It lives at
+ * the start of the region and is mirrored in RAM. The free lists exist
+ * only in RAM. mram_heap_open() reads the metadata in one transfer and
+ * rebuilds the lists by walking the block heads, without scanning the heap
+ * itself. mram_alloc() and mram_free() work only on the RAM copy and mark
+ * the entries they change.
+ *
+ * The metadata is kept in two copies, each with a header carrying a
+ * sequence number and a check over the copy. mram_heap_sync() writes only
+ * the copy that is not current: the entries it is missing, then its
+ * header, in one vector write under a single WREN. A torn sync therefore
+ * leaves the previous version intact, and mram_heap_open() picks the
+ * newest copy whose check matches.
+ *
+ * Region layout:
+ * Region     | Size            | Content
+ * -----------|-----------------|----------------------------------------
+ * Headers    | 2 * 24 bytes    | Header of metadata copy 0 and copy 1
+ * Metadata   | 2 * pages * 4   | Metadata copy 0, then copy 1
+ * Pages      | pages * 256     | Heap pages, 16-byte aligned
+ *
+ * @note Allocations and frees since the last sync are lost on power loss.
+ *       Sync before storing a returned address anywhere persistent.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_ALLOC_H
+#define MRAM_INTERFACE_MRAM_ALLOC_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Heap page size, also the slab size */
+#define MRAM_HEAP_PAGE_SIZE 256
+/** @brief Largest buddy order (2^11 pages = 512 KB) */
+#define MRAM_HEAP_MAX_ORDER 11
+/** @brief Number of slab size classes (16 << class bytes) */
+#define MRAM_HEAP_CLASSES 4
+/** @brief Smallest slab slot */
+#define MRAM_HEAP_MIN_SLOT 16
+/** @brief Largest request served from a slab */
+#define MRAM_HEAP_MAX_SLOT (MRAM_HEAP_MIN_SLOT << (MRAM_HEAP_CLASSES - 1))
+/** @brief Heap header magic ("MRHP") */
+#define MRAM_HEAP_MAGIC 0x5048524Du
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief On-device heap header
+ */
+struct mram_heap_header {
+    /** @brief MRAM_HEAP_MAGIC */
+    uint32_t magic;
+    /** @brief Size of the whole region */
+    uint32_t size;
+    /** @brief Number of heap pages */
+    uint32_t pages;
+    /** @brief MRAM_HEAP_PAGE_SIZE */
+    uint32_t page_size;
+    /** @brief Sync sequence number, the higher valid copy is current */
+    uint32_t seq;
+    /** @brief Check over the fields above and the metadata copy */
+    uint32_t check;
+};
+
+/**
+ * @brief Per-page metadata entry, stored on the device
+ */
+struct mram_heap_page {
+    /** @brief Page state (inside a block, free head, allocated head, slab) */
+    uint8_t state;
+    /** @brief Block order for block heads, size class for slabs */
+    uint8_t order;
+    /** @brief Allocated slot bitmap for slabs */
+    uint16_t slots;
+};
+
+/**
+ * @brief Heap statistics
+ */
+struct mram_heap_stats {
+    /** @brief Successful allocations */
+    uint64_t allocs;
+    /** @brief Successful frees */
+    uint64_t frees;
+    /** @brief Syncs that wrote metadata */
+    uint64_t syncs;
+    /** @brief Metadata frames written by syncs */
+    uint64_t frames;
+};
+
+/**
+ * @brief Heap handle
+ */
+struct mram_heap {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief First device address of the region */
+    uint32_t base;
+    /** @brief Device address of page 0 */
+    uint32_t heap;
+    /** @brief Header of the current metadata copy */
+    struct mram_heap_header header;
+    /** @brief Page metadata, mirrored from the device */
+    struct mram_heap_page* meta;
+    /** @brief Free or partial list links per page (RAM only) */
+    uint16_t* next;
+    /** @brief Free or partial list back links per page (RAM only) */
+    uint16_t* prev;
+    /** @brief Buddy free list heads per order */
+    uint16_t free_list[MRAM_HEAP_MAX_ORDER + 1];
+    /** @brief Slabs with free slots per class */
+    uint16_t partial[MRAM_HEAP_CLASSES];
+    /** @brief One bit per metadata entry changed since the last sync */
+    uint32_t* dirty;
+    /** @brief One bit per metadata entry the copy written by the next sync lacks from earlier syncs */
+    uint32_t* stale;
+    /** @brief Segment scratch for sync */
+    struct mram_iovec* iov;
+    /** @brief Statistics */
+    struct mram_heap_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create an empty heap in a device region
+ *
+ * @param heap Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param base First device address of the region
+ * @param size Size of the region
+ * @return true if successful, false if parameters are invalid, the region
+ *         is too small, allocation fails or communication fails
+ */
+bool mram_heap_format(struct mram_heap* heap, struct mram* mram, uint32_t base, uint32_t size);
+
+/**
+ * @brief Attach to a heap created earlier with the same base and size
+ *
+ * If the last sync was torn, the heap opens as of the sync before it.
+ *
+ * @param heap Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param base First device address of the region
+ * @param size Size of the region
+ * @return true if successful, false if parameters are invalid, no valid heap
+ *         is found, allocation fails or communication fails
+ */
+bool mram_heap_open(struct mram_heap* heap, struct mram* mram, uint32_t base, uint32_t size);
+
+/**
+ * @brief Release the RAM copy (unsynced changes are discarded)
+ *
+ * @param heap Pointer to the handle
+ */
+void mram_heap_deinit(struct mram_heap* heap);
+
+/**
+ * @brief Write all changed metadata to the device
+ *
+ * @param heap Pointer to the handle
+ * @return true if successful or nothing changed, false if communication fails
+ */
+bool mram_heap_sync(struct mram_heap* heap);
+
+/**
+ * @brief Allocate device memory
+ *
+ * @param heap Pointer to the handle
+ * @param size Number of bytes
+ * @param addr Receives the device address of the allocation
+ * @return true if successful, false if parameters are invalid or the heap is exhausted
+ */
+bool mram_alloc(struct mram_heap* heap, size_t size, uint32_t* addr);
+
+/**
+ * @brief Free device memory
+ *
+ * @param heap Pointer to the handle
+ * @param addr Address returned by mram_alloc()
+ * @return true if successful, false if addr is not a live allocation
+ */
+bool mram_free(struct mram_heap* heap, uint32_t addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_ALLOC_H
@@ -0,0 +1,233 @@
+#include "mram_blk.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool blk_overlap(const struct mram_blk_request* a, const struct mram_blk_request* b) {
+    return a->addr < b->addr + b->len && b->addr < a->addr + a->len;
+}
+
+// Reordering two requests is only unsafe when they touch the same bytes and
+// at least one of them writes
+static bool blk_conflict(const struct mram_blk_request* a, const struct mram_blk_request* b) {
+    return (a->op == MRAM_BLK_WRITE || b->op == MRAM_BLK_WRITE) && blk_overlap(a, b);
+}
+
+static int blk_compare(const void* a, const void* b) {
+    const struct mram_blk_request* ra = a;
+    const struct mram_blk_request* rb = b;
+    if (ra->addr != rb->addr) return ra->addr < rb->addr ? -1 : 1;
+    return 0;
+}
+
+// Collect the requests of one kind from a sorted sweep. Address-adjacent
+// segments are continued in the same frame by the vector transfer.
+static size_t blk_collect(struct mram_blk* blk, const struct mram_blk_request* reqs, size_t count,
+                          enum mram_blk_op op) {
+    size_t n = 0;
+    uint32_t end = UINT32_MAX;
+
+    for (size_t i = 0; i < count; i++) {
+        if (reqs[i].op != op) continue;
+        if (reqs[i].addr != end) blk->stats.frames++;
+        blk->iov[n].addr = reqs[i].addr;
+        blk->iov[n].buf = reqs[i].buf;
+        blk->iov[n].len = reqs[i].len;
+        end = reqs[i].addr + reqs[i].len;
+        n++;
+    }
+    return n;
+}
+
+static bool blk_dispatch(struct mram_blk* blk, struct mram_blk_request* reqs, size_t count) {
+    if (count > 1) qsort(reqs, count, sizeof(*reqs), blk_compare);
+    blk->stats.sweeps++;
+
+    // Nothing in a sweep conflicts, so all reads can go before all writes
+    size_t n = blk_collect(blk, reqs, count, MRAM_BLK_READ);
+    if (n != 0 && !mram_read_vector(blk->mram, blk->iov, n)) return false;
+
+    n = blk_collect(blk, reqs, count, MRAM_BLK_WRITE);
+    if (n != 0 && !mram_write_vector(blk->mram, blk->iov, n)) return false;
+    return true;
+}
+
+bool mram_blk_init(struct mram_blk* blk, struct mram* mram, const struct mram_blk_config* config) {
+    if (blk == NULL || mram == NULL || config == NULL) return false;
+    if (config->sector_size == 0 || config->sector_count == 0) return false;
+
+    uint64_t size = (uint64_t)config->sector_size * config->sector_count;
+    if (config->base > MRAM_MAX_ADDRESS || size - 1 > MRAM_MAX_ADDRESS - config->base) return false;
+
+    memset(blk, 0, sizeof(*blk));
+    blk->mram = mram;
+    blk->base = config->base;
+    blk->sector_size = config->sector_size;
+    blk->sector_count = config->sector_count;
+    blk->depth = config->queue_depth ? config->queue_depth : MRAM_BLK_DEFAULT_QUEUE_DEPTH;
+    blk->staging_size = config->staging_size;
+    if (blk->staging_size == 0) {
+        uint64_t staging = (uint64_t)blk->depth * blk->sector_size;
+        blk->staging_size = staging < size ? (uint32_t)staging : (uint32_t)size;
+    }
+
+    blk->queue = malloc(blk->depth * sizeof(*blk->queue));
+    blk->iov = malloc(blk->depth * sizeof(*blk->iov));
+    blk->staging = malloc(blk->staging_size);
+    if (blk->queue == NULL || blk->iov == NULL || blk->staging == NULL) {
+        mram_blk_deinit(blk);
+        return false;
+    }
+    return true;
+}
+
+void mram_blk_deinit(struct mram_blk* blk) {
+    if (blk == NULL) return;
+    free(blk->queue);
+    free(blk->iov);
+    free(blk->staging);
+    blk->queue = NULL;
+    blk->iov = NULL;
+    blk->staging = NULL;
+    blk->pending = 0;
+    blk->staging_used = 0;
+}
+
+bool mram_blk_flush(struct mram_blk* blk) {
+    if (blk == NULL || blk->queue == NULL) return false;
+
+    bool ok = true;
+    uint32_t start = 0;
+    while (start < blk->pending) {
+        // Grow the sweep until a request conflicts with one already in it
+        uint32_t end = start + 1;
+        for (; end < blk->pending; end++) {
+            uint32_t i = start;
+            while (i < end && !blk_conflict(&blk->queue[i], &blk->queue[end])) i++;
+            if (i < end) break;
+        }
+        if (!blk_dispatch(blk, &blk->queue[start], end - start)) {
+            ok = false;
+            break;
+        }
+        start = end;
+    }
+
+    // Keep the failed sweep and everything after it queued, in order, so a
+    // later flush issues them; staged copies stay in use until then
+    blk->pending -= start;
+    memmove(blk->queue, &blk->queue[start], blk->pending * sizeof(*blk->queue));
+    if (blk->pending == 0) blk->staging_used = 0;
+    return ok;
+}
+
+void mram_blk_discard(struct mram_blk* blk) {
+    if (blk == NULL) return;
+    blk->pending = 0;
+    blk->staging_used = 0;
+}
+
+// Drop one queued request whose caller buffer is about to be released. A
+// sweep is sorted in place, so the request is found by its sequence number
+// rather than its queue position; it is gone already if its sweep succeeded.
+static void blk_withdraw(struct mram_blk* blk, uint32_t seq) {
+    for (uint32_t i = 0; i < blk->pending; i++) {
+        if (blk->queue[i].seq != seq) continue;
+        blk->pending--;
+        memmove(&blk->queue[i], &blk->queue[i + 1], (blk->pending - i) * sizeof(*blk->queue));
+        break;
+    }
+    if (blk->pending == 0) blk->staging_used = 0;
+}
+
+// Dispatch the request queued last immediately; if that fails it is
+// withdrawn while earlier requests stay queued
+static bool blk_flush_now(struct mram_blk* blk) {
+    uint32_t seq = blk->queue[blk->pending - 1].seq;
+    if (mram_blk_flush(blk)) return true;
+    blk_withdraw(blk, seq);
+    return false;
+}
+
+// Queue a byte range relative to the block device base
+static bool blk_enqueue(struct mram_blk* blk, enum mram_blk_op op, uint32_t offset, uint32_t len, void* buf) {
+    if (blk->pending == blk->depth && !mram_blk_flush(blk)) return false;
+
+    struct mram_blk_request* req = &blk->queue[blk->pending++];
+    req->op = op;
+    req->addr = blk->base + offset;
+    req->len = len;
+    req->buf = buf;
+    req->seq = blk->seq++;
+    blk->stats.requests++;
+    return true;
+}
+
+bool mram_blk_submit(struct mram_blk* blk, enum mram_blk_op op, uint32_t sector, uint32_t count, void* buf) {
+    if (blk == NULL || blk->queue == NULL || buf == NULL || count == 0) return false;
+    if (op != MRAM_BLK_READ && op != MRAM_BLK_WRITE) return false;
+    if (sector >= blk->sector_count || count > blk->sector_count - sector) return false;
+
+    return blk_enqueue(blk, op, sector * blk->sector_size, count * blk->sector_size, buf);
+}
+
+bool mram_blk_read(struct mram_blk* blk, uint32_t sector, uint32_t count, void* buf) {
+    return mram_blk_submit(blk, MRAM_BLK_READ, sector, count, buf) && blk_flush_now(blk);
+}
+
+bool mram_blk_write(struct mram_blk* blk, uint32_t sector, uint32_t count, const void* buf) {
+    return mram_blk_submit(blk, MRAM_BLK_WRITE, sector, count, (void*)buf) && blk_flush_now(blk);
+}
+
+static bool blk_range_valid(const struct mram_blk* blk, uint32_t block, uint32_t off, uint32_t size) {
+    return blk != NULL && blk->queue != NULL && block < blk->sector_count && off < blk->sector_size &&
+           size <= blk->sector_size - off;
+}
+
+static int blk_ops_read(void* ctx, uint32_t block, uint32_t off, void* buffer, uint32_t size) {
+    struct mram_blk* blk = ctx;
+    if (!blk_range_valid(blk, block, off, size) || buffer == NULL) return MRAM_BLK_ERR_INVAL;
+    if (size == 0) return MRAM_BLK_OK;
+
+    // Queued programs must land first; the read rides along in the same flush
+    if (!blk_enqueue(blk, MRAM_BLK_READ, block * blk->sector_size + off, size, buffer)) return MRAM_BLK_ERR_IO;
+    return blk_flush_now(blk) ? MRAM_BLK_OK : MRAM_BLK_ERR_IO;
+}
+
+static int blk_ops_prog(void* ctx, uint32_t block, uint32_t off, const void* buffer, uint32_t size) {
+    struct mram_blk* blk = ctx;
+    if (!blk_range_valid(blk, block, off, size) || buffer == NULL) return MRAM_BLK_ERR_INVAL;
+    if (size == 0) return MRAM_BLK_OK;
+
+    // The filesystem reuses its buffer after prog returns, so queue a copy
+    if (size > blk->staging_size) {
+        if (!mram_blk_flush(blk)) return MRAM_BLK_ERR_IO;
+        struct mram_iovec iov = { blk->base + block * blk->sector_size + off, (void*)buffer, size };
+        return mram_write_vector(blk->mram, &iov, 1) ? MRAM_BLK_OK : MRAM_BLK_ERR_IO;
+    }
+    if ((blk->pending == blk->depth || size > blk->staging_size - blk->staging_used) && !mram_blk_flush(blk)) {
+        return MRAM_BLK_ERR_IO;
+    }
+
+    uint8_t* copy = blk->staging + blk->staging_used;
+    memcpy(copy, buffer, size);
+    blk->staging_used += size;
+    return blk_enqueue(blk, MRAM_BLK_WRITE, block * blk->sector_size + off, size, copy) ? MRAM_BLK_OK
+                                                                                         : MRAM_BLK_ERR_IO;
+}
+
+static int blk_ops_erase(void* ctx, uint32_t block) {
+    struct mram_blk* blk = ctx;
+    if (blk == NULL || block >= blk->sector_count) return MRAM_BLK_ERR_INVAL;
+    return MRAM_BLK_OK;
+}
+
+static int blk_ops_sync(void* ctx) {
+    return mram_blk_flush(ctx) ? MRAM_BLK_OK : MRAM_BLK_ERR_IO;
+}
+
+const struct mram_blk_ops mram_blk_ops = {
+    .read = blk_ops_read,
+    .prog = blk_ops_prog,
+    .erase = blk_ops_erase,
+    .sync = blk_ops_sync,
+};
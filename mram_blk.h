@@ -0,0 +1,243 @@
+/**
+ * @file mram_blk.h
+ * @brief Block device adapter with request merging
+ *
+ * Exposes a region of the MRAM device as an array of fixed-size sectors.
+ * Requests are queued and dispatched on flush: the queue is sorted by
+ * address in a single ascending sweep, adjacent sector requests collapse
+ * into one long READ or WRITE frame and all writes of a sweep share one
+ * WREN. Requests that overlap an earlier queued request of a different kind
+ * (or two overlapping writes) start a new sweep, so results always match
+ * submission order.
+ *
+ * A callback table with littlefs-style block operations (read, prog, erase,
+ * sync) is provided for embedded filesystems. MRAM needs no erase, so erase
+ * is a no-op.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_BLK_H
+#define MRAM_INTERFACE_MRAM_BLK_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default request queue depth */
+#define MRAM_BLK_DEFAULT_QUEUE_DEPTH 32
+/** @brief Callback return value on success */
+#define MRAM_BLK_OK 0
+/** @brief Callback return value on I/O failure (matches LFS_ERR_IO) */
+#define MRAM_BLK_ERR_IO (-5)
+/** @brief Callback return value for invalid arguments (matches LFS_ERR_INVAL) */
+#define MRAM_BLK_ERR_INVAL (-22)
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Block request type
+ */
+enum mram_blk_op {
+    /** @brief Read sectors into the request buffer */
+    MRAM_BLK_READ,
+    /** @brief Write sectors from the request buffer */
+    MRAM_BLK_WRITE,
+};
+
+/**
+ * @brief Block device configuration
+ */
+struct mram_blk_config {
+    /** @brief First MRAM address of the block device */
+    uint32_t base;
+    /** @brief Sector size in bytes */
+    uint32_t sector_size;
+    /** @brief Number of sectors */
+    uint32_t sector_count;
+    /** @brief Request queue depth (0 = MRAM_BLK_DEFAULT_QUEUE_DEPTH) */
+    uint32_t queue_depth;
+    /** @brief Bytes of write staging for the callback table (0 = queue_depth * sector_size) */
+    uint32_t staging_size;
+};
+
+/**
+ * @brief Queued block request
+ */
+struct mram_blk_request {
+    /** @brief Request type */
+    enum mram_blk_op op;
+    /** @brief Device address */
+    uint32_t addr;
+    /** @brief Length in bytes */
+    uint32_t len;
+    /** @brief Caller buffer */
+    void* buf;
+    /** @brief Sequence number (internal) */
+    uint32_t seq;
+};
+
+/**
+ * @brief Block device statistics
+ */
+struct mram_blk_stats {
+    /** @brief Requests submitted */
+    uint64_t requests;
+    /** @brief READ and WRITE frames issued after merging */
+    uint64_t frames;
+    /** @brief Sweeps dispatched (one WREN at most per sweep) */
+    uint64_t sweeps;
+};
+
+/**
+ * @brief Block device handle
+ */
+struct mram_blk {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief First MRAM address */
+    uint32_t base;
+    /** @brief Sector size */
+    uint32_t sector_size;
+    /** @brief Number of sectors */
+    uint32_t sector_count;
+    /** @brief Request queue */
+    struct mram_blk_request* queue;
+    /** @brief Segment scratch for dispatch */
+    struct mram_iovec* iov;
+    /** @brief Queue capacity */
+    uint32_t depth;
+    /** @brief Queued requests */
+    uint32_t pending;
+    /** @brief Sequence number of the next request */
+    uint32_t seq;
+    /** @brief Copy buffer for writes submitted through the callback table */
+    uint8_t* staging;
+    /** @brief Staging capacity */
+    uint32_t staging_size;
+    /** @brief Staging bytes in use */
+    uint32_t staging_used;
+    /** @brief Statistics */
+    struct mram_blk_stats stats;
+};
+
+/**
+ * @brief littlefs-style block operations
+ *
+ * All callbacks take the struct mram_blk handle as context and return
+ * MRAM_BLK_OK or a negative error code. Wrap them in the filesystem's own
+ * config callbacks, passing the handle through its context pointer.
+ */
+struct mram_blk_ops {
+    /** @brief Read size bytes at offset off of a block */
+    int (*read)(void* ctx, uint32_t block, uint32_t off, void* buffer, uint32_t size);
+    /** @brief Program size bytes at offset off of a block (queued until sync) */
+    int (*prog)(void* ctx, uint32_t block, uint32_t off, const void* buffer, uint32_t size);
+    /** @brief Erase a block (no-op on MRAM) */
+    int (*erase)(void* ctx, uint32_t block);
+    /** @brief Flush all queued programs */
+    int (*sync)(void* ctx);
+};
+
+/** @brief Block operations backed by a struct mram_blk */
+extern const struct mram_blk_ops mram_blk_ops;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a block device
+ *
+ * @param blk Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param config Block device configuration
+ * @return true if successful, false if parameters are invalid, the sectors
+ *         do not fit the device, or allocation fails
+ */
+bool mram_blk_init(struct mram_blk* blk, struct mram* mram, const struct mram_blk_config* config);
+
+/**
+ * @brief Release a block device (pending requests are discarded)
+ *
+ * @param blk Pointer to the handle
+ */
+void mram_blk_deinit(struct mram_blk* blk);
+
+/**
+ * @brief Queue a sector request
+ *
+ * The buffer is used in place and must stay valid until the request has been
+ * dispatched by mram_blk_flush(). A full queue is flushed automatically.
+ *
+ * @param blk Pointer to the handle
+ * @param op Request type
+ * @param sector First sector
+ * @param count Number of sectors
+ * @param buf Data buffer of count * sector_size bytes
+ * @return true if queued, false if parameters are invalid or an automatic
+ *         flush fails
+ */
+bool mram_blk_submit(struct mram_blk* blk, enum mram_blk_op op, uint32_t sector, uint32_t count, void* buf);
+
+/**
+ * @brief Dispatch all queued requests
+ *
+ * If communication fails, the sweep that failed and all requests after it
+ * stay queued in submission order and are issued again by the next flush.
+ * Their buffers must stay valid until then, or until mram_blk_discard().
+ *
+ * @param blk Pointer to the handle
+ * @return true if successful, false if blk is NULL or communication fails
+ */
+bool mram_blk_flush(struct mram_blk* blk);
+
+/**
+ * @brief Drop all queued requests without issuing them
+ *
+ * @param blk Pointer to the handle
+ */
+void mram_blk_discard(struct mram_blk* blk);
+
+/**
+ * @brief Read sectors immediately, together with anything already queued
+ *
+ * On failure this request is withdrawn; earlier requests stay queued.
+ *
+ * @param blk Pointer to the handle
+ * @param sector First sector
+ * @param count Number of sectors
+ * @param buf Destination buffer
+ * @return true if successful, false otherwise
+ */
+bool mram_blk_read(struct mram_blk* blk, uint32_t sector, uint32_t count, void* buf);
+
+/**
+ * @brief Write sectors immediately, together with anything already queued
+ *
+ * On failure this request is withdrawn; earlier requests stay queued.
+ *
+ * @param blk Pointer to the handle
+ * @param sector First sector
+ * @param count Number of sectors
+ * @param buf Source buffer
+ * @return true if successful, false otherwise
+ */
+bool mram_blk_write(struct mram_blk* blk, uint32_t sector, uint32_t count, const void* buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_BLK_H
@@ -0,0 +1,398 @@
+#define _GNU_SOURCE  // memfd_create, CMSG_SPACE, MSG_NOSIGNAL
+#include "mram_client.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static void client_prep(struct mram_client_op* op, uint8_t code) {
+    memset(op, 0, sizeof(*op));
+    op->req.op = code;
+    op->fd = -1;
+}
+
+void mram_client_prep_read(struct mram_client_op* op, uint32_t addr, void* buf, size_t len) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_READ);
+    op->req.addr = addr;
+    op->req.len = len > MRAM_PROTO_MAX_PAYLOAD ? UINT32_MAX : (uint32_t)len;
+    op->buf = buf;
+}
+
+void mram_client_prep_write(struct mram_client_op* op, uint32_t addr, const void* data, size_t len) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_WRITE);
+    op->req.addr = addr;
+    op->req.len = len > MRAM_PROTO_MAX_PAYLOAD ? UINT32_MAX : (uint32_t)len;
+    op->buf = (void*)data;
+}
+
+void mram_client_prep_read_vector(struct mram_client_op* op, const struct mram_iovec* iov, size_t count) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_READ_VECTOR);
+    op->req.count = count > MRAM_PROTO_MAX_SEGMENTS ? UINT16_MAX : (uint16_t)count;
+    op->iov = iov;
+}
+
+void mram_client_prep_write_vector(struct mram_client_op* op, const struct mram_iovec* iov, size_t count) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_WRITE_VECTOR);
+    op->req.count = count > MRAM_PROTO_MAX_SEGMENTS ? UINT16_MAX : (uint16_t)count;
+    op->iov = iov;
+}
+
+void mram_client_prep_read_status(struct mram_client_op* op) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_READ_STATUS);
+}
+
+void mram_client_prep_write_status(struct mram_client_op* op, uint8_t status) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_WRITE_STATUS);
+    op->req.arg = status;
+}
+
+void mram_client_prep_sleep(struct mram_client_op* op) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_SLEEP);
+}
+
+void mram_client_prep_wake(struct mram_client_op* op) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_WAKE);
+}
+
+void mram_client_prep_shm_read(struct mram_client_op* op, const struct mram_proto_segment* segs, size_t count) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_SHM_READ_VECTOR);
+    op->req.count = count > MRAM_PROTO_MAX_SEGMENTS ? UINT16_MAX : (uint16_t)count;
+    op->segs = segs;
+}
+
+void mram_client_prep_shm_write(struct mram_client_op* op, const struct mram_proto_segment* segs, size_t count) {
+    if (op == NULL) return;
+    client_prep(op, MRAM_PROTO_SHM_WRITE_VECTOR);
+    op->req.count = count > MRAM_PROTO_MAX_SEGMENTS ? UINT16_MAX : (uint16_t)count;
+    op->segs = segs;
+}
+
+// Send the whole iovec list, passing fd (if any) with the first byte
+static bool client_sendv(int sock, struct iovec* v, size_t n, int fd) {
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    while (n > 0) {
+        struct msghdr msg = { 0 };
+        msg.msg_iov = v;
+        msg.msg_iovlen = n;
+        if (fd >= 0) {
+            msg.msg_control = control.buf;
+            msg.msg_controllen = sizeof(control.buf);
+            struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+            c->cmsg_level = SOL_SOCKET;
+            c->cmsg_type = SCM_RIGHTS;
+            c->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(c), &fd, sizeof(int));
+        }
+
+        ssize_t r = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        fd = -1;
+        while (n > 0 && (size_t)r >= v->iov_len) {
+            r -= (ssize_t)v->iov_len;
+            v++;
+            n--;
+        }
+        if (n > 0) {
+            v->iov_base = (uint8_t*)v->iov_base + r;
+            v->iov_len -= (size_t)r;
+        }
+    }
+    return true;
+}
+
+static bool client_recvv(int sock, struct iovec* v, size_t n) {
+    while (n > 0) {
+        if (v->iov_len == 0) {
+            v++;
+            n--;
+            continue;
+        }
+        struct msghdr msg = { 0 };
+        msg.msg_iov = v;
+        msg.msg_iovlen = n;
+        ssize_t r = recvmsg(sock, &msg, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        while (n > 0 && (size_t)r >= v->iov_len) {
+            r -= (ssize_t)v->iov_len;
+            v++;
+            n--;
+        }
+        if (n > 0) {
+            v->iov_base = (uint8_t*)v->iov_base + r;
+            v->iov_len -= (size_t)r;
+        }
+    }
+    return true;
+}
+
+// Segment descriptors and total length of an inline vector request
+static bool client_vector(struct mram_client* client, struct mram_client_op* op) {
+    size_t total = 0;
+
+    if (op->iov == NULL || op->req.count == 0 || op->req.count > MRAM_PROTO_MAX_SEGMENTS) return false;
+    for (size_t i = 0; i < op->req.count; i++) {
+        if (op->iov[i].buf == NULL || op->iov[i].len == 0 || op->iov[i].len > MRAM_PROTO_MAX_PAYLOAD - total) {
+            return false;
+        }
+        client->segs[i].addr = op->iov[i].addr;
+        client->segs[i].len = (uint32_t)op->iov[i].len;
+        client->segs[i].offset = 0;
+        total += op->iov[i].len;
+    }
+    op->req.len = (uint32_t)total;
+    return true;
+}
+
+// The stream is out of step once a transfer fails: complete every in-flight
+// request as failed and close the connection, so no caller is left waiting
+// on a descriptor the handle still points to
+static bool client_fail(struct mram_client* client) {
+    for (struct mram_client_op* op = client->head; op != NULL; op = op->next) {
+        op->result = false;
+        op->done = true;
+    }
+    client->head = client->tail = NULL;
+    close(client->fd);
+    client->fd = -1;
+    return false;
+}
+
+bool mram_client_submit(struct mram_client* client, struct mram_client_op* op) {
+    if (client == NULL || client->fd < 0 || op == NULL) return false;
+
+    struct iovec v[2 + MRAM_PROTO_MAX_SEGMENTS];
+    size_t n = 1;
+    switch (op->req.op) {
+        case MRAM_PROTO_READ:
+        case MRAM_PROTO_WRITE:
+            if (op->buf == NULL || op->req.len == 0 || op->req.len > MRAM_PROTO_MAX_PAYLOAD) return false;
+            if (op->req.op == MRAM_PROTO_WRITE) v[n++] = (struct iovec){ op->buf, op->req.len };
+            break;
+        case MRAM_PROTO_READ_VECTOR:
+        case MRAM_PROTO_WRITE_VECTOR:
+            if (!client_vector(client, op)) return false;
+            v[n++] = (struct iovec){ client->segs, op->req.count * sizeof(*client->segs) };
+            if (op->req.op == MRAM_PROTO_WRITE_VECTOR) {
+                for (size_t i = 0; i < op->req.count; i++) v[n++] = (struct iovec){ op->iov[i].buf, op->iov[i].len };
+            }
+            break;
+        case MRAM_PROTO_SHM_READ_VECTOR:
+        case MRAM_PROTO_SHM_WRITE_VECTOR:
+            if (op->segs == NULL || op->req.count == 0 || op->req.count > MRAM_PROTO_MAX_SEGMENTS) return false;
+            v[n++] = (struct iovec){ (void*)op->segs, op->req.count * sizeof(*op->segs) };
+            break;
+        default:
+            break;
+    }
+
+    op->req.id = client->next_id++;
+    op->done = false;
+    op->result = false;
+    op->next = NULL;
+    v[0] = (struct iovec){ &op->req, sizeof(op->req) };
+    if (!client_sendv(client->fd, v, n, op->fd)) return client_fail(client);
+
+    if (client->tail) {
+        client->tail->next = op;
+    } else {
+        client->head = op;
+    }
+    client->tail = op;
+    return true;
+}
+
+bool mram_client_complete(struct mram_client* client, struct mram_client_op** out) {
+    if (client == NULL || client->fd < 0 || client->head == NULL) return false;
+
+    struct mram_client_op* op = client->head;
+    struct mram_proto_response resp;
+    struct iovec hv = { &resp, sizeof(resp) };
+    if (!client_recvv(client->fd, &hv, 1) || resp.id != op->req.id) return client_fail(client);
+
+    if (resp.len) {
+        struct iovec v[MRAM_PROTO_MAX_SEGMENTS];
+        size_t n = 0;
+        if (resp.len != op->req.len) return client_fail(client);
+        if (op->req.op == MRAM_PROTO_READ) {
+            v[n++] = (struct iovec){ op->buf, op->req.len };
+        } else if (op->req.op == MRAM_PROTO_READ_VECTOR) {
+            for (size_t i = 0; i < op->req.count; i++) v[n++] = (struct iovec){ op->iov[i].buf, op->iov[i].len };
+        } else {
+            return client_fail(client);
+        }
+        if (!client_recvv(client->fd, v, n)) return client_fail(client);
+    }
+
+    client->head = op->next;
+    if (client->head == NULL) client->tail = NULL;
+    op->result = resp.result == MRAM_PROTO_OK;
+    op->status = resp.status;
+    op->done = true;
+    if (out) *out = op;
+    return true;
+}
+
+// Submit and wait, completing anything queued ahead of op on the way
+static bool client_call(struct mram_client* client, struct mram_client_op* op) {
+    if (!mram_client_submit(client, op)) return false;
+    while (!op->done) {
+        if (!mram_client_complete(client, NULL)) return false;
+    }
+    return op->result;
+}
+
+bool mram_client_connect(struct mram_client* client, const char* path) {
+    if (client == NULL) return false;
+    if (path == NULL) path = MRAM_PROTO_DEFAULT_PATH;
+
+    struct sockaddr_un sa = { 0 };
+    if (strlen(path) >= sizeof(sa.sun_path)) return false;
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+
+    memset(client, 0, sizeof(*client));
+    client->segs = malloc(MRAM_PROTO_MAX_SEGMENTS * sizeof(*client->segs));
+    client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->segs == NULL || client->fd < 0 || connect(client->fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+        mram_client_close(client);
+        return false;
+    }
+    return true;
+}
+
+void mram_client_close(struct mram_client* client) {
+    if (client == NULL) return;
+    if (client->fd >= 0) close(client->fd);
+    if (client->shm) munmap(client->shm, client->shm_size);
+    free(client->segs);
+    client->fd = -1;
+    client->shm = NULL;
+    client->segs = NULL;
+    client->head = client->tail = NULL;
+}
+
+bool mram_client_attach_shm(struct mram_client* client, size_t size, void** mem) {
+    if (client == NULL || client->fd < 0 || mem == NULL || size == 0 || size > UINT32_MAX) return false;
+
+    // The server maps only sealed memory, so the client cannot shrink it later
+#ifdef MFD_ALLOW_SEALING
+    int fd = memfd_create("mram_client", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    int fd = -1;
+#endif
+    if (fd < 0) return false;
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0 && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) == 0) {
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (p == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    struct mram_client_op op;
+    client_prep(&op, MRAM_PROTO_ATTACH_SHM);
+    op.req.len = (uint32_t)size;
+    op.fd = fd;
+    bool ok = client_call(client, &op);
+    close(fd);
+    if (!ok) {
+        munmap(p, size);
+        return false;
+    }
+
+    if (client->shm) munmap(client->shm, client->shm_size);
+    client->shm = p;
+    client->shm_size = size;
+    *mem = p;
+    return true;
+}
+
+bool mram_client_read(struct mram_client* client, uint32_t addr, uint8_t* buffer, size_t len) {
+    struct mram_client_op op;
+    mram_client_prep_read(&op, addr, buffer, len);
+    return client_call(client, &op);
+}
+
+bool mram_client_write(struct mram_client* client, uint32_t addr, const uint8_t* data, size_t len) {
+    struct mram_client_op op;
+    mram_client_prep_write(&op, addr, data, len);
+    return client_call(client, &op);
+}
+
+bool mram_client_read_vector(struct mram_client* client, const struct mram_iovec* iov, size_t count) {
+    struct mram_client_op op;
+    mram_client_prep_read_vector(&op, iov, count);
+    return client_call(client, &op);
+}
+
+bool mram_client_write_vector(struct mram_client* client, const struct mram_iovec* iov, size_t count) {
+    struct mram_client_op op;
+    mram_client_prep_write_vector(&op, iov, count);
+    return client_call(client, &op);
+}
+
+bool mram_client_read_status_register(struct mram_client* client, uint8_t* status) {
+    if (status == NULL) return false;
+    struct mram_client_op op;
+    mram_client_prep_read_status(&op);
+    if (!client_call(client, &op)) return false;
+    *status = op.status;
+    return true;
+}
+
+bool mram_client_write_status_register(struct mram_client* client, uint8_t status) {
+    struct mram_client_op op;
+    mram_client_prep_write_status(&op, status);
+    return client_call(client, &op);
+}
+
+bool mram_client_sleep(struct mram_client* client) {
+    struct mram_client_op op;
+    mram_client_prep_sleep(&op);
+    return client_call(client, &op);
+}
+
+bool mram_client_wake(struct mram_client* client) {
+    struct mram_client_op op;
+    mram_client_prep_wake(&op);
+    return client_call(client, &op);
+}
+
+bool mram_client_shm_read(struct mram_client* client, const struct mram_proto_segment* segs, size_t count) {
+    struct mram_client_op op;
+    mram_client_prep_shm_read(&op, segs, count);
+    return client_call(client, &op);
+}
+
+bool mram_client_shm_write(struct mram_client* client, const struct mram_proto_segment* segs, size_t count) {
+    struct mram_client_op op;
+    mram_client_prep_shm_write(&op, segs, count);
+    return client_call(client, &op);
+}
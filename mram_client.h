@@ -0,0 +1,232 @@
+/**
+ * @file mram_client.h
+ * @brief Client library for mramd, mirroring the mram_* API
+ *
+ * mram_client_read(), mram_client_write() and the other blocking calls
+ * behave like their mram_* counterparts, but they run on the device owned
+ * by an mramd process, so any number of processes can share it.
+ *
+ * For pipelining, fill request descriptors with the mram_client_prep_*
+ * functions and pass them to mram_client_submit(), which sends at once
+ * without waiting. mram_client_complete() then collects the responses in
+ * submission order. Inline payloads leave user buffers through scatter
+ * sends and return through scatter receives, with no staging copy.
+ *
+ * For bulk data, mram_client_attach_shm() creates a shared memory buffer
+ * and passes its descriptor to the server. The SHM vector operations then
+ * move data between the device and that buffer, and only the segment
+ * descriptors cross the socket.
+ *
+ * A failed send or receive leaves the stream out of step, so the handle
+ * closes the connection: every in-flight request completes with a false
+ * result, and later calls fail until the handle is connected again.
+ *
+ * @note A client handle is not thread-safe. Collect completions before more
+ *       than the server's backlog limit (MRAM_SERVER_MAX_BACKLOG unless
+ *       changed) of responses is outstanding, or the server stops reading
+ *       from the connection.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_CLIENT_H
+#define MRAM_INTERFACE_MRAM_CLIENT_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+#include "mram_proto.h"
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Request descriptor, owned by the caller until it completes
+ */
+struct mram_client_op {
+    /** @brief Wire header (id is assigned on submit) */
+    struct mram_proto_request req;
+    /** @brief Buffer of a plain read or write */
+    void* buf;
+    /** @brief Segments of an inline vector operation */
+    const struct mram_iovec* iov;
+    /** @brief Segments of an SHM vector operation */
+    const struct mram_proto_segment* segs;
+    /** @brief Descriptor passed along with the request, -1 for none */
+    int fd;
+    /** @brief Set once the response has arrived */
+    bool done;
+    /** @brief True if the server reported success */
+    bool result;
+    /** @brief Status register value of a status read */
+    uint8_t status;
+    /** @brief In-flight list link */
+    struct mram_client_op* next;
+};
+
+/**
+ * @brief Client handle
+ */
+struct mram_client {
+    /** @brief Connected socket, -1 once closed or after a connection failure */
+    int fd;
+    /** @brief Next request id */
+    uint32_t next_id;
+    /** @brief Oldest in-flight request */
+    struct mram_client_op* head;
+    /** @brief Newest in-flight request */
+    struct mram_client_op* tail;
+    /** @brief Shared memory attached to the server, NULL if none */
+    void* shm;
+    /** @brief Size of the shared memory */
+    size_t shm_size;
+    /** @brief Segment scratch for inline vector requests */
+    struct mram_proto_segment* segs;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Connect to mramd
+ *
+ * @param client Pointer to the handle to initialize
+ * @param path Socket path (NULL = MRAM_PROTO_DEFAULT_PATH)
+ * @return true if successful, false if parameters are invalid or the connection fails
+ */
+bool mram_client_connect(struct mram_client* client, const char* path);
+
+/**
+ * @brief Close the connection (in-flight requests are abandoned)
+ *
+ * @param client Pointer to the handle
+ */
+void mram_client_close(struct mram_client* client);
+
+/** @brief Prepare a read of len bytes at addr into buf */
+void mram_client_prep_read(struct mram_client_op* op, uint32_t addr, void* buf, size_t len);
+/** @brief Prepare a write of len bytes from data to addr */
+void mram_client_prep_write(struct mram_client_op* op, uint32_t addr, const void* data, size_t len);
+/** @brief Prepare a vectored read */
+void mram_client_prep_read_vector(struct mram_client_op* op, const struct mram_iovec* iov, size_t count);
+/** @brief Prepare a vectored write */
+void mram_client_prep_write_vector(struct mram_client_op* op, const struct mram_iovec* iov, size_t count);
+/** @brief Prepare a status register read */
+void mram_client_prep_read_status(struct mram_client_op* op);
+/** @brief Prepare a status register write */
+void mram_client_prep_write_status(struct mram_client_op* op, uint8_t status);
+/** @brief Prepare entering sleep mode */
+void mram_client_prep_sleep(struct mram_client_op* op);
+/** @brief Prepare leaving sleep mode */
+void mram_client_prep_wake(struct mram_client_op* op);
+/** @brief Prepare a read from the device into the shared memory */
+void mram_client_prep_shm_read(struct mram_client_op* op, const struct mram_proto_segment* segs, size_t count);
+/** @brief Prepare a write from the shared memory to the device */
+void mram_client_prep_shm_write(struct mram_client_op* op, const struct mram_proto_segment* segs, size_t count);
+
+/**
+ * @brief Send a prepared request without waiting for its response
+ *
+ * @param client Pointer to the handle
+ * @param op Prepared descriptor, must stay valid until it completes
+ * @return true if sent, false if the request is too large or the connection
+ *         fails (which fails every in-flight request, see above)
+ */
+bool mram_client_submit(struct mram_client* client, struct mram_client_op* op);
+
+/**
+ * @brief Wait for the oldest in-flight request to complete
+ *
+ * @param client Pointer to the handle
+ * @param op Receives the completed descriptor (may be NULL)
+ * @return true if a request completed, false if none is in flight or the
+ *         connection fails (which fails every in-flight request, see above)
+ */
+bool mram_client_complete(struct mram_client* client, struct mram_client_op** op);
+
+/**
+ * @brief Create shared memory and attach it to the server
+ *
+ * Replaces any earlier shared memory of this client. The memory is a
+ * memfd sealed against shrinking, so this needs memfd sealing (Linux).
+ *
+ * @param client Pointer to the handle
+ * @param size Size in bytes
+ * @param mem Receives the local mapping
+ * @return true if successful, false otherwise
+ */
+bool mram_client_attach_shm(struct mram_client* client, size_t size, void** mem);
+
+/**
+ * @brief Remote mram_read()
+ */
+bool mram_client_read(struct mram_client* client, uint32_t addr, uint8_t* buffer, size_t len);
+
+/**
+ * @brief Remote mram_write()
+ */
+bool mram_client_write(struct mram_client* client, uint32_t addr, const uint8_t* data, size_t len);
+
+/**
+ * @brief Remote mram_read_vector()
+ */
+bool mram_client_read_vector(struct mram_client* client, const struct mram_iovec* iov, size_t count);
+
+/**
+ * @brief Remote mram_write_vector()
+ */
+bool mram_client_write_vector(struct mram_client* client, const struct mram_iovec* iov, size_t count);
+
+/**
+ * @brief Remote mram_read_status_register()
+ */
+bool mram_client_read_status_register(struct mram_client* client, uint8_t* status);
+
+/**
+ * @brief Remote mram_write_status_register()
+ */
+bool mram_client_write_status_register(struct mram_client* client, uint8_t status);
+
+/**
+ * @brief Remote mram_sleep()
+ */
+bool mram_client_sleep(struct mram_client* client);
+
+/**
+ * @brief Remote mram_wake()
+ */
+bool mram_client_wake(struct mram_client* client);
+
+/**
+ * @brief Read segments from the device into the shared memory
+ *
+ * @param client Pointer to the handle
+ * @param segs Segments with device address, length and shared memory offset
+ * @param count Number of segments
+ * @return true if successful, false otherwise
+ */
+bool mram_client_shm_read(struct mram_client* client, const struct mram_proto_segment* segs, size_t count);
+
+/**
+ * @brief Write segments from the shared memory to the device
+ *
+ * @param client Pointer to the handle
+ * @param segs Segments with device address, length and shared memory offset
+ * @param count Number of segments
+ * @return true if successful, false otherwise
+ */
+bool mram_client_shm_write(struct mram_client* client, const struct mram_proto_segment* segs, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_CLIENT_H
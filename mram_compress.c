@@ -0,0 +1,477 @@
+#include "mram_compress.h"
+#include <stdlib.h>
+#include <string.h>
+
+// LZ4 block format parameters
+#define LZ_MIN_MATCH      4
+#define LZ_LAST_LITERALS  5
+#define LZ_MFLIMIT        12
+#define LZ_MAX_OFFSET     65535
+#define LZ_HASH_BITS      12
+#define LZ_SKIP_TRIGGER   6
+
+// On-device map slot: unit(2) len(2, bit 15 = raw) gen(2) check(2)
+#define CZ_SLOT_SIZE      8
+#define CZ_LEN_RAW        0x8000u
+#define CZ_NO_BLOCK       UINT32_MAX
+#define CZ_MAP_CHUNK      4096
+
+/*******************************************************************************
+ * LZ4 block codec
+ ******************************************************************************/
+
+static uint32_t lz_read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t lz_hash(uint32_t seq) {
+    return (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Write a length continuation (255, 255, ..., rest). Returns false on overflow.
+static bool lz_put_length(uint8_t* dst, size_t cap, size_t* op, size_t len) {
+    for (; len >= 255; len -= 255) {
+        if (*op >= cap) return false;
+        dst[(*op)++] = 255;
+    }
+    if (*op >= cap) return false;
+    dst[(*op)++] = (uint8_t)len;
+    return true;
+}
+
+static bool lz_emit(uint8_t* dst, size_t cap, size_t* op, const uint8_t* literals, size_t lit_len,
+                    size_t offset, size_t match_len) {
+    if (*op >= cap) return false;
+    size_t token = (*op)++;
+    dst[token] = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15 && !lz_put_length(dst, cap, op, lit_len - 15)) return false;
+
+    if (lit_len > cap - *op) return false;
+    memcpy(dst + *op, literals, lit_len);
+    *op += lit_len;
+
+    // The final sequence carries literals only
+    if (match_len == 0) return true;
+
+    if (cap - *op < 2) return false;
+    dst[(*op)++] = offset & 0xFF;
+    dst[(*op)++] = (offset >> 8) & 0xFF;
+
+    size_t ml = match_len - LZ_MIN_MATCH;
+    dst[token] |= (uint8_t)(ml >= 15 ? 15 : ml);
+    if (ml >= 15 && !lz_put_length(dst, cap, op, ml - 15)) return false;
+    return true;
+}
+
+size_t mram_lz_compress(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_cap) {
+    if (src == NULL || dst == NULL) return 0;
+
+    uint32_t table[1u << LZ_HASH_BITS];
+    size_t ip = 0, anchor = 0, op = 0;
+    memset(table, 0xFF, sizeof(table));
+
+    if (src_len > LZ_MFLIMIT) {
+        size_t limit = src_len - LZ_MFLIMIT;
+        size_t misses = 0;
+
+        while (ip < limit) {
+            uint32_t seq = lz_read32(src + ip);
+            uint32_t h = lz_hash(seq);
+            size_t ref = table[h];
+            table[h] = (uint32_t)ip;
+
+            if (ref == UINT32_MAX || ip - ref > LZ_MAX_OFFSET || lz_read32(src + ref) != seq) {
+                // Step faster through data that does not compress
+                ip += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+
+            // Extend backwards over pending literals, then forwards
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                ip--;
+                ref--;
+            }
+            size_t len = LZ_MIN_MATCH;
+            while (ip + len < src_len - LZ_LAST_LITERALS && src[ref + len] == src[ip + len]) len++;
+
+            if (!lz_emit(dst, dst_cap, &op, src + anchor, ip - anchor, ip - ref, len)) return 0;
+            ip += len;
+            anchor = ip;
+        }
+    }
+
+    if (!lz_emit(dst, dst_cap, &op, src + anchor, src_len - anchor, 0, 0)) return 0;
+    return op;
+}
+
+bool mram_lz_decompress(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len) {
+    if (src == NULL || dst == NULL) return false;
+    size_t ip = 0, op = 0;
+
+    while (ip < src_len) {
+        uint8_t token = src[ip++];
+
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= src_len) return false;
+                b = src[ip++];
+                lit += b;
+            } while (b == 255);
+        }
+        if (lit > src_len - ip || lit > dst_len - op) return false;
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+
+        if (ip == src_len) break;
+
+        if (src_len - ip < 2) return false;
+        size_t offset = src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) return false;
+
+        size_t len = (token & 0x0F) + LZ_MIN_MATCH;
+        if ((token & 0x0F) == 15) {
+            uint8_t b;
+            do {
+                if (ip >= src_len) return false;
+                b = src[ip++];
+                len += b;
+            } while (b == 255);
+        }
+        if (len > dst_len - op) return false;
+
+        // Overlapping matches replicate the pattern, so copy bytewise then
+        if (offset >= len) {
+            memcpy(dst + op, dst + op - offset, len);
+        } else {
+            for (size_t i = 0; i < len; i++) dst[op + i] = dst[op - offset + i];
+        }
+        op += len;
+    }
+    return op == dst_len;
+}
+
+/*******************************************************************************
+ * Map slots and allocation
+ ******************************************************************************/
+
+static uint16_t cz_check(const uint8_t* slot) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        h ^= slot[i];
+        h *= 16777619u;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+static void cz_encode_slot(uint8_t* slot, uint16_t unit, uint16_t len, bool raw, uint16_t gen) {
+    uint16_t stored_len = len | (raw ? CZ_LEN_RAW : 0);
+    slot[0] = unit & 0xFF;
+    slot[1] = unit >> 8;
+    slot[2] = stored_len & 0xFF;
+    slot[3] = stored_len >> 8;
+    slot[4] = gen & 0xFF;
+    slot[5] = gen >> 8;
+    uint16_t check = cz_check(slot);
+    slot[6] = check & 0xFF;
+    slot[7] = check >> 8;
+}
+
+static bool cz_decode_slot(const uint8_t* slot, struct mram_cz_block* out) {
+    if (cz_check(slot) != (uint16_t)(slot[6] | (slot[7] << 8))) return false;
+    uint16_t stored_len = (uint16_t)(slot[2] | (slot[3] << 8));
+    out->unit = (uint16_t)(slot[0] | (slot[1] << 8));
+    out->len = stored_len & ~CZ_LEN_RAW;
+    out->raw = (stored_len & CZ_LEN_RAW) != 0;
+    out->gen = (uint16_t)(slot[4] | (slot[5] << 8));
+    return true;
+}
+
+static uint32_t cz_units_for(uint32_t len) {
+    return (len + MRAM_CZ_UNIT_SIZE - 1) / MRAM_CZ_UNIT_SIZE;
+}
+
+static bool cz_unit_used(const struct mram_cz* cz, uint32_t unit) {
+    return (cz->used[unit / 32] >> (unit % 32)) & 1;
+}
+
+static void cz_mark(struct mram_cz* cz, uint32_t unit, uint32_t n, bool used) {
+    for (uint32_t u = unit; u < unit + n; u++) {
+        if (used) cz->used[u / 32] |= 1u << (u % 32);
+        else cz->used[u / 32] &= ~(1u << (u % 32));
+    }
+    if (used) cz->used_units += n;
+    else cz->used_units -= n;
+}
+
+// Next-fit search for n free consecutive units.
+static bool cz_alloc(struct mram_cz* cz, uint32_t n, uint32_t* unit_out) {
+    if (n > cz->units - cz->used_units) return false;
+
+    uint32_t start = cz->cursor, run = 0;
+    for (uint32_t scanned = 0; scanned < cz->units + n; scanned++) {
+        uint32_t u = (start + scanned) % cz->units;
+        if (u == 0) run = 0;  // runs never wrap around the region end
+        if (cz_unit_used(cz, u)) {
+            run = 0;
+            continue;
+        }
+        if (++run == n) {
+            *unit_out = u + 1 - n;
+            cz_mark(cz, *unit_out, n, true);
+            cz->cursor = (u + 1) % cz->units;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * Block load and store
+ ******************************************************************************/
+
+static bool cz_load_block(struct mram_cz* cz, uint32_t b, uint8_t* out) {
+    const struct mram_cz_block* m = &cz->map[b];
+    if (m->len == 0) {
+        memset(out, 0, cz->block_size);
+        return true;
+    }
+
+    struct mram_iovec iov = {
+        .addr = cz->data_addr + (uint32_t)m->unit * MRAM_CZ_UNIT_SIZE,
+        .buf = m->raw ? out : cz->packed,
+        .len = m->len,
+    };
+    if (!mram_read_vector(cz->mram, &iov, 1)) return false;
+    cz->stats.bus_read += m->len;
+
+    if (m->raw) return m->len == cz->block_size;
+    return mram_lz_decompress(cz->packed, m->len, out, cz->block_size);
+}
+
+// Store a full logical block out of place: data frame and map slot go out
+// under one WREN, and the old units are released only after both landed.
+static bool cz_store_block(struct mram_cz* cz, uint32_t b, const uint8_t* plain) {
+    struct mram_cz_block* m = &cz->map[b];
+    const uint8_t* payload = cz->packed;
+    bool raw = false;
+
+    size_t len = mram_lz_compress(plain, cz->block_size, cz->packed, cz->block_size - 1);
+    if (len == 0) {
+        payload = plain;
+        len = cz->block_size;
+        raw = true;
+    }
+
+    uint32_t n = cz_units_for((uint32_t)len);
+    uint32_t old_n = cz_units_for(m->len);
+    uint32_t unit;
+    // Overwriting the old units in place would lose both versions to a torn
+    // write, so a region too full for a second copy refuses the update
+    if (!cz_alloc(cz, n, &unit)) return false;
+
+    uint16_t gen = m->gen + 1;
+    uint8_t slot[CZ_SLOT_SIZE];
+    cz_encode_slot(slot, (uint16_t)unit, (uint16_t)len, raw, gen);
+
+    struct mram_iovec iov[2] = {
+        { cz->data_addr + unit * MRAM_CZ_UNIT_SIZE, (void*)payload, len },
+        { cz->map_addr + b * MRAM_CZ_MAP_ENTRY_SIZE + (gen & 1) * CZ_SLOT_SIZE, slot, sizeof(slot) },
+    };
+    // A failed call may still have put the data and the map slot on the
+    // device, e.g. when only the closing WRDI failed, and the next open would
+    // then pick them. The units stay allocated until that open rebuilds the
+    // usage map; the next store of b takes the same map slot again.
+    if (!mram_write_vector(cz->mram, iov, 2)) return false;
+    cz->stats.bus_written += len + sizeof(slot);
+
+    if (m->len != 0) cz_mark(cz, m->unit, old_n, false);
+    m->unit = (uint16_t)unit;
+    m->len = (uint16_t)len;
+    m->raw = raw;
+    m->gen = gen;
+    return true;
+}
+
+/*******************************************************************************
+ * Public API
+ ******************************************************************************/
+
+static bool cz_config_valid(const struct mram_cz_config* config) {
+    if (config == NULL) return false;
+    uint32_t bs = config->block_size;
+    if (bs < MRAM_CZ_MIN_BLOCK_SIZE || bs > MRAM_CZ_MAX_BLOCK_SIZE || (bs & (bs - 1)) != 0) return false;
+    if (config->logical_size == 0 || config->logical_size % bs != 0) return false;
+    if (config->data_size < MRAM_CZ_UNIT_SIZE) return false;
+
+    uint32_t map_size = config->logical_size / bs * MRAM_CZ_MAP_ENTRY_SIZE;
+    if (config->map_addr > MRAM_MAX_ADDRESS || map_size > MRAM_SIZE_BYTES - config->map_addr) return false;
+    if (config->data_addr > MRAM_MAX_ADDRESS || config->data_size > MRAM_SIZE_BYTES - config->data_addr) return false;
+    return config->map_addr + map_size <= config->data_addr || config->data_addr + config->data_size <= config->map_addr;
+}
+
+bool mram_cz_format(struct mram* mram, const struct mram_cz_config* config) {
+    if (mram == NULL || !cz_config_valid(config)) return false;
+
+    static const uint8_t zero[256];
+    struct mram_iovec iov[CZ_MAP_CHUNK / sizeof(zero)];
+    uint32_t map_size = config->logical_size / config->block_size * MRAM_CZ_MAP_ENTRY_SIZE;
+
+    // Adjacent segments share one frame, so each call is one long WRITE
+    for (uint32_t done = 0; done < map_size;) {
+        size_t n = 0;
+        while (n < sizeof(iov) / sizeof(iov[0]) && done < map_size) {
+            uint32_t len = map_size - done < sizeof(zero) ? map_size - done : sizeof(zero);
+            iov[n].addr = config->map_addr + done;
+            iov[n].buf = (void*)zero;
+            iov[n].len = len;
+            n++;
+            done += len;
+        }
+        if (!mram_write_vector(mram, iov, n)) return false;
+    }
+    return true;
+}
+
+bool mram_cz_open(struct mram_cz* cz, struct mram* mram, const struct mram_cz_config* config) {
+    if (cz == NULL || mram == NULL || !cz_config_valid(config)) return false;
+
+    memset(cz, 0, sizeof(*cz));
+    cz->mram = mram;
+    cz->map_addr = config->map_addr;
+    cz->data_addr = config->data_addr;
+    cz->units = config->data_size / MRAM_CZ_UNIT_SIZE;
+    cz->block_size = config->block_size;
+    cz->blocks = config->logical_size / config->block_size;
+    cz->cache_block = CZ_NO_BLOCK;
+    cz->map = calloc(cz->blocks, sizeof(*cz->map));
+    cz->used = calloc((cz->units + 31) / 32, sizeof(*cz->used));
+    cz->cache = malloc(cz->block_size);
+    cz->packed = malloc(cz->block_size);
+    uint8_t* chunk = malloc(CZ_MAP_CHUNK);
+    if (cz->map == NULL || cz->used == NULL || cz->cache == NULL || cz->packed == NULL || chunk == NULL) {
+        free(chunk);
+        mram_cz_close(cz);
+        return false;
+    }
+
+    const uint32_t per_chunk = CZ_MAP_CHUNK / MRAM_CZ_MAP_ENTRY_SIZE;
+    for (uint32_t b0 = 0; b0 < cz->blocks; b0 += per_chunk) {
+        uint32_t nb = cz->blocks - b0 < per_chunk ? cz->blocks - b0 : per_chunk;
+        struct mram_iovec iov = { cz->map_addr + b0 * MRAM_CZ_MAP_ENTRY_SIZE, chunk, nb * MRAM_CZ_MAP_ENTRY_SIZE };
+        if (!mram_read_vector(mram, &iov, 1)) {
+            free(chunk);
+            mram_cz_close(cz);
+            return false;
+        }
+
+        for (uint32_t k = 0; k < nb; k++) {
+            struct mram_cz_block a, b;
+            const uint8_t* entry = chunk + k * MRAM_CZ_MAP_ENTRY_SIZE;
+            bool a_valid = cz_decode_slot(entry, &a) && (a.gen & 1) == 0;
+            bool b_valid = cz_decode_slot(entry + CZ_SLOT_SIZE, &b) && (b.gen & 1) == 1;
+            struct mram_cz_block* m = &cz->map[b0 + k];
+
+            if (a_valid && (!b_valid || (int16_t)(a.gen - b.gen) > 0)) *m = a;
+            else if (b_valid) *m = b;
+
+            // Drop entries that do not fit the region rather than trusting them
+            uint32_t n = cz_units_for(m->len);
+            if (m->len > cz->block_size || m->unit + n > cz->units || (m->raw && m->len != cz->block_size)) {
+                m->len = 0;
+                n = 0;
+            }
+            if (n > 0) cz_mark(cz, m->unit, n, true);
+        }
+    }
+    free(chunk);
+    return true;
+}
+
+void mram_cz_close(struct mram_cz* cz) {
+    if (cz == NULL) return;
+    free(cz->map);
+    free(cz->used);
+    free(cz->cache);
+    free(cz->packed);
+    cz->map = NULL;
+    cz->used = NULL;
+    cz->cache = NULL;
+    cz->packed = NULL;
+}
+
+static bool cz_range_valid(const struct mram_cz* cz, uint32_t addr, size_t len) {
+    uint32_t size = cz->blocks * cz->block_size;
+    return cz->map != NULL && len != 0 && addr < size && len <= size - addr;
+}
+
+bool mram_cz_read(struct mram_cz* cz, uint32_t addr, void* buffer, size_t len) {
+    if (cz == NULL || buffer == NULL || !cz_range_valid(cz, addr, len)) return false;
+
+    uint8_t* out = buffer;
+    cz->stats.logical_read += len;
+    while (len > 0) {
+        uint32_t b = addr / cz->block_size;
+        uint32_t offset = addr % cz->block_size;
+        uint32_t n = cz->block_size - offset < len ? cz->block_size - offset : (uint32_t)len;
+
+        if (b != cz->cache_block && n == cz->block_size) {
+            if (!cz_load_block(cz, b, out)) return false;
+        } else {
+            if (b != cz->cache_block) {
+                cz->cache_block = CZ_NO_BLOCK;
+                if (!cz_load_block(cz, b, cz->cache)) return false;
+                cz->cache_block = b;
+            }
+            memcpy(out, cz->cache + offset, n);
+        }
+        out += n;
+        addr += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool mram_cz_write(struct mram_cz* cz, uint32_t addr, const void* data, size_t len) {
+    if (cz == NULL || data == NULL || !cz_range_valid(cz, addr, len)) return false;
+
+    const uint8_t* in = data;
+    cz->stats.logical_written += len;
+    while (len > 0) {
+        uint32_t b = addr / cz->block_size;
+        uint32_t offset = addr % cz->block_size;
+        uint32_t n = cz->block_size - offset < len ? cz->block_size - offset : (uint32_t)len;
+
+        if (n == cz->block_size) {
+            if (b == cz->cache_block) cz->cache_block = CZ_NO_BLOCK;
+            if (!cz_store_block(cz, b, in)) return false;
+        } else {
+            // Partial block: merge into the cached plain copy, then store it
+            if (b != cz->cache_block) {
+                cz->cache_block = CZ_NO_BLOCK;
+                if (!cz_load_block(cz, b, cz->cache)) return false;
+                cz->cache_block = b;
+            }
+            memcpy(cz->cache + offset, in, n);
+            if (!cz_store_block(cz, b, cz->cache)) {
+                cz->cache_block = CZ_NO_BLOCK;
+                return false;
+            }
+        }
+        in += n;
+        addr += n;
+        len -= n;
+    }
+    return true;
+}
+
+uint32_t mram_cz_physical_used(const struct mram_cz* cz) {
+    if (cz == NULL) return 0;
+    return cz->used_units * MRAM_CZ_UNIT_SIZE;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file mram_compress.h
+ * @brief Transparent block compression region on top of the MRAM interface
+ *
+ * Presents a logical address space, which may be larger than the physical
+ * region backing it, and stores it as independently compressed logical
+ * blocks. Compression uses an LZ4-compatible block format: byte-aligned
+ * sequences with no entropy stage, so it runs much faster than the SPI bus
+ * can move the bytes it saves.
+ *
+ * A RAM-resident block map records where each compressed block lives, so a
+ * read fetches and decompresses only the blocks it touches. Blocks are
+ * rewritten out of place and their map entries alternate between two slots
+ * with a generation counter, so a torn update keeps the previous version.
+ *
+ * Region layout:
+ * Region | Size                        | Content
+ * -------|-----------------------------|-----------------------------------
+ * Map    | logical blocks * 16 bytes   | Two map slots per logical block
+ * Data   | configurable                | Compressed blocks in 32-byte units
+ *
+ * @note Blocks that do not shrink are stored raw, so the worst case costs
+ *       only the map entry on top of an uncompressed write.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_COMPRESS_H
+#define MRAM_INTERFACE_MRAM_COMPRESS_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Allocation unit of the data region in bytes */
+#define MRAM_CZ_UNIT_SIZE 32
+/** @brief Smallest supported logical block size */
+#define MRAM_CZ_MIN_BLOCK_SIZE 256
+/** @brief Largest supported logical block size */
+#define MRAM_CZ_MAX_BLOCK_SIZE 4096
+/** @brief On-device size of the map entry pair of one logical block */
+#define MRAM_CZ_MAP_ENTRY_SIZE 16
+/** @brief Worst-case compressed size of n input bytes */
+#define MRAM_LZ_BOUND(n) ((n) + (n) / 255 + 16)
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Compressed region configuration
+ */
+struct mram_cz_config {
+    /** @brief Start address of the block map (logical_size / block_size * 16 bytes) */
+    uint32_t map_addr;
+    /** @brief Start address of the physical data region */
+    uint32_t data_addr;
+    /** @brief Size of the physical data region in bytes */
+    uint32_t data_size;
+    /** @brief Size of the logical address space (multiple of block_size) */
+    uint32_t logical_size;
+    /** @brief Logical block size in bytes (power of two) */
+    uint32_t block_size;
+};
+
+/**
+ * @brief RAM block map entry
+ */
+struct mram_cz_block {
+    /** @brief First allocation unit of the stored block */
+    uint16_t unit;
+    /** @brief Stored length in bytes, 0 if the block was never written */
+    uint16_t len;
+    /** @brief Generation of the current map slot */
+    uint16_t gen;
+    /** @brief True if the block is stored uncompressed */
+    bool raw;
+};
+
+/**
+ * @brief Transfer statistics
+ */
+struct mram_cz_stats {
+    /** @brief Logical bytes requested by mram_cz_read() */
+    uint64_t logical_read;
+    /** @brief Logical bytes passed to mram_cz_write() */
+    uint64_t logical_written;
+    /** @brief Payload bytes read from the device */
+    uint64_t bus_read;
+    /** @brief Payload bytes written to the device */
+    uint64_t bus_written;
+};
+
+/**
+ * @brief Compressed region handle
+ */
+struct mram_cz {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief Block map address */
+    uint32_t map_addr;
+    /** @brief Data region address */
+    uint32_t data_addr;
+    /** @brief Number of allocation units in the data region */
+    uint32_t units;
+    /** @brief Logical block size */
+    uint32_t block_size;
+    /** @brief Number of logical blocks */
+    uint32_t blocks;
+    /** @brief RAM block map */
+    struct mram_cz_block* map;
+    /** @brief Allocation bitmap, one bit per unit */
+    uint32_t* used;
+    /** @brief Next-fit allocation cursor */
+    uint32_t cursor;
+    /** @brief Number of allocated units */
+    uint32_t used_units;
+    /** @brief Decompressed copy of the most recently touched block */
+    uint8_t* cache;
+    /** @brief Logical block held in cache, UINT32_MAX if none */
+    uint32_t cache_block;
+    /** @brief Buffer for compressed data */
+    uint8_t* packed;
+    /** @brief Transfer statistics */
+    struct mram_cz_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compress a buffer into the LZ4 block format
+ *
+ * @param src Input data
+ * @param src_len Input length
+ * @param dst Output buffer
+ * @param dst_cap Output capacity (MRAM_LZ_BOUND(src_len) always suffices)
+ * @return Compressed length, or 0 if dst_cap is too small
+ */
+size_t mram_lz_compress(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_cap);
+
+/**
+ * @brief Decompress an LZ4 block
+ *
+ * @param src Compressed data
+ * @param src_len Compressed length
+ * @param dst Output buffer
+ * @param dst_len Exact expected decompressed length
+ * @return true if the block is well formed and decompresses to dst_len bytes
+ */
+bool mram_lz_decompress(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+
+/**
+ * @brief Erase the block map so every logical block reads as zeros
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param config Region configuration
+ * @return true if successful, false if the configuration is invalid or communication fails
+ */
+bool mram_cz_format(struct mram* mram, const struct mram_cz_config* config);
+
+/**
+ * @brief Open a compressed region and load its block map
+ *
+ * @param cz Pointer to the handle to initialize
+ * @param mram Pointer to the MRAM interface structure
+ * @param config Region configuration (must match the one used to format)
+ * @return true if successful, false if the configuration is invalid,
+ *         allocation fails or communication fails
+ */
+bool mram_cz_open(struct mram_cz* cz, struct mram* mram, const struct mram_cz_config* config);
+
+/**
+ * @brief Release a compressed region handle
+ *
+ * @param cz Pointer to the handle
+ */
+void mram_cz_close(struct mram_cz* cz);
+
+/**
+ * @brief Read from the logical address space
+ *
+ * @param cz Pointer to the handle
+ * @param addr Logical start address
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid, a block is
+ *         corrupt or communication fails
+ */
+bool mram_cz_read(struct mram_cz* cz, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Write to the logical address space
+ *
+ * Every block is written next to its previous version, so a write fails
+ * once the physical region has no room for the new copy, even if it would
+ * fit in the units of the old one. The space of a store that failed stays
+ * allocated until the next mram_cz_open(), as its data may have landed.
+ *
+ * @param cz Pointer to the handle
+ * @param addr Logical start address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid, the physical
+ *         region is full or communication fails
+ */
+bool mram_cz_write(struct mram_cz* cz, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Get the number of physical bytes currently allocated
+ *
+ * @param cz Pointer to the handle
+ * @return Allocated bytes in the data region, 0 if cz is NULL
+ */
+uint32_t mram_cz_physical_used(const struct mram_cz* cz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_COMPRESS_H
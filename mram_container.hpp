@@ -0,0 +1,499 @@
+/**
+ * @file mram_container.hpp
+ * @brief Persistent array, vector and ring containers with block-cached access
+ *
+ * The containers store trivially copyable elements in a device region that
+ * starts with a small header (magic, element size, capacity, size and ring
+ * head), so a container can be reopened after a restart. Element access
+ * goes through a one-block cache. A miss flushes the block and then fetches
+ * the next block_bytes of elements in one READ frame. Stores only mark
+ * elements dirty. A flush writes every contiguous run of dirty elements,
+ * plus the header when it changed, in one vector write under a single WREN.
+ * Standard algorithms such as std::find_if or std::accumulate therefore
+ * cost one bulk read per block instead of one transfer per element.
+ *
+ * Iterators are random access and, like std::vector<bool>, dereference to a
+ * proxy that converts to T and can be assigned from T. Element access
+ * throws std::runtime_error if the device fails. format(), open() and
+ * flush() report errors through their return value. The destructor flushes
+ * but cannot report errors, so call flush() when the outcome matters.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_CONTAINER_HPP
+#define MRAM_INTERFACE_MRAM_CONTAINER_HPP
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "mram_device.hpp"
+
+namespace mram_interface {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default cache block size in bytes */
+inline constexpr size_t container_block_bytes = 512;
+
+namespace detail {
+
+/**
+ * @brief On-device container header
+ */
+struct container_header {
+    uint32_t magic;
+    uint32_t elem_size;
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t head;
+};
+
+inline constexpr uint32_t array_magic = 0x3141524Du;   // "MRA1"
+inline constexpr uint32_t vector_magic = 0x3156524Du;  // "MRV1"
+inline constexpr uint32_t ring_magic = 0x3152524Du;    // "MRR1"
+
+/*******************************************************************************
+ * Element Access
+ ******************************************************************************/
+/**
+ * @brief Proxy reference to one element
+ */
+template <class Container>
+class element_ref {
+public:
+    using value_type = typename Container::value_type;
+
+    element_ref(Container& c, size_t i) noexcept : c_(&c), i_(i) {}
+    element_ref(const element_ref&) = default;
+
+    operator value_type() const { return c_->get(i_); }
+
+    element_ref& operator=(const value_type& v) {
+        c_->set(i_, v);
+        return *this;
+    }
+
+    // Assignment copies the element, not the proxy
+    element_ref& operator=(const element_ref& other) { return *this = static_cast<value_type>(other); }
+
+    // Found by ADL, so algorithms such as std::sort can swap through proxies
+    friend void swap(element_ref a, element_ref b) {
+        value_type t = a;
+        a = static_cast<value_type>(b);
+        b = t;
+    }
+
+private:
+    Container* c_;
+    size_t i_;
+};
+
+/**
+ * @brief Random-access iterator over a container, mutable or const
+ */
+template <class Container, bool Const>
+class basic_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename Container::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::conditional_t<Const, value_type, element_ref<Container>>;
+    using container_type = std::conditional_t<Const, const Container, Container>;
+
+    basic_iterator() = default;
+    basic_iterator(container_type* c, size_t i) noexcept : c_(c), i_(i) {}
+
+    template <bool C = Const, std::enable_if_t<C, int> = 0>
+    basic_iterator(const basic_iterator<Container, false>& other) noexcept : c_(other.c_), i_(other.i_) {}
+
+    reference operator*() const {
+        if constexpr (Const) {
+            return c_->get(i_);
+        } else {
+            return reference(*c_, i_);
+        }
+    }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    basic_iterator& operator++() noexcept { ++i_; return *this; }
+    basic_iterator& operator--() noexcept { --i_; return *this; }
+    basic_iterator operator++(int) noexcept { basic_iterator t = *this; ++i_; return t; }
+    basic_iterator operator--(int) noexcept { basic_iterator t = *this; --i_; return t; }
+    basic_iterator& operator+=(difference_type n) noexcept { i_ += n; return *this; }
+    basic_iterator& operator-=(difference_type n) noexcept { i_ -= n; return *this; }
+
+    friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept { return it += n; }
+    friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it += n; }
+    friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept { return it -= n; }
+    friend difference_type operator-(const basic_iterator& a, const basic_iterator& b) noexcept {
+        return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+    }
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i_ == b.i_; }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i_ != b.i_; }
+    friend bool operator<(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i_ < b.i_; }
+    friend bool operator>(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i_ > b.i_; }
+    friend bool operator<=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i_ <= b.i_; }
+    friend bool operator>=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.i_ >= b.i_; }
+
+private:
+    friend class basic_iterator<Container, !Const>;
+
+    container_type* c_ = nullptr;
+    size_t i_ = 0;
+};
+
+/*******************************************************************************
+ * Block Cache
+ ******************************************************************************/
+/**
+ * @brief Header handling and the write-back block cache shared by all containers
+ *
+ * Element indices here are physical slots, 0 to capacity - 1.
+ */
+template <class T, class Transport>
+class container_base {
+    static_assert(std::is_trivially_copyable_v<T>, "MRAM containers hold trivially copyable types only");
+
+public:
+    container_base(const container_base&) = delete;
+    container_base& operator=(const container_base&) = delete;
+
+    /** @brief Bytes a container of the given capacity occupies on the device */
+    static constexpr size_t footprint(size_t capacity) noexcept {
+        return sizeof(container_header) + capacity * sizeof(T);
+    }
+
+    /** @brief Maximum number of elements */
+    size_t capacity() const noexcept { return header_.capacity; }
+
+    /**
+     * @brief Write back dirty elements and the header in one vector write
+     *
+     * @return true if successful or nothing was dirty, false if communication fails
+     */
+    bool flush() {
+        std::vector<mram_iovec> iov;
+        for (size_t i = 0; i < block_len_;) {
+            if (!dirty_[i]) {
+                i++;
+                continue;
+            }
+            size_t end = i;
+            while (end < block_len_ && dirty_[end]) end++;
+            iov.push_back({ slot_addr(block_first_ + i), block_.get() + i * sizeof(T), (end - i) * sizeof(T) });
+            i = end;
+        }
+        // The header goes last, so a new size never covers elements not yet written
+        if (header_dirty_) iov.push_back({ base_, &header_, sizeof(header_) });
+        if (iov.empty()) return true;
+
+        if (!dev_.write_vector(iov.data(), iov.size())) return false;
+        std::fill(dirty_.begin(), dirty_.end(), false);
+        header_dirty_ = false;
+        return true;
+    }
+
+protected:
+    container_base(device<Transport>& dev, uint32_t base, size_t capacity, uint32_t magic, size_t block_bytes)
+        : dev_(dev), base_(base) {
+        if (capacity == 0 || capacity > UINT32_MAX || !range_valid(base, footprint(capacity))) {
+            throw std::invalid_argument("MRAM container does not fit the device");
+        }
+        header_ = { magic, static_cast<uint32_t>(sizeof(T)), static_cast<uint32_t>(capacity), 0, 0 };
+        block_cap_ = std::min(capacity, std::max<size_t>(1, block_bytes / sizeof(T)));
+        block_ = std::make_unique<uint8_t[]>(block_cap_ * sizeof(T));
+        dirty_.assign(block_cap_, false);
+    }
+
+    ~container_base() {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    // Reset the container in place; element contents are left as they are
+    bool write_header(uint32_t size, uint32_t head) {
+        header_.size = size;
+        header_.head = head;
+        header_dirty_ = true;
+        return flush();
+    }
+
+    // Load the header from the device and check it matches this container
+    bool read_header() {
+        container_header h{};
+        if (!dev_.read(base_, reinterpret_cast<uint8_t*>(&h), sizeof(h))) return false;
+        if (h.magic != header_.magic || h.elem_size != header_.elem_size || h.capacity != header_.capacity ||
+            h.size > h.capacity || h.head >= h.capacity) {
+            return false;
+        }
+        header_ = h;
+        header_dirty_ = false;
+        block_len_ = 0;
+        std::fill(dirty_.begin(), dirty_.end(), false);
+        return true;
+    }
+
+    T load(size_t slot) const {
+        const uint8_t* p = cached(slot);
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    void store(size_t slot, const T& v) {
+        uint8_t* p = cached(slot);
+        std::memcpy(p, &v, sizeof(T));
+        dirty_[slot - block_first_] = true;
+    }
+
+    void mark_header_dirty() noexcept { header_dirty_ = true; }
+
+    container_header header_;
+
+private:
+    uint32_t slot_addr(size_t slot) const noexcept {
+        return base_ + static_cast<uint32_t>(sizeof(container_header) + slot * sizeof(T));
+    }
+
+    // Make the block holding slot resident, writing back the previous one first
+    uint8_t* cached(size_t slot) const {
+        auto* self = const_cast<container_base*>(this);
+        if (slot < block_first_ || slot >= block_first_ + block_len_) {
+            if (!self->flush()) throw std::runtime_error("MRAM container write-back failed");
+            size_t first = slot - slot % block_cap_;
+            size_t len = std::min(block_cap_, static_cast<size_t>(header_.capacity) - first);
+            self->block_len_ = 0;
+            if (!dev_.read(slot_addr(first), block_.get(), len * sizeof(T))) {
+                throw std::runtime_error("MRAM container read failed");
+            }
+            self->block_first_ = first;
+            self->block_len_ = len;
+        }
+        return block_.get() + (slot - block_first_) * sizeof(T);
+    }
+
+    device<Transport>& dev_;
+    uint32_t base_;
+    size_t block_cap_ = 0;
+    std::unique_ptr<uint8_t[]> block_;
+    size_t block_first_ = 0;
+    size_t block_len_ = 0;
+    std::vector<bool> dirty_;
+    bool header_dirty_ = false;
+};
+
+}  // namespace detail
+
+/*******************************************************************************
+ * Containers
+ ******************************************************************************/
+/**
+ * @brief Fixed-size persistent array
+ */
+template <class T, size_t N, class Transport = pointer_transport>
+class array : public detail::container_base<T, Transport> {
+    using base_type = detail::container_base<T, Transport>;
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = detail::element_ref<array>;
+    using iterator = detail::basic_iterator<array, false>;
+    using const_iterator = detail::basic_iterator<array, true>;
+
+    /**
+     * @param dev Device the array lives on
+     * @param base Device address of the header
+     * @param block_bytes Cache block size
+     * @throws std::invalid_argument if the array does not fit the device
+     */
+    array(device<Transport>& dev, uint32_t base, size_t block_bytes = container_block_bytes)
+        : base_type(dev, base, N, detail::array_magic, block_bytes) {}
+
+    /** @brief Write a fresh header */
+    bool format() { return this->write_header(N, 0); }
+
+    /** @brief Attach to an array previously formatted at the same address */
+    bool open() { return this->read_header(); }
+
+    static constexpr size_t size() noexcept { return N; }
+
+    T get(size_t i) const { return this->load(i); }
+    void set(size_t i, const T& v) { this->store(i, v); }
+
+    reference operator[](size_t i) { return reference(*this, i); }
+    T operator[](size_t i) const { return get(i); }
+
+    iterator begin() noexcept { return { this, 0 }; }
+    iterator end() noexcept { return { this, N }; }
+    const_iterator begin() const noexcept { return { this, 0 }; }
+    const_iterator end() const noexcept { return { this, N }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+};
+
+/**
+ * @brief Persistent vector with a fixed capacity
+ */
+template <class T, class Transport = pointer_transport>
+class vector : public detail::container_base<T, Transport> {
+    using base_type = detail::container_base<T, Transport>;
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = detail::element_ref<vector>;
+    using iterator = detail::basic_iterator<vector, false>;
+    using const_iterator = detail::basic_iterator<vector, true>;
+
+    /**
+     * @param dev Device the vector lives on
+     * @param base Device address of the header
+     * @param capacity Maximum number of elements
+     * @param block_bytes Cache block size
+     * @throws std::invalid_argument if the vector does not fit the device
+     */
+    vector(device<Transport>& dev, uint32_t base, size_t capacity, size_t block_bytes = container_block_bytes)
+        : base_type(dev, base, capacity, detail::vector_magic, block_bytes) {}
+
+    /** @brief Write a fresh, empty header */
+    bool format() { return this->write_header(0, 0); }
+
+    /** @brief Attach to a vector previously formatted at the same address */
+    bool open() { return this->read_header(); }
+
+    size_t size() const noexcept { return this->header_.size; }
+    bool empty() const noexcept { return size() == 0; }
+
+    T get(size_t i) const { return this->load(i); }
+    void set(size_t i, const T& v) { this->store(i, v); }
+
+    reference operator[](size_t i) { return reference(*this, i); }
+    T operator[](size_t i) const { return get(i); }
+
+    /** @throws std::out_of_range if i >= size() */
+    reference at(size_t i) {
+        if (i >= size()) throw std::out_of_range("mram_interface::vector::at");
+        return (*this)[i];
+    }
+
+    reference back() { return (*this)[size() - 1]; }
+
+    /** @throws std::length_error if the vector is full */
+    void push_back(const T& v) {
+        if (size() == this->capacity()) throw std::length_error("mram_interface::vector is full");
+        this->store(size(), v);
+        this->header_.size++;
+        this->mark_header_dirty();
+    }
+
+    void pop_back() noexcept {
+        if (empty()) return;
+        this->header_.size--;
+        this->mark_header_dirty();
+    }
+
+    void clear() noexcept {
+        this->header_.size = 0;
+        this->mark_header_dirty();
+    }
+
+    iterator begin() noexcept { return { this, 0 }; }
+    iterator end() noexcept { return { this, size() }; }
+    const_iterator begin() const noexcept { return { this, 0 }; }
+    const_iterator end() const noexcept { return { this, size() }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+};
+
+/**
+ * @brief Persistent ring buffer; pushing onto a full ring drops the oldest element
+ */
+template <class T, class Transport = pointer_transport>
+class ring : public detail::container_base<T, Transport> {
+    using base_type = detail::container_base<T, Transport>;
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = detail::element_ref<ring>;
+    using iterator = detail::basic_iterator<ring, false>;
+    using const_iterator = detail::basic_iterator<ring, true>;
+
+    /**
+     * @param dev Device the ring lives on
+     * @param base Device address of the header
+     * @param capacity Maximum number of elements
+     * @param block_bytes Cache block size
+     * @throws std::invalid_argument if the ring does not fit the device
+     */
+    ring(device<Transport>& dev, uint32_t base, size_t capacity, size_t block_bytes = container_block_bytes)
+        : base_type(dev, base, capacity, detail::ring_magic, block_bytes) {}
+
+    /** @brief Write a fresh, empty header */
+    bool format() { return this->write_header(0, 0); }
+
+    /** @brief Attach to a ring previously formatted at the same address */
+    bool open() { return this->read_header(); }
+
+    size_t size() const noexcept { return this->header_.size; }
+    bool empty() const noexcept { return size() == 0; }
+    bool full() const noexcept { return size() == this->capacity(); }
+
+    /** @brief Element i, counted from the oldest */
+    T get(size_t i) const { return this->load(slot(i)); }
+    void set(size_t i, const T& v) { this->store(slot(i), v); }
+
+    reference operator[](size_t i) { return reference(*this, i); }
+    T operator[](size_t i) const { return get(i); }
+
+    reference front() { return (*this)[0]; }
+    reference back() { return (*this)[size() - 1]; }
+
+    void push_back(const T& v) {
+        this->store(slot(size()), v);
+        if (full()) {
+            this->header_.head = static_cast<uint32_t>(slot(1));
+        } else {
+            this->header_.size++;
+        }
+        this->mark_header_dirty();
+    }
+
+    void pop_front() noexcept {
+        if (empty()) return;
+        this->header_.head = static_cast<uint32_t>(slot(1));
+        this->header_.size--;
+        this->mark_header_dirty();
+    }
+
+    iterator begin() noexcept { return { this, 0 }; }
+    iterator end() noexcept { return { this, size() }; }
+    const_iterator begin() const noexcept { return { this, 0 }; }
+    const_iterator end() const noexcept { return { this, size() }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+private:
+    size_t slot(size_t i) const noexcept { return (this->header_.head + i) % this->capacity(); }
+};
+
+}  // namespace mram_interface
+
+#endif //MRAM_INTERFACE_MRAM_CONTAINER_HPP
@@ -0,0 +1,297 @@
+/**
+ * @file mram_coro.hpp
+ * @brief C++20 coroutine wrapper with awaitable MRAM operations
+ *
+ * mram_interface::async_device hands a struct mram to an mram_uring I/O
+ * thread. It returns awaitables, so coroutines can write
+ * `co_await dev.read(addr, span)` without blocking their executor. A
+ * suspended operation costs only its awaitable, which lives in the
+ * coroutine frame. Operations that find the submission ring full wait in
+ * an intrusive overflow list and are fed to the ring as completions free
+ * slots, so the number of logical operations in flight is bounded only by
+ * memory.
+ *
+ * One completion thread reaps the ring. It resumes each coroutine through
+ * the executor passed to the operation; any type with
+ * `post(std::coroutine_handle<>)` qualifies. The default inline_executor
+ * resumes directly on the completion thread.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_CORO_HPP
+#define MRAM_INTERFACE_MRAM_CORO_HPP
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "mram_uring.h"
+
+namespace mram_interface {
+
+/*******************************************************************************
+ * Executors
+ ******************************************************************************/
+/**
+ * @brief Anything that can schedule a coroutine for resumption
+ */
+template <class E>
+concept executor = std::copy_constructible<E> && requires(E& ex, std::coroutine_handle<> h) { ex.post(h); };
+
+/**
+ * @brief Executor that resumes on the completion thread itself
+ */
+struct inline_executor {
+    void post(std::coroutine_handle<> h) const { h.resume(); }
+};
+
+class async_device;
+
+namespace detail {
+
+/**
+ * @brief Type-erased in-flight operation, linked into the overflow list when the ring is full
+ */
+struct io_op {
+    io_op* next = nullptr;
+    mram_uring_sqe sqe{};
+    int32_t res = 0;
+    void (*complete)(io_op*) = nullptr;
+};
+
+}  // namespace detail
+
+/*******************************************************************************
+ * Awaitables
+ ******************************************************************************/
+/**
+ * @brief Common awaitable logic: submit on suspend, resume through the executor
+ */
+template <executor Executor>
+class basic_awaitable : protected detail::io_op {
+public:
+    basic_awaitable(async_device& dev, const mram_uring_sqe& sqe, Executor ex)
+        : dev_(dev), ex_(std::move(ex)) {
+        this->sqe = sqe;
+        this->complete = &basic_awaitable::on_complete;
+    }
+
+    basic_awaitable(const basic_awaitable&) = delete;
+    basic_awaitable& operator=(const basic_awaitable&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    // Nothing may touch *this after submit(): the completion can resume the
+    // coroutine, and destroy this awaitable, before submit() returns
+    void await_suspend(std::coroutine_handle<> h) {
+        handle_ = h;
+        submit();
+    }
+
+protected:
+    void submit();
+
+    int32_t result() const noexcept { return this->res; }
+
+private:
+    static void on_complete(detail::io_op* op) {
+        auto* self = static_cast<basic_awaitable*>(op);
+        std::coroutine_handle<> h = self->handle_;
+        Executor ex = std::move(self->ex_);
+        ex.post(h);
+    }
+
+    async_device& dev_;
+    Executor ex_;
+    std::coroutine_handle<> handle_;
+};
+
+/**
+ * @brief Read or write, resumes with true on success
+ */
+template <executor Executor>
+class transfer_awaitable : public basic_awaitable<Executor> {
+public:
+    using basic_awaitable<Executor>::basic_awaitable;
+
+    bool await_resume() const noexcept { return this->result() == 0; }
+};
+
+/**
+ * @brief Status register read, resumes with the register value or nullopt on failure
+ */
+template <executor Executor>
+class status_awaitable : public basic_awaitable<Executor> {
+public:
+    using basic_awaitable<Executor>::basic_awaitable;
+
+    std::optional<uint8_t> await_resume() const noexcept {
+        if (this->result() < 0) return std::nullopt;
+        return static_cast<uint8_t>(this->result());
+    }
+};
+
+/*******************************************************************************
+ * Device
+ ******************************************************************************/
+/**
+ * @brief Asynchronous MRAM device
+ *
+ * The wrapped struct mram belongs to the I/O thread until the async_device
+ * is destroyed. All operations must have completed before destruction.
+ */
+class async_device {
+public:
+    /**
+     * @brief Start the I/O and completion threads
+     *
+     * @param dev Initialized MRAM interface structure
+     * @param entries Submission ring size, a power of two
+     * @throws std::runtime_error if the ring or a thread cannot be created
+     */
+    explicit async_device(::mram& dev, uint32_t entries = MRAM_URING_DEFAULT_ENTRIES) {
+        mram_uring_config config{};
+        config.sq_entries = entries;
+        if (!mram_uring_init(&ring_, &dev, &config)) throw std::runtime_error("mram_uring_init failed");
+        try {
+            reaper_ = std::thread([this] { reap(); });
+        } catch (...) {
+            mram_uring_deinit(&ring_);
+            throw;
+        }
+    }
+
+    ~async_device() {
+        // A NOP with no operation attached tells the completion thread to exit
+        stop_.sqe.op = MRAM_URING_OP_NOP;
+        stop_.sqe.user_data = 0;
+        enqueue(&stop_);
+        reaper_.join();
+        mram_uring_deinit(&ring_);
+    }
+
+    async_device(const async_device&) = delete;
+    async_device& operator=(const async_device&) = delete;
+
+    /**
+     * @brief Read into a buffer
+     *
+     * @param addr Starting address
+     * @param buffer Destination, must stay valid until the operation completes
+     * @param ex Executor that resumes the awaiting coroutine
+     */
+    template <executor Executor = inline_executor>
+    transfer_awaitable<Executor> read(uint32_t addr, std::span<std::byte> buffer, Executor ex = {}) {
+        return { *this, make_sqe(MRAM_URING_OP_READ, addr, buffer.data(), buffer.size()), std::move(ex) };
+    }
+
+    /**
+     * @brief Write from a buffer
+     *
+     * @param addr Starting address
+     * @param data Source, must stay valid until the operation completes
+     * @param ex Executor that resumes the awaiting coroutine
+     */
+    template <executor Executor = inline_executor>
+    transfer_awaitable<Executor> write(uint32_t addr, std::span<const std::byte> data, Executor ex = {}) {
+        return { *this, make_sqe(MRAM_URING_OP_WRITE, addr, const_cast<std::byte*>(data.data()), data.size()),
+                 std::move(ex) };
+    }
+
+    /**
+     * @brief Read the status register
+     *
+     * @param ex Executor that resumes the awaiting coroutine
+     */
+    template <executor Executor = inline_executor>
+    status_awaitable<Executor> read_status(Executor ex = {}) {
+        return { *this, make_sqe(MRAM_URING_OP_READ_STATUS, 0, nullptr, 0), std::move(ex) };
+    }
+
+private:
+    template <executor>
+    friend class basic_awaitable;
+
+    static mram_uring_sqe make_sqe(uint8_t op, uint32_t addr, void* buf, size_t len) {
+        mram_uring_sqe sqe{};
+        sqe.op = op;
+        sqe.addr = addr;
+        sqe.buf = buf;
+        sqe.len = len;
+        return sqe;
+    }
+
+    // Queue an operation behind any overflow and push what fits into the ring
+    void enqueue(detail::io_op* op) {
+        std::lock_guard<std::mutex> guard(lock_);
+        op->next = nullptr;
+        if (overflow_tail_) {
+            overflow_tail_->next = op;
+        } else {
+            overflow_head_ = op;
+        }
+        overflow_tail_ = op;
+        pump();
+    }
+
+    // Move overflowed operations into free submission slots (lock held)
+    void pump() {
+        uint32_t n = 0;
+        while (overflow_head_) {
+            mram_uring_sqe* sqe = mram_uring_get_sqe(&ring_);
+            if (sqe == nullptr) break;
+            detail::io_op* op = overflow_head_;
+            overflow_head_ = op->next;
+            if (overflow_head_ == nullptr) overflow_tail_ = nullptr;
+            *sqe = op->sqe;
+            if (op != &stop_) sqe->user_data = reinterpret_cast<uintptr_t>(op);
+            n++;
+        }
+        if (n) mram_uring_submit(&ring_);
+    }
+
+    void reap() {
+        for (;;) {
+            mram_uring_cqe* cqe = mram_uring_wait_cqe(&ring_);
+            auto* op = reinterpret_cast<detail::io_op*>(static_cast<uintptr_t>(cqe->user_data));
+            int32_t res = cqe->res;
+            mram_uring_cqe_seen(&ring_);
+            if (op == nullptr) return;
+
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                pump();
+            }
+            op->res = res;
+            op->complete(op);
+        }
+    }
+
+    mram_uring ring_{};
+    std::mutex lock_;
+    detail::io_op* overflow_head_ = nullptr;
+    detail::io_op* overflow_tail_ = nullptr;
+    detail::io_op stop_;
+    std::thread reaper_;
+};
+
+template <executor Executor>
+void basic_awaitable<Executor>::submit() {
+    dev_.enqueue(this);
+}
+
+}  // namespace mram_interface
+
+#endif //MRAM_INTERFACE_MRAM_CORO_HPP
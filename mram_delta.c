@@ -0,0 +1,153 @@
+#include "mram_delta.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Index of the first byte at or after pos whose equality matches want_equal,
+// or len if there is none.
+static size_t delta_scan(const uint8_t* a, const uint8_t* b, size_t pos, size_t len, bool want_equal) {
+#if defined(__SSE2__)
+    while (len - pos >= 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos)),
+                                    _mm_loadu_si128((const __m128i*)(b + pos)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(eq);
+        if (!want_equal) mask = ~mask & 0xFFFFu;
+        if (mask) return pos + (size_t)__builtin_ctz(mask);
+        pos += 16;
+    }
+#elif defined(__ARM_NEON)
+    while (len - pos >= 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(a + pos), vld1q_u8(b + pos));
+        if (!want_equal) eq = vmvnq_u8(eq);
+        // Narrow to four mask bits per byte, NEON has no movemask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask) return pos + (size_t)(__builtin_ctzll(mask) >> 2);
+        pos += 16;
+    }
+#else
+    if (!want_equal) {
+        while (len - pos >= 8 && memcmp(a + pos, b + pos, 8) == 0) pos += 8;
+    }
+#endif
+    for (; pos < len; pos++) {
+        if ((a[pos] == b[pos]) == want_equal) return pos;
+    }
+    return len;
+}
+
+bool mram_write_delta_stats(struct mram* mram, uint32_t addr, const void* new_data, const void* old_data,
+                            size_t len, struct mram_delta_stats* stats) {
+    if (mram == NULL || new_data == NULL || old_data == NULL || len == 0) return false;
+    if (addr > MRAM_MAX_ADDRESS || len - 1 > (size_t)(MRAM_MAX_ADDRESS - addr)) return false;
+
+    const uint8_t* nw = new_data;
+    const uint8_t* od = old_data;
+    struct mram_iovec iov[MRAM_DELTA_MAX_RUNS];
+    size_t n = 0;
+
+    size_t pos = delta_scan(nw, od, 0, len, false);
+    while (pos < len) {
+        size_t start = pos;
+        size_t end = delta_scan(nw, od, start, len, true);
+        pos = end < len ? delta_scan(nw, od, end, len, false) : len;
+
+        // Resending a short unchanged gap is cheaper than a new frame
+        while (pos < len && pos - end <= MRAM_DELTA_MERGE_GAP) {
+            end = delta_scan(nw, od, pos, len, true);
+            pos = end < len ? delta_scan(nw, od, end, len, false) : len;
+        }
+
+        if (n == MRAM_DELTA_MAX_RUNS) {
+            // Out of frames: stretch the last one over all remaining changes
+            size_t last = len;
+            while (nw[last - 1] == od[last - 1]) last--;
+            iov[n - 1].len = last - (iov[n - 1].addr - addr);
+            break;
+        }
+        iov[n].addr = addr + (uint32_t)start;
+        iov[n].buf = (void*)(nw + start);
+        iov[n].len = end - start;
+        n++;
+    }
+
+    if (n != 0 && !mram_write_vector(mram, iov, n)) return false;
+
+    if (stats) {
+        stats->bytes_requested += len;
+        stats->frames += n;
+        for (size_t i = 0; i < n; i++) stats->bytes_sent += iov[i].len;
+    }
+    return true;
+}
+
+bool mram_write_delta(struct mram* mram, uint32_t addr, const void* new_data, const void* old_data, size_t len) {
+    return mram_write_delta_stats(mram, addr, new_data, old_data, len, NULL);
+}
+
+bool mram_shadow_init(struct mram_shadow* sh, struct mram* mram, uint32_t base, uint32_t size) {
+    if (sh == NULL || mram == NULL || size == 0) return false;
+    if (base > MRAM_MAX_ADDRESS || size - 1 > MRAM_MAX_ADDRESS - base) return false;
+
+    memset(sh, 0, sizeof(*sh));
+    sh->mram = mram;
+    sh->base = base;
+    sh->size = size;
+    sh->shadow = malloc(size);
+    if (sh->shadow == NULL) return false;
+
+    struct mram_iovec iov = { base, sh->shadow, size };
+    if (!mram_read_vector(mram, &iov, 1)) {
+        mram_shadow_deinit(sh);
+        return false;
+    }
+    return true;
+}
+
+void mram_shadow_deinit(struct mram_shadow* sh) {
+    if (sh == NULL) return;
+    free(sh->shadow);
+    sh->shadow = NULL;
+}
+
+static bool shadow_range_valid(const struct mram_shadow* sh, uint32_t addr, size_t len) {
+    return sh->shadow != NULL && len != 0 && addr >= sh->base && addr - sh->base < sh->size &&
+           len <= sh->size - (addr - sh->base);
+}
+
+bool mram_shadow_write(struct mram_shadow* sh, uint32_t addr, const void* data, size_t len) {
+    if (sh == NULL || data == NULL || !shadow_range_valid(sh, addr, len)) return false;
+    if (!mram_shadow_resync(sh)) return false;
+
+    uint8_t* old = sh->shadow + (addr - sh->base);
+    if (!mram_write_delta_stats(sh->mram, addr, data, old, len, &sh->stats)) {
+        // Some runs may already be on the device: trust only the device now
+        sh->stale_addr = addr;
+        sh->stale_len = (uint32_t)len;
+        mram_shadow_resync(sh);
+        return false;
+    }
+    memcpy(old, data, len);
+    return true;
+}
+
+bool mram_shadow_read(const struct mram_shadow* sh, uint32_t addr, void* buffer, size_t len) {
+    if (sh == NULL || buffer == NULL || !shadow_range_valid(sh, addr, len)) return false;
+    if (sh->stale_len != 0 && addr < sh->stale_addr + sh->stale_len && sh->stale_addr < addr + len) return false;
+    memcpy(buffer, sh->shadow + (addr - sh->base), len);
+    return true;
+}
+
+bool mram_shadow_resync(struct mram_shadow* sh) {
+    if (sh == NULL || sh->shadow == NULL) return false;
+    if (sh->stale_len == 0) return true;
+
+    struct mram_iovec iov = { sh->stale_addr, sh->shadow + (sh->stale_addr - sh->base), sh->stale_len };
+    if (!mram_read_vector(sh->mram, &iov, 1)) return false;
+    sh->stale_len = 0;
+    return true;
+}
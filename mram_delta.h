@@ -0,0 +1,170 @@
+/**
+ * @file mram_delta.h
+ * @brief Delta writes that only transfer changed bytes
+ *
+ * mram_write_delta() compares the new contents of a range with the previous
+ * contents, 16 bytes per step with SSE2 or NEON, and sends WRITE frames only
+ * for the runs that differ. Runs separated by fewer unchanged bytes than a
+ * frame costs (command, address and CS cycle) are merged, and all frames of
+ * one call share a single WREN/WRDI pair.
+ *
+ * The shadow variant keeps a RAM copy of a device range, so callers do not
+ * need to hold on to the previous contents themselves and reads of the range
+ * are served without touching the bus. A write that fails part-way may have
+ * sent some of its runs, so the shadow no longer knows that range; it is
+ * read back from the device at once, or by the next write or
+ * mram_shadow_resync() when the device does not answer.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_DELTA_H
+#define MRAM_INTERFACE_MRAM_DELTA_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+#ifndef MRAM_DELTA_MERGE_GAP
+/** @brief Unchanged bytes worth resending instead of starting a new frame
+ *  (4 header bytes plus the CS high/low cycle) */
+#define MRAM_DELTA_MERGE_GAP 6
+#endif
+/** @brief Maximum number of WRITE frames per delta write */
+#define MRAM_DELTA_MAX_RUNS 64
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Delta write statistics
+ */
+struct mram_delta_stats {
+    /** @brief Bytes passed to delta writes */
+    uint64_t bytes_requested;
+    /** @brief Payload bytes actually sent, including merged gaps */
+    uint64_t bytes_sent;
+    /** @brief WRITE frames sent */
+    uint64_t frames;
+};
+
+/**
+ * @brief Shadow-backed delta writer
+ */
+struct mram_shadow {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief First shadowed device address */
+    uint32_t base;
+    /** @brief Number of shadowed bytes */
+    uint32_t size;
+    /** @brief RAM copy of the device range */
+    uint8_t* shadow;
+    /** @brief Start of a range a failed write left unknown */
+    uint32_t stale_addr;
+    /** @brief Length of that range, 0 while the shadow matches the device */
+    uint32_t stale_len;
+    /** @brief Accumulated statistics */
+    struct mram_delta_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Write only the bytes that differ from the previous contents
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param addr Start address of the range
+ * @param new_data New contents of the range
+ * @param old_data Contents currently stored on the device
+ * @param len Length of the range
+ * @return true if successful (including when nothing changed), false if
+ *         parameters are invalid or communication fails
+ */
+bool mram_write_delta(struct mram* mram, uint32_t addr, const void* new_data, const void* old_data, size_t len);
+
+/**
+ * @brief Delta write that also accumulates statistics
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param addr Start address of the range
+ * @param new_data New contents of the range
+ * @param old_data Contents currently stored on the device
+ * @param len Length of the range
+ * @param stats Statistics to update (may be NULL)
+ * @return Same as mram_write_delta()
+ */
+bool mram_write_delta_stats(struct mram* mram, uint32_t addr, const void* new_data, const void* old_data,
+                            size_t len, struct mram_delta_stats* stats);
+
+/**
+ * @brief Initialize a shadow from the current device contents
+ *
+ * @param sh Pointer to the shadow to initialize
+ * @param mram Pointer to the MRAM interface structure
+ * @param base First device address to shadow
+ * @param size Number of bytes to shadow
+ * @return true if successful, false if parameters are invalid, allocation
+ *         fails or communication fails
+ */
+bool mram_shadow_init(struct mram_shadow* sh, struct mram* mram, uint32_t base, uint32_t size);
+
+/**
+ * @brief Release a shadow
+ *
+ * @param sh Pointer to the shadow
+ */
+void mram_shadow_deinit(struct mram_shadow* sh);
+
+/**
+ * @brief Delta-write a range against the shadow and update the shadow
+ *
+ * @param sh Pointer to the shadow
+ * @param addr Device address inside the shadowed range
+ * @param data New contents
+ * @param len Number of bytes
+ * @return true if successful, false if the range is outside the shadow, a
+ *         range left unknown by an earlier failure cannot be read back or
+ *         communication fails (the written range is then read back from
+ *         the device, or left unknown if that fails too)
+ */
+bool mram_shadow_write(struct mram_shadow* sh, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Read a range from the shadow without bus traffic
+ *
+ * @param sh Pointer to the shadow
+ * @param addr Device address inside the shadowed range
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if the range is outside the shadow or
+ *         overlaps a range left unknown by a failed write
+ */
+bool mram_shadow_read(const struct mram_shadow* sh, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Read back the range a failed write left unknown
+ *
+ * @param sh Pointer to the shadow
+ * @return true if the shadow matches the device again (or already did),
+ *         false if parameters are invalid or communication fails
+ */
+bool mram_shadow_resync(struct mram_shadow* sh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_DELTA_H
@@ -0,0 +1,274 @@
+/**
+ * @file mram_device.hpp
+ * @brief Header-only C++17 device with a statically dispatched transport policy
+ *
+ * mram_interface::device<Transport> implements the same command sequences as
+ * mram.c, but calls the transport through a policy type instead of the
+ * function pointers in struct mram. Chip select and SPI calls are resolved
+ * at compile time, so the compiler can inline the transport into the frame
+ * code, including the header bytes and the CS toggling.
+ *
+ * A transport policy provides three members:
+ *
+ *     bool select();                                                // CS low
+ *     bool deselect();                                              // CS high
+ *     bool transfer(const uint8_t* tx, uint8_t* rx, size_t len);
+ *
+ * transfer follows the same contract as struct mram::spi_transfer: rx is
+ * nullptr for transmit-only transfers, and tx may equal rx in the data
+ * phase of reads. pointer_transport adapts an existing struct mram, so the
+ * same code path can run over the C function pointers.
+ *
+ * Overloads that take an address<A> from mram_frame.hpp transfer a
+ * trivially copyable object at a fixed address. Range and size are checked
+ * at compile time and the frame header is a constant.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_DEVICE_HPP
+#define MRAM_INTERFACE_MRAM_DEVICE_HPP
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "mram.h"
+#include "mram_frame.hpp"
+
+namespace mram_interface {
+
+/*******************************************************************************
+ * Transports
+ ******************************************************************************/
+/**
+ * @brief Transport policy over the function pointers of a struct mram
+ */
+class pointer_transport {
+public:
+    explicit pointer_transport(::mram& dev) noexcept : dev_(&dev) {}
+
+    bool select() { return dev_->gpio_write(dev_->cs_pin, MRAM_GPIO_LOW); }
+    bool deselect() { return dev_->gpio_write(dev_->cs_pin, MRAM_GPIO_HIGH); }
+    bool transfer(const uint8_t* tx, uint8_t* rx, size_t len) { return dev_->spi_transfer(tx, rx, len); }
+
+private:
+    ::mram* dev_;
+};
+
+/*******************************************************************************
+ * Device
+ ******************************************************************************/
+/**
+ * @brief MRAM device bound to a transport policy
+ *
+ * Member functions mirror the C API and return false on invalid parameters
+ * or transport failure.
+ */
+template <class Transport>
+class device {
+public:
+    /**
+     * @brief Construct the device and its transport
+     *
+     * Call init() before any other operation.
+     *
+     * @param args Arguments forwarded to the transport constructor
+     */
+    template <class... Args>
+    explicit device(Args&&... args) : transport_(std::forward<Args>(args)...) {}
+
+    /**
+     * @brief Deselect the device and clear the write enable latch
+     */
+    bool init() { return transport_.deselect() && write_disable(); }
+
+    /** @brief Access the transport policy */
+    Transport& transport() noexcept { return transport_; }
+
+    bool write_enable() { return command(MRAM_CMD_WREN); }
+
+    bool write_disable() { return command(MRAM_CMD_WRDI); }
+
+    /**
+     * @brief Read data
+     *
+     * @param addr Starting address (19-bit maximum)
+     * @param buffer Destination buffer
+     * @param len Number of bytes
+     */
+    bool read(uint32_t addr, uint8_t* buffer, size_t len) {
+        if (buffer == nullptr || !range_valid(addr, len)) return false;
+        if (!frame_begin(MRAM_CMD_READ, addr)) return false;
+        return data(MRAM_CMD_READ, buffer, len) && transport_.deselect();
+    }
+
+    /**
+     * @brief Write data, framed by WREN and WRDI
+     *
+     * @param addr Starting address (19-bit maximum)
+     * @param data_in Data to write
+     * @param len Number of bytes
+     */
+    bool write(uint32_t addr, const uint8_t* data_in, size_t len) {
+        if (data_in == nullptr || !range_valid(addr, len)) return false;
+        if (!write_enable() || !frame_begin(MRAM_CMD_WRITE, addr)) return false;
+        if (!data(MRAM_CMD_WRITE, const_cast<uint8_t*>(data_in), len) || !transport_.deselect()) return false;
+        return write_disable();
+    }
+
+    /**
+     * @brief Read an object from a fixed address
+     *
+     * @param object Trivially copyable destination, e.g. a config record or a byte array
+     */
+    template <uint32_t A, class T>
+    bool read(address<A>, T& object) {
+        static_assert(std::is_trivially_copyable_v<T>, "object must be trivially copyable");
+        static_assert(address<A>::template fits<sizeof(T)>, "object does not fit the device at this address");
+        if (!frame_begin(address<A>::read_header)) return false;
+        return data(MRAM_CMD_READ, reinterpret_cast<uint8_t*>(&object), sizeof(T)) && transport_.deselect();
+    }
+
+    /**
+     * @brief Write an object to a fixed address, framed by WREN and WRDI
+     *
+     * @param object Trivially copyable source
+     */
+    template <uint32_t A, class T>
+    bool write(address<A>, const T& object) {
+        static_assert(std::is_trivially_copyable_v<T>, "object must be trivially copyable");
+        static_assert(address<A>::template fits<sizeof(T)>, "object does not fit the device at this address");
+        if (!write_enable() || !frame_begin(address<A>::write_header)) return false;
+        uint8_t* bytes = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(&object));
+        if (!data(MRAM_CMD_WRITE, bytes, sizeof(T)) || !transport_.deselect()) return false;
+        return write_disable();
+    }
+
+    /**
+     * @brief Vectored read, adjacent segments share one frame
+     */
+    bool read_vector(const mram_iovec* iov, size_t count) {
+        if (!iovec_valid(iov, count)) return false;
+        return transfer_vector(MRAM_CMD_READ, iov, count);
+    }
+
+    /**
+     * @brief Vectored write under a single WREN, adjacent segments share one frame
+     */
+    bool write_vector(const mram_iovec* iov, size_t count) {
+        if (!iovec_valid(iov, count)) return false;
+        if (!write_enable() || !transfer_vector(MRAM_CMD_WRITE, iov, count)) return false;
+        return write_disable();
+    }
+
+    bool sleep() {
+        if (!command(MRAM_CMD_SLEEP)) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(MRAM_TDP_US));
+        return true;
+    }
+
+    // CS must stay high for tRDP after WAKE
+    bool wake() {
+        if (!command(MRAM_CMD_WAKE)) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(MRAM_TRDP_US));
+        return true;
+    }
+
+    bool read_status_register(uint8_t& status) {
+        uint8_t frame[2] = { MRAM_CMD_RDSR, 0xFF };
+        if (!transport_.select()) return false;
+        if (!transport_.transfer(frame, frame, sizeof(frame))) {
+            transport_.deselect();
+            return false;
+        }
+        status = frame[1];
+        return transport_.deselect();
+    }
+
+    bool write_status_register(uint8_t status) {
+        const auto frame = status_frame(status);
+        if (!write_enable() || !transport_.select()) return false;
+        if (!transport_.transfer(frame.data(), nullptr, frame.size())) {
+            transport_.deselect();
+            return false;
+        }
+        return transport_.deselect() && write_disable();
+    }
+
+private:
+    static bool iovec_valid(const mram_iovec* iov, size_t count) noexcept {
+        if (iov == nullptr || count == 0) return false;
+        for (size_t i = 0; i < count; i++) {
+            if (iov[i].buf == nullptr || !range_valid(iov[i].addr, iov[i].len)) return false;
+        }
+        return true;
+    }
+
+    // Single-byte command in its own CS cycle
+    bool command(uint8_t cmd) {
+        if (!transport_.select()) return false;
+        if (!transport_.transfer(&cmd, nullptr, 1)) {
+            transport_.deselect();
+            return false;
+        }
+        return transport_.deselect();
+    }
+
+    bool frame_begin(uint8_t cmd, uint32_t addr) { return frame_begin(frame_header(cmd, addr)); }
+
+    // Select and send CMD(1) + ADDR(3); CS is released again on failure
+    bool frame_begin(const frame_header_t& header) {
+        if (!transport_.select()) return false;
+        if (!transport_.transfer(header.data(), nullptr, header.size())) {
+            transport_.deselect();
+            return false;
+        }
+        return true;
+    }
+
+    // Data phase of an open frame; CS is released on failure
+    bool data(uint8_t cmd, uint8_t* buf, size_t len) {
+        bool ok;
+        if (cmd == MRAM_CMD_READ) {
+            // Clock out dummy bytes from the destination buffer itself
+            std::memset(buf, 0xFF, len);
+            ok = transport_.transfer(buf, buf, len);
+        } else {
+            ok = transport_.transfer(buf, nullptr, len);
+        }
+        if (!ok) transport_.deselect();
+        return ok;
+    }
+
+    bool transfer_vector(uint8_t cmd, const mram_iovec* iov, size_t count) {
+        bool selected = false;
+        uint32_t next_addr = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            if (!selected || iov[i].addr != next_addr) {
+                if (selected && !transport_.deselect()) return false;
+                selected = false;
+                if (!frame_begin(cmd, iov[i].addr)) return false;
+                selected = true;
+            }
+            if (!data(cmd, static_cast<uint8_t*>(iov[i].buf), iov[i].len)) return false;
+            next_addr = iov[i].addr + static_cast<uint32_t>(iov[i].len);
+        }
+        return transport_.deselect();
+    }
+
+    Transport transport_;
+};
+
+}  // namespace mram_interface
+
+#endif //MRAM_INTERFACE_MRAM_DEVICE_HPP
@@ -0,0 +1,320 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, nanosleep
+#include "mram_fault.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Eight histogram buckets per power of two; values below 8 ns get their own bucket
+#define FAULT_HIST_BUCKETS 496
+
+// Latency histogram of one outcome
+struct fault_hist {
+    uint64_t count;
+    uint64_t errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t buckets[FAULT_HIST_BUCKETS];
+};
+
+// Faults planned for one callback invocation
+struct fault_plan {
+    uint64_t delay_ns;
+    bool fail;
+    bool flip;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    struct mram inner;
+    struct mram_hook hook;
+    struct mram_fault_rule rules[MRAM_FAULT_CLASSES];
+    uint64_t prng;
+    struct mram_fault_class_stats classes[MRAM_FAULT_CLASSES];
+    struct fault_hist outcomes[MRAM_FAULT_OUTCOMES];
+    // Worst outcome of the API call in progress
+    uint8_t outcome;
+    // Command and bytes so far of the current CS frame
+    bool selected;
+    uint8_t cmd;
+    size_t frame_bytes;
+    // Copy of outgoing data that gets a flipped bit
+    uint8_t* scratch;
+    size_t scratch_cap;
+} fault = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t fault_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void fault_sleep(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+// splitmix64, so every seed (0 included) gives a full-period stream
+static uint64_t fault_random(void) {
+    uint64_t z = (fault.prng += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+static bool fault_chance(uint32_t ppm) {
+    return ppm != 0 && fault_random() % 1000000u < ppm;
+}
+
+static uint64_t fault_latency_us(const struct mram_fault_rule* rule) {
+    double u = (double)(fault_random() >> 11) * 0x1.0p-53;
+
+    switch (rule->dist) {
+        case MRAM_FAULT_DIST_FIXED:
+            return rule->latency_us;
+        case MRAM_FAULT_DIST_UNIFORM:
+            if (rule->latency_max_us <= rule->latency_us) return rule->latency_us;
+            return rule->latency_us + fault_random() % ((uint64_t)rule->latency_max_us - rule->latency_us + 1);
+        case MRAM_FAULT_DIST_EXPONENTIAL: {
+            double us = -(double)rule->latency_us * log(1.0 - u);
+            if (rule->latency_max_us && us > rule->latency_max_us) us = rule->latency_max_us;
+            return (uint64_t)us;
+        }
+        default:
+            return 0;
+    }
+}
+
+static void fault_mark(uint8_t outcome) {
+    if (outcome > fault.outcome) fault.outcome = outcome;
+}
+
+// Draw this invocation's faults from the rule of its class and count them
+static struct fault_plan fault_draw(uint8_t cls, bool data) {
+    struct fault_plan plan = { 0, false, false };
+    struct mram_fault_rule* rule = &fault.rules[cls];
+    struct mram_fault_class_stats* stats = &fault.classes[cls];
+
+    pthread_mutex_lock(&fault.lock);
+    stats->calls++;
+    uint64_t us = fault_latency_us(rule);
+    if (us) {
+        stats->delayed++;
+        fault_mark(MRAM_FAULT_DELAYED);
+    }
+    if (fault_chance(rule->stall_ppm)) {
+        us += rule->stall_us;
+        stats->stalls++;
+        fault_mark(MRAM_FAULT_STALLED);
+    }
+    plan.delay_ns = us * 1000u;
+    stats->injected_ns += plan.delay_ns;
+    if (fault_chance(rule->fail_ppm)) {
+        plan.fail = true;
+        stats->failures++;
+        fault_mark(MRAM_FAULT_FAILED);
+    } else if (data && fault_chance(rule->flip_ppm)) {
+        plan.flip = true;
+    }
+    pthread_mutex_unlock(&fault.lock);
+    return plan;
+}
+
+// Count a planned flip once it has actually changed a byte
+static void fault_flipped(uint8_t cls) {
+    pthread_mutex_lock(&fault.lock);
+    fault.classes[cls].flips++;
+    fault_mark(MRAM_FAULT_FLIPPED);
+    pthread_mutex_unlock(&fault.lock);
+}
+
+static uint8_t fault_class(uint8_t cmd) {
+    if (cmd == MRAM_CMD_READ) return MRAM_FAULT_READ;
+    if (cmd == MRAM_CMD_WRITE) return MRAM_FAULT_WRITE;
+    if (cmd == MRAM_CMD_RDSR || cmd == MRAM_CMD_WRSR) return MRAM_FAULT_STATUS;
+    return MRAM_FAULT_CONTROL;
+}
+
+// Bytes before the data phase of a frame; control frames carry no data
+static size_t fault_header(uint8_t cmd) {
+    if (cmd == MRAM_CMD_READ || cmd == MRAM_CMD_WRITE) return 4;
+    if (cmd == MRAM_CMD_RDSR || cmd == MRAM_CMD_WRSR) return 1;
+    return SIZE_MAX;
+}
+
+// Index of one random bit in [first, first + count) bytes
+static size_t fault_bit(size_t first, size_t count) {
+    pthread_mutex_lock(&fault.lock);
+    size_t bit = first * 8 + (size_t)(fault_random() % (count * 8));
+    pthread_mutex_unlock(&fault.lock);
+    return bit;
+}
+
+static bool fault_gpio_write(uint8_t pin, uint8_t value) {
+    struct fault_plan plan = fault_draw(MRAM_FAULT_GPIO, false);
+    if (plan.delay_ns) fault_sleep(plan.delay_ns);
+    if (plan.fail) return false;
+
+    if (pin == fault.inner.cs_pin) {
+        if (value == MRAM_GPIO_LOW && !fault.selected) fault.frame_bytes = 0;
+        fault.selected = value == MRAM_GPIO_LOW;
+    }
+    return fault.inner.gpio_write(pin, value);
+}
+
+static bool fault_spi_transfer(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    if (fault.frame_bytes == 0) fault.cmd = tx_buf && len ? tx_buf[0] : 0xFF;
+
+    // Data bytes of this transfer, after the command and address
+    size_t header = fault_header(fault.cmd);
+    size_t first = header > fault.frame_bytes ? header - fault.frame_bytes : 0;
+    size_t data = first < len ? len - first : 0;
+    fault.frame_bytes += len;
+
+    uint8_t cls = fault_class(fault.cmd);
+    struct fault_plan plan = fault_draw(cls, data != 0);
+    if (plan.delay_ns) fault_sleep(plan.delay_ns);
+    if (plan.fail) return false;
+    if (!plan.flip) return fault.inner.spi_transfer(tx_buf, rx_buf, len);
+
+    size_t bit = fault_bit(first, data);
+    uint8_t mask = (uint8_t)(1u << (bit % 8));
+    if (fault.cmd == MRAM_CMD_WRITE || fault.cmd == MRAM_CMD_WRSR) {
+        if (tx_buf == NULL) return fault.inner.spi_transfer(tx_buf, rx_buf, len);
+        if (len > fault.scratch_cap) {
+            uint8_t* p = realloc(fault.scratch, len);
+            if (p == NULL) return false;
+            fault.scratch = p;
+            fault.scratch_cap = len;
+        }
+        memcpy(fault.scratch, tx_buf, len);
+        fault.scratch[bit / 8] ^= mask;
+        fault_flipped(cls);
+        return fault.inner.spi_transfer(fault.scratch, rx_buf, len);
+    }
+
+    if (!fault.inner.spi_transfer(tx_buf, rx_buf, len)) return false;
+    if (rx_buf) {
+        rx_buf[bit / 8] ^= mask;
+        fault_flipped(cls);
+    }
+    return true;
+}
+
+static void fault_enter(struct mram_hook* hook, struct mram_call* call) {
+    (void)hook;
+    pthread_mutex_lock(&fault.lock);
+    fault.outcome = MRAM_FAULT_NONE;
+    pthread_mutex_unlock(&fault.lock);
+    call->cookie = fault_now();
+}
+
+static size_t fault_bucket(uint64_t ns) {
+    if (ns < 8) return (size_t)ns;
+    unsigned msb = 63u - (unsigned)__builtin_clzll(ns);
+    return (msb - 2) * 8 + ((ns >> (msb - 3)) & 7);
+}
+
+// Largest value that falls into a bucket
+static uint64_t fault_bucket_limit(size_t bucket) {
+    if (bucket < 8) return bucket;
+    unsigned shift = (unsigned)(bucket / 8) - 1;
+    return ((8 + (uint64_t)(bucket % 8) + 1) << shift) - 1;
+}
+
+static void fault_leave(struct mram_hook* hook, struct mram_call* call, bool ok) {
+    (void)hook;
+    uint64_t ns = fault_now() - call->cookie;
+
+    pthread_mutex_lock(&fault.lock);
+    struct fault_hist* h = &fault.outcomes[fault.outcome];
+    h->count++;
+    if (!ok) h->errors++;
+    h->total_ns += ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+    h->buckets[fault_bucket(ns)]++;
+    pthread_mutex_unlock(&fault.lock);
+}
+
+static uint64_t fault_percentile(const struct fault_hist* h, unsigned pct) {
+    uint64_t rank = (h->count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < FAULT_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t limit = fault_bucket_limit(i);
+            return limit < h->max_ns ? limit : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+bool mram_fault_init(struct mram* mram, const struct mram* inner, uint64_t seed) {
+    if (mram == NULL || inner == NULL || inner->gpio_write == NULL || inner->spi_transfer == NULL) return false;
+
+    pthread_mutex_lock(&fault.lock);
+    fault.inner = *inner;
+    fault.inner.hook = NULL;
+    memset(fault.rules, 0, sizeof(fault.rules));
+    fault.prng = seed;
+    fault.selected = false;
+    fault.frame_bytes = 0;
+    fault.hook.enter = fault_enter;
+    fault.hook.leave = fault_leave;
+    pthread_mutex_unlock(&fault.lock);
+
+    if (!mram_init(mram, fault_gpio_write, fault_spi_transfer, inner->cs_pin)) return false;
+    mram->hook = &fault.hook;
+    mram_fault_reset_stats();
+    return true;
+}
+
+bool mram_fault_set_rule(uint8_t cls, const struct mram_fault_rule* rule) {
+    if (cls >= MRAM_FAULT_CLASSES) return false;
+
+    pthread_mutex_lock(&fault.lock);
+    if (rule) {
+        fault.rules[cls] = *rule;
+    } else {
+        memset(&fault.rules[cls], 0, sizeof(fault.rules[cls]));
+    }
+    pthread_mutex_unlock(&fault.lock);
+    return true;
+}
+
+void mram_fault_seed(uint64_t seed) {
+    pthread_mutex_lock(&fault.lock);
+    fault.prng = seed;
+    pthread_mutex_unlock(&fault.lock);
+}
+
+void mram_fault_stats(struct mram_fault_stats* stats) {
+    if (stats == NULL) return;
+
+    pthread_mutex_lock(&fault.lock);
+    memcpy(stats->classes, fault.classes, sizeof(stats->classes));
+    for (size_t i = 0; i < MRAM_FAULT_OUTCOMES; i++) {
+        const struct fault_hist* h = &fault.outcomes[i];
+        struct mram_fault_latency* l = &stats->outcomes[i];
+        memset(l, 0, sizeof(*l));
+        l->count = h->count;
+        l->errors = h->errors;
+        if (h->count == 0) continue;
+        l->mean_ns = h->total_ns / h->count;
+        l->p50_ns = fault_percentile(h, 50);
+        l->p90_ns = fault_percentile(h, 90);
+        l->p99_ns = fault_percentile(h, 99);
+        l->max_ns = h->max_ns;
+    }
+    pthread_mutex_unlock(&fault.lock);
+}
+
+void mram_fault_reset_stats(void) {
+    pthread_mutex_lock(&fault.lock);
+    memset(fault.classes, 0, sizeof(fault.classes));
+    memset(fault.outcomes, 0, sizeof(fault.outcomes));
+    pthread_mutex_unlock(&fault.lock);
+}
@@ -0,0 +1,200 @@
+/**
+ * @file mram_fault.h
+ * @brief Fault and latency injection transport
+ *
+ * Wraps the gpio_write and spi_transfer callbacks of another struct mram
+ * and injects faults before passing calls through. Each call is classified
+ * by the command of its frame: READ, WRITE, status (RDSR, WRSR), control
+ * (WREN, WRDI, SLEEP, WAKE), or GPIO for chip select writes. Every class
+ * has its own rule, which can combine:
+ *
+ * - added latency, fixed, uniform or exponentially distributed;
+ * - rare stalls of a fixed length;
+ * - failures: the callback returns false without reaching the device;
+ * - bit flips: one random data bit is inverted, in the received data of
+ *   reads and status reads or in the sent data of writes.
+ *
+ * Rules may be changed at run time from any thread. All random decisions
+ * come from one PRNG seeded by the caller, so a single-threaded run
+ * injects the same faults every time.
+ *
+ * The wrapped device also gets a hook (see struct mram_hook) that times
+ * every API call end to end and files it under the worst fault it met
+ * (failure > bit flip > stall > latency > none). Comparing the latency
+ * percentiles of those outcomes shows how each fault changes end-to-end
+ * latency, for sizing timeouts and queue depths. Callers that retry should
+ * read the outcomes together with their own retry counts.
+ *
+ * @note struct mram callbacks carry no context, so there is one fault layer
+ *       per process. The hook slot of the wrapped device is taken.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_FAULT_H
+#define MRAM_INTERFACE_MRAM_FAULT_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Call classes with separate rules
+ */
+enum mram_fault_class {
+    MRAM_FAULT_GPIO,
+    MRAM_FAULT_READ,
+    MRAM_FAULT_WRITE,
+    MRAM_FAULT_STATUS,
+    MRAM_FAULT_CONTROL,
+    MRAM_FAULT_CLASSES,
+};
+
+/**
+ * @brief Worst fault an API call met
+ */
+enum mram_fault_outcome {
+    MRAM_FAULT_NONE,
+    MRAM_FAULT_DELAYED,
+    MRAM_FAULT_STALLED,
+    MRAM_FAULT_FLIPPED,
+    MRAM_FAULT_FAILED,
+    MRAM_FAULT_OUTCOMES,
+};
+
+/**
+ * @brief Latency distribution
+ */
+enum mram_fault_dist {
+    /** @brief No added latency */
+    MRAM_FAULT_DIST_NONE,
+    /** @brief latency_us on every call */
+    MRAM_FAULT_DIST_FIXED,
+    /** @brief Uniform between latency_us and latency_max_us */
+    MRAM_FAULT_DIST_UNIFORM,
+    /** @brief Exponential with mean latency_us, capped at latency_max_us (0 = no cap) */
+    MRAM_FAULT_DIST_EXPONENTIAL,
+};
+
+/**
+ * @brief Injection rule of one call class (all zero = pass through)
+ */
+struct mram_fault_rule {
+    /** @brief Latency distribution (enum mram_fault_dist) */
+    uint8_t dist;
+    /** @brief Fixed latency, uniform minimum or exponential mean, in microseconds */
+    uint32_t latency_us;
+    /** @brief Uniform maximum or exponential cap, in microseconds */
+    uint32_t latency_max_us;
+    /** @brief Stall probability per call, in parts per million */
+    uint32_t stall_ppm;
+    /** @brief Stall length in microseconds */
+    uint32_t stall_us;
+    /** @brief Failure probability per call, in parts per million */
+    uint32_t fail_ppm;
+    /** @brief Bit flip probability per call carrying data, in parts per million */
+    uint32_t flip_ppm;
+};
+
+/**
+ * @brief Injection counters of one call class
+ */
+struct mram_fault_class_stats {
+    /** @brief Callback invocations */
+    uint64_t calls;
+    /** @brief Calls with added latency */
+    uint64_t delayed;
+    /** @brief Stalls injected */
+    uint64_t stalls;
+    /** @brief Failures injected */
+    uint64_t failures;
+    /** @brief Bits flipped */
+    uint64_t flips;
+    /** @brief Total injected delay in nanoseconds */
+    uint64_t injected_ns;
+};
+
+/**
+ * @brief End-to-end latency of the API calls with one outcome
+ *
+ * Percentiles come from a histogram with eight buckets per power of two and
+ * are rounded up to the bucket's upper bound (at most 12.5% high).
+ */
+struct mram_fault_latency {
+    /** @brief API calls */
+    uint64_t count;
+    /** @brief Calls that returned false */
+    uint64_t errors;
+    /** @brief Mean, percentiles and maximum in nanoseconds */
+    uint64_t mean_ns, p50_ns, p90_ns, p99_ns, max_ns;
+};
+
+/**
+ * @brief Fault layer statistics
+ */
+struct mram_fault_stats {
+    /** @brief Injection counters, indexed by enum mram_fault_class */
+    struct mram_fault_class_stats classes[MRAM_FAULT_CLASSES];
+    /** @brief End-to-end latency, indexed by enum mram_fault_outcome */
+    struct mram_fault_latency outcomes[MRAM_FAULT_OUTCOMES];
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bind an MRAM interface to the fault layer in front of another one
+ *
+ * All rules start as pass through and the statistics are cleared.
+ *
+ * @param mram Pointer to the MRAM interface structure to initialize
+ * @param inner Pointer to an initialized MRAM interface to wrap (copied)
+ * @param seed PRNG seed
+ * @return true if successful, false if parameters are invalid
+ */
+bool mram_fault_init(struct mram* mram, const struct mram* inner, uint64_t seed);
+
+/**
+ * @brief Replace the rule of a call class
+ *
+ * @param cls Call class (enum mram_fault_class)
+ * @param rule New rule, or NULL to pass calls through
+ * @return true if successful, false if cls is out of range
+ */
+bool mram_fault_set_rule(uint8_t cls, const struct mram_fault_rule* rule);
+
+/**
+ * @brief Restart the PRNG
+ *
+ * @param seed PRNG seed
+ */
+void mram_fault_seed(uint64_t seed);
+
+/**
+ * @brief Read the statistics
+ *
+ * @param stats Receives the statistics
+ */
+void mram_fault_stats(struct mram_fault_stats* stats);
+
+/**
+ * @brief Clear the statistics
+ */
+void mram_fault_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_FAULT_H
@@ -0,0 +1,50 @@
+#include "mram_field.h"
+#include <string.h>
+
+bool mram_field_read(struct mram* mram, uint32_t addr, void* buffer, size_t len) {
+    struct mram_iovec iov = { addr, buffer, len };
+    return mram_read_vector(mram, &iov, 1);
+}
+
+bool mram_field_write(struct mram* mram, uint32_t addr, const void* data, size_t len) {
+    struct mram_iovec iov = { addr, (void*)data, len };
+    return mram_write_vector(mram, &iov, 1);
+}
+
+void mram_field_batch_init(struct mram_field_batch* batch) {
+    if (batch == NULL) return;
+    batch->count = 0;
+}
+
+static bool field_overlaps(const struct mram_iovec* a, const struct mram_iovec* b) {
+    return a->addr < b->addr + b->len && b->addr < a->addr + a->len;
+}
+
+bool mram_field_batch_add(struct mram_field_batch* batch, uint32_t addr, void* buf, size_t len) {
+    if (batch == NULL || buf == NULL || len == 0 || batch->count == MRAM_FIELD_MAX_BATCH) return false;
+    if (addr > MRAM_MAX_ADDRESS || len - 1 > (size_t)(MRAM_MAX_ADDRESS - addr)) return false;
+
+    // Insertion by address so adjacent members end up in one frame. Never move
+    // past an overlapping segment, the later write of the two has to stay later.
+    struct mram_iovec seg = { addr, buf, len };
+    size_t i = batch->count;
+    while (i > 0 && batch->iov[i - 1].addr > addr && !field_overlaps(&batch->iov[i - 1], &seg)) {
+        batch->iov[i] = batch->iov[i - 1];
+        i--;
+    }
+    batch->iov[i] = seg;
+    batch->count++;
+    return true;
+}
+
+bool mram_field_batch_read(struct mram* mram, const struct mram_field_batch* batch) {
+    if (mram == NULL || batch == NULL) return false;
+    if (batch->count == 0) return true;
+    return mram_read_vector(mram, batch->iov, batch->count);
+}
+
+bool mram_field_batch_write(struct mram* mram, const struct mram_field_batch* batch) {
+    if (mram == NULL || batch == NULL) return false;
+    if (batch->count == 0) return true;
+    return mram_write_vector(mram, batch->iov, batch->count);
+}
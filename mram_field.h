@@ -0,0 +1,189 @@
+/**
+ * @file mram_field.h
+ * @brief Field-granular access to C structs stored in MRAM
+ *
+ * For a struct of type T stored at a device address, the MRAM_FIELD_*
+ * macros locate a member with offsetof(). They read or write only that
+ * member's bytes, so updating a 4-byte counter in a 256-byte record moves 4
+ * bytes instead of 256. The macros check at compile time that the RAM
+ * object passed for a member has the member's size.
+ *
+ * Several field accesses can be collected in a batch and sent as one
+ * vectored operation. The batch keeps its segments in address order, so
+ * fields that lie next to each other in the struct share one frame, and a
+ * write batch needs one WREN/WRDI pair. Overlapping write segments keep
+ * their submission order, so the later one still wins.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_FIELD_H
+#define MRAM_INTERFACE_MRAM_FIELD_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stddef.h>
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+#ifndef MRAM_FIELD_MAX_BATCH
+/** @brief Maximum number of field accesses per batch */
+#define MRAM_FIELD_MAX_BATCH 16
+#endif
+
+/** @brief Device address of a member of a struct stored at base */
+#define MRAM_FIELD_ADDR(type, base, member) ((uint32_t)(base) + (uint32_t)offsetof(type, member))
+
+/** @brief Size of a struct member */
+#define MRAM_FIELD_SIZE(type, member) sizeof(((type*)0)->member)
+
+// Evaluates to 0, or fails to compile if *(ptr) is not the size of the member
+#define MRAM_FIELD_CHECK(type, member, ptr) \
+    (0 * sizeof(char[sizeof(*(ptr)) == MRAM_FIELD_SIZE(type, member) ? 1 : -1]))
+
+/**
+ * @brief Read one member of a struct stored at base into *dst
+ * @return Same as mram_field_read()
+ */
+#define MRAM_FIELD_READ(mram, type, base, member, dst)                                              \
+    mram_field_read((mram), MRAM_FIELD_ADDR(type, base, member) + MRAM_FIELD_CHECK(type, member, dst), \
+                    (dst), MRAM_FIELD_SIZE(type, member))
+
+/**
+ * @brief Write *src to one member of a struct stored at base
+ * @return Same as mram_field_write()
+ */
+#define MRAM_FIELD_WRITE(mram, type, base, member, src)                                              \
+    mram_field_write((mram), MRAM_FIELD_ADDR(type, base, member) + MRAM_FIELD_CHECK(type, member, src), \
+                     (src), MRAM_FIELD_SIZE(type, member))
+
+/**
+ * @brief Read len bytes starting off bytes into a member
+ * @return Same as mram_field_read(), also false if the range leaves the member
+ */
+#define MRAM_FIELD_READ_RANGE(mram, type, base, member, off, dst, len)                                 \
+    (mram_field_range_valid(MRAM_FIELD_SIZE(type, member), (off), (len)) &&                            \
+     mram_field_read((mram), MRAM_FIELD_ADDR(type, base, member) + (uint32_t)(off), (dst), (len)))
+
+/**
+ * @brief Write len bytes starting off bytes into a member
+ * @return Same as mram_field_write(), also false if the range leaves the member
+ */
+#define MRAM_FIELD_WRITE_RANGE(mram, type, base, member, off, src, len)                                \
+    (mram_field_range_valid(MRAM_FIELD_SIZE(type, member), (off), (len)) &&                            \
+     mram_field_write((mram), MRAM_FIELD_ADDR(type, base, member) + (uint32_t)(off), (src), (len)))
+
+/**
+ * @brief Add one member access to a batch
+ * @return Same as mram_field_batch_add()
+ */
+#define MRAM_FIELD_BATCH_ADD(batch, type, base, member, ptr)                                                 \
+    mram_field_batch_add((batch), MRAM_FIELD_ADDR(type, base, member) + MRAM_FIELD_CHECK(type, member, ptr), \
+                         (void*)(ptr), MRAM_FIELD_SIZE(type, member))
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Batch of field accesses sent as one vectored operation
+ *
+ * A batch is used for either reads or writes, never both.
+ */
+struct mram_field_batch {
+    /** @brief Segments in address order */
+    struct mram_iovec iov[MRAM_FIELD_MAX_BATCH];
+    /** @brief Segments in use */
+    size_t count;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Check that a byte range stays inside a member
+ *
+ * A function rather than an expression in the range macros, so a constant
+ * len of 0 does not trip -Wtype-limits.
+ *
+ * @param size Size of the member
+ * @param off Offset of the range into the member
+ * @param len Length of the range
+ * @return true if off + len does not pass the end of the member
+ */
+static inline bool mram_field_range_valid(size_t size, size_t off, size_t len) {
+    return off <= size && len <= size - off;
+}
+
+/**
+ * @brief Read a byte range of a stored struct
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param addr Device address
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if parameters are invalid or communication fails
+ */
+bool mram_field_read(struct mram* mram, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Write a byte range of a stored struct
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param addr Device address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if successful, false if parameters are invalid or communication fails
+ */
+bool mram_field_write(struct mram* mram, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Empty a batch
+ *
+ * @param batch Pointer to the batch
+ */
+void mram_field_batch_init(struct mram_field_batch* batch);
+
+/**
+ * @brief Add a byte range to a batch
+ *
+ * @param batch Pointer to the batch
+ * @param addr Device address
+ * @param buf RAM side of the access, must stay valid until the batch is sent
+ * @param len Number of bytes
+ * @return true if added, false if parameters are invalid or the batch is full
+ */
+bool mram_field_batch_add(struct mram_field_batch* batch, uint32_t addr, void* buf, size_t len);
+
+/**
+ * @brief Read all batched ranges in one vectored operation
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param batch Pointer to the batch
+ * @return true if successful (or the batch is empty), false otherwise
+ */
+bool mram_field_batch_read(struct mram* mram, const struct mram_field_batch* batch);
+
+/**
+ * @brief Write all batched ranges in one vectored operation
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param batch Pointer to the batch
+ * @return true if successful (or the batch is empty), false otherwise
+ */
+bool mram_field_batch_write(struct mram* mram, const struct mram_field_batch* batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_FIELD_H
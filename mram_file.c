@@ -0,0 +1,47 @@
+#define _POSIX_C_SOURCE 200809L  // ftruncate, msync
+#include "mram_file.h"
+#include "mram_sim.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool mram_file_open(struct mram_file* file, struct mram* mram, const char* path) {
+    if (file == NULL || mram == NULL || path == NULL) return false;
+
+    file->memory = NULL;
+    file->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (file->fd < 0) return false;
+
+    struct stat st;
+    bool ok = fstat(file->fd, &st) == 0;
+    // A fresh file is sized here and an image without the status byte gets
+    // a zero one; anything else must already be an image
+    if (ok && (st.st_size == 0 || st.st_size == MRAM_SIZE_BYTES)) {
+        ok = ftruncate(file->fd, MRAM_FILE_IMAGE_SIZE) == 0;
+    } else if (ok) {
+        ok = st.st_size == MRAM_FILE_IMAGE_SIZE;
+    }
+    if (ok) {
+        void* p = mmap(NULL, MRAM_FILE_IMAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+        if (p != MAP_FAILED) file->memory = p;
+    }
+    if (file->memory == NULL || !mram_sim_init_nv(mram, file->memory, file->memory + MRAM_SIZE_BYTES)) {
+        mram_file_close(file);
+        return false;
+    }
+    return true;
+}
+
+bool mram_file_sync(struct mram_file* file) {
+    if (file == NULL || file->memory == NULL) return false;
+    return msync(file->memory, MRAM_FILE_IMAGE_SIZE, MS_SYNC) == 0;
+}
+
+void mram_file_close(struct mram_file* file) {
+    if (file == NULL) return;
+    if (file->memory) munmap(file->memory, MRAM_FILE_IMAGE_SIZE);
+    if (file->fd >= 0) close(file->fd);
+    file->memory = NULL;
+    file->fd = -1;
+}
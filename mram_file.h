@@ -0,0 +1,98 @@
+/**
+ * @file mram_file.h
+ * @brief File-backed MRAM device for development and CI
+ *
+ * Maps a 512 KB image file into memory and binds a struct mram to it, so
+ * code written against mram_read(), mram_write() and the rest of the API
+ * runs on a workstation without SPI hardware. Command semantics come from
+ * the mram_sim.h model: the write enable latch, block protection, WRSR and
+ * sleep behave as on the device. Payloads move with memcpy straight to and
+ * from the mapping, so only the command and address bytes are decoded one
+ * at a time.
+ *
+ * The image is the raw device contents followed by one byte holding the
+ * nonvolatile bits of the status register (BP0, BP1 and WPEN), and
+ * persists across runs. A new file is created zero-filled. An image of
+ * MRAM_SIZE_BYTES from before the status byte is extended with a zero one.
+ *
+ * @note The backend shares the single simulated device of mram_sim.h, so a
+ *       process can have one open file device at a time, and it replaces
+ *       any device bound with mram_sim_init().
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_FILE_H
+#define MRAM_INTERFACE_MRAM_FILE_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Image file size: device contents and the status register byte */
+#define MRAM_FILE_IMAGE_SIZE (MRAM_SIZE_BYTES + 1)
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief File device handle
+ */
+struct mram_file {
+    /** @brief Image file descriptor */
+    int fd;
+    /** @brief Mapping of the image, MRAM_FILE_IMAGE_SIZE long */
+    uint8_t* memory;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Open or create an image file and bind an MRAM interface to it
+ *
+ * @param file Pointer to the handle to initialize
+ * @param mram Pointer to the MRAM interface structure to initialize
+ * @param path Image file path
+ * @return true if successful, false if parameters are invalid, the file has
+ *         a size other than 0, MRAM_SIZE_BYTES or MRAM_FILE_IMAGE_SIZE, or
+ *         a system call fails
+ */
+bool mram_file_open(struct mram_file* file, struct mram* mram, const char* path);
+
+/**
+ * @brief Flush the image to storage
+ *
+ * Not needed for persistence across runs (the mapping is shared), only for
+ * durability against a system crash.
+ *
+ * @param file Pointer to the handle
+ * @return true if successful, false otherwise
+ */
+bool mram_file_sync(struct mram_file* file);
+
+/**
+ * @brief Unmap and close the image
+ *
+ * The MRAM interface bound by mram_file_open() must not be used afterwards.
+ *
+ * @param file Pointer to the handle
+ */
+void mram_file_close(struct mram_file* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_FILE_H
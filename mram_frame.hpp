@@ -0,0 +1,108 @@
+/**
+ * @file mram_frame.hpp
+ * @brief constexpr command frames and compile-time checked addresses
+ *
+ * frame_header() builds the CMD(1) + ADDR(3) bytes of a READ or WRITE
+ * frame, and status_frame() builds the two-byte WRSR frame. Both are
+ * constexpr, so frames for constant addresses are folded into read-only
+ * data.
+ *
+ * address<A> carries a device address in its type. Its range check is a
+ * static_assert, and it precomputes the READ and WRITE headers as constants.
+ * The device overloads that take an address<A> check the object size at
+ * compile time as well, so fixed-address accesses such as well-known config
+ * records have no run-time validation branches and no header assembly.
+ *
+ * This header opens namespace mram_interface, which the other C++ headers
+ * share. It cannot be named mram because it would clash with struct mram
+ * in the global namespace.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_FRAME_HPP
+#define MRAM_INTERFACE_MRAM_FRAME_HPP
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "mram.h"
+
+namespace mram_interface {
+
+/*******************************************************************************
+ * Frame Builders
+ ******************************************************************************/
+/** @brief CMD(1) + ADDR(3) frame header */
+using frame_header_t = std::array<uint8_t, 4>;
+
+/**
+ * @brief Build the header of a READ or WRITE frame
+ *
+ * @param cmd Command code
+ * @param addr Device address, masked to 19 bits
+ */
+constexpr frame_header_t frame_header(uint8_t cmd, uint32_t addr) noexcept {
+    addr &= MRAM_ADDRESS_MASK;
+    return { cmd, static_cast<uint8_t>(addr >> 16), static_cast<uint8_t>(addr >> 8), static_cast<uint8_t>(addr) };
+}
+
+/**
+ * @brief Build a WRSR frame
+ *
+ * @param status Value to write to the status register
+ */
+constexpr std::array<uint8_t, 2> status_frame(uint8_t status) noexcept { return { MRAM_CMD_WRSR, status }; }
+
+/**
+ * @brief Check that len bytes starting at addr lie inside the device
+ */
+constexpr bool range_valid(uint32_t addr, size_t len) noexcept {
+    return len != 0 && addr <= MRAM_MAX_ADDRESS && len - 1 <= static_cast<size_t>(MRAM_MAX_ADDRESS - addr);
+}
+
+/*******************************************************************************
+ * Typed Addresses
+ ******************************************************************************/
+/**
+ * @brief Device address known at compile time
+ *
+ * @tparam A Address, must not exceed MRAM_MAX_ADDRESS
+ */
+template <uint32_t A>
+struct address {
+    static_assert(A <= MRAM_MAX_ADDRESS, "MRAM address out of range");
+
+    /** @brief Address value */
+    static constexpr uint32_t value = A;
+    /** @brief Precomputed READ header */
+    static constexpr frame_header_t read_header = frame_header(MRAM_CMD_READ, A);
+    /** @brief Precomputed WRITE header */
+    static constexpr frame_header_t write_header = frame_header(MRAM_CMD_WRITE, A);
+
+    /** @brief True if len bytes starting at A fit the device */
+    template <size_t Len>
+    static constexpr bool fits = range_valid(A, Len);
+
+    constexpr operator uint32_t() const noexcept { return A; }
+
+    /** @brief Address Offset bytes further on, range checked as well */
+    template <uint32_t Offset>
+    constexpr address<A + Offset> offset() const noexcept {
+        static_assert(Offset <= MRAM_MAX_ADDRESS - A, "MRAM address out of range");
+        return {};
+    }
+};
+
+/** @brief Shorthand for address<A>{} */
+template <uint32_t A>
+inline constexpr address<A> at{};
+
+}  // namespace mram_interface
+
+#endif //MRAM_INTERFACE_MRAM_FRAME_HPP
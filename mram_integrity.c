@@ -0,0 +1,405 @@
+#include "mram_integrity.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define MRAM_CRC32C_HW 1
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#define MRAM_CRC32C_HW 1
+#endif
+
+// Reflected Castagnoli polynomial
+#define CRC32C_POLY 0x82F63B78u
+
+static uint32_t crc32c_table[8][256];
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+static bool crc32c_use_hw;
+
+/*******************************************************************************
+ * Portable slicing-by-8
+ ******************************************************************************/
+
+static uint32_t crc32c_sw(uint32_t c, const uint8_t* p, size_t len) {
+    while (len >= 8) {
+        uint32_t lo = c ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+        uint32_t hi = (uint32_t)p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+        c = crc32c_table[7][lo & 0xFF] ^ crc32c_table[6][(lo >> 8) & 0xFF] ^
+            crc32c_table[5][(lo >> 16) & 0xFF] ^ crc32c_table[4][lo >> 24] ^
+            crc32c_table[3][hi & 0xFF] ^ crc32c_table[2][(hi >> 8) & 0xFF] ^
+            crc32c_table[1][(hi >> 16) & 0xFF] ^ crc32c_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = crc32c_table[0][(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c;
+}
+
+/*******************************************************************************
+ * Hardware CRC instructions
+ ******************************************************************************/
+
+#if defined(__x86_64__)
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+#define crc32c_hw_u64(c, w) ((uint32_t)_mm_crc32_u64((c), (w)))
+#define crc32c_hw_u8(c, b) _mm_crc32_u8((c), (b))
+#elif defined(__aarch64__)
+#define CRC32C_TARGET __attribute__((target("+crc")))
+#define crc32c_hw_u64(c, w) __crc32cd((c), (w))
+#define crc32c_hw_u8(c, b) __crc32cb((c), (b))
+#endif
+
+#ifdef MRAM_CRC32C_HW
+static inline uint64_t crc32c_load64(const uint8_t* p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+CRC32C_TARGET
+static uint32_t crc32c_hw(uint32_t c, const uint8_t* p, size_t len) {
+    while (len >= 8) {
+        c = crc32c_hw_u64(c, crc32c_load64(p));
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = crc32c_hw_u8(c, *p++);
+    return c;
+}
+
+// The CRC instruction has a latency of about three cycles but a throughput of
+// one per cycle, so three independent streams keep the unit busy.
+CRC32C_TARGET
+static void crc32c_batch_hw(const uint8_t* data, size_t block_size, size_t count, uint32_t* crcs) {
+    size_t i = 0;
+    for (; i + 3 <= count; i += 3) {
+        const uint8_t* a = data + i * block_size;
+        const uint8_t* b = a + block_size;
+        const uint8_t* c = b + block_size;
+        uint32_t ca = 0xFFFFFFFFu, cb = 0xFFFFFFFFu, cc = 0xFFFFFFFFu;
+        size_t n = 0;
+        for (; n + 8 <= block_size; n += 8) {
+            ca = crc32c_hw_u64(ca, crc32c_load64(a + n));
+            cb = crc32c_hw_u64(cb, crc32c_load64(b + n));
+            cc = crc32c_hw_u64(cc, crc32c_load64(c + n));
+        }
+        for (; n < block_size; n++) {
+            ca = crc32c_hw_u8(ca, a[n]);
+            cb = crc32c_hw_u8(cb, b[n]);
+            cc = crc32c_hw_u8(cc, c[n]);
+        }
+        crcs[i] = ~ca;
+        crcs[i + 1] = ~cb;
+        crcs[i + 2] = ~cc;
+    }
+    for (; i < count; i++)
+        crcs[i] = ~crc32c_hw(0xFFFFFFFFu, data + i * block_size, block_size);
+}
+#endif
+
+static void crc32c_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        crc32c_table[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = crc32c_table[0][n];
+        for (int k = 1; k < 8; k++) {
+            c = crc32c_table[0][c & 0xFF] ^ (c >> 8);
+            crc32c_table[k][n] = c;
+        }
+    }
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    crc32c_use_hw = __builtin_cpu_supports("sse4.2");
+#elif defined(__aarch64__) && defined(__linux__)
+    crc32c_use_hw = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    crc32c_use_hw = true;
+#endif
+}
+
+uint32_t mram_crc32c(uint32_t crc, const void* data, size_t len) {
+    pthread_once(&crc32c_once, crc32c_init);
+    if (data == NULL) return crc;
+#ifdef MRAM_CRC32C_HW
+    if (crc32c_use_hw) return ~crc32c_hw(~crc, data, len);
+#endif
+    return ~crc32c_sw(~crc, data, len);
+}
+
+void mram_crc32c_batch(const void* data, size_t block_size, size_t count, uint32_t* crcs) {
+    pthread_once(&crc32c_once, crc32c_init);
+    if (data == NULL || crcs == NULL) return;
+#ifdef MRAM_CRC32C_HW
+    if (crc32c_use_hw) {
+        crc32c_batch_hw(data, block_size, count, crcs);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++)
+        crcs[i] = ~crc32c_sw(0xFFFFFFFFu, (const uint8_t*)data + i * block_size, block_size);
+}
+
+bool mram_crc32c_hw_available(void) {
+    pthread_once(&crc32c_once, crc32c_init);
+    return crc32c_use_hw;
+}
+
+/*******************************************************************************
+ * Integrity layer
+ ******************************************************************************/
+
+static void ig_put_crc(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t ig_get_crc(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool ig_ranges_overlap(uint32_t a, uint32_t a_len, uint32_t b, uint32_t b_len) {
+    return a < b + b_len && b < a + a_len;
+}
+
+static bool ig_range_valid(const struct mram_integrity* ig, uint32_t addr, size_t len) {
+    return len != 0 && addr >= ig->data_addr && addr - ig->data_addr < ig->data_size &&
+           len <= ig->data_size - (addr - ig->data_addr);
+}
+
+// Checksums of the chunk of nb blocks starting at cs. Bytes of [cs, us) come
+// from head, [us, ue) from user and [ue, chunk end) from tail. Blocks fully
+// inside the user range go through the batch path.
+static void ig_chunk_crcs(const struct mram_integrity* ig, uint32_t cs, uint32_t nb, uint32_t us, uint32_t ue,
+                          const uint8_t* head, const uint8_t* user, const uint8_t* tail, uint32_t* crcs) {
+    const uint32_t bsz = ig->block_size;
+    uint32_t first_full = nb, last_full = 0;
+
+    for (uint32_t k = 0; k < nb; k++) {
+        uint32_t bs = cs + k * bsz;
+        uint32_t be = bs + bsz;
+        if (bs >= us && be <= ue) {
+            if (first_full == nb) first_full = k;
+            last_full = k;
+            continue;
+        }
+
+        uint32_t crc = 0;
+        if (bs < us) crc = mram_crc32c(crc, head + (bs - cs), us - bs);
+        uint32_t ps = bs > us ? bs : us;
+        uint32_t pe = be < ue ? be : ue;
+        if (ps < pe) crc = mram_crc32c(crc, user + (ps - us), pe - ps);
+        if (be > ue) {
+            uint32_t ts = bs > ue ? bs : ue;
+            crc = mram_crc32c(crc, tail + (ts - ue), be - ts);
+        }
+        crcs[k] = crc;
+    }
+
+    if (first_full < nb)
+        mram_crc32c_batch(user + (cs + first_full * bsz - us), bsz, last_full - first_full + 1, crcs + first_full);
+}
+
+static bool ig_verify(struct mram_integrity* ig, uint32_t first_block, uint32_t nb,
+                      const uint32_t* crcs, const uint8_t* stored) {
+    for (uint32_t k = 0; k < nb; k++) {
+        if (crcs[k] != ig_get_crc(stored + k * MRAM_INTEGRITY_CRC_SIZE)) {
+            ig->last_bad_block = first_block + k;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mram_integrity_init(struct mram_integrity* ig, struct mram* mram, const struct mram_integrity_config* config) {
+    if (ig == NULL || mram == NULL || config == NULL) return false;
+
+    uint32_t bsz = config->block_size;
+    if (bsz < MRAM_INTEGRITY_MIN_BLOCK_SIZE || bsz > MRAM_INTEGRITY_MAX_BLOCK_SIZE || (bsz & (bsz - 1)) != 0)
+        return false;
+    if (config->data_size == 0 || (config->data_size & (bsz - 1)) != 0) return false;
+
+    uint32_t meta_size = (config->data_size / bsz) * MRAM_INTEGRITY_CRC_SIZE;
+    if (config->data_addr > MRAM_MAX_ADDRESS || config->data_size > MRAM_SIZE_BYTES - config->data_addr) return false;
+    if (config->meta_addr > MRAM_MAX_ADDRESS || meta_size > MRAM_SIZE_BYTES - config->meta_addr) return false;
+    if (ig_ranges_overlap(config->data_addr, config->data_size, config->meta_addr, meta_size)) return false;
+
+    memset(ig, 0, sizeof(*ig));
+    ig->mram = mram;
+    ig->data_addr = config->data_addr;
+    ig->data_size = config->data_size;
+    ig->block_size = bsz;
+    while ((1u << ig->block_shift) < bsz) ig->block_shift++;
+    ig->meta_addr = config->meta_addr;
+    ig->scratch_size = 2 * bsz > MRAM_INTEGRITY_SCAN_SIZE ? 2 * bsz : MRAM_INTEGRITY_SCAN_SIZE;
+    ig->scratch = malloc(ig->scratch_size);
+    return ig->scratch != NULL;
+}
+
+void mram_integrity_deinit(struct mram_integrity* ig) {
+    if (ig == NULL) return;
+    free(ig->scratch);
+    ig->scratch = NULL;
+}
+
+bool mram_integrity_format(struct mram_integrity* ig) {
+    if (ig == NULL || ig->scratch == NULL) return false;
+
+    uint32_t blocks = ig->data_size >> ig->block_shift;
+    uint32_t per_pass = ig->scratch_size >> ig->block_shift;
+    if (per_pass > MRAM_INTEGRITY_CHUNK_BLOCKS) per_pass = MRAM_INTEGRITY_CHUNK_BLOCKS;
+
+    for (uint32_t b = 0; b < blocks; b += per_pass) {
+        uint32_t nb = blocks - b < per_pass ? blocks - b : per_pass;
+        uint32_t crcs[MRAM_INTEGRITY_CHUNK_BLOCKS];
+        uint8_t stored[MRAM_INTEGRITY_CHUNK_BLOCKS * MRAM_INTEGRITY_CRC_SIZE];
+        struct mram_iovec data = { ig->data_addr + (b << ig->block_shift), ig->scratch, nb << ig->block_shift };
+
+        if (!mram_read_vector(ig->mram, &data, 1)) return false;
+        mram_crc32c_batch(ig->scratch, ig->block_size, nb, crcs);
+        for (uint32_t k = 0; k < nb; k++) ig_put_crc(stored + k * MRAM_INTEGRITY_CRC_SIZE, crcs[k]);
+        if (!mram_write(ig->mram, ig->meta_addr + b * MRAM_INTEGRITY_CRC_SIZE, stored, nb * MRAM_INTEGRITY_CRC_SIZE))
+            return false;
+    }
+    return true;
+}
+
+bool mram_integrity_read(struct mram_integrity* ig, uint32_t addr, void* buffer, size_t len) {
+    if (ig == NULL || ig->scratch == NULL || buffer == NULL || !ig_range_valid(ig, addr, len)) return false;
+
+    uint8_t* out = buffer;
+    uint32_t end = addr + (uint32_t)len;
+    uint32_t first = (addr - ig->data_addr) >> ig->block_shift;
+    uint32_t last = (end - 1 - ig->data_addr) >> ig->block_shift;
+
+    for (uint32_t b0 = first; b0 <= last; b0 += MRAM_INTEGRITY_CHUNK_BLOCKS) {
+        uint32_t nb = last - b0 + 1 < MRAM_INTEGRITY_CHUNK_BLOCKS ? last - b0 + 1 : MRAM_INTEGRITY_CHUNK_BLOCKS;
+        uint32_t cs = ig->data_addr + (b0 << ig->block_shift);
+        uint32_t ce = cs + (nb << ig->block_shift);
+        uint32_t us = addr > cs ? addr : cs;
+        uint32_t ue = end < ce ? end : ce;
+        uint8_t stored[MRAM_INTEGRITY_CHUNK_BLOCKS * MRAM_INTEGRITY_CRC_SIZE];
+        uint32_t crcs[MRAM_INTEGRITY_CHUNK_BLOCKS];
+        uint8_t* head = ig->scratch;
+        uint8_t* tail = ig->scratch + ig->block_size;
+
+        // Leading partial block, user range and trailing partial block are
+        // adjacent on the device, so together they form a single READ frame.
+        struct mram_iovec iov[4];
+        size_t n = 0;
+        if (cs < us) iov[n++] = (struct mram_iovec){ cs, head, us - cs };
+        iov[n++] = (struct mram_iovec){ us, out + (us - addr), ue - us };
+        if (ue < ce) iov[n++] = (struct mram_iovec){ ue, tail, ce - ue };
+        iov[n++] = (struct mram_iovec){ ig->meta_addr + b0 * MRAM_INTEGRITY_CRC_SIZE, stored,
+                                        nb * MRAM_INTEGRITY_CRC_SIZE };
+        if (!mram_read_vector(ig->mram, iov, n)) return false;
+
+        ig_chunk_crcs(ig, cs, nb, us, ue, head, out + (us - addr), tail, crcs);
+        if (!ig_verify(ig, b0, nb, crcs, stored)) return false;
+    }
+    return true;
+}
+
+bool mram_integrity_write(struct mram_integrity* ig, uint32_t addr, const void* data, size_t len) {
+    if (ig == NULL || ig->scratch == NULL || data == NULL || !ig_range_valid(ig, addr, len)) return false;
+
+    const uint8_t* in = data;
+    const uint32_t bsz = ig->block_size;
+    uint32_t end = addr + (uint32_t)len;
+    uint32_t first = (addr - ig->data_addr) >> ig->block_shift;
+    uint32_t last = (end - 1 - ig->data_addr) >> ig->block_shift;
+
+    for (uint32_t b0 = first; b0 <= last; b0 += MRAM_INTEGRITY_CHUNK_BLOCKS) {
+        uint32_t nb = last - b0 + 1 < MRAM_INTEGRITY_CHUNK_BLOCKS ? last - b0 + 1 : MRAM_INTEGRITY_CHUNK_BLOCKS;
+        uint32_t cs = ig->data_addr + (b0 << ig->block_shift);
+        uint32_t ce = cs + (nb << ig->block_shift);
+        uint32_t us = addr > cs ? addr : cs;
+        uint32_t ue = end < ce ? end : ce;
+        uint8_t stored[MRAM_INTEGRITY_CHUNK_BLOCKS * MRAM_INTEGRITY_CRC_SIZE];
+        uint32_t crcs[MRAM_INTEGRITY_CHUNK_BLOCKS];
+        const uint8_t* user = in + (us - addr);
+        uint8_t* head = ig->scratch;
+        uint8_t* tail = ig->scratch + bsz;
+        bool head_partial = cs < us;
+        bool tail_partial = ue < ce;
+
+        if (head_partial || tail_partial) {
+            // Fetch whole partial blocks and verify them before they get a new checksum
+            struct mram_iovec iov[3];
+            size_t n = 0;
+            bool shared = head_partial && tail_partial && nb == 1;
+            if (head_partial) iov[n++] = (struct mram_iovec){ cs, head, bsz };
+            if (tail_partial && !shared) iov[n++] = (struct mram_iovec){ ce - bsz, tail, bsz };
+            iov[n++] = (struct mram_iovec){ ig->meta_addr + b0 * MRAM_INTEGRITY_CRC_SIZE, stored,
+                                            nb * MRAM_INTEGRITY_CRC_SIZE };
+            if (!mram_read_vector(ig->mram, iov, n)) return false;
+
+            if (head_partial && mram_crc32c(0, head, bsz) != ig_get_crc(stored)) {
+                ig->last_bad_block = b0;
+                return false;
+            }
+            if (shared) {
+                tail = head + (ue - cs);
+            } else if (tail_partial) {
+                if (mram_crc32c(0, tail, bsz) != ig_get_crc(stored + (nb - 1) * MRAM_INTEGRITY_CRC_SIZE)) {
+                    ig->last_bad_block = b0 + nb - 1;
+                    return false;
+                }
+                tail += bsz - (ce - ue);
+            }
+        }
+
+        ig_chunk_crcs(ig, cs, nb, us, ue, head, user, tail, crcs);
+        for (uint32_t k = 0; k < nb; k++) ig_put_crc(stored + k * MRAM_INTEGRITY_CRC_SIZE, crcs[k]);
+
+        struct mram_iovec out[2] = {
+            { us, (void*)user, ue - us },
+            { ig->meta_addr + b0 * MRAM_INTEGRITY_CRC_SIZE, stored, nb * MRAM_INTEGRITY_CRC_SIZE },
+        };
+        if (!mram_write_vector(ig->mram, out, 2)) return false;
+    }
+    return true;
+}
+
+bool mram_integrity_scrub(struct mram_integrity* ig, uint32_t* bad_blocks) {
+    if (ig == NULL || ig->scratch == NULL) return false;
+
+    uint32_t blocks = ig->data_size >> ig->block_shift;
+    uint32_t per_pass = ig->scratch_size >> ig->block_shift;
+    uint32_t bad = 0;
+    if (per_pass > MRAM_INTEGRITY_CHUNK_BLOCKS) per_pass = MRAM_INTEGRITY_CHUNK_BLOCKS;
+
+    for (uint32_t b = 0; b < blocks; b += per_pass) {
+        uint32_t nb = blocks - b < per_pass ? blocks - b : per_pass;
+        uint32_t crcs[MRAM_INTEGRITY_CHUNK_BLOCKS];
+        uint8_t stored[MRAM_INTEGRITY_CHUNK_BLOCKS * MRAM_INTEGRITY_CRC_SIZE];
+        struct mram_iovec iov[2] = {
+            { ig->data_addr + (b << ig->block_shift), ig->scratch, nb << ig->block_shift },
+            { ig->meta_addr + b * MRAM_INTEGRITY_CRC_SIZE, stored, nb * MRAM_INTEGRITY_CRC_SIZE },
+        };
+
+        if (!mram_read_vector(ig->mram, iov, 2)) return false;
+        mram_crc32c_batch(ig->scratch, ig->block_size, nb, crcs);
+        for (uint32_t k = 0; k < nb; k++) {
+            if (crcs[k] != ig_get_crc(stored + k * MRAM_INTEGRITY_CRC_SIZE)) {
+                ig->last_bad_block = b + k;
+                bad++;
+            }
+        }
+    }
+
+    if (bad_blocks) *bad_blocks = bad;
+    return bad == 0;
+}
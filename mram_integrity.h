@@ -0,0 +1,191 @@
+/**
+ * @file mram_integrity.h
+ * @brief CRC32C integrity layer for MRAM reads and writes
+ *
+ * Splits a protected data region into fixed-size blocks and keeps one
+ * CRC32C per block in a separate metadata region. Writes update the data and
+ * the affected checksums under a single write enable; reads fetch the data
+ * and the stored checksums in one vectored read and verify every touched
+ * block.
+ *
+ * The checksum uses the SSE4.2 CRC32 instruction on x86-64 and the ARMv8 CRC
+ * extension on AArch64 when the CPU supports them, and a slicing-by-8 table
+ * implementation otherwise. The batch API interleaves several blocks so the
+ * hardware instruction latency is hidden.
+ *
+ * @note Data and checksum frames are sent back to back but not atomically; a
+ *       write torn by power loss shows up as a checksum mismatch. Use
+ *       mram_txn when the update itself has to be atomic.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_INTEGRITY_H
+#define MRAM_INTERFACE_MRAM_INTEGRITY_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Smallest supported block size in bytes */
+#define MRAM_INTEGRITY_MIN_BLOCK_SIZE 16
+/** @brief Largest supported block size in bytes */
+#define MRAM_INTEGRITY_MAX_BLOCK_SIZE 4096
+/** @brief Size of one stored checksum in bytes */
+#define MRAM_INTEGRITY_CRC_SIZE 4
+/** @brief Maximum number of blocks handled per bus round trip */
+#define MRAM_INTEGRITY_CHUNK_BLOCKS 64
+/** @brief Scratch size used when formatting or scrubbing */
+#define MRAM_INTEGRITY_SCAN_SIZE 4096
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Integrity layer configuration
+ */
+struct mram_integrity_config {
+    /** @brief Start address of the protected data region (block aligned) */
+    uint32_t data_addr;
+    /** @brief Size of the protected data region (multiple of block_size) */
+    uint32_t data_size;
+    /** @brief Block size in bytes (power of two) */
+    uint32_t block_size;
+    /** @brief Start address of the checksum region (data_size / block_size * 4 bytes) */
+    uint32_t meta_addr;
+};
+
+/**
+ * @brief Integrity layer handle
+ */
+struct mram_integrity {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief Protected data region start */
+    uint32_t data_addr;
+    /** @brief Protected data region size */
+    uint32_t data_size;
+    /** @brief Block size in bytes */
+    uint32_t block_size;
+    /** @brief log2(block_size) */
+    uint8_t block_shift;
+    /** @brief Checksum region start */
+    uint32_t meta_addr;
+    /** @brief Scratch buffer for partial blocks and scans */
+    uint8_t* scratch;
+    /** @brief Scratch buffer size */
+    uint32_t scratch_size;
+    /** @brief Index of the last block that failed verification */
+    uint32_t last_bad_block;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compute or continue a CRC32C (Castagnoli) checksum
+ *
+ * @param crc Previous checksum, 0 to start a new one
+ * @param data Data to checksum
+ * @param len Number of bytes
+ * @return Updated checksum
+ */
+uint32_t mram_crc32c(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief Compute CRC32C checksums of many equally sized blocks in one pass
+ *
+ * @param data Start of count contiguous blocks
+ * @param block_size Size of each block in bytes
+ * @param count Number of blocks
+ * @param crcs Receives one checksum per block
+ */
+void mram_crc32c_batch(const void* data, size_t block_size, size_t count, uint32_t* crcs);
+
+/**
+ * @brief Check whether mram_crc32c() uses a hardware CRC instruction
+ *
+ * @return true if SSE4.2 or ARMv8 CRC instructions are in use
+ */
+bool mram_crc32c_hw_available(void);
+
+/**
+ * @brief Initialize an integrity layer handle
+ *
+ * @param ig Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param config Region configuration
+ * @return true if successful, false if parameters are invalid, regions
+ *         overlap or exceed the device, or allocation fails
+ */
+bool mram_integrity_init(struct mram_integrity* ig, struct mram* mram, const struct mram_integrity_config* config);
+
+/**
+ * @brief Release an integrity layer handle
+ *
+ * @param ig Pointer to the handle
+ */
+void mram_integrity_deinit(struct mram_integrity* ig);
+
+/**
+ * @brief Recompute and store the checksums of the whole data region
+ *
+ * Use once after the region was written without the integrity layer.
+ *
+ * @param ig Pointer to the handle
+ * @return true if successful, false if communication fails
+ */
+bool mram_integrity_format(struct mram_integrity* ig);
+
+/**
+ * @brief Read and verify data
+ *
+ * @param ig Pointer to the handle
+ * @param addr Start address inside the data region
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if parameters are invalid, communication
+ *         fails or a block fails verification (see last_bad_block)
+ */
+bool mram_integrity_read(struct mram_integrity* ig, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Write data and update the checksums of the touched blocks
+ *
+ * Partially covered blocks are read back and verified first so that an
+ * existing corruption is never covered by a fresh checksum.
+ *
+ * @param ig Pointer to the handle
+ * @param addr Start address inside the data region
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if successful, false if parameters are invalid, communication
+ *         fails or a partially covered block fails verification
+ */
+bool mram_integrity_write(struct mram_integrity* ig, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Verify every block of the data region
+ *
+ * @param ig Pointer to the handle
+ * @param bad_blocks Receives the number of blocks that failed (may be NULL)
+ * @return true if all blocks verified, false on mismatch or communication failure
+ */
+bool mram_integrity_scrub(struct mram_integrity* ig, uint32_t* bad_blocks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_INTEGRITY_H
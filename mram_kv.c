@@ -0,0 +1,786 @@
+#include "mram_kv.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Superblock layout: two alternating copies so a torn update never loses both
+#define KV_SB_MAGIC          0x31564B4Du  // "MKV1"
+#define KV_SB_VERSION        1
+#define KV_SB_SIZE           44
+#define KV_SB_SLOT           64
+#define KV_SB_AREA           (2 * KV_SB_SLOT)
+#define KV_STATE_DIRTY       0
+#define KV_STATE_CLEAN       1
+#define KV_STATE_COMPACTING  2
+
+// Staging slot layout, right after the superblock area
+#define KV_STAGING_MAGIC     0x53564B4Du  // "MKVS"
+#define KV_STAGING_OFFSET    KV_SB_AREA
+#define KV_STAGING_HEADER    16
+#define KV_MAX_RECORD        (MRAM_KV_RECORD_HEADER_SIZE + MRAM_KV_MAX_VALUE_LEN + MRAM_KV_MAX_KEY_LEN)
+
+// Record header: cap(2) key_len(1) flags(1) val_len(2) seq(4) check(4) reserved(1) magic(1)
+// The magic byte is last so that a torn header append never looks valid.
+#define KV_RECORD_MAGIC      0xA5
+#define KV_RECORD_LIVE       0x01
+#define KV_TERMINATOR_SIZE   MRAM_KV_RECORD_HEADER_SIZE
+
+// Index slot markers
+#define KV_SLOT_EMPTY        0u
+#define KV_SLOT_DELETED      1u
+
+#define KV_FNV_OFFSET        2166136261u
+#define KV_FNV_PRIME         16777619u
+
+static const uint8_t kv_zero[KV_TERMINATOR_SIZE] = { 0 };
+
+static void kv_put_u16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void kv_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint16_t kv_get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t kv_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t kv_fnv(uint32_t h, const void* data, size_t len) {
+    const uint8_t* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= KV_FNV_PRIME;
+    }
+    return h;
+}
+
+static uint32_t kv_record_size(uint16_t cap, uint8_t key_len) {
+    return MRAM_KV_RECORD_HEADER_SIZE + cap + key_len;
+}
+
+static uint32_t kv_entry_size(const struct mram_kv_entry* e) {
+    return kv_record_size(e->val_cap, e->key_len);
+}
+
+// Check covers geometry, length, sequence, value and key but not the flags,
+// so a delete (flags cleared) keeps the record walkable and verifiable.
+static uint32_t kv_record_check(const uint8_t* hdr, const void* value, uint16_t val_len,
+                                const void* key, uint8_t key_len) {
+    uint32_t h = kv_fnv(KV_FNV_OFFSET, hdr, 3);
+    h = kv_fnv(h, hdr + 4, 6);
+    h = kv_fnv(h, value, val_len);
+    return kv_fnv(h, key, key_len);
+}
+
+static void kv_build_header(uint8_t* hdr, uint16_t cap, uint8_t key_len, uint16_t val_len, uint32_t seq,
+                            const void* value, const void* key) {
+    kv_put_u16(hdr, cap);
+    hdr[2] = key_len;
+    hdr[3] = KV_RECORD_LIVE;
+    kv_put_u16(hdr + 4, val_len);
+    kv_put_u32(hdr + 6, seq);
+    kv_put_u32(hdr + 10, kv_record_check(hdr, value, val_len, key, key_len));
+    hdr[14] = 0;
+    hdr[15] = KV_RECORD_MAGIC;
+}
+
+// Validate a complete record image. Returns false for torn or foreign data.
+static bool kv_record_valid(const uint8_t* rec, uint32_t* seq_out) {
+    if (rec[15] != KV_RECORD_MAGIC) return false;
+    uint16_t cap = kv_get_u16(rec);
+    uint8_t key_len = rec[2];
+    uint16_t val_len = kv_get_u16(rec + 4);
+    if (key_len == 0 || key_len > MRAM_KV_MAX_KEY_LEN || cap > MRAM_KV_MAX_VALUE_LEN || val_len > cap)
+        return false;
+    const uint8_t* value = rec + MRAM_KV_RECORD_HEADER_SIZE;
+    if (kv_record_check(rec, value, val_len, value + cap, key_len) != kv_get_u32(rec + 10))
+        return false;
+    if (seq_out) *seq_out = kv_get_u32(rec + 6);
+    return true;
+}
+
+static bool kv_read(struct mram_kv* kv, uint32_t offset, void* buffer, size_t len) {
+    return mram_read(kv->mram, kv->base + offset, buffer, len);
+}
+
+static bool kv_write(struct mram_kv* kv, uint32_t offset, const void* data, size_t len) {
+    return mram_write(kv->mram, kv->base + offset, data, len);
+}
+
+static bool kv_layout(const struct mram_kv_config* config, uint32_t* snap_offset,
+                      uint32_t* log_start, uint32_t* log_limit) {
+    if (config == NULL || config->max_entries == 0 || config->size == 0) return false;
+    if (config->base > MRAM_MAX_ADDRESS || config->size > MRAM_SIZE_BYTES - config->base) return false;
+
+    uint64_t snap = KV_STAGING_OFFSET + KV_STAGING_HEADER + KV_MAX_RECORD;
+    uint64_t start = snap + (uint64_t)config->max_entries * MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+    // Room for at least one terminator at the start and one reserved at the end
+    if (start + 2 * KV_TERMINATOR_SIZE > config->size) return false;
+
+    *snap_offset = (uint32_t)snap;
+    *log_start = (uint32_t)start;
+    *log_limit = config->size - KV_TERMINATOR_SIZE;
+    return true;
+}
+
+/*******************************************************************************
+ * Superblock and snapshot
+ ******************************************************************************/
+
+static bool kv_write_superblock(struct mram_kv* kv, uint8_t state, uint32_t snap_check) {
+    uint8_t sb[KV_SB_SIZE];
+    kv_put_u32(sb, KV_SB_MAGIC);
+    sb[4] = KV_SB_VERSION;
+    sb[5] = state;
+    kv_put_u16(sb + 6, 0);
+    kv_put_u32(sb + 8, kv->size);
+    kv_put_u32(sb + 12, kv->max_entries);
+    kv_put_u32(sb + 16, kv->log_end);
+    kv_put_u32(sb + 20, kv->seq);
+    kv_put_u32(sb + 24, kv->count);
+    kv_put_u32(sb + 28, kv->dead_bytes);
+    kv_put_u32(sb + 32, snap_check);
+    kv_put_u32(sb + 36, kv->generation);
+    kv_put_u32(sb + 40, kv_fnv(KV_FNV_OFFSET, sb, 40));
+    if (!kv_write(kv, (kv->generation & 1) * KV_SB_SLOT, sb, sizeof(sb))) return false;
+    kv->generation++;
+    return true;
+}
+
+static bool kv_superblock_valid(const struct mram_kv* kv, const uint8_t* sb) {
+    return kv_get_u32(sb) == KV_SB_MAGIC && sb[4] == KV_SB_VERSION &&
+           kv_get_u32(sb + 40) == kv_fnv(KV_FNV_OFFSET, sb, 40) &&
+           kv_get_u32(sb + 8) == kv->size && kv_get_u32(sb + 12) == kv->max_entries;
+}
+
+// The first mutation after a clean open invalidates the persisted snapshot.
+static bool kv_mark_dirty(struct mram_kv* kv) {
+    if (kv->device_dirty) return true;
+    if (!kv_write_superblock(kv, KV_STATE_DIRTY, 0)) return false;
+    kv->device_dirty = true;
+    return true;
+}
+
+// Serialize all live index entries in scratch-sized chunks, then publish them
+// with a superblock carrying the snapshot check and the given state.
+static bool kv_write_snapshot(struct mram_kv* kv, uint8_t state) {
+    const uint32_t per_chunk = MRAM_KV_SCRATCH_SIZE / MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+    uint32_t check = KV_FNV_OFFSET;
+    uint32_t offset = kv->snap_offset;
+    uint32_t filled = 0;
+
+    for (uint32_t i = 0; i <= kv->slot_mask; i++) {
+        const struct mram_kv_entry* e = &kv->slots[i];
+        if (e->offset == KV_SLOT_EMPTY || e->offset == KV_SLOT_DELETED) continue;
+
+        uint8_t* p = kv->scratch + filled * MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+        kv_put_u32(p, e->hash);
+        kv_put_u32(p + 4, e->offset);
+        kv_put_u32(p + 8, e->seq);
+        kv_put_u16(p + 12, e->val_len);
+        kv_put_u16(p + 14, e->val_cap);
+        p[16] = e->key_len;
+        p[17] = p[18] = p[19] = 0;
+
+        if (++filled == per_chunk) {
+            uint32_t bytes = filled * MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+            check = kv_fnv(check, kv->scratch, bytes);
+            if (!kv_write(kv, offset, kv->scratch, bytes)) return false;
+            offset += bytes;
+            filled = 0;
+        }
+    }
+    if (filled > 0) {
+        uint32_t bytes = filled * MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+        check = kv_fnv(check, kv->scratch, bytes);
+        if (!kv_write(kv, offset, kv->scratch, bytes)) return false;
+    }
+
+    if (!kv_write_superblock(kv, state, check)) return false;
+    kv->device_dirty = (state != KV_STATE_CLEAN);
+    return true;
+}
+
+/*******************************************************************************
+ * Index
+ ******************************************************************************/
+
+static uint32_t kv_hash(const char* key, size_t key_len) {
+    return kv_fnv(KV_FNV_OFFSET, key, key_len);
+}
+
+// Compare a stored key against the given one. Only reached on a full hash
+// and length match, so the extra read is rare.
+static bool kv_key_matches(struct mram_kv* kv, const struct mram_kv_entry* e,
+                           const char* key, uint8_t key_len, bool* match) {
+    uint8_t stored[MRAM_KV_MAX_KEY_LEN];
+    if (!kv_read(kv, e->offset + MRAM_KV_RECORD_HEADER_SIZE + e->val_cap, stored, key_len)) return false;
+    *match = (memcmp(stored, key, key_len) == 0);
+    return true;
+}
+
+// Find the slot holding a key. Returns the slot index, -1 if absent or -2 on
+// a communication error.
+static int32_t kv_find(struct mram_kv* kv, const char* key, uint8_t key_len, uint32_t hash) {
+    for (uint32_t i = hash & kv->slot_mask, n = 0; n <= kv->slot_mask; i = (i + 1) & kv->slot_mask, n++) {
+        const struct mram_kv_entry* e = &kv->slots[i];
+        if (e->offset == KV_SLOT_EMPTY) return -1;
+        if (e->offset == KV_SLOT_DELETED || e->hash != hash || e->key_len != key_len) continue;
+
+        bool match;
+        if (!kv_key_matches(kv, e, key, key_len, &match)) return -2;
+        if (match) return (int32_t)i;
+    }
+    return -1;
+}
+
+static void kv_insert_slot(struct mram_kv* kv, const struct mram_kv_entry* entry) {
+    for (uint32_t i = entry->hash & kv->slot_mask;; i = (i + 1) & kv->slot_mask) {
+        struct mram_kv_entry* e = &kv->slots[i];
+        if (e->offset == KV_SLOT_EMPTY || e->offset == KV_SLOT_DELETED) {
+            if (e->offset == KV_SLOT_DELETED) kv->tombstones--;
+            *e = *entry;
+            return;
+        }
+    }
+}
+
+// Rebuild the table in place of the old one to purge deleted slots.
+static bool kv_rehash(struct mram_kv* kv) {
+    struct mram_kv_entry* old = kv->slots;
+    kv->slots = calloc(kv->slot_mask + 1, sizeof(*kv->slots));
+    if (kv->slots == NULL) {
+        kv->slots = old;
+        return false;
+    }
+    kv->tombstones = 0;
+    for (uint32_t i = 0; i <= kv->slot_mask; i++) {
+        if (old[i].offset != KV_SLOT_EMPTY && old[i].offset != KV_SLOT_DELETED)
+            kv_insert_slot(kv, &old[i]);
+    }
+    free(old);
+    return true;
+}
+
+static bool kv_load_snapshot(struct mram_kv* kv, uint32_t count, uint32_t expected_check) {
+    const uint32_t per_chunk = MRAM_KV_SCRATCH_SIZE / MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+    uint32_t check = KV_FNV_OFFSET;
+    uint32_t offset = kv->snap_offset;
+
+    if (count > kv->max_entries) return false;
+
+    for (uint32_t done = 0; done < count;) {
+        uint32_t n = (count - done < per_chunk) ? count - done : per_chunk;
+        uint32_t bytes = n * MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+        if (!kv_read(kv, offset, kv->scratch, bytes)) return false;
+        check = kv_fnv(check, kv->scratch, bytes);
+
+        for (uint32_t i = 0; i < n; i++) {
+            const uint8_t* p = kv->scratch + i * MRAM_KV_SNAPSHOT_ENTRY_SIZE;
+            struct mram_kv_entry e = {
+                .hash = kv_get_u32(p),
+                .offset = kv_get_u32(p + 4),
+                .seq = kv_get_u32(p + 8),
+                .val_len = kv_get_u16(p + 12),
+                .val_cap = kv_get_u16(p + 14),
+                .key_len = p[16],
+            };
+            kv_insert_slot(kv, &e);
+        }
+        offset += bytes;
+        done += n;
+    }
+
+    if (check != expected_check) return false;
+    kv->count = count;
+    return true;
+}
+
+/*******************************************************************************
+ * Log scan
+ ******************************************************************************/
+
+// Make [pos, pos + need) available in the scratch window.
+static bool kv_window(struct mram_kv* kv, uint32_t pos, uint32_t need, uint32_t* win_start, uint32_t* win_len) {
+    if (pos >= *win_start && pos + need <= *win_start + *win_len) return true;
+    uint32_t len = kv->size - pos;
+    if (len > MRAM_KV_SCRATCH_SIZE) len = MRAM_KV_SCRATCH_SIZE;
+    if (!kv_read(kv, pos, kv->scratch, len)) return false;
+    *win_start = pos;
+    *win_len = len;
+    return true;
+}
+
+// Rebuild the index by walking the whole log. Used after an unclean shutdown.
+static bool kv_scan(struct mram_kv* kv) {
+    uint32_t pos = kv->log_start;
+    uint32_t win_start = 0, win_len = 0;
+    uint32_t max_seq = 0;
+
+    // Entries a failed snapshot load left behind must not survive the scan
+    memset(kv->slots, 0, (kv->slot_mask + 1) * sizeof(*kv->slots));
+    kv->count = 0;
+    kv->tombstones = 0;
+    kv->dead_bytes = 0;
+
+    while (pos + MRAM_KV_RECORD_HEADER_SIZE <= kv->log_limit) {
+        if (!kv_window(kv, pos, MRAM_KV_RECORD_HEADER_SIZE, &win_start, &win_len)) return false;
+        const uint8_t* rec = kv->scratch + (pos - win_start);
+        if (rec[15] != KV_RECORD_MAGIC) break;
+
+        uint16_t cap = kv_get_u16(rec);
+        uint8_t key_len = rec[2];
+        if (key_len == 0 || key_len > MRAM_KV_MAX_KEY_LEN || cap > MRAM_KV_MAX_VALUE_LEN) break;
+        uint32_t size = kv_record_size(cap, key_len);
+        if (pos + size > kv->log_limit) break;
+
+        if (!kv_window(kv, pos, size, &win_start, &win_len)) return false;
+        rec = kv->scratch + (pos - win_start);
+
+        uint32_t seq;
+        bool valid = kv_record_valid(rec, &seq);
+        if (valid && seq > max_seq) max_seq = seq;
+        if (!valid || !(rec[3] & KV_RECORD_LIVE)) {
+            kv->dead_bytes += size;
+            pos += size;
+            continue;
+        }
+
+        const char* key = (const char*)rec + MRAM_KV_RECORD_HEADER_SIZE + cap;
+        struct mram_kv_entry entry = {
+            .hash = kv_hash(key, key_len),
+            .offset = pos,
+            .seq = seq,
+            .val_len = kv_get_u16(rec + 4),
+            .val_cap = cap,
+            .key_len = key_len,
+        };
+
+        // A crash between an append and the dead-marking of the previous
+        // version leaves two live copies; the higher sequence wins.
+        int32_t idx = kv_find(kv, key, key_len, entry.hash);
+        if (idx == -2) return false;
+        if (idx >= 0) {
+            struct mram_kv_entry* old = &kv->slots[idx];
+            if (old->seq < seq) {
+                kv->dead_bytes += kv_entry_size(old);
+                *old = entry;
+            } else {
+                kv->dead_bytes += size;
+            }
+        } else if (kv->count < kv->max_entries) {
+            kv_insert_slot(kv, &entry);
+            kv->count++;
+        } else {
+            kv->dead_bytes += size;
+        }
+        pos += size;
+    }
+
+    kv->log_end = pos;
+    kv->seq = max_seq + 1;
+    return true;
+}
+
+// Finish an in-place update cut short by power loss. The staging slot holds
+// the complete new record; it is written back only if it is newer than
+// every record in the log and its destination still holds a record of the
+// same key and geometry. Call after kv_scan(); sets replayed if the log
+// changed and needs another scan.
+static bool kv_replay_staged(struct mram_kv* kv, bool* replayed) {
+    uint8_t stage[KV_STAGING_HEADER];
+    uint8_t* rec = kv->scratch;
+    uint8_t* old = kv->scratch + KV_MAX_RECORD;
+
+    *replayed = false;
+    if (!kv_read(kv, KV_STAGING_OFFSET, stage, sizeof(stage))) return false;
+    if (kv_get_u32(stage) != KV_STAGING_MAGIC) return true;
+    uint32_t dest = kv_get_u32(stage + 4);
+    uint32_t size = kv_get_u32(stage + 8);
+    if (size < MRAM_KV_RECORD_HEADER_SIZE || size > KV_MAX_RECORD || dest < kv->log_start ||
+        dest > kv->log_limit || size > kv->log_limit - dest)
+        return true;
+
+    uint32_t seq;
+    if (!kv_read(kv, KV_STAGING_OFFSET + KV_STAGING_HEADER, rec, size)) return false;
+    if (!kv_record_valid(rec, &seq) || seq < kv->seq || kv_record_size(kv_get_u16(rec), rec[2]) != size) return true;
+
+    // Geometry and key are never changed by an in-place update
+    uint32_t key_at = MRAM_KV_RECORD_HEADER_SIZE + kv_get_u16(rec);
+    if (!kv_read(kv, dest, old, size)) return false;
+    if (memcmp(old, rec, 3) != 0 || memcmp(old + key_at, rec + key_at, rec[2]) != 0) return true;
+
+    if (!kv_write(kv, dest, rec, size)) return false;
+    if (!kv_write(kv, KV_STAGING_OFFSET, kv_zero, 4)) return false;
+    *replayed = true;
+    return true;
+}
+
+/*******************************************************************************
+ * Compaction
+ ******************************************************************************/
+
+struct kv_move {
+    uint32_t offset;
+    uint32_t slot;
+};
+
+static int kv_move_compare(const void* a, const void* b) {
+    uint32_t x = ((const struct kv_move*)a)->offset;
+    uint32_t y = ((const struct kv_move*)b)->offset;
+    return (x > y) - (x < y);
+}
+
+static bool kv_record_is(const uint8_t* rec, const struct mram_kv_entry* e) {
+    uint32_t seq;
+    return kv_record_valid(rec, &seq) && seq == e->seq &&
+           kv_get_u16(rec) == e->val_cap && rec[2] == e->key_len;
+}
+
+// Put a complete record image for dest into the staging slot, image first
+// and header second, so the slot is never armed with a partial image
+static bool kv_stage(struct mram_kv* kv, uint32_t dest, const uint8_t* rec, uint32_t size) {
+    uint8_t stage[KV_STAGING_HEADER];
+    kv_put_u32(stage, KV_STAGING_MAGIC);
+    kv_put_u32(stage + 4, dest);
+    kv_put_u32(stage + 8, size);
+    kv_put_u32(stage + 12, 0);
+    if (!kv_write(kv, KV_STAGING_OFFSET + KV_STAGING_HEADER, rec, size)) return false;
+    return kv_write(kv, KV_STAGING_OFFSET, stage, sizeof(stage));
+}
+
+// Move one record down to dest. Overlapping moves go through the staging
+// slot so that a crash never leaves the only copy half overwritten. When
+// recovering, moves that already landed are detected and skipped.
+static bool kv_move_record(struct mram_kv* kv, const struct mram_kv_entry* e, uint32_t dest, bool recovering) {
+    uint32_t size = kv_entry_size(e);
+    uint8_t* rec = kv->scratch;
+
+    if (recovering) {
+        uint8_t stage[KV_STAGING_HEADER];
+        if (!kv_read(kv, dest, rec, size)) return false;
+        if (kv_record_is(rec, e)) return true;
+
+        if (!kv_read(kv, KV_STAGING_OFFSET, stage, sizeof(stage))) return false;
+        if (kv_get_u32(stage) == KV_STAGING_MAGIC && kv_get_u32(stage + 4) == dest &&
+            kv_get_u32(stage + 8) == size) {
+            if (!kv_read(kv, KV_STAGING_OFFSET + KV_STAGING_HEADER, rec, size)) return false;
+            if (kv_record_is(rec, e)) {
+                if (!kv_write(kv, dest, rec, size)) return false;
+                return kv_write(kv, KV_STAGING_OFFSET, kv_zero, 4);
+            }
+        }
+    }
+
+    if (!kv_read(kv, e->offset, rec, size)) return false;
+
+    if (dest + size > e->offset) {
+        if (!kv_stage(kv, dest, rec, size)) return false;
+        if (!kv_write(kv, dest, rec, size)) return false;
+        return kv_write(kv, KV_STAGING_OFFSET, kv_zero, 4);
+    }
+    return kv_write(kv, dest, rec, size);
+}
+
+// Slide all live records to the start of the log in address order. The
+// pre-compaction index is persisted first with the COMPACTING state, which
+// makes the move plan reproducible if power is lost half way.
+static bool kv_compact(struct mram_kv* kv, bool recovering) {
+    struct kv_move* moves = NULL;
+    uint32_t n = 0;
+
+    if (kv->count > 0) {
+        moves = malloc(kv->count * sizeof(*moves));
+        if (moves == NULL) return false;
+    }
+    for (uint32_t i = 0; i <= kv->slot_mask; i++) {
+        uint32_t offset = kv->slots[i].offset;
+        if (offset == KV_SLOT_EMPTY || offset == KV_SLOT_DELETED) continue;
+        moves[n].offset = offset;
+        moves[n].slot = i;
+        n++;
+    }
+    if (n > 1) qsort(moves, n, sizeof(*moves), kv_move_compare);
+
+    // A staged in-place update left armed by a failed write is stale by now
+    // and must not be mistaken for a move of this compaction
+    if (!recovering && (!kv_write(kv, KV_STAGING_OFFSET, kv_zero, 4) || !kv_write_snapshot(kv, KV_STATE_COMPACTING))) {
+        free(moves);
+        return false;
+    }
+
+    uint32_t dest = kv->log_start;
+    for (uint32_t i = 0; i < n; i++) {
+        struct mram_kv_entry* e = &kv->slots[moves[i].slot];
+        if (e->offset != dest) {
+            if (!kv_move_record(kv, e, dest, recovering)) {
+                free(moves);
+                return false;
+            }
+            e->offset = dest;
+        }
+        dest += kv_entry_size(e);
+    }
+    free(moves);
+
+    if (!kv_write(kv, dest, kv_zero, KV_TERMINATOR_SIZE)) return false;
+    kv->log_end = dest;
+    kv->dead_bytes = 0;
+    return kv_write_snapshot(kv, KV_STATE_CLEAN);
+}
+
+static bool kv_maybe_compact(struct mram_kv* kv) {
+    uint32_t used = kv->log_end - kv->log_start;
+    if (kv->compact_percent >= 100 || kv->dead_bytes < MRAM_KV_SCRATCH_SIZE) return true;
+    if ((uint64_t)kv->dead_bytes * 100 < (uint64_t)used * kv->compact_percent) return true;
+    return kv_compact(kv, false);
+}
+
+/*******************************************************************************
+ * Public API
+ ******************************************************************************/
+
+bool mram_kv_format(struct mram* mram, const struct mram_kv_config* config) {
+    uint32_t snap_offset, log_start, log_limit;
+    if (mram == NULL || !kv_layout(config, &snap_offset, &log_start, &log_limit)) return false;
+
+    struct mram_kv kv = {
+        .mram = mram,
+        .base = config->base,
+        .size = config->size,
+        .max_entries = config->max_entries,
+        .log_start = log_start,
+        .log_end = log_start,
+        .seq = 1,
+    };
+
+    if (!kv_write(&kv, KV_STAGING_OFFSET, kv_zero, 4)) return false;
+    if (!kv_write(&kv, log_start, kv_zero, KV_TERMINATOR_SIZE)) return false;
+    // Write both superblock copies so no stale copy from an older store survives
+    if (!kv_write_superblock(&kv, KV_STATE_CLEAN, KV_FNV_OFFSET)) return false;
+    return kv_write_superblock(&kv, KV_STATE_CLEAN, KV_FNV_OFFSET);
+}
+
+bool mram_kv_open(struct mram_kv* kv, struct mram* mram, const struct mram_kv_config* config) {
+    if (kv == NULL || mram == NULL) return false;
+    memset(kv, 0, sizeof(*kv));
+    if (!kv_layout(config, &kv->snap_offset, &kv->log_start, &kv->log_limit)) return false;
+
+    kv->mram = mram;
+    kv->base = config->base;
+    kv->size = config->size;
+    kv->max_entries = config->max_entries;
+    kv->compact_percent = config->compact_percent ? config->compact_percent : MRAM_KV_DEFAULT_COMPACT_PERCENT;
+
+    uint8_t sbs[KV_SB_SLOT + KV_SB_SIZE];
+    if (!kv_read(kv, 0, sbs, sizeof(sbs))) return false;
+    const uint8_t* a = sbs;
+    const uint8_t* b = sbs + KV_SB_SLOT;
+    bool a_valid = kv_superblock_valid(kv, a);
+    bool b_valid = kv_superblock_valid(kv, b);
+    if (!a_valid && !b_valid) return false;
+    const uint8_t* sb = a;
+    if (!a_valid || (b_valid && (int32_t)(kv_get_u32(b + 36) - kv_get_u32(a + 36)) > 0))
+        sb = b;
+    kv->generation = kv_get_u32(sb + 36) + 1;
+
+    // Keep the index at most half full so probe chains stay short
+    uint32_t slots = 16;
+    while (slots < kv->max_entries * 2) slots <<= 1;
+    kv->slot_mask = slots - 1;
+    kv->slots = calloc(slots, sizeof(*kv->slots));
+    kv->scratch = malloc(MRAM_KV_SCRATCH_SIZE);
+    if (kv->slots == NULL || kv->scratch == NULL) {
+        mram_kv_close(kv);
+        return false;
+    }
+
+    uint8_t state = sb[5];
+    bool loaded = false;
+    if (state == KV_STATE_CLEAN || state == KV_STATE_COMPACTING) {
+        loaded = kv_load_snapshot(kv, kv_get_u32(sb + 24), kv_get_u32(sb + 32));
+        kv->log_end = kv_get_u32(sb + 16);
+        kv->seq = kv_get_u32(sb + 20);
+        kv->dead_bytes = kv_get_u32(sb + 28);
+    }
+
+    bool ok;
+    if (!loaded) {
+        bool replayed = false;
+        ok = kv_scan(kv) && kv_replay_staged(kv, &replayed) && (!replayed || kv_scan(kv));
+        kv->device_dirty = true;
+    } else if (state == KV_STATE_COMPACTING) {
+        ok = kv_compact(kv, true);
+    } else {
+        kv->device_dirty = false;
+        ok = true;
+    }
+
+    if (!ok) {
+        free(kv->slots);
+        free(kv->scratch);
+        kv->slots = NULL;
+        kv->scratch = NULL;
+    }
+    return ok;
+}
+
+bool mram_kv_sync(struct mram_kv* kv) {
+    if (kv == NULL || kv->slots == NULL) return false;
+    if (!kv->device_dirty) return true;
+    return kv_write_snapshot(kv, KV_STATE_CLEAN);
+}
+
+bool mram_kv_close(struct mram_kv* kv) {
+    if (kv == NULL) return false;
+    bool ok = (kv->slots != NULL && kv->scratch != NULL) ? mram_kv_sync(kv) : false;
+    free(kv->slots);
+    free(kv->scratch);
+    kv->slots = NULL;
+    kv->scratch = NULL;
+    return ok;
+}
+
+bool mram_kv_get(struct mram_kv* kv, const char* key, void* value, size_t value_size, size_t* value_len) {
+    if (kv == NULL || kv->slots == NULL || key == NULL || (value == NULL && value_size > 0)) return false;
+    size_t key_len = strlen(key);
+    if (key_len == 0 || key_len > MRAM_KV_MAX_KEY_LEN) return false;
+
+    uint32_t hash = kv_hash(key, key_len);
+    for (uint32_t i = hash & kv->slot_mask, n = 0; n <= kv->slot_mask; i = (i + 1) & kv->slot_mask, n++) {
+        const struct mram_kv_entry* e = &kv->slots[i];
+        if (e->offset == KV_SLOT_EMPTY) return false;
+        if (e->offset == KV_SLOT_DELETED || e->hash != hash || e->key_len != key_len) continue;
+
+        // Value and key are adjacent, so one read both verifies and fetches
+        if (!kv_read(kv, e->offset + MRAM_KV_RECORD_HEADER_SIZE, kv->scratch, e->val_cap + e->key_len))
+            return false;
+        if (memcmp(kv->scratch + e->val_cap, key, key_len) != 0) continue;
+
+        if (value_len) *value_len = e->val_len;
+        if (e->val_len > value_size) return false;
+        if (e->val_len > 0) memcpy(value, kv->scratch, e->val_len);
+        return true;
+    }
+    return false;
+}
+
+bool mram_kv_put(struct mram_kv* kv, const char* key, const void* value, size_t value_len) {
+    if (kv == NULL || kv->slots == NULL || key == NULL || (value == NULL && value_len > 0)) return false;
+    size_t key_len = strlen(key);
+    if (key_len == 0 || key_len > MRAM_KV_MAX_KEY_LEN || value_len > MRAM_KV_MAX_VALUE_LEN) return false;
+
+    uint32_t hash = kv_hash(key, key_len);
+    int32_t idx = kv_find(kv, key, (uint8_t)key_len, hash);
+    if (idx == -2) return false;
+
+    // In-place update: header and value are adjacent, so one write suffices.
+    // The whole new record is staged first, so that a torn write is finished
+    // on the next open instead of destroying the only copy of the key.
+    if (idx >= 0 && value_len <= kv->slots[idx].val_cap) {
+        struct mram_kv_entry* e = &kv->slots[idx];
+        uint8_t* rec = kv->scratch;
+        if (!kv_mark_dirty(kv)) return false;
+        uint32_t seq = kv->seq++;
+        kv_build_header(rec, e->val_cap, e->key_len, (uint16_t)value_len, seq, value, key);
+        if (value_len > 0) memcpy(rec + MRAM_KV_RECORD_HEADER_SIZE, value, value_len);
+        memset(rec + MRAM_KV_RECORD_HEADER_SIZE + value_len, 0, e->val_cap - value_len);
+        memcpy(rec + MRAM_KV_RECORD_HEADER_SIZE + e->val_cap, key, key_len);
+        if (!kv_stage(kv, e->offset, rec, kv_entry_size(e))) return false;
+        if (!kv_write(kv, e->offset, rec, MRAM_KV_RECORD_HEADER_SIZE + value_len)) return false;
+        if (!kv_write(kv, KV_STAGING_OFFSET, kv_zero, 4)) return false;
+        e->val_len = (uint16_t)value_len;
+        e->seq = seq;
+        return true;
+    }
+
+    if (idx < 0 && kv->count >= kv->max_entries) return false;
+
+    // Leave some slack so small growth stays in place
+    uint16_t cap = (uint16_t)((value_len + 15) & ~(size_t)15);
+    if (cap > MRAM_KV_MAX_VALUE_LEN) cap = MRAM_KV_MAX_VALUE_LEN;
+    uint32_t size = kv_record_size(cap, (uint8_t)key_len);
+
+    if (kv->log_end + size > kv->log_limit) {
+        if (kv->log_end - kv->dead_bytes + size > kv->log_limit) return false;
+        if (!kv_compact(kv, false)) return false;
+    }
+    if (!kv_mark_dirty(kv)) return false;
+
+    // Body and the next terminator first, header (magic last) second: a torn
+    // append leaves the previous terminator in place.
+    uint32_t offset = kv->log_end;
+    uint32_t seq = kv->seq++;
+    uint8_t* body = kv->scratch;
+    if (value_len > 0) memcpy(body, value, value_len);
+    memset(body + value_len, 0, cap - value_len);
+    memcpy(body + cap, key, key_len);
+    memset(body + cap + key_len, 0, KV_TERMINATOR_SIZE);
+    if (!kv_write(kv, offset + MRAM_KV_RECORD_HEADER_SIZE, body, cap + key_len + KV_TERMINATOR_SIZE))
+        return false;
+
+    uint8_t hdr[MRAM_KV_RECORD_HEADER_SIZE];
+    kv_build_header(hdr, cap, (uint8_t)key_len, (uint16_t)value_len, seq, value, key);
+    if (!kv_write(kv, offset, hdr, sizeof(hdr))) return false;
+    kv->log_end += size;
+
+    struct mram_kv_entry entry = {
+        .hash = hash,
+        .offset = offset,
+        .seq = seq,
+        .val_len = (uint16_t)value_len,
+        .val_cap = cap,
+        .key_len = (uint8_t)key_len,
+    };
+
+    if (idx >= 0) {
+        struct mram_kv_entry* old = &kv->slots[idx];
+        uint8_t dead = 0;
+        if (!kv_write(kv, old->offset + 3, &dead, 1)) return false;
+        kv->dead_bytes += kv_entry_size(old);
+        *old = entry;
+        return kv_maybe_compact(kv);
+    }
+
+    if (kv->count + kv->tombstones + 1 > (kv->slot_mask + 1) / 4 * 3 && !kv_rehash(kv)) return false;
+    kv_insert_slot(kv, &entry);
+    kv->count++;
+    return true;
+}
+
+bool mram_kv_delete(struct mram_kv* kv, const char* key) {
+    if (kv == NULL || kv->slots == NULL || key == NULL) return false;
+    size_t key_len = strlen(key);
+    if (key_len == 0 || key_len > MRAM_KV_MAX_KEY_LEN) return false;
+
+    int32_t idx = kv_find(kv, key, (uint8_t)key_len, kv_hash(key, key_len));
+    if (idx < 0) return false;
+    if (!kv_mark_dirty(kv)) return false;
+
+    struct mram_kv_entry* e = &kv->slots[idx];
+    uint8_t dead = 0;
+    if (!kv_write(kv, e->offset + 3, &dead, 1)) return false;
+    kv->dead_bytes += kv_entry_size(e);
+    e->offset = KV_SLOT_DELETED;
+    kv->count--;
+    kv->tombstones++;
+    return kv_maybe_compact(kv);
+}
+
+bool mram_kv_compact(struct mram_kv* kv) {
+    if (kv == NULL || kv->slots == NULL) return false;
+    return kv_compact(kv, false);
+}
+
+uint32_t mram_kv_count(const struct mram_kv* kv) {
+    if (kv == NULL) return 0;
+    return kv->count;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file mram_kv.h
+ * @brief Persistent key-value store on top of the MRAM interface
+ *
+ * Stores small keyed records in a region of the MRAM device. Records are
+ * appended to an on-device log and located through a RAM-resident
+ * open-addressing hash index, so a lookup costs a single mram_read().
+ * Updates that fit into the existing record are written in place; everything
+ * else is appended and the old record is marked dead. Dead space is reclaimed
+ * by compaction, either on demand or once the dead ratio crosses a threshold.
+ *
+ * A snapshot of the index is persisted on clean shutdown (mram_kv_sync() /
+ * mram_kv_close()) so that mram_kv_open() can rebuild the index with a bulk
+ * read instead of scanning the whole log.
+ *
+ * Region layout (offsets relative to the region base):
+ * Range                 | Content
+ * ----------------------|-----------------------------------------------
+ * 0 .. 127              | Two alternating superblocks (state, log end, checks)
+ * 128 .. staging end    | Staging slot for in-place updates and overlapping compaction moves
+ * snapshot              | Index snapshot, max_entries * 20 bytes
+ * log start .. limit    | Record log, terminated by a 16-byte zero header
+ *
+ * An in-place update stages the complete new record before overwriting the
+ * old one, so an update torn by power loss is finished on the next open and
+ * the key keeps its old or its new value.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_KV_H
+#define MRAM_INTERFACE_MRAM_KV_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Maximum key length in bytes (excluding the terminating NUL) */
+#define MRAM_KV_MAX_KEY_LEN 64
+/** @brief Maximum value length in bytes */
+#define MRAM_KV_MAX_VALUE_LEN 1024
+/** @brief Size of the on-device record header in bytes */
+#define MRAM_KV_RECORD_HEADER_SIZE 16
+/** @brief Size of one persisted index snapshot entry in bytes */
+#define MRAM_KV_SNAPSHOT_ENTRY_SIZE 20
+/** @brief Size of the RAM scratch buffer used for scans and snapshots */
+#define MRAM_KV_SCRATCH_SIZE 4096
+/** @brief Default dead-space percentage that triggers automatic compaction */
+#define MRAM_KV_DEFAULT_COMPACT_PERCENT 50
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Key-value store configuration
+ */
+struct mram_kv_config {
+    /** @brief First MRAM address of the store region */
+    uint32_t base;
+    /** @brief Size of the store region in bytes */
+    uint32_t size;
+    /** @brief Maximum number of live entries (sizes index and snapshot) */
+    uint32_t max_entries;
+    /** @brief Dead-space percentage of the used log that triggers compaction (0 = default, 100 = only when full) */
+    uint8_t compact_percent;
+};
+
+/**
+ * @brief RAM index slot
+ *
+ * Carries everything needed to fetch a record with one read.
+ */
+struct mram_kv_entry {
+    /** @brief Key hash */
+    uint32_t hash;
+    /** @brief Record offset relative to the region base (0 = empty, 1 = deleted) */
+    uint32_t offset;
+    /** @brief Record sequence number */
+    uint32_t seq;
+    /** @brief Current value length */
+    uint16_t val_len;
+    /** @brief Value capacity reserved in the record */
+    uint16_t val_cap;
+    /** @brief Key length */
+    uint8_t key_len;
+};
+
+/**
+ * @brief Key-value store handle
+ */
+struct mram_kv {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief Region base address */
+    uint32_t base;
+    /** @brief Region size in bytes */
+    uint32_t size;
+    /** @brief Maximum number of live entries */
+    uint32_t max_entries;
+    /** @brief Compaction threshold in percent */
+    uint8_t compact_percent;
+    /** @brief Snapshot area offset */
+    uint32_t snap_offset;
+    /** @brief First log byte offset */
+    uint32_t log_start;
+    /** @brief Log limit offset (exclusive, terminator space reserved) */
+    uint32_t log_limit;
+    /** @brief Current log end offset */
+    uint32_t log_end;
+    /** @brief Bytes occupied by dead records */
+    uint32_t dead_bytes;
+    /** @brief Next record sequence number */
+    uint32_t seq;
+    /** @brief Number of live entries */
+    uint32_t count;
+    /** @brief Number of deleted index slots */
+    uint32_t tombstones;
+    /** @brief Index slot array (power of two sized) */
+    struct mram_kv_entry* slots;
+    /** @brief Index slot mask (slot count - 1) */
+    uint32_t slot_mask;
+    /** @brief Generation of the next superblock write */
+    uint32_t generation;
+    /** @brief True once the on-device superblock has been marked dirty */
+    bool device_dirty;
+    /** @brief Scratch buffer of MRAM_KV_SCRATCH_SIZE bytes */
+    uint8_t* scratch;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Format a region as an empty key-value store
+ *
+ * @param mram Pointer to the MRAM interface structure
+ * @param config Store configuration
+ * @return true if successful, false if parameters are invalid, the region is
+ *         too small for the requested entry count, or communication fails
+ */
+bool mram_kv_format(struct mram* mram, const struct mram_kv_config* config);
+
+/**
+ * @brief Open a formatted key-value store
+ *
+ * Loads the index from the persisted snapshot when the store was closed
+ * cleanly, finishes an interrupted compaction, or falls back to a full log
+ * scan after an unclean shutdown.
+ *
+ * @param kv Pointer to the store handle to initialize
+ * @param mram Pointer to the MRAM interface structure
+ * @param config Store configuration (must match the one used to format)
+ * @return true if successful, false if the region is not formatted,
+ *         allocation fails or communication fails
+ */
+bool mram_kv_open(struct mram_kv* kv, struct mram* mram, const struct mram_kv_config* config);
+
+/**
+ * @brief Persist the index snapshot and mark the store clean
+ *
+ * @param kv Pointer to the store handle
+ * @return true if successful, false if kv is NULL or communication fails
+ */
+bool mram_kv_sync(struct mram_kv* kv);
+
+/**
+ * @brief Sync and release a key-value store handle
+ *
+ * @param kv Pointer to the store handle
+ * @return true if the final sync succeeded; resources are released either way
+ */
+bool mram_kv_close(struct mram_kv* kv);
+
+/**
+ * @brief Look up a value
+ *
+ * @param kv Pointer to the store handle
+ * @param key NUL-terminated key
+ * @param value Buffer receiving the value
+ * @param value_size Size of the value buffer
+ * @param value_len Receives the stored value length (may be NULL)
+ * @return true if found and copied, false if not found, the buffer is too
+ *         small or communication fails
+ */
+bool mram_kv_get(struct mram_kv* kv, const char* key, void* value, size_t value_size, size_t* value_len);
+
+/**
+ * @brief Insert or update a value
+ *
+ * @param kv Pointer to the store handle
+ * @param key NUL-terminated key (at most MRAM_KV_MAX_KEY_LEN bytes)
+ * @param value Value data
+ * @param value_len Value length (at most MRAM_KV_MAX_VALUE_LEN bytes)
+ * @return true if successful, false if parameters are invalid, the store is
+ *         full or communication fails
+ */
+bool mram_kv_put(struct mram_kv* kv, const char* key, const void* value, size_t value_len);
+
+/**
+ * @brief Delete a key
+ *
+ * @param kv Pointer to the store handle
+ * @param key NUL-terminated key
+ * @return true if the key existed and was deleted, false otherwise
+ */
+bool mram_kv_delete(struct mram_kv* kv, const char* key);
+
+/**
+ * @brief Compact the record log, reclaiming space held by dead records
+ *
+ * @param kv Pointer to the store handle
+ * @return true if successful, false if kv is NULL or communication fails
+ */
+bool mram_kv_compact(struct mram_kv* kv);
+
+/**
+ * @brief Get the number of live entries
+ *
+ * @param kv Pointer to the store handle
+ * @return Number of live entries, 0 if kv is NULL
+ */
+uint32_t mram_kv_count(const struct mram_kv* kv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_KV_H
@@ -0,0 +1,312 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include "mram_mirror.h"
+#include <string.h>
+#include <time.h>
+
+// Run one transfer on a replica and wait for it
+static bool mirror_job(struct mram_worker* worker, bool write, uint32_t addr, void* buf, size_t len) {
+    struct mram_iovec iov = { addr, buf, len };
+    struct mram_worker_batch batch;
+    struct mram_worker_job job = { .write = write, .iov = &iov, .count = 1, .batch = &batch };
+
+    mram_worker_batch_init(&batch, 1);
+    mram_worker_submit(worker, &job);
+    return mram_worker_batch_wait(&batch);
+}
+
+// Degrade a replica out and let the resync thread start probing it (lock held)
+static void mirror_fail(struct mram_mirror* mirror, uint32_t r) {
+    if (mirror->state[r] == MRAM_MIRROR_FAILED) return;
+    mirror->state[r] = MRAM_MIRROR_FAILED;
+    mirror->stats.failures++;
+    pthread_cond_signal(&mirror->cond);
+}
+
+// Collect replicas in the given state, starting at the round-robin cursor (lock held)
+static uint32_t mirror_collect(struct mram_mirror* mirror, uint8_t state, uint32_t* out) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < mirror->count; i++) {
+        uint32_t r = (mirror->next + i) % mirror->count;
+        if (mirror->state[r] == state) out[n++] = r;
+    }
+    return n;
+}
+
+// Copy the next chunk to a resyncing replica (lock held, released during I/O)
+static void mirror_resync_step(struct mram_mirror* mirror, uint32_t target, uint8_t* chunk) {
+    uint32_t active[MRAM_MIRROR_MAX_REPLICAS];
+    if (mirror_collect(mirror, MRAM_MIRROR_ACTIVE, active) == 0) {
+        // Nothing to copy from; the replica cannot become consistent
+        mirror->state[target] = MRAM_MIRROR_FAILED;
+        return;
+    }
+    uint32_t source = active[0];
+    uint32_t offset = mirror->resync_done[target];
+    uint32_t len = mirror->size - offset < MRAM_MIRROR_RESYNC_CHUNK ? mirror->size - offset : MRAM_MIRROR_RESYNC_CHUNK;
+
+    // Writes are held off while the chunk is in transit, or one landing
+    // between the read and the write-back would be lost on the target
+    mirror->copying = true;
+    while (mirror->writers != 0) pthread_cond_wait(&mirror->io_cond, &mirror->lock);
+    pthread_mutex_unlock(&mirror->lock);
+
+    uint32_t addr = mirror->base + offset;
+    bool src_ok = mirror_job(&mirror->workers[source], false, addr, chunk, len);
+    bool dst_ok = src_ok && mirror_job(&mirror->workers[target], true, addr, chunk, len);
+
+    pthread_mutex_lock(&mirror->lock);
+    mirror->copying = false;
+    pthread_cond_broadcast(&mirror->io_cond);
+    if (!src_ok) {
+        mirror_fail(mirror, source);
+    } else if (!dst_ok) {
+        mirror_fail(mirror, target);
+    } else if (mirror->state[target] == MRAM_MIRROR_RESYNCING && mirror->resync_done[target] == offset) {
+        mirror->resync_done[target] += len;
+        if (mirror->resync_done[target] == mirror->size) {
+            mirror->state[target] = MRAM_MIRROR_ACTIVE;
+            mirror->stats.resyncs++;
+        }
+    }
+}
+
+// Probe failed replicas and schedule a resync for those that answer (lock held,
+// released during I/O). Returns true if any replica came back.
+static bool mirror_probe(struct mram_mirror* mirror) {
+    uint32_t failed[MRAM_MIRROR_MAX_REPLICAS];
+    uint32_t n = mirror_collect(mirror, MRAM_MIRROR_FAILED, failed);
+    bool alive[MRAM_MIRROR_MAX_REPLICAS];
+    bool any = false;
+    uint8_t probe;
+
+    pthread_mutex_unlock(&mirror->lock);
+    for (uint32_t i = 0; i < n; i++) alive[i] = mirror_job(&mirror->workers[failed[i]], false, mirror->base, &probe, 1);
+    pthread_mutex_lock(&mirror->lock);
+
+    uint32_t active[MRAM_MIRROR_MAX_REPLICAS];
+    if (mirror_collect(mirror, MRAM_MIRROR_ACTIVE, active) == 0) return false;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!alive[i] || mirror->state[failed[i]] != MRAM_MIRROR_FAILED) continue;
+        mirror->state[failed[i]] = MRAM_MIRROR_RESYNCING;
+        mirror->resync_done[failed[i]] = 0;
+        any = true;
+    }
+    return any;
+}
+
+static void* mirror_thread(void* arg) {
+    struct mram_mirror* mirror = arg;
+    uint8_t chunk[MRAM_MIRROR_RESYNC_CHUNK];
+
+    pthread_mutex_lock(&mirror->lock);
+    while (!mirror->stop) {
+        uint32_t list[MRAM_MIRROR_MAX_REPLICAS];
+        if (mirror_collect(mirror, MRAM_MIRROR_RESYNCING, list) != 0) {
+            mirror_resync_step(mirror, list[0], chunk);
+            continue;
+        }
+        if (mirror_collect(mirror, MRAM_MIRROR_FAILED, list) == 0) {
+            pthread_cond_wait(&mirror->cond, &mirror->lock);
+            continue;
+        }
+        if (mirror_probe(mirror)) continue;
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += mirror->probe_ms / 1000;
+        deadline.tv_nsec += (long)(mirror->probe_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (!mirror->stop) pthread_cond_timedwait(&mirror->cond, &mirror->lock, &deadline);
+    }
+    pthread_mutex_unlock(&mirror->lock);
+    return NULL;
+}
+
+bool mram_mirror_init(struct mram_mirror* mirror, struct mram* const* devices, uint32_t count,
+                      const struct mram_mirror_config* config) {
+    if (mirror == NULL || devices == NULL || config == NULL) return false;
+    if (count == 0 || count > MRAM_MIRROR_MAX_REPLICAS || config->size == 0) return false;
+    if (config->base > MRAM_MAX_ADDRESS || config->size - 1 > MRAM_MAX_ADDRESS - config->base) return false;
+
+    memset(mirror, 0, sizeof(*mirror));
+    mirror->base = config->base;
+    mirror->size = config->size;
+    mirror->split = config->split_threshold ? config->split_threshold : MRAM_MIRROR_DEFAULT_SPLIT;
+    mirror->probe_ms = config->probe_ms ? config->probe_ms : MRAM_MIRROR_DEFAULT_PROBE_MS;
+
+    for (uint32_t r = 0; r < count; r++) {
+        int cpu = config->cpus ? config->cpus[r] : MRAM_WORKER_ANY_CPU;
+        if (devices[r] == NULL || !mram_worker_start(&mirror->workers[r], devices[r], cpu)) {
+            for (uint32_t i = 0; i < r; i++) mram_worker_stop(&mirror->workers[i]);
+            return false;
+        }
+        mirror->state[r] = MRAM_MIRROR_ACTIVE;
+    }
+    mirror->count = count;
+
+    pthread_mutex_init(&mirror->lock, NULL);
+    pthread_cond_init(&mirror->cond, NULL);
+    pthread_cond_init(&mirror->io_cond, NULL);
+    if (pthread_create(&mirror->thread, NULL, mirror_thread, mirror) != 0) {
+        pthread_cond_destroy(&mirror->io_cond);
+        pthread_cond_destroy(&mirror->cond);
+        pthread_mutex_destroy(&mirror->lock);
+        for (uint32_t r = 0; r < count; r++) mram_worker_stop(&mirror->workers[r]);
+        mirror->count = 0;
+        return false;
+    }
+    return true;
+}
+
+void mram_mirror_deinit(struct mram_mirror* mirror) {
+    if (mirror == NULL || mirror->count == 0) return;
+
+    pthread_mutex_lock(&mirror->lock);
+    mirror->stop = true;
+    pthread_cond_signal(&mirror->cond);
+    pthread_mutex_unlock(&mirror->lock);
+    pthread_join(mirror->thread, NULL);
+
+    for (uint32_t r = 0; r < mirror->count; r++) mram_worker_stop(&mirror->workers[r]);
+    pthread_cond_destroy(&mirror->io_cond);
+    pthread_cond_destroy(&mirror->cond);
+    pthread_mutex_destroy(&mirror->lock);
+    mirror->count = 0;
+}
+
+static bool mirror_range_valid(const struct mram_mirror* mirror, uint32_t addr, const void* buf, size_t len) {
+    return mirror != NULL && mirror->count != 0 && buf != NULL && len != 0 && addr < mirror->size &&
+           len <= mirror->size - addr;
+}
+
+bool mram_mirror_read(struct mram_mirror* mirror, uint32_t addr, void* buffer, size_t len) {
+    if (!mirror_range_valid(mirror, addr, buffer, len)) return false;
+
+    for (;;) {
+        uint32_t active[MRAM_MIRROR_MAX_REPLICAS];
+        pthread_mutex_lock(&mirror->lock);
+        uint32_t n = mirror_collect(mirror, MRAM_MIRROR_ACTIVE, active);
+        mirror->next = (mirror->next + 1) % mirror->count;
+        pthread_mutex_unlock(&mirror->lock);
+        if (n == 0) return false;
+
+        uint32_t pieces = 1;
+        if (len >= mirror->split) {
+            pieces = len < n ? (uint32_t)len : n;
+        } else {
+            // Shortest queue wins; ties go to the round-robin order
+            uint32_t best = 0;
+            uint32_t best_depth = UINT32_MAX;
+            for (uint32_t i = 0; i < n; i++) {
+                uint32_t depth = mram_worker_depth(&mirror->workers[active[i]]);
+                if (depth < best_depth) {
+                    best = i;
+                    best_depth = depth;
+                }
+            }
+            active[0] = active[best];
+        }
+
+        struct mram_iovec iov[MRAM_MIRROR_MAX_REPLICAS];
+        struct mram_worker_job jobs[MRAM_MIRROR_MAX_REPLICAS];
+        struct mram_worker_batch batch;
+        mram_worker_batch_init(&batch, pieces);
+        for (uint32_t i = 0; i < pieces; i++) {
+            size_t lo = len * i / pieces;
+            size_t hi = len * (i + 1) / pieces;
+            iov[i].addr = mirror->base + addr + (uint32_t)lo;
+            iov[i].buf = (uint8_t*)buffer + lo;
+            iov[i].len = hi - lo;
+            jobs[i].write = false;
+            jobs[i].iov = &iov[i];
+            jobs[i].count = 1;
+            jobs[i].batch = &batch;
+            mram_worker_submit(&mirror->workers[active[i]], &jobs[i]);
+        }
+        bool ok = mram_worker_batch_wait(&batch);
+
+        pthread_mutex_lock(&mirror->lock);
+        for (uint32_t i = 0; i < pieces; i++) {
+            if (jobs[i].result) {
+                mirror->stats.reads[active[i]]++;
+            } else {
+                mirror_fail(mirror, active[i]);
+            }
+        }
+        pthread_mutex_unlock(&mirror->lock);
+        if (ok) return true;
+        // Retry on the replicas that are left
+    }
+}
+
+bool mram_mirror_write(struct mram_mirror* mirror, uint32_t addr, const void* data, size_t len) {
+    if (!mirror_range_valid(mirror, addr, data, len)) return false;
+
+    uint32_t targets[MRAM_MIRROR_MAX_REPLICAS];
+    uint32_t n = 0;
+    struct mram_iovec iov = { mirror->base + addr, (void*)data, len };
+    struct mram_worker_job jobs[MRAM_MIRROR_MAX_REPLICAS];
+    struct mram_worker_batch batch;
+
+    pthread_mutex_lock(&mirror->lock);
+    while (mirror->copying) pthread_cond_wait(&mirror->io_cond, &mirror->lock);
+    mirror->writers++;
+    // Replicas being resynced get the write too, so copied chunks stay current
+    for (uint32_t r = 0; r < mirror->count; r++) {
+        if (mirror->state[r] != MRAM_MIRROR_FAILED) targets[n++] = r;
+    }
+    // Queue on every replica before the next write can, so the FIFO workers
+    // apply overlapping concurrent writes in the same order everywhere
+    mram_worker_batch_init(&batch, n);
+    for (uint32_t i = 0; i < n; i++) {
+        jobs[i].write = true;
+        jobs[i].iov = &iov;
+        jobs[i].count = 1;
+        jobs[i].batch = &batch;
+        mram_worker_submit(&mirror->workers[targets[i]], &jobs[i]);
+    }
+    pthread_mutex_unlock(&mirror->lock);
+    mram_worker_batch_wait(&batch);
+
+    bool ok = false;
+    pthread_mutex_lock(&mirror->lock);
+    for (uint32_t i = 0; i < n; i++) {
+        if (!jobs[i].result) {
+            mirror_fail(mirror, targets[i]);
+        } else if (mirror->state[targets[i]] == MRAM_MIRROR_ACTIVE) {
+            ok = true;
+        }
+    }
+    if (--mirror->writers == 0) pthread_cond_broadcast(&mirror->io_cond);
+    pthread_mutex_unlock(&mirror->lock);
+    return ok;
+}
+
+bool mram_mirror_resync(struct mram_mirror* mirror, uint32_t replica) {
+    if (mirror == NULL || replica >= mirror->count) return false;
+
+    pthread_mutex_lock(&mirror->lock);
+    bool other = false;
+    for (uint32_t r = 0; r < mirror->count; r++) {
+        if (r != replica && mirror->state[r] == MRAM_MIRROR_ACTIVE) other = true;
+    }
+    if (other) {
+        mirror->state[replica] = MRAM_MIRROR_RESYNCING;
+        mirror->resync_done[replica] = 0;
+        pthread_cond_signal(&mirror->cond);
+    }
+    pthread_mutex_unlock(&mirror->lock);
+    return other;
+}
+
+enum mram_mirror_state mram_mirror_replica_state(struct mram_mirror* mirror, uint32_t replica) {
+    if (mirror == NULL || replica >= mirror->count) return MRAM_MIRROR_FAILED;
+
+    pthread_mutex_lock(&mirror->lock);
+    enum mram_mirror_state state = mirror->state[replica];
+    pthread_mutex_unlock(&mirror->lock);
+    return state;
+}
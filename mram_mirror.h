@@ -0,0 +1,205 @@
+/**
+ * @file mram_mirror.h
+ * @brief Mirrored volume with read load balancing across replicas
+ *
+ * Keeps identical copies of a range on N devices, each on its own bus.
+ * Writes go to every replica in parallel through per-bus worker threads.
+ * A write is queued on all replicas before the next one is, so concurrent
+ * overlapping writes land in the same order on every replica.
+ * A read goes to the replica with the shortest queue. A read of at least
+ * split_threshold bytes is instead cut into one piece per healthy replica,
+ * and the pieces are read in parallel.
+ *
+ * A replica whose transfer fails is degraded out and stops serving reads.
+ * A background thread probes it periodically. Once it answers again, the
+ * thread copies the range over from a healthy replica chunk by chunk while
+ * the volume stays online; the replica keeps receiving new writes during
+ * the copy. When the copy is complete the replica rejoins the read set.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_MIRROR_H
+#define MRAM_INTERFACE_MRAM_MIRROR_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram_worker.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Maximum number of replicas */
+#define MRAM_MIRROR_MAX_REPLICAS 8
+/** @brief Default size from which reads are split across replicas */
+#define MRAM_MIRROR_DEFAULT_SPLIT 4096
+/** @brief Default interval between probes of a failed replica */
+#define MRAM_MIRROR_DEFAULT_PROBE_MS 100
+/** @brief Bytes copied per resync step */
+#define MRAM_MIRROR_RESYNC_CHUNK 4096
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Replica state
+ */
+enum mram_mirror_state {
+    /** @brief In sync, serves reads and writes */
+    MRAM_MIRROR_ACTIVE,
+    /** @brief Being copied from a healthy replica, receives writes only */
+    MRAM_MIRROR_RESYNCING,
+    /** @brief Degraded out, probed periodically */
+    MRAM_MIRROR_FAILED,
+};
+
+/**
+ * @brief Mirrored volume configuration
+ */
+struct mram_mirror_config {
+    /** @brief First address of the range on every device */
+    uint32_t base;
+    /** @brief Size of the range */
+    uint32_t size;
+    /** @brief Reads of at least this many bytes are split (0 = MRAM_MIRROR_DEFAULT_SPLIT) */
+    uint32_t split_threshold;
+    /** @brief Interval between probes of failed replicas (0 = MRAM_MIRROR_DEFAULT_PROBE_MS) */
+    uint32_t probe_ms;
+    /** @brief CPU for each replica's worker thread, or NULL for no affinity */
+    const int* cpus;
+};
+
+/**
+ * @brief Mirrored volume statistics
+ */
+struct mram_mirror_stats {
+    /** @brief Read jobs served by each replica */
+    uint64_t reads[MRAM_MIRROR_MAX_REPLICAS];
+    /** @brief Replica failures detected */
+    uint64_t failures;
+    /** @brief Resyncs completed */
+    uint64_t resyncs;
+};
+
+/**
+ * @brief Mirrored volume handle
+ */
+struct mram_mirror {
+    /** @brief One worker per replica */
+    struct mram_worker workers[MRAM_MIRROR_MAX_REPLICAS];
+    /** @brief Replica states (enum mram_mirror_state) */
+    uint8_t state[MRAM_MIRROR_MAX_REPLICAS];
+    /** @brief Bytes already copied to each resyncing replica */
+    uint32_t resync_done[MRAM_MIRROR_MAX_REPLICAS];
+    /** @brief Number of replicas */
+    uint32_t count;
+    /** @brief First device address */
+    uint32_t base;
+    /** @brief Range size */
+    uint32_t size;
+    /** @brief Split threshold */
+    uint32_t split;
+    /** @brief Probe interval */
+    uint32_t probe_ms;
+    /** @brief Round-robin start for ties between equally loaded replicas */
+    uint32_t next;
+    /** @brief Protects state, resync_done, next, writers, copying and stats */
+    pthread_mutex_t lock;
+    /** @brief Wakes the resync thread */
+    pthread_cond_t cond;
+    /** @brief Signalled when the last write leaves or a resync chunk copy ends */
+    pthread_cond_t io_cond;
+    /** @brief Writes in flight */
+    uint32_t writers;
+    /** @brief Set while a resync chunk is copied; new writes wait for it */
+    bool copying;
+    /** @brief Set to stop the resync thread */
+    bool stop;
+    /** @brief Resync thread */
+    pthread_t thread;
+    /** @brief Statistics */
+    struct mram_mirror_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a mirrored volume and start its threads
+ *
+ * All replicas are assumed to be in sync; call mram_mirror_resync() for any
+ * that is not.
+ *
+ * @param mirror Pointer to the handle to initialize
+ * @param devices Initialized MRAM devices, owned by the volume until deinit
+ * @param count Number of replicas (1..MRAM_MIRROR_MAX_REPLICAS)
+ * @param config Volume configuration
+ * @return true if successful, false if parameters are invalid or a thread
+ *         cannot be started
+ */
+bool mram_mirror_init(struct mram_mirror* mirror, struct mram* const* devices, uint32_t count,
+                      const struct mram_mirror_config* config);
+
+/**
+ * @brief Stop all threads (an unfinished resync leaves its replica out of sync)
+ *
+ * @param mirror Pointer to the handle
+ */
+void mram_mirror_deinit(struct mram_mirror* mirror);
+
+/**
+ * @brief Read from the volume
+ *
+ * @param mirror Pointer to the handle
+ * @param addr Volume address
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid or no active
+ *         replica could serve the read
+ */
+bool mram_mirror_read(struct mram_mirror* mirror, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Write to every replica
+ *
+ * @param mirror Pointer to the handle
+ * @param addr Volume address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if at least one active replica stored the data, false if
+ *         the range is invalid or every active replica failed
+ */
+bool mram_mirror_write(struct mram_mirror* mirror, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Force a full background resync of a replica, e.g. after it was replaced
+ *
+ * @param mirror Pointer to the handle
+ * @param replica Replica index
+ * @return true if the resync was scheduled, false if the index is invalid or
+ *         no other replica is active
+ */
+bool mram_mirror_resync(struct mram_mirror* mirror, uint32_t replica);
+
+/**
+ * @brief Get the state of a replica
+ *
+ * @param mirror Pointer to the handle
+ * @param replica Replica index
+ * @return Replica state, MRAM_MIRROR_FAILED if the index is invalid
+ */
+enum mram_mirror_state mram_mirror_replica_state(struct mram_mirror* mirror, uint32_t replica);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_MIRROR_H
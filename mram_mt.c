@@ -0,0 +1,280 @@
+#include "mram_mt.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    MT_OP_READ,
+    MT_OP_WRITE,
+    MT_OP_READ_VECTOR,
+    MT_OP_WRITE_VECTOR,
+    MT_OP_READ_STATUS,
+    MT_OP_WRITE_STATUS,
+    MT_OP_SLEEP,
+    MT_OP_WAKE,
+};
+
+// Upper bound on drain passes per session, so a drainer whose own request is
+// done cannot be kept busy forever by other producers
+#define MT_MAX_PASSES 8
+// Busy-wait iterations before a waiter starts yielding its time slice
+#define MT_SPIN_LIMIT 128
+
+static void mt_relax(unsigned spins) {
+    if (spins < MT_SPIN_LIMIT) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ volatile("yield");
+#endif
+    } else {
+        sched_yield();
+    }
+}
+
+// Bounded MPSC enqueue: claim a position with one CAS, then publish the slot
+static bool mt_push(struct mram_mt* mt, struct mram_mt_request* req) {
+    size_t pos = atomic_load_explicit(&mt->tail, memory_order_relaxed);
+    struct mram_mt_slot* slot;
+
+    for (;;) {
+        slot = &mt->ring[pos & mt->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mt->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // Full
+        } else {
+            pos = atomic_load_explicit(&mt->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->req = req;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+// Pop every published request into the batch array (drainer only)
+static size_t mt_pop(struct mram_mt* mt) {
+    size_t n = 0;
+
+    while (n <= mt->mask) {
+        struct mram_mt_slot* slot = &mt->ring[mt->head & mt->mask];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != mt->head + 1) break;
+        mt->batch[n++] = slot->req;
+        atomic_store_explicit(&slot->seq, mt->head + mt->mask + 1, memory_order_release);
+        mt->head++;
+    }
+    return n;
+}
+
+static void mt_complete(struct mram_mt_request* req, bool result) {
+    req->result = result;
+    atomic_store_explicit(&req->done, true, memory_order_release);
+}
+
+static bool mt_execute_one(struct mram* mram, struct mram_mt_request* req) {
+    switch (req->op) {
+        case MT_OP_READ_VECTOR:
+            return mram_read_vector(mram, req->iov, req->count);
+        case MT_OP_WRITE_VECTOR:
+            return mram_write_vector(mram, req->iov, req->count);
+        case MT_OP_READ_STATUS:
+            return mram_read_status_register(mram, &req->status);
+        case MT_OP_WRITE_STATUS:
+            return mram_write_status_register(mram, req->status);
+        case MT_OP_SLEEP:
+            return mram_sleep(mram);
+        case MT_OP_WAKE:
+            return mram_wake(mram);
+        default:
+            return false;
+    }
+}
+
+// Earlier read of the run [from, to) that covers req and goes to the bus itself
+static struct mram_mt_request* mt_find_leader(struct mram_mt* mt, size_t from, size_t to,
+                                              const struct mram_mt_request* req) {
+    for (size_t m = from; m < to; m++) {
+        struct mram_mt_request* r = mt->batch[m];
+        if (r->leader == NULL && req->addr >= r->addr && req->addr + req->len <= r->addr + r->len) return r;
+    }
+    return NULL;
+}
+
+static void mt_execute(struct mram_mt* mt, size_t n) {
+    size_t i = 0;
+
+    while (i < n) {
+        struct mram_mt_request* req = mt->batch[i];
+        if (req->op != MT_OP_READ && req->op != MT_OP_WRITE) {
+            mt_complete(req, mt_execute_one(mt->mram, req));
+            mt->stats.bus_calls++;
+            mt->stats.requests++;
+            i++;
+            continue;
+        }
+
+        // A run of plain reads or writes becomes one vector transfer; writes
+        // keep queue order so the later of two overlapping writes wins
+        size_t j = i;
+        size_t k = 0;
+        for (; j < n && mt->batch[j]->op == req->op; j++) {
+            struct mram_mt_request* r = mt->batch[j];
+            r->leader = r->op == MT_OP_READ ? mt_find_leader(mt, i, j, r) : NULL;
+            if (r->leader) continue;
+            mt->iov[k].addr = r->addr;
+            mt->iov[k].buf = r->buf;
+            mt->iov[k].len = r->len;
+            k++;
+        }
+        bool ok = req->op == MT_OP_READ ? mram_read_vector(mt->mram, mt->iov, k)
+                                        : mram_write_vector(mt->mram, mt->iov, k);
+        mt->stats.bus_calls++;
+        mt->stats.requests += j - i;
+
+        // Fill attached reads before any completion, a completed leader's
+        // buffer may go away as soon as its thread returns
+        for (size_t m = i; m < j; m++) {
+            struct mram_mt_request* r = mt->batch[m];
+            if (r->leader == NULL || !ok) continue;
+            memcpy(r->buf, (const uint8_t*)r->leader->buf + (r->addr - r->leader->addr), r->len);
+            mt->stats.reads_saved++;
+            mt->stats.bytes_saved += r->len;
+        }
+        for (; i < j; i++) mt_complete(mt->batch[i], ok);
+    }
+}
+
+// Take the drainer role if it is free and run queued requests on this thread
+static bool mt_try_drain(struct mram_mt* mt) {
+    if (atomic_load_explicit(&mt->draining, memory_order_relaxed) ||
+        atomic_exchange_explicit(&mt->draining, true, memory_order_acquire)) {
+        return false;
+    }
+
+    mt->stats.drains++;
+    for (int pass = 0; pass < MT_MAX_PASSES; pass++) {
+        size_t n = mt_pop(mt);
+        if (n == 0) break;
+        mt_execute(mt, n);
+    }
+
+    atomic_store_explicit(&mt->draining, false, memory_order_release);
+    return true;
+}
+
+static bool mt_submit(struct mram_mt* mt, struct mram_mt_request* req) {
+    atomic_init(&req->done, false);
+
+    unsigned spins = 0;
+    while (!mt_push(mt, req)) {
+        if (!mt_try_drain(mt)) mt_relax(spins++);
+    }
+
+    // Whoever is waiting drains; a request published just after the previous
+    // drainer finished is picked up by its own submitter at the latest
+    spins = 0;
+    while (!atomic_load_explicit(&req->done, memory_order_acquire)) {
+        if (!mt_try_drain(mt)) mt_relax(spins++);
+    }
+    return req->result;
+}
+
+static bool mt_range_valid(uint32_t addr, const void* buf, size_t len) {
+    return buf != NULL && len != 0 && addr <= MRAM_MAX_ADDRESS && len - 1 <= (size_t)(MRAM_MAX_ADDRESS - addr);
+}
+
+static bool mt_iovec_valid(const struct mram_iovec* iov, size_t count) {
+    if (iov == NULL || count == 0) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (!mt_range_valid(iov[i].addr, iov[i].buf, iov[i].len)) return false;
+    }
+    return true;
+}
+
+bool mram_mt_init(struct mram_mt* mt, struct mram* mram, size_t capacity) {
+    if (mt == NULL || mram == NULL) return false;
+    if (capacity == 0) capacity = MRAM_MT_DEFAULT_CAPACITY;
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) return false;
+
+    memset(mt, 0, sizeof(*mt));
+    mt->mram = mram;
+    mt->mask = capacity - 1;
+    mt->ring = malloc(capacity * sizeof(*mt->ring));
+    mt->batch = malloc(capacity * sizeof(*mt->batch));
+    mt->iov = malloc(capacity * sizeof(*mt->iov));
+    if (mt->ring == NULL || mt->batch == NULL || mt->iov == NULL) {
+        mram_mt_deinit(mt);
+        return false;
+    }
+
+    for (size_t i = 0; i < capacity; i++) atomic_init(&mt->ring[i].seq, i);
+    atomic_init(&mt->tail, 0);
+    atomic_init(&mt->draining, false);
+    return true;
+}
+
+void mram_mt_deinit(struct mram_mt* mt) {
+    if (mt == NULL) return;
+    free(mt->ring);
+    free(mt->batch);
+    free(mt->iov);
+    mt->ring = NULL;
+    mt->batch = NULL;
+    mt->iov = NULL;
+}
+
+bool mram_mt_read(struct mram_mt* mt, uint32_t addr, uint8_t* buffer, size_t len) {
+    if (mt == NULL || mt->ring == NULL || !mt_range_valid(addr, buffer, len)) return false;
+    struct mram_mt_request req = { .op = MT_OP_READ, .addr = addr, .buf = buffer, .len = len };
+    return mt_submit(mt, &req);
+}
+
+bool mram_mt_write(struct mram_mt* mt, uint32_t addr, const uint8_t* data, size_t len) {
+    if (mt == NULL || mt->ring == NULL || !mt_range_valid(addr, data, len)) return false;
+    struct mram_mt_request req = { .op = MT_OP_WRITE, .addr = addr, .buf = (void*)data, .len = len };
+    return mt_submit(mt, &req);
+}
+
+bool mram_mt_read_vector(struct mram_mt* mt, const struct mram_iovec* iov, size_t count) {
+    if (mt == NULL || mt->ring == NULL || !mt_iovec_valid(iov, count)) return false;
+    struct mram_mt_request req = { .op = MT_OP_READ_VECTOR, .iov = iov, .count = count };
+    return mt_submit(mt, &req);
+}
+
+bool mram_mt_write_vector(struct mram_mt* mt, const struct mram_iovec* iov, size_t count) {
+    if (mt == NULL || mt->ring == NULL || !mt_iovec_valid(iov, count)) return false;
+    struct mram_mt_request req = { .op = MT_OP_WRITE_VECTOR, .iov = iov, .count = count };
+    return mt_submit(mt, &req);
+}
+
+bool mram_mt_read_status_register(struct mram_mt* mt, uint8_t* status) {
+    if (mt == NULL || mt->ring == NULL || status == NULL) return false;
+    struct mram_mt_request req = { .op = MT_OP_READ_STATUS };
+    if (!mt_submit(mt, &req)) return false;
+    *status = req.status;
+    return true;
+}
+
+bool mram_mt_write_status_register(struct mram_mt* mt, uint8_t status) {
+    if (mt == NULL || mt->ring == NULL) return false;
+    struct mram_mt_request req = { .op = MT_OP_WRITE_STATUS, .status = status };
+    return mt_submit(mt, &req);
+}
+
+bool mram_mt_sleep(struct mram_mt* mt) {
+    if (mt == NULL || mt->ring == NULL) return false;
+    struct mram_mt_request req = { .op = MT_OP_SLEEP };
+    return mt_submit(mt, &req);
+}
+
+bool mram_mt_wake(struct mram_mt* mt) {
+    if (mt == NULL || mt->ring == NULL) return false;
+    struct mram_mt_request req = { .op = MT_OP_WAKE };
+    return mt_submit(mt, &req);
+}
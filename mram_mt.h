@@ -0,0 +1,237 @@
+/**
+ * @file mram_mt.h
+ * @brief Thread-safe MRAM handle built on a lock-free submission queue
+ *
+ * Any number of threads may call the mram_mt_* functions concurrently. Each
+ * call places a request descriptor in a bounded multi-producer ring (one CAS
+ * on the tail, no lock) and waits for its completion. The bus is driven by
+ * a single drainer at a time: whichever waiting submitter wins an atomic
+ * exchange on the drainer flag executes everything queued, including the
+ * requests of other threads, and then hands the role back. Uncontended
+ * calls therefore run on the caller's thread with no context switch. Under
+ * contention, runs of queued reads or writes are issued as one vector
+ * transfer.
+ *
+ * Reads are single-flight: a queued read whose range lies inside another
+ * read of the same run attaches to it and is served by copying from that
+ * read's buffer once the bus transfer completes. Threads polling the same
+ * hot control block therefore share one bus read.
+ *
+ * @note The wrapped struct mram must only be used through this handle while
+ *       the handle is in use
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_MT_H
+#define MRAM_INTERFACE_MRAM_MT_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#ifdef __cplusplus
+#include <atomic>
+using std::atomic_bool;
+using std::atomic_size_t;
+#else
+#include <stdatomic.h>
+#endif
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default submission ring capacity */
+#define MRAM_MT_DEFAULT_CAPACITY 64
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Request descriptor, owned by the submitting thread while in flight
+ */
+struct mram_mt_request {
+    /** @brief Operation code */
+    uint8_t op;
+    /** @brief Status register value for status operations */
+    uint8_t status;
+    /** @brief Device address */
+    uint32_t addr;
+    /** @brief Data buffer */
+    void* buf;
+    /** @brief Data length */
+    size_t len;
+    /** @brief Segments for vector operations */
+    const struct mram_iovec* iov;
+    /** @brief Segment count for vector operations */
+    size_t count;
+    /** @brief Result of the operation */
+    bool result;
+    /** @brief Read this request attached to instead of using the bus (drainer only) */
+    struct mram_mt_request* leader;
+    /** @brief Set by the drainer once the request has completed */
+    atomic_bool done;
+};
+
+/**
+ * @brief Submission ring slot
+ */
+struct mram_mt_slot {
+    /** @brief Sequence number that tells producers and the drainer whose turn it is */
+    atomic_size_t seq;
+    /** @brief Published request */
+    struct mram_mt_request* req;
+};
+
+/**
+ * @brief Drainer statistics
+ *
+ * Updated only by the active drainer; read them once all threads are idle.
+ */
+struct mram_mt_stats {
+    /** @brief Requests completed */
+    uint64_t requests;
+    /** @brief Drainer sessions */
+    uint64_t drains;
+    /** @brief Calls into the underlying driver */
+    uint64_t bus_calls;
+    /** @brief Reads served from another in-flight read instead of the bus */
+    uint64_t reads_saved;
+    /** @brief Bytes those reads did not transfer */
+    uint64_t bytes_saved;
+};
+
+/**
+ * @brief Thread-safe MRAM handle
+ */
+struct mram_mt {
+    /** @brief Wrapped MRAM device */
+    struct mram* mram;
+    /** @brief Submission ring */
+    struct mram_mt_slot* ring;
+    /** @brief Ring capacity minus one (capacity is a power of two) */
+    size_t mask;
+    /** @brief Next position producers claim */
+    atomic_size_t tail;
+    /** @brief Next position the drainer consumes (drainer only) */
+    size_t head;
+    /** @brief Set while a thread holds the drainer role */
+    atomic_bool draining;
+    /** @brief Requests popped in the current drain pass (drainer only) */
+    struct mram_mt_request** batch;
+    /** @brief Segments for merged transfers (drainer only) */
+    struct mram_iovec* iov;
+    /** @brief Statistics */
+    struct mram_mt_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a thread-safe handle
+ *
+ * @param mt Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param capacity Ring capacity, a power of two (0 = MRAM_MT_DEFAULT_CAPACITY)
+ * @return true if successful, false if parameters are invalid or allocation fails
+ */
+bool mram_mt_init(struct mram_mt* mt, struct mram* mram, size_t capacity);
+
+/**
+ * @brief Release a thread-safe handle (no calls may be in flight)
+ *
+ * @param mt Pointer to the handle
+ */
+void mram_mt_deinit(struct mram_mt* mt);
+
+/**
+ * @brief Thread-safe mram_read()
+ *
+ * @param mt Pointer to the handle
+ * @param addr Starting address
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return Same as mram_read()
+ */
+bool mram_mt_read(struct mram_mt* mt, uint32_t addr, uint8_t* buffer, size_t len);
+
+/**
+ * @brief Thread-safe mram_write()
+ *
+ * @param mt Pointer to the handle
+ * @param addr Starting address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return Same as mram_write()
+ *
+ * @note A write merged with other queued writes fails together with them
+ */
+bool mram_mt_write(struct mram_mt* mt, uint32_t addr, const uint8_t* data, size_t len);
+
+/**
+ * @brief Thread-safe mram_read_vector()
+ *
+ * @param mt Pointer to the handle
+ * @param iov Array of segments
+ * @param count Number of segments
+ * @return Same as mram_read_vector()
+ */
+bool mram_mt_read_vector(struct mram_mt* mt, const struct mram_iovec* iov, size_t count);
+
+/**
+ * @brief Thread-safe mram_write_vector()
+ *
+ * @param mt Pointer to the handle
+ * @param iov Array of segments
+ * @param count Number of segments
+ * @return Same as mram_write_vector()
+ */
+bool mram_mt_write_vector(struct mram_mt* mt, const struct mram_iovec* iov, size_t count);
+
+/**
+ * @brief Thread-safe mram_read_status_register()
+ *
+ * @param mt Pointer to the handle
+ * @param status Pointer to store the status register value
+ * @return Same as mram_read_status_register()
+ */
+bool mram_mt_read_status_register(struct mram_mt* mt, uint8_t* status);
+
+/**
+ * @brief Thread-safe mram_write_status_register()
+ *
+ * @param mt Pointer to the handle
+ * @param status Value to write
+ * @return Same as mram_write_status_register()
+ */
+bool mram_mt_write_status_register(struct mram_mt* mt, uint8_t status);
+
+/**
+ * @brief Thread-safe mram_sleep()
+ *
+ * @param mt Pointer to the handle
+ * @return Same as mram_sleep()
+ */
+bool mram_mt_sleep(struct mram_mt* mt);
+
+/**
+ * @brief Thread-safe mram_wake()
+ *
+ * @param mt Pointer to the handle
+ * @return Same as mram_wake()
+ */
+bool mram_mt_wake(struct mram_mt* mt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_MT_H
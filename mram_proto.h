@@ -0,0 +1,136 @@
+/**
+ * @file mram_proto.h
+ * @brief Binary protocol between mramd and its clients
+ *
+ * Clients talk to mramd over a Unix-domain stream socket. Every request is
+ * a fixed 16-byte header, optionally followed by segment descriptors and
+ * inline payload. Every response is a 12-byte header followed by len bytes
+ * of read data. A client may send any number of requests before reading
+ * responses (pipelining). The server executes the requests of one
+ * connection in order and answers in the same order, echoing the request
+ * id.
+ *
+ * Request layout per operation:
+ *
+ * Op                | Header fields  | Follows the header
+ * ------------------|----------------|--------------------------------------
+ * READ              | addr, len      | -
+ * WRITE             | addr, len      | len data bytes
+ * READ_VECTOR       | count, len     | count segments
+ * WRITE_VECTOR      | count, len     | count segments, then len data bytes
+ * READ_STATUS       | -              | -
+ * WRITE_STATUS      | arg            | -
+ * SLEEP / WAKE      | -              | -
+ * ATTACH_SHM        | len            | - (memory fd passed via SCM_RIGHTS)
+ * SHM_READ_VECTOR   | count          | count segments
+ * SHM_WRITE_VECTOR  | count          | count segments
+ *
+ * For the inline vector operations, len is the sum of the segment lengths,
+ * and the data of all segments is concatenated in segment order. The SHM
+ * variants move data between the device and the shared memory attached
+ * with ATTACH_SHM, at each segment's offset, so bulk payloads never pass
+ * through the socket. The memory passed with ATTACH_SHM must be at least
+ * len bytes long and sealed against shrinking (F_SEAL_SHRINK), so the
+ * client cannot truncate it under the server. A successful READ or
+ * READ_VECTOR response carries the data; every other response has len 0.
+ * READ_STATUS returns the register in the status field.
+ *
+ * All integers are in host byte order; both ends run on the same machine.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_PROTO_H
+#define MRAM_INTERFACE_MRAM_PROTO_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default socket path of mramd */
+#define MRAM_PROTO_DEFAULT_PATH "/tmp/mramd.sock"
+/** @brief Maximum segments per vector request */
+#define MRAM_PROTO_MAX_SEGMENTS 256
+/** @brief Maximum data bytes per request */
+#define MRAM_PROTO_MAX_PAYLOAD MRAM_SIZE_BYTES
+
+/** @brief Request completed */
+#define MRAM_PROTO_OK 0
+/** @brief Device communication failed */
+#define MRAM_PROTO_ERR_IO 1
+/** @brief Invalid range, segment or missing shared memory */
+#define MRAM_PROTO_ERR_INVAL 2
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Request operation codes
+ */
+enum mram_proto_op {
+    MRAM_PROTO_READ = 1,
+    MRAM_PROTO_WRITE,
+    MRAM_PROTO_READ_VECTOR,
+    MRAM_PROTO_WRITE_VECTOR,
+    MRAM_PROTO_READ_STATUS,
+    MRAM_PROTO_WRITE_STATUS,
+    MRAM_PROTO_SLEEP,
+    MRAM_PROTO_WAKE,
+    MRAM_PROTO_ATTACH_SHM,
+    MRAM_PROTO_SHM_READ_VECTOR,
+    MRAM_PROTO_SHM_WRITE_VECTOR,
+};
+
+/**
+ * @brief Request header
+ */
+struct mram_proto_request {
+    /** @brief Caller-chosen id, echoed in the response */
+    uint32_t id;
+    /** @brief Operation (enum mram_proto_op) */
+    uint8_t op;
+    /** @brief Status register value for WRITE_STATUS */
+    uint8_t arg;
+    /** @brief Number of segments for vector operations */
+    uint16_t count;
+    /** @brief Device address for READ and WRITE */
+    uint32_t addr;
+    /** @brief Data length, see the table above */
+    uint32_t len;
+};
+
+/**
+ * @brief Segment descriptor of a vector request
+ */
+struct mram_proto_segment {
+    /** @brief Device address */
+    uint32_t addr;
+    /** @brief Length in bytes */
+    uint32_t len;
+    /** @brief Offset into the shared memory (SHM operations only) */
+    uint32_t offset;
+};
+
+/**
+ * @brief Response header
+ */
+struct mram_proto_response {
+    /** @brief Id of the request */
+    uint32_t id;
+    /** @brief MRAM_PROTO_OK or an error code */
+    uint8_t result;
+    /** @brief Status register value for READ_STATUS */
+    uint8_t status;
+    /** @brief Reserved, zero */
+    uint16_t reserved;
+    /** @brief Bytes of read data that follow */
+    uint32_t len;
+};
+
+#endif //MRAM_INTERFACE_MRAM_PROTO_H
@@ -0,0 +1,416 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, pthread_condattr_setclock
+#include "mram_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct mram_sched_cluster {
+    // Device range covered by the cluster
+    uint32_t lo;
+    uint32_t hi;
+    // Members as a range of the sorted array
+    size_t first;
+    size_t last;
+    // Bounce buffer when members overlap, NULL for a single member
+    uint8_t* copy;
+};
+
+static uint64_t sched_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint32_t sched_end(const struct mram_sched_request* req) {
+    return req->addr + (uint32_t)req->len;
+}
+
+static bool sched_overlap(const struct mram_sched_request* a, const struct mram_sched_request* b) {
+    return a->addr < sched_end(b) && b->addr < sched_end(a);
+}
+
+// Minimum level distance from earlier to later: 1 if later must be issued
+// after earlier completes, 0 if it may share earlier's level but not precede
+// it (overlapping writes, merged in submission order), -1 if unordered
+static int sched_order(const struct mram_sched_request* earlier, const struct mram_sched_request* later) {
+    for (size_t d = 0; d < MRAM_SCHED_MAX_DEPS; d++) {
+        if (later->deps[d] == earlier) return 1;
+    }
+    if (!sched_overlap(earlier, later)) return -1;
+    if (earlier->op != later->op) return 1;
+    return earlier->op == MRAM_SCHED_WRITE ? 0 : -1;
+}
+
+static int sched_compare_addr(const void* a, const void* b) {
+    const struct mram_sched_request* ra = *(const struct mram_sched_request* const*)a;
+    const struct mram_sched_request* rb = *(const struct mram_sched_request* const*)b;
+    if (ra->addr != rb->addr) return ra->addr < rb->addr ? -1 : 1;
+    return ra->seq < rb->seq ? -1 : ra->seq > rb->seq;
+}
+
+static int sched_compare_seq(const void* a, const void* b) {
+    const struct mram_sched_request* ra = *(const struct mram_sched_request* const*)a;
+    const struct mram_sched_request* rb = *(const struct mram_sched_request* const*)b;
+    return ra->seq < rb->seq ? -1 : ra->seq > rb->seq;
+}
+
+// Build clusters of transitively overlapping requests from an address-sorted
+// run. Overlapping writes are combined in submission order, so the request
+// submitted last wins; returns false if a bounce buffer cannot be allocated.
+static bool sched_cluster(struct mram_sched* sched, struct mram_sched_request** reqs, size_t n, size_t* count) {
+    size_t c = 0;
+
+    for (size_t i = 0; i < n;) {
+        struct mram_sched_cluster* cl = &sched->clusters[c++];
+        cl->lo = reqs[i]->addr;
+        cl->hi = sched_end(reqs[i]);
+        cl->first = i;
+        cl->copy = NULL;
+        for (i++; i < n && reqs[i]->addr < cl->hi; i++) {
+            if (sched_end(reqs[i]) > cl->hi) cl->hi = sched_end(reqs[i]);
+        }
+        cl->last = i;
+
+        if (cl->last - cl->first > 1) {
+            cl->copy = malloc(cl->hi - cl->lo);
+            if (cl->copy == NULL) {
+                *count = c;
+                return false;
+            }
+            if (reqs[cl->first]->op == MRAM_SCHED_WRITE) {
+                qsort(&reqs[cl->first], cl->last - cl->first, sizeof(*reqs), sched_compare_seq);
+                for (size_t k = cl->first; k < cl->last; k++) {
+                    memcpy(cl->copy + (reqs[k]->addr - cl->lo), reqs[k]->buf, reqs[k]->len);
+                }
+            }
+        }
+    }
+    *count = c;
+    return true;
+}
+
+// Issue clusters [first, last) as one vector call and record the results
+static void sched_issue(struct mram_sched* sched, struct mram_sched_request** reqs, size_t first, size_t last,
+                        uint8_t op) {
+    size_t n = 0;
+    for (size_t c = first; c < last; c++) {
+        struct mram_sched_cluster* cl = &sched->clusters[c];
+        sched->iov[n].addr = cl->lo;
+        sched->iov[n].buf = cl->copy ? (void*)cl->copy : reqs[cl->first]->buf;
+        sched->iov[n].len = cl->hi - cl->lo;
+        n++;
+    }
+
+    bool ok = op == MRAM_SCHED_READ ? mram_read_vector(sched->mram, sched->iov, n)
+                                    : mram_write_vector(sched->mram, sched->iov, n);
+    sched->stats.bus_calls++;
+
+    for (size_t c = first; c < last; c++) {
+        struct mram_sched_cluster* cl = &sched->clusters[c];
+        for (size_t k = cl->first; k < cl->last; k++) {
+            reqs[k]->result = ok;
+            if (ok && cl->copy && op == MRAM_SCHED_READ) {
+                memcpy(reqs[k]->buf, cl->copy + (reqs[k]->addr - cl->lo), reqs[k]->len);
+            }
+        }
+    }
+}
+
+// Last resort when a bounce buffer cannot be allocated: one call per request
+static void sched_run_unmerged(struct mram_sched* sched, struct mram_sched_request** reqs, size_t n) {
+    qsort(reqs, n, sizeof(*reqs), sched_compare_seq);
+    for (size_t i = 0; i < n; i++) {
+        struct mram_iovec iov = { reqs[i]->addr, reqs[i]->buf, reqs[i]->len };
+        reqs[i]->result = reqs[i]->op == MRAM_SCHED_READ ? mram_read_vector(sched->mram, &iov, 1)
+                                                         : mram_write_vector(sched->mram, &iov, 1);
+        sched->stats.bus_calls++;
+        sched->stats.frames++;
+    }
+}
+
+// Execute requests of one direction that are free of hazards among each other
+static void sched_run(struct mram_sched* sched, struct mram_sched_request** reqs, size_t n) {
+    if (n == 0) return;
+    qsort(reqs, n, sizeof(*reqs), sched_compare_addr);
+
+    size_t count;
+    bool ok = sched_cluster(sched, reqs, n, &count);
+    if (!ok) {
+        for (size_t c = 0; c < count; c++) free(sched->clusters[c].copy);
+        sched_run_unmerged(sched, reqs, n);
+        return;
+    }
+
+    // Adjacent clusters share a frame up to max_merge bytes. The driver joins
+    // every adjacent pair inside one call, so a frame that hits the limit
+    // next to its neighbour ends the call instead.
+    uint8_t op = reqs[0]->op;
+    size_t call_first = 0;
+    uint32_t frame_lo = 0;
+    for (size_t c = 0; c < count; c++) {
+        struct mram_sched_cluster* cl = &sched->clusters[c];
+        if (c != 0 && cl->lo == sched->clusters[c - 1].hi) {
+            if (cl->hi - frame_lo <= sched->max_merge) continue;
+            sched_issue(sched, reqs, call_first, c, op);
+            call_first = c;
+        }
+        frame_lo = cl->lo;
+        sched->stats.frames++;
+    }
+    sched_issue(sched, reqs, call_first, count, op);
+
+    for (size_t c = 0; c < count; c++) free(sched->clusters[c].copy);
+}
+
+// Whether a request must fail without being issued: one of its
+// dependencies failed, or it was submitted behind a fence after a failed
+// request and before that failure was reported
+static bool sched_blocked(const struct mram_sched* sched, const struct mram_sched_request* req) {
+    if (req->epoch > sched->failed_epoch && req->seq < sched->failed_before) return true;
+    for (size_t d = 0; d < MRAM_SCHED_MAX_DEPS; d++) {
+        if (req->deps[d] && !req->deps[d]->result) return true;
+    }
+    return false;
+}
+
+// Dispatch one dependency level of a fence epoch: reads first, then writes
+static void sched_level(struct mram_sched* sched, struct mram_sched_request** reqs, const uint32_t* levels,
+                        size_t n, uint32_t level) {
+    size_t reads = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (levels[i] != level) continue;
+        if (sched_blocked(sched, reqs[i])) {
+            reqs[i]->result = false;
+        } else if (reqs[i]->op == MRAM_SCHED_READ) {
+            sched->sorted[reads++] = reqs[i];
+        }
+    }
+    size_t writes = reads;
+    for (size_t i = 0; i < n; i++) {
+        if (levels[i] == level && reqs[i]->op == MRAM_SCHED_WRITE && !sched_blocked(sched, reqs[i])) {
+            sched->sorted[writes++] = reqs[i];
+        }
+    }
+
+    sched_run(sched, sched->sorted, reads);
+    sched_run(sched, sched->sorted + reads, writes - reads);
+}
+
+// Place every request of a fence epoch at the lowest level its ordering
+// constraints allow, then issue the levels in turn
+static void sched_epoch(struct mram_sched* sched, struct mram_sched_request** reqs, uint32_t* levels, size_t n) {
+    uint32_t top = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        levels[i] = 0;
+        for (size_t e = 0; e < i; e++) {
+            int gap = sched_order(reqs[e], reqs[i]);
+            if (gap >= 0 && levels[e] + (uint32_t)gap > levels[i]) levels[i] = levels[e] + (uint32_t)gap;
+        }
+        if (levels[i] > top) top = levels[i];
+    }
+
+    for (uint32_t level = 0; level <= top; level++) sched_level(sched, reqs, levels, n, level);
+}
+
+static void sched_dispatch(struct mram_sched* sched, size_t n) {
+    struct mram_sched_request** batch = sched->batch;
+    bool failed = false;
+    sched->stats.batches++;
+
+    for (size_t start = 0; start < n;) {
+        size_t end = start + 1;
+        while (end < n && batch[end]->epoch == batch[start]->epoch) end++;
+        sched_epoch(sched, &batch[start], &sched->levels[start], end - start);
+        // A failure holds back everything behind a fence, in this batch
+        // and in any later one, until it has been reported
+        for (size_t i = start; i < end && !failed; i++) {
+            if (!batch[i]->result) {
+                sched->failed_epoch = batch[i]->epoch;
+                sched->failed_before = UINT64_MAX;
+                failed = true;
+            }
+        }
+        start = end;
+    }
+
+    // Requests submitted from now on may see the failure, e.g. a retry
+    if (failed) {
+        pthread_mutex_lock(&sched->lock);
+        sched->failed_before = sched->seq;
+        pthread_mutex_unlock(&sched->lock);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        sched->stats.requests++;
+        if (batch[i]->callback) batch[i]->callback(batch[i], batch[i]->ctx);
+    }
+}
+
+static void* sched_thread(void* arg) {
+    struct mram_sched* sched = arg;
+
+    pthread_mutex_lock(&sched->lock);
+    for (;;) {
+        while (sched->head == NULL && !sched->stop) pthread_cond_wait(&sched->cond, &sched->lock);
+        if (sched->head == NULL) break;
+
+        // Hold the window open for more requests to merge with
+        while (!sched->stop && sched->queued < sched->max_batch) {
+            uint64_t now = sched_now_us();
+            if (now >= sched->deadline_us) break;
+            struct timespec ts = { (time_t)(sched->deadline_us / 1000000u),
+                                   (long)(sched->deadline_us % 1000000u) * 1000 };
+            pthread_cond_timedwait(&sched->cond, &sched->lock, &ts);
+        }
+
+        size_t n = 0;
+        while (sched->head && n < sched->max_batch) {
+            sched->batch[n++] = sched->head;
+            sched->head = sched->head->next;
+        }
+        if (sched->head == NULL) sched->tail = NULL;
+        sched->queued -= (uint32_t)n;
+        // Leftovers have waited a full window already
+        sched->deadline_us = 0;
+        pthread_mutex_unlock(&sched->lock);
+
+        sched_dispatch(sched, n);
+
+        pthread_mutex_lock(&sched->lock);
+    }
+    pthread_mutex_unlock(&sched->lock);
+    return NULL;
+}
+
+bool mram_sched_init(struct mram_sched* sched, struct mram* mram, const struct mram_sched_config* config) {
+    if (sched == NULL || mram == NULL) return false;
+
+    memset(sched, 0, sizeof(*sched));
+    sched->mram = mram;
+    sched->max_delay_us = config && config->max_delay_us ? config->max_delay_us : MRAM_SCHED_DEFAULT_DELAY_US;
+    sched->max_merge = config && config->max_merge ? config->max_merge : MRAM_SCHED_DEFAULT_MAX_MERGE;
+    sched->max_batch = config && config->max_batch ? config->max_batch : MRAM_SCHED_DEFAULT_MAX_BATCH;
+
+    sched->batch = malloc(sched->max_batch * sizeof(*sched->batch));
+    sched->sorted = malloc(sched->max_batch * sizeof(*sched->sorted));
+    sched->levels = malloc(sched->max_batch * sizeof(*sched->levels));
+    sched->clusters = malloc(sched->max_batch * sizeof(*sched->clusters));
+    sched->iov = malloc(sched->max_batch * sizeof(*sched->iov));
+    if (sched->batch == NULL || sched->sorted == NULL || sched->levels == NULL ||
+        sched->clusters == NULL || sched->iov == NULL) {
+        free(sched->batch);
+        free(sched->sorted);
+        free(sched->levels);
+        free(sched->clusters);
+        free(sched->iov);
+        return false;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&sched->lock, NULL);
+    pthread_cond_init(&sched->cond, &attr);
+    pthread_cond_init(&sched->done_cond, NULL);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&sched->thread, NULL, sched_thread, sched) != 0) {
+        pthread_cond_destroy(&sched->done_cond);
+        pthread_cond_destroy(&sched->cond);
+        pthread_mutex_destroy(&sched->lock);
+        free(sched->batch);
+        free(sched->sorted);
+        free(sched->levels);
+        free(sched->clusters);
+        free(sched->iov);
+        sched->batch = NULL;
+        return false;
+    }
+    return true;
+}
+
+void mram_sched_deinit(struct mram_sched* sched) {
+    if (sched == NULL || sched->batch == NULL) return;
+
+    pthread_mutex_lock(&sched->lock);
+    sched->stop = true;
+    pthread_cond_signal(&sched->cond);
+    pthread_mutex_unlock(&sched->lock);
+    pthread_join(sched->thread, NULL);
+
+    pthread_cond_destroy(&sched->done_cond);
+    pthread_cond_destroy(&sched->cond);
+    pthread_mutex_destroy(&sched->lock);
+    free(sched->batch);
+    free(sched->sorted);
+    free(sched->levels);
+    free(sched->clusters);
+    free(sched->iov);
+    sched->batch = NULL;
+}
+
+bool mram_sched_submit(struct mram_sched* sched, struct mram_sched_request* req) {
+    if (sched == NULL || sched->batch == NULL || req == NULL || req->buf == NULL || req->len == 0) return false;
+    if (req->op != MRAM_SCHED_READ && req->op != MRAM_SCHED_WRITE) return false;
+    if (req->addr > MRAM_MAX_ADDRESS || req->len - 1 > (size_t)(MRAM_MAX_ADDRESS - req->addr)) return false;
+
+    req->next = NULL;
+    req->done = false;
+    req->result = false;
+
+    pthread_mutex_lock(&sched->lock);
+    req->seq = sched->seq++;
+    req->epoch = sched->epoch;
+    if (sched->tail) {
+        sched->tail->next = req;
+    } else {
+        sched->head = req;
+        sched->deadline_us = sched_now_us() + sched->max_delay_us;
+    }
+    sched->tail = req;
+    sched->queued++;
+    // Wake the thread to open the window, and again when the batch is full
+    if (sched->queued == 1 || sched->queued == sched->max_batch) pthread_cond_signal(&sched->cond);
+    pthread_mutex_unlock(&sched->lock);
+    return true;
+}
+
+bool mram_sched_fence(struct mram_sched* sched) {
+    if (sched == NULL || sched->batch == NULL) return false;
+
+    pthread_mutex_lock(&sched->lock);
+    sched->epoch++;
+    pthread_mutex_unlock(&sched->lock);
+    return true;
+}
+
+static void sched_wake(struct mram_sched_request* req, void* ctx) {
+    struct mram_sched* sched = ctx;
+
+    pthread_mutex_lock(&sched->lock);
+    req->done = true;
+    pthread_cond_broadcast(&sched->done_cond);
+    pthread_mutex_unlock(&sched->lock);
+}
+
+static bool sched_wait(struct mram_sched* sched, struct mram_sched_request* req) {
+    req->callback = sched_wake;
+    req->ctx = sched;
+    if (!mram_sched_submit(sched, req)) return false;
+
+    pthread_mutex_lock(&sched->lock);
+    while (!req->done) pthread_cond_wait(&sched->done_cond, &sched->lock);
+    pthread_mutex_unlock(&sched->lock);
+    return req->result;
+}
+
+bool mram_sched_read(struct mram_sched* sched, uint32_t addr, void* buffer, size_t len) {
+    struct mram_sched_request req = { .op = MRAM_SCHED_READ, .addr = addr, .buf = buffer, .len = len };
+    return sched_wait(sched, &req);
+}
+
+bool mram_sched_write(struct mram_sched* sched, uint32_t addr, const void* data, size_t len) {
+    struct mram_sched_request req = { .op = MRAM_SCHED_WRITE, .addr = addr, .buf = (void*)data, .len = len };
+    return sched_wait(sched, &req);
+}
@@ -0,0 +1,261 @@
+/**
+ * @file mram_sched.h
+ * @brief Request scheduler that merges queued operations before they reach the bus
+ *
+ * Producers queue reads and writes; a scheduler thread collects them for a
+ * short batching window and then issues the batch with as few frames as
+ * possible. Requests are sorted by address, contiguous requests share one
+ * READ or WRITE frame, overlapping writes are combined so the most recently
+ * submitted data wins, overlapping reads are served from one transfer, and
+ * all writes of a batch share one WREN. Results are delivered back to each
+ * original request.
+ *
+ * Reordering never changes what a request observes: a request that
+ * overlaps an earlier queued request of the other direction is issued after
+ * it, so a read always sees exactly the writes submitted before it.
+ *
+ * Ordering on the device can be constrained further for crash consistency:
+ * - mram_sched_fence() separates everything submitted before it from
+ *   everything submitted after it; nothing is merged or reordered across
+ *   a fence.
+ * - A request may name up to MRAM_SCHED_MAX_DEPS earlier requests in deps;
+ *   it is issued only after those have completed.
+ * Within these constraints each request is placed at the earliest
+ * dependency level it can run at, and all requests of a level are merged
+ * together, so a single edge does not serialize unrelated traffic.
+ *
+ * An ordering constraint also carries failure. A request whose dependency
+ * failed fails without being issued. If any request fails, every request
+ * submitted after a later fence fails without being issued as well, up to
+ * the point where the failure is reported. That point is just before the
+ * callbacks of the failed request's batch run. A commit record written
+ * behind a fence therefore never lands after a failed write of the data
+ * it commits. Requests submitted once the failure is visible, such as a
+ * retry, are issued normally.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_SCHED_H
+#define MRAM_INTERFACE_MRAM_SCHED_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <pthread.h>
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default batching window in microseconds */
+#define MRAM_SCHED_DEFAULT_DELAY_US 50
+/** @brief Default upper bound on the length of a merged frame */
+#define MRAM_SCHED_DEFAULT_MAX_MERGE 4096
+/** @brief Default number of requests that closes a batch early */
+#define MRAM_SCHED_DEFAULT_MAX_BATCH 64
+/** @brief Dependency edges per request */
+#define MRAM_SCHED_MAX_DEPS 4
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Request direction
+ */
+enum mram_sched_op {
+    /** @brief Read into buf */
+    MRAM_SCHED_READ,
+    /** @brief Write from buf */
+    MRAM_SCHED_WRITE,
+};
+
+/**
+ * @brief Queued request, owned by the caller until its callback has run
+ */
+struct mram_sched_request {
+    /** @brief Request direction (enum mram_sched_op) */
+    uint8_t op;
+    /** @brief Device address */
+    uint32_t addr;
+    /** @brief Data buffer, must stay valid until completion */
+    void* buf;
+    /** @brief Number of bytes */
+    size_t len;
+    /** @brief Completion callback, run on the scheduler thread (may be NULL) */
+    void (*callback)(struct mram_sched_request* req, void* ctx);
+    /** @brief Callback context */
+    void* ctx;
+    /** @brief Earlier requests that must complete first, unused entries NULL.
+     *  A dependency must still be queued or already completed; do not
+     *  resubmit it before this request has been submitted. */
+    struct mram_sched_request* deps[MRAM_SCHED_MAX_DEPS];
+    /** @brief Result, valid once the callback runs */
+    bool result;
+    /** @brief Queue link (scheduler internal) */
+    struct mram_sched_request* next;
+    /** @brief Submission sequence number (scheduler internal) */
+    uint64_t seq;
+    /** @brief Fence epoch at submission (scheduler internal) */
+    uint64_t epoch;
+    /** @brief Completion flag for the blocking helpers (scheduler internal) */
+    bool done;
+};
+
+/**
+ * @brief Scheduler configuration
+ */
+struct mram_sched_config {
+    /** @brief Batching window from the first queued request (0 = MRAM_SCHED_DEFAULT_DELAY_US) */
+    uint32_t max_delay_us;
+    /** @brief Maximum frame length built from adjacent requests (0 = MRAM_SCHED_DEFAULT_MAX_MERGE) */
+    uint32_t max_merge;
+    /** @brief Queued requests that dispatch a batch before the window ends (0 = MRAM_SCHED_DEFAULT_MAX_BATCH) */
+    uint32_t max_batch;
+};
+
+/**
+ * @brief Scheduler statistics, read them once the scheduler is idle
+ */
+struct mram_sched_stats {
+    /** @brief Requests completed */
+    uint64_t requests;
+    /** @brief Batches dispatched */
+    uint64_t batches;
+    /** @brief READ and WRITE frames issued */
+    uint64_t frames;
+    /** @brief Calls into the underlying driver */
+    uint64_t bus_calls;
+};
+
+/** @brief Run of overlapping requests merged into one segment (scheduler internal) */
+struct mram_sched_cluster;
+
+/**
+ * @brief Scheduler handle
+ */
+struct mram_sched {
+    /** @brief Device driven by the scheduler thread */
+    struct mram* mram;
+    /** @brief Batching window */
+    uint32_t max_delay_us;
+    /** @brief Maximum merged frame length */
+    uint32_t max_merge;
+    /** @brief Maximum requests per batch */
+    uint32_t max_batch;
+    /** @brief Protects the queue and the blocking helpers' completion flags */
+    pthread_mutex_t lock;
+    /** @brief Wakes the scheduler thread */
+    pthread_cond_t cond;
+    /** @brief Wakes callers of the blocking helpers */
+    pthread_cond_t done_cond;
+    /** @brief Oldest queued request */
+    struct mram_sched_request* head;
+    /** @brief Newest queued request */
+    struct mram_sched_request* tail;
+    /** @brief Queued requests */
+    uint32_t queued;
+    /** @brief Next submission sequence number */
+    uint64_t seq;
+    /** @brief Current fence epoch */
+    uint64_t epoch;
+    /** @brief Epoch of the last failed request (scheduler thread only) */
+    uint64_t failed_epoch;
+    /** @brief Submission sequence number at which that failure was reported (scheduler thread only) */
+    uint64_t failed_before;
+    /** @brief Monotonic time in microseconds at which the current window closes */
+    uint64_t deadline_us;
+    /** @brief Set to stop the thread once the queue is empty */
+    bool stop;
+    /** @brief Requests of the batch being dispatched (scheduler thread only) */
+    struct mram_sched_request** batch;
+    /** @brief Sorted view of the batch (scheduler thread only) */
+    struct mram_sched_request** sorted;
+    /** @brief Dependency level of each batch entry (scheduler thread only) */
+    uint32_t* levels;
+    /** @brief Merge clusters of the batch (scheduler thread only) */
+    struct mram_sched_cluster* clusters;
+    /** @brief Segments for vector transfers (scheduler thread only) */
+    struct mram_iovec* iov;
+    /** @brief Scheduler thread */
+    pthread_t thread;
+    /** @brief Statistics */
+    struct mram_sched_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start a scheduler for a device
+ *
+ * @param sched Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure, owned by
+ *        the scheduler until deinit
+ * @param config Scheduler configuration (NULL for defaults)
+ * @return true if successful, false if parameters are invalid, allocation
+ *         fails or the thread cannot be created
+ */
+bool mram_sched_init(struct mram_sched* sched, struct mram* mram, const struct mram_sched_config* config);
+
+/**
+ * @brief Complete all queued requests and stop the scheduler
+ *
+ * @param sched Pointer to the handle
+ */
+void mram_sched_deinit(struct mram_sched* sched);
+
+/**
+ * @brief Queue a request
+ *
+ * @param sched Pointer to the handle
+ * @param req Request with op, addr, buf, len and optionally callback, ctx and deps set
+ * @return true if queued, false if parameters are invalid (no callback runs then)
+ */
+bool mram_sched_submit(struct mram_sched* sched, struct mram_sched_request* req);
+
+/**
+ * @brief Insert an ordering fence
+ *
+ * Requests submitted before the fence are issued, and complete, before any
+ * request submitted after it is issued. The fence does not wait.
+ *
+ * @param sched Pointer to the handle
+ * @return true if successful, false if sched is NULL
+ */
+bool mram_sched_fence(struct mram_sched* sched);
+
+/**
+ * @brief Queue a read and wait for it
+ *
+ * @param sched Pointer to the handle
+ * @param addr Device address
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false otherwise
+ */
+bool mram_sched_read(struct mram_sched* sched, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Queue a write and wait for it
+ *
+ * @param sched Pointer to the handle
+ * @param addr Device address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if successful, false otherwise
+ */
+bool mram_sched_write(struct mram_sched* sched, uint32_t addr, const void* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_SCHED_H
@@ -0,0 +1,423 @@
+#define _GNU_SOURCE  // CMSG_SPACE, MSG_NOSIGNAL
+#include "mram_server.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Passed descriptors a connection may hold before ATTACH_SHM consumes them
+#define SERVER_MAX_FDS 4
+// Free input space guaranteed before each socket read
+#define SERVER_READ_CHUNK 65536
+
+struct mram_server_conn {
+    int fd;
+    uint8_t* in;
+    size_t in_len;
+    size_t in_cap;
+    uint8_t* out;
+    size_t out_off;
+    size_t out_len;
+    size_t out_cap;
+    int fds[SERVER_MAX_FDS];
+    size_t nfds;
+    uint8_t* shm;
+    size_t shm_size;
+};
+
+static bool server_reserve(uint8_t** buf, size_t* cap, size_t need) {
+    if (need <= *cap) return true;
+    size_t n = *cap ? *cap : SERVER_READ_CHUNK;
+    while (n < need) n *= 2;
+    uint8_t* p = realloc(*buf, n);
+    if (p == NULL) return false;
+    *buf = p;
+    *cap = n;
+    return true;
+}
+
+static bool server_range_valid(uint32_t addr, size_t len) {
+    return len != 0 && addr <= MRAM_MAX_ADDRESS && len - 1 <= (size_t)(MRAM_MAX_ADDRESS - addr);
+}
+
+static bool server_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void server_conn_close(struct mram_server_conn* conn) {
+    close(conn->fd);
+    for (size_t i = 0; i < conn->nfds; i++) close(conn->fds[i]);
+    if (conn->shm) munmap(conn->shm, conn->shm_size);
+    free(conn->in);
+    free(conn->out);
+    free(conn);
+}
+
+// Translate segment descriptors into iovecs. Inline data (base != NULL) is
+// laid out back to back; SHM segments point into the shared memory instead.
+static uint8_t server_segments(struct mram_server* server, const struct mram_server_conn* conn,
+                               const struct mram_proto_request* req, const uint8_t* raw, uint8_t* base) {
+    size_t total = 0;
+
+    if (req->count == 0) return MRAM_PROTO_ERR_INVAL;
+    if (base == NULL && conn->shm == NULL) return MRAM_PROTO_ERR_INVAL;
+    for (size_t i = 0; i < req->count; i++) {
+        struct mram_proto_segment seg;
+        memcpy(&seg, raw + i * sizeof(seg), sizeof(seg));
+        if (!server_range_valid(seg.addr, seg.len)) return MRAM_PROTO_ERR_INVAL;
+        server->iov[i].addr = seg.addr;
+        server->iov[i].len = seg.len;
+        if (base) {
+            server->iov[i].buf = base + total;
+        } else {
+            if (seg.offset > conn->shm_size || seg.len > conn->shm_size - seg.offset) return MRAM_PROTO_ERR_INVAL;
+            server->iov[i].buf = conn->shm + seg.offset;
+        }
+        total += seg.len;
+    }
+    if (base && total != req->len) return MRAM_PROTO_ERR_INVAL;
+    return MRAM_PROTO_OK;
+}
+
+// Only memory the client cannot shrink later is mapped; touching pages past
+// the end of the file would kill the server with SIGBUS
+static bool server_shm_valid(int fd, size_t size) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 0 || size > (uint64_t)st.st_size) return false;
+#ifdef F_GET_SEALS
+    int seals = fcntl(fd, F_GET_SEALS);
+    return seals >= 0 && (seals & F_SEAL_SHRINK);
+#else
+    return false;
+#endif
+}
+
+static uint8_t server_attach(struct mram_server_conn* conn, size_t size) {
+    if (conn->nfds == 0 || size == 0) return MRAM_PROTO_ERR_INVAL;
+
+    int fd = conn->fds[0];
+    memmove(conn->fds, conn->fds + 1, --conn->nfds * sizeof(int));
+    void* p = MAP_FAILED;
+    if (server_shm_valid(fd, size)) p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return MRAM_PROTO_ERR_INVAL;
+
+    if (conn->shm) munmap(conn->shm, conn->shm_size);
+    conn->shm = p;
+    conn->shm_size = size;
+    return MRAM_PROTO_OK;
+}
+
+// Execute one request and queue its response; false only if buffers cannot grow
+static bool server_execute(struct mram_server* server, struct mram_server_conn* conn,
+                           const struct mram_proto_request* req, const uint8_t* segs, const uint8_t* data) {
+    bool reads = req->op == MRAM_PROTO_READ || req->op == MRAM_PROTO_READ_VECTOR;
+    size_t need = conn->out_len + sizeof(struct mram_proto_response) + (reads ? req->len : 0);
+    if (!server_reserve(&conn->out, &conn->out_cap, need)) return false;
+
+    struct mram_proto_response resp = { req->id, MRAM_PROTO_OK, 0, 0, 0 };
+    uint8_t* payload = conn->out + conn->out_len + sizeof(resp);
+    struct mram_iovec one = { req->addr, payload, req->len };
+    bool ok = true;
+
+    switch (req->op) {
+        case MRAM_PROTO_READ:
+        case MRAM_PROTO_WRITE:
+            if (!server_range_valid(req->addr, req->len)) {
+                resp.result = MRAM_PROTO_ERR_INVAL;
+                break;
+            }
+            if (req->op == MRAM_PROTO_WRITE) one.buf = (void*)data;
+            ok = req->op == MRAM_PROTO_READ ? mram_read_vector(server->mram, &one, 1)
+                                            : mram_write_vector(server->mram, &one, 1);
+            break;
+        case MRAM_PROTO_READ_VECTOR:
+            resp.result = server_segments(server, conn, req, segs, payload);
+            if (resp.result == MRAM_PROTO_OK) ok = mram_read_vector(server->mram, server->iov, req->count);
+            break;
+        case MRAM_PROTO_WRITE_VECTOR:
+            resp.result = server_segments(server, conn, req, segs, (uint8_t*)data);
+            if (resp.result == MRAM_PROTO_OK) ok = mram_write_vector(server->mram, server->iov, req->count);
+            break;
+        case MRAM_PROTO_SHM_READ_VECTOR:
+        case MRAM_PROTO_SHM_WRITE_VECTOR:
+            resp.result = server_segments(server, conn, req, segs, NULL);
+            if (resp.result != MRAM_PROTO_OK) break;
+            ok = req->op == MRAM_PROTO_SHM_READ_VECTOR ? mram_read_vector(server->mram, server->iov, req->count)
+                                                       : mram_write_vector(server->mram, server->iov, req->count);
+            break;
+        case MRAM_PROTO_READ_STATUS:
+            ok = mram_read_status_register(server->mram, &resp.status);
+            break;
+        case MRAM_PROTO_WRITE_STATUS:
+            ok = mram_write_status_register(server->mram, req->arg);
+            break;
+        case MRAM_PROTO_SLEEP:
+            ok = mram_sleep(server->mram);
+            break;
+        case MRAM_PROTO_WAKE:
+            ok = mram_wake(server->mram);
+            break;
+        case MRAM_PROTO_ATTACH_SHM:
+            resp.result = server_attach(conn, req->len);
+            break;
+        default:
+            resp.result = MRAM_PROTO_ERR_INVAL;
+            break;
+    }
+    if (!ok) resp.result = MRAM_PROTO_ERR_IO;
+    if (reads && resp.result == MRAM_PROTO_OK) resp.len = req->len;
+
+    memcpy(conn->out + conn->out_len, &resp, sizeof(resp));
+    conn->out_len += sizeof(resp) + resp.len;
+    server->stats.requests++;
+    if (resp.result != MRAM_PROTO_OK) server->stats.errors++;
+    return true;
+}
+
+// Run every complete request in the input buffer; false closes the connection
+static bool server_process(struct mram_server* server, struct mram_server_conn* conn) {
+    size_t pos = 0;
+
+    if (conn->out_off) {
+        memmove(conn->out, conn->out + conn->out_off, conn->out_len - conn->out_off);
+        conn->out_len -= conn->out_off;
+        conn->out_off = 0;
+    }
+
+    // Stop once the queued responses reach the backlog limit; the rest of
+    // the input is parsed after the client has drained them
+    while (conn->in_len - pos >= sizeof(struct mram_proto_request) && conn->out_len < server->max_backlog) {
+        struct mram_proto_request req;
+        memcpy(&req, conn->in + pos, sizeof(req));
+
+        size_t seg_bytes = 0;
+        size_t data_bytes = 0;
+        switch (req.op) {
+            case MRAM_PROTO_WRITE:
+                data_bytes = req.len;
+                break;
+            case MRAM_PROTO_WRITE_VECTOR:
+                data_bytes = req.len;
+                seg_bytes = req.count * sizeof(struct mram_proto_segment);
+                break;
+            case MRAM_PROTO_READ_VECTOR:
+            case MRAM_PROTO_SHM_READ_VECTOR:
+            case MRAM_PROTO_SHM_WRITE_VECTOR:
+                seg_bytes = req.count * sizeof(struct mram_proto_segment);
+                break;
+            default:
+                break;
+        }
+        // Oversized requests cannot be skipped safely, the stream is lost
+        // (ATTACH_SHM's len is a mapping size, not payload)
+        if (req.count > MRAM_PROTO_MAX_SEGMENTS) return false;
+        if (req.op != MRAM_PROTO_ATTACH_SHM && req.len > MRAM_PROTO_MAX_PAYLOAD) return false;
+
+        size_t total = sizeof(req) + seg_bytes + data_bytes;
+        if (conn->in_len - pos < total) break;
+        const uint8_t* segs = conn->in + pos + sizeof(req);
+        if (!server_execute(server, conn, &req, segs, segs + seg_bytes)) return false;
+        pos += total;
+    }
+
+    memmove(conn->in, conn->in + pos, conn->in_len - pos);
+    conn->in_len -= pos;
+    return true;
+}
+
+static bool server_conn_read(struct mram_server* server, struct mram_server_conn* conn) {
+    if (!server_reserve(&conn->in, &conn->in_cap, conn->in_len + SERVER_READ_CHUNK)) return false;
+
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(SERVER_MAX_FDS * sizeof(int))];
+    } control;
+    struct iovec v = { conn->in + conn->in_len, conn->in_cap - conn->in_len };
+    struct msghdr msg = { 0 };
+    msg.msg_iov = &v;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n = recvmsg(conn->fd, &msg, 0);
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if (n == 0) return false;
+
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c != NULL; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; i++) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+            if (conn->nfds < SERVER_MAX_FDS) {
+                conn->fds[conn->nfds++] = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+
+    conn->in_len += (size_t)n;
+    return server_process(server, conn);
+}
+
+static bool server_conn_write(struct mram_server_conn* conn) {
+    while (conn->out_off < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out + conn->out_off, conn->out_len - conn->out_off, MSG_NOSIGNAL);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        conn->out_off += (size_t)n;
+    }
+    conn->out_off = 0;
+    conn->out_len = 0;
+    return true;
+}
+
+static void server_accept(struct mram_server* server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+
+        struct mram_server_conn* conn = calloc(1, sizeof(*conn));
+        if (server->conn_count == server->conn_cap) {
+            size_t cap = server->conn_cap ? server->conn_cap * 2 : 8;
+            struct mram_server_conn** p = realloc(server->conns, cap * sizeof(*p));
+            if (p) {
+                server->conns = p;
+                server->conn_cap = cap;
+            }
+        }
+        if (conn == NULL || server->conn_count == server->conn_cap || !server_nonblocking(fd)) {
+            free(conn);
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        server->conns[server->conn_count++] = conn;
+        server->stats.connections++;
+    }
+}
+
+bool mram_server_init(struct mram_server* server, struct mram* mram, const char* path) {
+    if (server == NULL || mram == NULL) return false;
+    if (path == NULL) path = MRAM_PROTO_DEFAULT_PATH;
+
+    struct sockaddr_un sa = { 0 };
+    if (strlen(path) >= sizeof(sa.sun_path) || strlen(path) >= sizeof(server->path)) return false;
+
+    memset(server, 0, sizeof(*server));
+    server->mram = mram;
+    server->max_backlog = MRAM_SERVER_MAX_BACKLOG;
+    server->listen_fd = -1;
+    server->wake_fd[0] = server->wake_fd[1] = -1;
+    strcpy(server->path, path);
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+
+    server->iov = malloc(MRAM_PROTO_MAX_SEGMENTS * sizeof(*server->iov));
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server->iov == NULL || server->listen_fd < 0 || pipe(server->wake_fd) != 0) {
+        mram_server_deinit(server);
+        return false;
+    }
+    unlink(path);
+    if (bind(server->listen_fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 || listen(server->listen_fd, 16) != 0 ||
+        !server_nonblocking(server->listen_fd) || !server_nonblocking(server->wake_fd[0])) {
+        mram_server_deinit(server);
+        return false;
+    }
+    return true;
+}
+
+bool mram_server_run(struct mram_server* server) {
+    if (server == NULL || server->listen_fd < 0) return false;
+
+    struct pollfd* pfds = NULL;
+    for (;;) {
+        size_t count = server->conn_count;
+        struct pollfd* p = realloc(pfds, (count + 2) * sizeof(*p));
+        if (p == NULL) {
+            free(pfds);
+            return false;
+        }
+        pfds = p;
+        pfds[0] = (struct pollfd){ server->wake_fd[0], POLLIN, 0 };
+        pfds[1] = (struct pollfd){ server->listen_fd, POLLIN, 0 };
+        for (size_t i = 0; i < count; i++) {
+            const struct mram_server_conn* conn = server->conns[i];
+            size_t backlog = conn->out_len - conn->out_off;
+            pfds[i + 2].fd = conn->fd;
+            pfds[i + 2].events = (short)((backlog < server->max_backlog ? POLLIN : 0) | (backlog ? POLLOUT : 0));
+            pfds[i + 2].revents = 0;
+        }
+
+        if (poll(pfds, count + 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            free(pfds);
+            return false;
+        }
+        if (pfds[0].revents) {
+            char drain[16];
+            while (read(server->wake_fd[0], drain, sizeof(drain)) > 0) {
+            }
+            free(pfds);
+            return true;
+        }
+
+        // Backwards, so a swap-remove only moves connections already handled
+        for (size_t i = count; i-- > 0;) {
+            struct mram_server_conn* conn = server->conns[i];
+            short rev = pfds[i + 2].revents;
+            bool ok = true;
+            if (rev & POLLIN) ok = server_conn_read(server, conn);
+            if (ok && (rev & (POLLIN | POLLOUT))) ok = server_conn_write(conn);
+            // Requests held back by the backlog limit resume once it has
+            // room, whichever event drained it: a write after POLLIN can
+            // empty it, and then only POLLIN is polled for again
+            if (ok && conn->in_len && conn->out_len - conn->out_off < server->max_backlog) {
+                ok = server_process(server, conn);
+            }
+            if (ok && (rev & (POLLERR | POLLNVAL | POLLHUP)) && !(rev & POLLIN)) ok = false;
+            if (!ok) {
+                server_conn_close(conn);
+                server->conns[i] = server->conns[--server->conn_count];
+            }
+        }
+        if (pfds[1].revents & POLLIN) server_accept(server);
+    }
+}
+
+void mram_server_stop(struct mram_server* server) {
+    if (server == NULL || server->wake_fd[1] < 0) return;
+    ssize_t n = write(server->wake_fd[1], "", 1);
+    (void)n;
+}
+
+void mram_server_deinit(struct mram_server* server) {
+    if (server == NULL) return;
+    for (size_t i = 0; i < server->conn_count; i++) server_conn_close(server->conns[i]);
+    free(server->conns);
+    free(server->iov);
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        unlink(server->path);
+    }
+    if (server->wake_fd[0] >= 0) close(server->wake_fd[0]);
+    if (server->wake_fd[1] >= 0) close(server->wake_fd[1]);
+    server->conns = NULL;
+    server->conn_count = 0;
+    server->iov = NULL;
+    server->listen_fd = -1;
+    server->wake_fd[0] = server->wake_fd[1] = -1;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file mram_server.h
+ * @brief Unix-domain socket server that shares one MRAM device between processes
+ *
+ * The server owns a struct mram and serves the mram_proto.h protocol to any
+ * number of local clients. It runs a single-threaded poll() loop, so device
+ * access is serialized without locks. Each connection has its own input and
+ * output buffers. The server parses every complete request in the input
+ * buffer, runs them in order, and queues their responses, so pipelined
+ * requests cost one socket read and one socket write per batch rather than
+ * per request. Read data goes from the device straight into the output
+ * buffer, and inline write data goes from the input buffer straight to the
+ * device. The SHM operations move data between the device and the client's
+ * shared memory, with no copy at all.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_SERVER_H
+#define MRAM_INTERFACE_MRAM_SERVER_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+#include "mram_proto.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default for mram_server::max_backlog */
+#define MRAM_SERVER_MAX_BACKLOG (64u * 1024 * 1024)
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+struct mram_server_conn;
+
+/**
+ * @brief Server statistics
+ */
+struct mram_server_stats {
+    /** @brief Connections accepted */
+    uint64_t connections;
+    /** @brief Requests executed */
+    uint64_t requests;
+    /** @brief Requests that failed */
+    uint64_t errors;
+};
+
+/**
+ * @brief Server handle
+ */
+struct mram_server {
+    /** @brief Served MRAM device */
+    struct mram* mram;
+    /** @brief Listening socket */
+    int listen_fd;
+    /** @brief Self-pipe used by mram_server_stop() */
+    int wake_fd[2];
+    /** @brief Socket path, unlinked on deinit */
+    char path[108];
+    /** @brief Open connections */
+    struct mram_server_conn** conns;
+    /** @brief Number of open connections */
+    size_t conn_count;
+    /** @brief Capacity of conns */
+    size_t conn_cap;
+    /** @brief Segment scratch for vector requests */
+    struct mram_iovec* iov;
+    /** @brief Queued response bytes per connection above which the server
+     *  stops parsing and reading its requests; may be changed before
+     *  mram_server_run() */
+    size_t max_backlog;
+    /** @brief Statistics */
+    struct mram_server_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the listening socket
+ *
+ * A stale socket file at path is removed first.
+ *
+ * @param server Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param path Socket path (NULL = MRAM_PROTO_DEFAULT_PATH)
+ * @return true if successful, false if parameters are invalid or a system call fails
+ */
+bool mram_server_init(struct mram_server* server, struct mram* mram, const char* path);
+
+/**
+ * @brief Serve clients until mram_server_stop() is called
+ *
+ * @param server Pointer to the handle
+ * @return true after a stop request, false if polling fails
+ */
+bool mram_server_run(struct mram_server* server);
+
+/**
+ * @brief Ask a running server to return from mram_server_run()
+ *
+ * Async-signal-safe, so it may be called from a signal handler.
+ *
+ * @param server Pointer to the handle
+ */
+void mram_server_stop(struct mram_server* server);
+
+/**
+ * @brief Close all connections and the socket, and remove the socket file
+ *
+ * @param server Pointer to the handle
+ */
+void mram_server_deinit(struct mram_server* server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_SERVER_H
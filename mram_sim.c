@@ -0,0 +1,188 @@
+#include "mram_sim.h"
+#include <string.h>
+
+enum {
+    SIM_PHASE_COMMAND,
+    SIM_PHASE_ADDRESS,
+    SIM_PHASE_DATA,
+    SIM_PHASE_STATUS_OUT,
+    SIM_PHASE_STATUS_IN,
+    SIM_PHASE_IGNORE,
+};
+
+// Status register bits the host can change through WRSR
+#define SIM_STATUS_WRITABLE (MRAM_STATUS_BP0 | MRAM_STATUS_BP1 | MRAM_STATUS_WPEN)
+
+static uint8_t sim_builtin[MRAM_SIZE_BYTES];
+// Status register of devices bound with mram_sim_init()
+static uint8_t sim_builtin_status;
+
+static struct {
+    uint8_t* memory;
+    uint8_t* nv_status;
+    bool selected;
+    bool wel;
+    bool sleeping;
+    uint8_t status;
+    uint8_t phase;
+    uint8_t cmd;
+    uint8_t addr_bytes;
+    uint32_t addr;
+    struct mram_sim_stats stats;
+} sim = { .memory = sim_builtin, .nv_status = &sim_builtin_status };
+
+// BP1:BP0 protect the upper quarter, the upper half or the whole array
+static uint32_t sim_protected_base(void) {
+    switch ((sim.status & (MRAM_STATUS_BP0 | MRAM_STATUS_BP1)) >> 2) {
+        case 1:
+            return MRAM_SIZE_BYTES / 4 * 3;
+        case 2:
+            return MRAM_SIZE_BYTES / 2;
+        case 3:
+            return 0;
+        default:
+            return MRAM_SIZE_BYTES;
+    }
+}
+
+static uint8_t sim_command(uint8_t cmd) {
+    sim.cmd = cmd;
+    sim.phase = SIM_PHASE_IGNORE;
+    if (sim.sleeping) {
+        if (cmd == MRAM_CMD_WAKE) sim.sleeping = false;
+        return 0xFF;
+    }
+
+    if (cmd == MRAM_CMD_WREN) {
+        sim.wel = true;
+        sim.stats.write_enables++;
+    } else if (cmd == MRAM_CMD_WRDI) {
+        sim.wel = false;
+    } else if (cmd == MRAM_CMD_RDSR) {
+        sim.phase = SIM_PHASE_STATUS_OUT;
+    } else if (cmd == MRAM_CMD_WRSR) {
+        sim.phase = SIM_PHASE_STATUS_IN;
+    } else if (cmd == MRAM_CMD_READ || cmd == MRAM_CMD_WRITE) {
+        sim.phase = SIM_PHASE_ADDRESS;
+        sim.addr_bytes = 0;
+        sim.addr = 0;
+    } else if (cmd == MRAM_CMD_SLEEP) {
+        sim.sleeping = true;
+    }
+    return 0xFF;
+}
+
+static uint8_t sim_byte(uint8_t in) {
+    uint8_t out = 0xFF;
+
+    switch (sim.phase) {
+        case SIM_PHASE_COMMAND:
+            return sim_command(in);
+        case SIM_PHASE_ADDRESS:
+            sim.addr = (sim.addr << 8) | in;
+            if (++sim.addr_bytes == 3) {
+                sim.addr &= MRAM_ADDRESS_MASK;
+                sim.phase = SIM_PHASE_DATA;
+            }
+            break;
+        case SIM_PHASE_STATUS_OUT:
+            out = (uint8_t)(sim.status | (sim.wel ? MRAM_STATUS_WEL : 0));
+            break;
+        case SIM_PHASE_STATUS_IN:
+            if (sim.wel) {
+                sim.status = in & SIM_STATUS_WRITABLE;
+                *sim.nv_status = sim.status;
+            }
+            sim.phase = SIM_PHASE_IGNORE;
+            break;
+        default:
+            break;
+    }
+    return out;
+}
+
+// Payload bytes up to the end of the array, copied in bulk; returns the count
+static size_t sim_data(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    size_t n = MRAM_SIZE_BYTES - sim.addr;
+    if (n > len) n = len;
+
+    if (sim.cmd == MRAM_CMD_READ) {
+        if (rx_buf) memmove(rx_buf, sim.memory + sim.addr, n);
+    } else {
+        if (sim.wel) {
+            uint32_t base = sim_protected_base();
+            size_t w = sim.addr < base ? base - sim.addr : 0;
+            if (w > n) w = n;
+            if (tx_buf) {
+                memmove(sim.memory + sim.addr, tx_buf, w);
+            } else {
+                memset(sim.memory + sim.addr, 0xFF, w);
+            }
+        }
+        if (rx_buf) memset(rx_buf, 0xFF, n);
+    }
+    sim.addr = (uint32_t)((sim.addr + n) & MRAM_ADDRESS_MASK);
+    return n;
+}
+
+static bool sim_gpio_write(uint8_t pin, uint8_t value) {
+    if (pin != MRAM_SIM_CS_PIN) return true;
+
+    bool select = value == MRAM_GPIO_LOW;
+    if (select && !sim.selected) {
+        sim.phase = SIM_PHASE_COMMAND;
+        sim.stats.frames++;
+    }
+    sim.selected = select;
+    return true;
+}
+
+static bool sim_spi_transfer(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    if (!sim.selected || (tx_buf == NULL && rx_buf == NULL)) return false;
+
+    for (size_t i = 0; i < len;) {
+        if (sim.phase == SIM_PHASE_DATA) {
+            i += sim_data(tx_buf ? tx_buf + i : NULL, rx_buf ? rx_buf + i : NULL, len - i);
+            continue;
+        }
+        if (sim.phase == SIM_PHASE_IGNORE) {
+            if (rx_buf) memset(rx_buf + i, 0xFF, len - i);
+            break;
+        }
+        // tx_buf may alias rx_buf, so take the input byte first
+        uint8_t out = sim_byte(tx_buf ? tx_buf[i] : 0xFF);
+        if (rx_buf) rx_buf[i] = out;
+        i++;
+    }
+    sim.stats.bytes += len;
+    return true;
+}
+
+bool mram_sim_init(struct mram* mram, uint8_t* memory) {
+    if (mram == NULL) return false;
+
+    uint8_t* backing = memory ? memory : sim_builtin;
+    // Another array is another device, which starts with protection off
+    if (backing != sim.memory || sim.nv_status != &sim_builtin_status) sim_builtin_status = 0;
+    return mram_sim_init_nv(mram, backing, &sim_builtin_status);
+}
+
+bool mram_sim_init_nv(struct mram* mram, uint8_t* memory, uint8_t* status) {
+    if (mram == NULL || memory == NULL || status == NULL) return false;
+
+    // A power cycle clears WEL and sleep; BP0, BP1 and WPEN are nonvolatile
+    memset(&sim, 0, sizeof(sim));
+    sim.memory = memory;
+    sim.nv_status = status;
+    sim.status = *status & SIM_STATUS_WRITABLE;
+    return mram_init(mram, sim_gpio_write, sim_spi_transfer, MRAM_SIM_CS_PIN);
+}
+
+uint8_t* mram_sim_memory(void) {
+    return sim.memory;
+}
+
+void mram_sim_stats(struct mram_sim_stats* stats) {
+    if (stats == NULL) return;
+    *stats = sim.stats;
+}
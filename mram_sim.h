@@ -0,0 +1,105 @@
+/**
+ * @file mram_sim.h
+ * @brief Simulated MR25H40 transport for host builds and tests
+ *
+ * Implements the gpio_write and spi_transfer callbacks of struct mram on
+ * top of a 512 KB memory array. The model decodes the command set the way
+ * the device does: READ and WRITE with 19-bit wrapping addresses, the
+ * write enable latch, RDSR and WRSR, block protection through BP0/BP1, and
+ * sleep mode (everything but WAKE is ignored while asleep). An SPI
+ * transfer while CS is high fails, which catches framing bugs. Command and
+ * address bytes are decoded one at a time; payloads are copied in bulk.
+ *
+ * As on the device, BP0, BP1 and WPEN are nonvolatile: re-initializing
+ * the simulator on the same array models a power cycle, which clears WEL
+ * and sleep mode but keeps the array and the protection bits.
+ * mram_sim_init_nv() takes the status register from storage of the
+ * caller's, such as the trailer of an image file.
+ *
+ * struct mram callbacks carry no context, so there is one simulated device
+ * per process. The callbacks are not thread-safe; drive the device from
+ * one thread at a time, as with real hardware.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_SIM_H
+#define MRAM_INTERFACE_MRAM_SIM_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Chip select pin number used by the simulator */
+#define MRAM_SIM_CS_PIN 0
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Simulator statistics
+ */
+struct mram_sim_stats {
+    /** @brief CS low/high cycles */
+    uint64_t frames;
+    /** @brief Bytes clocked over SPI */
+    uint64_t bytes;
+    /** @brief WREN commands */
+    uint64_t write_enables;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reset the simulated device and bind an MRAM interface to it
+ *
+ * @param mram Pointer to the MRAM interface structure to initialize
+ * @param memory MRAM_SIZE_BYTES of backing store, or NULL for a built-in
+ *        array (contents and status register are kept across calls with
+ *        the same backing)
+ * @return true if successful, false if mram is NULL
+ */
+bool mram_sim_init(struct mram* mram, uint8_t* memory);
+
+/**
+ * @brief Reset the simulated device with its status register in caller storage
+ *
+ * @param mram Pointer to the MRAM interface structure to initialize
+ * @param memory MRAM_SIZE_BYTES of backing store
+ * @param status Nonvolatile status register, read now and updated by every
+ *        accepted WRSR; must stay valid while the device is in use
+ * @return true if successful, false if a parameter is NULL
+ */
+bool mram_sim_init_nv(struct mram* mram, uint8_t* memory, uint8_t* status);
+
+/**
+ * @brief Backing store of the simulated device
+ *
+ * @return Pointer to MRAM_SIZE_BYTES of device contents
+ */
+uint8_t* mram_sim_memory(void);
+
+/**
+ * @brief Read the simulator statistics
+ *
+ * @param stats Receives the statistics
+ */
+void mram_sim_stats(struct mram_sim_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_SIM_H
@@ -0,0 +1,162 @@
+#include "mram_snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool snap_streamed(const struct mram_snapshot* snap, uint32_t chunk) {
+    return (snap->streamed[chunk / 32] >> (chunk % 32)) & 1u;
+}
+
+static uint32_t snap_chunk_len(const struct mram_snapshot* snap, uint32_t chunk) {
+    uint32_t offset = chunk * snap->chunk_size;
+    return snap->size - offset < snap->chunk_size ? snap->size - offset : snap->chunk_size;
+}
+
+static bool snap_device_read(struct mram_snapshot* snap, uint32_t offset, void* buffer, size_t len) {
+    struct mram_iovec iov = { snap->base + offset, buffer, len };
+    return mram_read_vector(snap->mram, &iov, 1);
+}
+
+// Drop all preserved chunks (lock held)
+static void snap_release(struct mram_snapshot* snap) {
+    for (uint32_t c = 0; c < snap->chunks && snap->saved_count; c++) {
+        if (snap->saved[c] == NULL) continue;
+        free(snap->saved[c]);
+        snap->saved[c] = NULL;
+        snap->saved_count--;
+    }
+}
+
+bool mram_snapshot_init(struct mram_snapshot* snap, struct mram* mram, uint32_t base, uint32_t size,
+                        uint32_t chunk_size) {
+    if (snap == NULL || mram == NULL || size == 0) return false;
+    if (base > MRAM_MAX_ADDRESS || size - 1 > MRAM_MAX_ADDRESS - base) return false;
+
+    memset(snap, 0, sizeof(*snap));
+    snap->mram = mram;
+    snap->base = base;
+    snap->size = size;
+    snap->chunk_size = chunk_size ? chunk_size : MRAM_SNAPSHOT_DEFAULT_CHUNK;
+    snap->chunks = (size + snap->chunk_size - 1) / snap->chunk_size;
+    snap->streamed = calloc((snap->chunks + 31) / 32, sizeof(*snap->streamed));
+    snap->saved = calloc(snap->chunks, sizeof(*snap->saved));
+    if (snap->streamed == NULL || snap->saved == NULL) {
+        free(snap->streamed);
+        free(snap->saved);
+        snap->saved = NULL;
+        return false;
+    }
+    pthread_mutex_init(&snap->lock, NULL);
+    return true;
+}
+
+void mram_snapshot_deinit(struct mram_snapshot* snap) {
+    if (snap == NULL || snap->saved == NULL) return;
+    snap_release(snap);
+    pthread_mutex_destroy(&snap->lock);
+    free(snap->streamed);
+    free(snap->saved);
+    snap->streamed = NULL;
+    snap->saved = NULL;
+}
+
+static bool snap_range_valid(const struct mram_snapshot* snap, uint32_t addr, const void* buf, size_t len) {
+    return snap != NULL && snap->saved != NULL && buf != NULL && len != 0 && addr >= snap->base &&
+           addr - snap->base < snap->size && len <= snap->size - (addr - snap->base);
+}
+
+bool mram_snapshot_read(struct mram_snapshot* snap, uint32_t addr, void* buffer, size_t len) {
+    if (!snap_range_valid(snap, addr, buffer, len)) return false;
+
+    pthread_mutex_lock(&snap->lock);
+    bool ok = snap_device_read(snap, addr - snap->base, buffer, len);
+    pthread_mutex_unlock(&snap->lock);
+    return ok;
+}
+
+bool mram_snapshot_write(struct mram_snapshot* snap, uint32_t addr, const void* data, size_t len) {
+    if (!snap_range_valid(snap, addr, data, len)) return false;
+
+    uint32_t offset = addr - snap->base;
+    uint32_t first = offset / snap->chunk_size;
+    uint32_t last = (uint32_t)((offset + len - 1) / snap->chunk_size);
+    bool ok = true;
+
+    pthread_mutex_lock(&snap->lock);
+    if (snap->active) {
+        // The image still needs these chunks as they were at begin
+        for (uint32_t c = first; c <= last && ok; c++) {
+            if (snap_streamed(snap, c) || snap->saved[c]) continue;
+            uint32_t chunk_len = snap_chunk_len(snap, c);
+            uint8_t* copy = malloc(chunk_len);
+            ok = copy && snap_device_read(snap, c * snap->chunk_size, copy, chunk_len);
+            if (!ok) {
+                free(copy);
+                break;
+            }
+            snap->saved[c] = copy;
+            snap->saved_count++;
+            snap->stats.chunks_preserved++;
+            if (snap->saved_count > snap->stats.peak_chunks) snap->stats.peak_chunks = snap->saved_count;
+        }
+    }
+    if (ok) {
+        struct mram_iovec iov = { addr, (void*)data, len };
+        ok = mram_write_vector(snap->mram, &iov, 1);
+    }
+    pthread_mutex_unlock(&snap->lock);
+    return ok;
+}
+
+bool mram_snapshot_begin(struct mram_snapshot* snap) {
+    if (snap == NULL || snap->saved == NULL) return false;
+
+    pthread_mutex_lock(&snap->lock);
+    bool ok = !snap->active;
+    if (ok) {
+        memset(snap->streamed, 0, ((snap->chunks + 31) / 32) * sizeof(*snap->streamed));
+        snap->cursor = 0;
+        snap->active = true;
+        snap->stats.snapshots++;
+    }
+    pthread_mutex_unlock(&snap->lock);
+    return ok;
+}
+
+bool mram_snapshot_next(struct mram_snapshot* snap, void* buffer, uint32_t* offset, uint32_t* len) {
+    if (snap == NULL || snap->saved == NULL || buffer == NULL || offset == NULL || len == NULL) return false;
+
+    pthread_mutex_lock(&snap->lock);
+    bool ok = snap->active;
+    if (ok && snap->cursor == snap->chunks) {
+        *offset = snap->size;
+        *len = 0;
+    } else if (ok) {
+        uint32_t c = snap->cursor;
+        uint32_t chunk_len = snap_chunk_len(snap, c);
+        if (snap->saved[c]) {
+            memcpy(buffer, snap->saved[c], chunk_len);
+            free(snap->saved[c]);
+            snap->saved[c] = NULL;
+            snap->saved_count--;
+        } else {
+            ok = snap_device_read(snap, c * snap->chunk_size, buffer, chunk_len);
+        }
+        if (ok) {
+            snap->streamed[c / 32] |= 1u << (c % 32);
+            snap->cursor++;
+            *offset = c * snap->chunk_size;
+            *len = chunk_len;
+        }
+    }
+    pthread_mutex_unlock(&snap->lock);
+    return ok;
+}
+
+void mram_snapshot_end(struct mram_snapshot* snap) {
+    if (snap == NULL || snap->saved == NULL) return;
+
+    pthread_mutex_lock(&snap->lock);
+    snap->active = false;
+    snap_release(snap);
+    pthread_mutex_unlock(&snap->lock);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file mram_snapshot.h
+ * @brief Consistent snapshot reads while writes continue (copy-on-write)
+ *
+ * Wraps a device range so a reader can stream a point-in-time image of it
+ * while writers keep running. mram_snapshot_begin() only resets a per-chunk
+ * bitmap, so it returns immediately. From then on, a write that hits a
+ * chunk the reader has not yet streamed first copies that chunk's old
+ * contents to RAM. The reader walks the range chunk by chunk. For each
+ * chunk it takes either the preserved copy or, if the chunk was never
+ * written, the device contents.
+ *
+ * Writers block for at most one chunk transfer: a reader fetching a chunk
+ * holds the lock only for that chunk, and a writer preserves only the
+ * chunks it touches. RAM use is bounded by the number of chunks written
+ * during the snapshot.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_SNAPSHOT_H
+#define MRAM_INTERFACE_MRAM_SNAPSHOT_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <pthread.h>
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default copy-on-write chunk size */
+#define MRAM_SNAPSHOT_DEFAULT_CHUNK 1024
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Snapshot statistics
+ */
+struct mram_snapshot_stats {
+    /** @brief Snapshots started */
+    uint64_t snapshots;
+    /** @brief Chunks preserved by writers */
+    uint64_t chunks_preserved;
+    /** @brief Largest number of chunks held in RAM at once */
+    uint64_t peak_chunks;
+};
+
+/**
+ * @brief Snapshot-capable range handle
+ */
+struct mram_snapshot {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief First device address of the range */
+    uint32_t base;
+    /** @brief Size of the range */
+    uint32_t size;
+    /** @brief Copy-on-write chunk size */
+    uint32_t chunk_size;
+    /** @brief Number of chunks */
+    uint32_t chunks;
+    /** @brief Serializes bus access and the copy-on-write state */
+    pthread_mutex_t lock;
+    /** @brief True between begin and end */
+    bool active;
+    /** @brief One bit per chunk already delivered to the reader */
+    uint32_t* streamed;
+    /** @brief Preserved old contents per chunk, NULL if not preserved */
+    uint8_t** saved;
+    /** @brief Chunks currently preserved */
+    uint32_t saved_count;
+    /** @brief Next chunk the reader streams */
+    uint32_t cursor;
+    /** @brief Statistics */
+    struct mram_snapshot_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a snapshot-capable range
+ *
+ * @param snap Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure; while the
+ *        handle exists all access to the range must go through it
+ * @param base First device address of the range
+ * @param size Size of the range
+ * @param chunk_size Copy-on-write granularity (0 = MRAM_SNAPSHOT_DEFAULT_CHUNK)
+ * @return true if successful, false if parameters are invalid or allocation fails
+ */
+bool mram_snapshot_init(struct mram_snapshot* snap, struct mram* mram, uint32_t base, uint32_t size,
+                        uint32_t chunk_size);
+
+/**
+ * @brief Release the handle and any preserved chunks
+ *
+ * @param snap Pointer to the handle
+ */
+void mram_snapshot_deinit(struct mram_snapshot* snap);
+
+/**
+ * @brief Read live data from the range
+ *
+ * @param snap Pointer to the handle
+ * @param addr Device address inside the range
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid or communication fails
+ */
+bool mram_snapshot_read(struct mram_snapshot* snap, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Write live data, preserving old contents for an active snapshot first
+ *
+ * @param snap Pointer to the handle
+ * @param addr Device address inside the range
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid, preserving
+ *         fails or communication fails (nothing is written then)
+ */
+bool mram_snapshot_write(struct mram_snapshot* snap, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Freeze the current contents of the range as a snapshot
+ *
+ * @param snap Pointer to the handle
+ * @return true if successful, false if snap is NULL or a snapshot is already active
+ */
+bool mram_snapshot_begin(struct mram_snapshot* snap);
+
+/**
+ * @brief Stream the next chunk of the active snapshot
+ *
+ * @param snap Pointer to the handle
+ * @param buffer Destination of at least chunk_size bytes
+ * @param offset Receives the offset of the chunk within the range
+ * @param len Receives the chunk length, 0 once the whole image has been streamed
+ * @return true if successful, false if no snapshot is active or communication fails
+ */
+bool mram_snapshot_next(struct mram_snapshot* snap, void* buffer, uint32_t* offset, uint32_t* len);
+
+/**
+ * @brief Finish or abandon the active snapshot and free preserved chunks
+ *
+ * @param snap Pointer to the handle
+ */
+void mram_snapshot_end(struct mram_snapshot* snap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_SNAPSHOT_H
@@ -0,0 +1,245 @@
+/**
+ * @file mram_span.hpp
+ * @brief C++20 span and range overloads for MRAM transfers
+ *
+ * Overloads of read() and write() in mram_interface take the following,
+ * with no pointer and length pairs:
+ *
+ * - a std::span of bytes;
+ * - any contiguous sized range of a trivially copyable type, such as
+ *   std::vector<T>, std::array<T, N> or a C array;
+ * - a sequence of buffers that maps onto consecutive device addresses;
+ * - a sequence of segments, each with its own address.
+ *
+ * Every overload goes through the vector operations. Data moves directly
+ * between user memory and the transport, with no staging copy or heap
+ * allocation. Adjacent buffers share a frame, and a write sequence runs
+ * under one WREN.
+ *
+ * Sequences are translated to iovecs in fixed-size batches on the stack.
+ * Only sequences longer than span_batch buffers are split into more than one
+ * vector call. Empty buffers inside a sequence are skipped.
+ *
+ * The device can be a struct mram or any device<Transport> from
+ * mram_device.hpp.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_SPAN_HPP
+#define MRAM_INTERFACE_MRAM_SPAN_HPP
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include "mram_device.hpp"
+
+namespace mram_interface {
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Buffers translated per vector call */
+inline constexpr size_t span_batch = 32;
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Buffer at its own device address
+ */
+template <class Byte>
+struct basic_segment {
+    /** @brief Device address */
+    uint32_t addr;
+    /** @brief User memory */
+    std::span<Byte> data;
+};
+
+/** @brief Segment to read into */
+using read_segment = basic_segment<std::byte>;
+/** @brief Segment to write from */
+using write_segment = basic_segment<const std::byte>;
+
+/*******************************************************************************
+ * Concepts
+ ******************************************************************************/
+namespace detail {
+
+inline bool read_vector(::mram& dev, const mram_iovec* iov, size_t count) {
+    return mram_read_vector(&dev, iov, count);
+}
+
+inline bool write_vector(::mram& dev, const mram_iovec* iov, size_t count) {
+    return mram_write_vector(&dev, iov, count);
+}
+
+template <class Transport>
+bool read_vector(device<Transport>& dev, const mram_iovec* iov, size_t count) {
+    return dev.read_vector(iov, count);
+}
+
+template <class Transport>
+bool write_vector(device<Transport>& dev, const mram_iovec* iov, size_t count) {
+    return dev.write_vector(iov, count);
+}
+
+// Feed iovecs made from each item to submit, span_batch at a time
+template <class Range, class Make, class Submit>
+bool batched(Range&& range, Make make, Submit submit) {
+    std::array<mram_iovec, span_batch> iov;
+    size_t n = 0;
+    for (auto&& item : range) {
+        mram_iovec v = make(item);
+        if (v.len == 0) continue;
+        iov[n++] = v;
+        if (n == iov.size()) {
+            if (!submit(iov.data(), n)) return false;
+            n = 0;
+        }
+    }
+    return n == 0 || submit(iov.data(), n);
+}
+
+}  // namespace detail
+
+/** @brief Anything read() and write() can drive */
+template <class D>
+concept transfer_device = requires(D& dev, const mram_iovec* iov, size_t n) {
+    { detail::read_vector(dev, iov, n) } -> std::same_as<bool>;
+    { detail::write_vector(dev, iov, n) } -> std::same_as<bool>;
+};
+
+/** @brief Sequence of buffers, each convertible to a span of Byte */
+template <class R, class Byte>
+concept buffer_sequence = std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>,
+                                                                              std::span<Byte>>;
+
+/** @brief Sequence of addressed segments */
+template <class R, class Byte>
+concept segment_sequence = std::ranges::input_range<R> &&
+    std::convertible_to<std::ranges::range_reference_t<R>, basic_segment<Byte>>;
+
+/** @brief Contiguous sized range of trivially copyable objects that is not a buffer or segment sequence */
+template <class R>
+concept object_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+    std::is_trivially_copyable_v<std::ranges::range_value_t<R>> &&
+    !buffer_sequence<R, const std::byte> && !segment_sequence<R, const std::byte>;
+
+/*******************************************************************************
+ * Transfers
+ ******************************************************************************/
+/**
+ * @brief Read into a byte span
+ *
+ * @return true if successful, false if the span is empty, out of range or communication fails
+ */
+template <transfer_device Device>
+bool read(Device& dev, uint32_t addr, std::span<std::byte> buffer) {
+    mram_iovec iov = { addr, buffer.data(), buffer.size() };
+    return detail::read_vector(dev, &iov, 1);
+}
+
+/**
+ * @brief Write a byte span
+ *
+ * @return true if successful, false if the span is empty, out of range or communication fails
+ */
+template <transfer_device Device>
+bool write(Device& dev, uint32_t addr, std::span<const std::byte> data) {
+    mram_iovec iov = { addr, const_cast<std::byte*>(data.data()), data.size() };
+    return detail::write_vector(dev, &iov, 1);
+}
+
+/**
+ * @brief Read a contiguous range of trivially copyable objects
+ */
+template <transfer_device Device, object_range R>
+    requires(!std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<R>>>)
+bool read(Device& dev, uint32_t addr, R&& range) {
+    return read(dev, addr, std::as_writable_bytes(std::span(std::ranges::data(range), std::ranges::size(range))));
+}
+
+/**
+ * @brief Write a contiguous range of trivially copyable objects
+ */
+template <transfer_device Device, object_range R>
+bool write(Device& dev, uint32_t addr, R&& range) {
+    return write(dev, addr, std::as_bytes(std::span(std::ranges::data(range), std::ranges::size(range))));
+}
+
+/**
+ * @brief Scatter consecutive device bytes starting at addr into a sequence of buffers
+ *
+ * @return true if successful (including an empty sequence), false otherwise
+ */
+template <transfer_device Device, buffer_sequence<std::byte> R>
+bool read(Device& dev, uint32_t addr, R&& buffers) {
+    return detail::batched(
+        buffers,
+        [&addr](std::span<std::byte> b) {
+            mram_iovec v = { addr, b.data(), b.size() };
+            addr += static_cast<uint32_t>(b.size());
+            return v;
+        },
+        [&dev](const mram_iovec* iov, size_t n) { return detail::read_vector(dev, iov, n); });
+}
+
+/**
+ * @brief Gather a sequence of buffers into consecutive device bytes starting at addr
+ *
+ * @return true if successful (including an empty sequence), false otherwise
+ */
+template <transfer_device Device, buffer_sequence<const std::byte> R>
+    requires(!object_range<R>)
+bool write(Device& dev, uint32_t addr, R&& buffers) {
+    return detail::batched(
+        buffers,
+        [&addr](std::span<const std::byte> b) {
+            mram_iovec v = { addr, const_cast<std::byte*>(b.data()), b.size() };
+            addr += static_cast<uint32_t>(b.size());
+            return v;
+        },
+        [&dev](const mram_iovec* iov, size_t n) { return detail::write_vector(dev, iov, n); });
+}
+
+/**
+ * @brief Read a sequence of addressed segments
+ *
+ * @return true if successful (including an empty sequence), false otherwise
+ */
+template <transfer_device Device, segment_sequence<std::byte> R>
+bool read(Device& dev, R&& segments) {
+    return detail::batched(
+        segments,
+        [](const read_segment& s) { return mram_iovec{ s.addr, s.data.data(), s.data.size() }; },
+        [&dev](const mram_iovec* iov, size_t n) { return detail::read_vector(dev, iov, n); });
+}
+
+/**
+ * @brief Write a sequence of addressed segments; later segments win where they overlap
+ *
+ * @return true if successful (including an empty sequence), false otherwise
+ */
+template <transfer_device Device, segment_sequence<const std::byte> R>
+bool write(Device& dev, R&& segments) {
+    return detail::batched(
+        segments,
+        [](const write_segment& s) {
+            return mram_iovec{ s.addr, const_cast<std::byte*>(s.data.data()), s.data.size() };
+        },
+        [&dev](const mram_iovec* iov, size_t n) { return detail::write_vector(dev, iov, n); });
+}
+
+}  // namespace mram_interface
+
+#endif //MRAM_INTERFACE_MRAM_SPAN_HPP
@@ -0,0 +1,103 @@
+#include "mram_stripe.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool stripe_transfer(struct mram_stripe* stripe, uint32_t addr, uint8_t* buf, size_t len, bool write) {
+    if (stripe == NULL || stripe->count == 0 || buf == NULL || len == 0) return false;
+    if (addr >= stripe->size || len > stripe->size - addr) return false;
+
+    uint32_t n = stripe->count;
+    uint32_t unit = stripe->unit;
+    uint32_t first = addr / unit;
+    uint32_t last = (uint32_t)((addr + len - 1) / unit);
+    size_t units = (size_t)last - first + 1;
+
+    struct mram_iovec* iov = malloc(units * sizeof(*iov));
+    if (iov == NULL) return false;
+
+    // Group the segments by device; consecutive units of one device are
+    // adjacent on that device and merge into a single frame
+    uint32_t start[MRAM_STRIPE_MAX_DEVICES] = { 0 };
+    uint32_t fill[MRAM_STRIPE_MAX_DEVICES] = { 0 };
+    for (uint32_t u = first; u <= last; u++) start[u % n]++;
+    for (uint32_t d = 0, sum = 0; d < n; d++) {
+        uint32_t cnt = start[d];
+        start[d] = sum;
+        sum += cnt;
+    }
+
+    uint32_t end = (uint32_t)(addr + len);
+    for (uint32_t u = first; u <= last; u++) {
+        uint32_t lo = u == first ? addr : u * unit;
+        uint32_t hi = u == last ? end : (u + 1) * unit;
+        uint32_t d = u % n;
+        struct mram_iovec* seg = &iov[start[d] + fill[d]++];
+        seg->addr = stripe->base + (u / n) * unit + (lo - u * unit);
+        seg->buf = buf + (lo - addr);
+        seg->len = hi - lo;
+    }
+
+    struct mram_worker_job jobs[MRAM_STRIPE_MAX_DEVICES];
+    struct mram_worker_batch batch;
+    uint32_t active = 0;
+    for (uint32_t d = 0; d < n; d++) active += fill[d] != 0;
+    mram_worker_batch_init(&batch, active);
+
+    for (uint32_t d = 0; d < n; d++) {
+        if (fill[d] == 0) continue;
+        jobs[d].write = write;
+        jobs[d].iov = &iov[start[d]];
+        jobs[d].count = fill[d];
+        jobs[d].batch = &batch;
+        mram_worker_submit(&stripe->workers[d], &jobs[d]);
+    }
+
+    bool ok = mram_worker_batch_wait(&batch);
+    free(iov);
+    return ok;
+}
+
+bool mram_stripe_init(struct mram_stripe* stripe, struct mram* const* devices, uint32_t count,
+                      const struct mram_stripe_config* config) {
+    if (stripe == NULL || devices == NULL || config == NULL) return false;
+    if (count == 0 || count > MRAM_STRIPE_MAX_DEVICES || config->stripe_unit == 0) return false;
+    if (config->base > MRAM_MAX_ADDRESS) return false;
+
+    uint32_t device_size = config->device_size ? config->device_size : MRAM_SIZE_BYTES - config->base;
+    if (device_size > MRAM_SIZE_BYTES - config->base) return false;
+    uint32_t units = device_size / config->stripe_unit;
+    if (units == 0) return false;
+
+    memset(stripe, 0, sizeof(*stripe));
+    stripe->unit = config->stripe_unit;
+    stripe->base = config->base;
+    stripe->size = count * units * config->stripe_unit;
+
+    for (uint32_t d = 0; d < count; d++) {
+        int cpu = config->cpus ? config->cpus[d] : MRAM_WORKER_ANY_CPU;
+        if (devices[d] == NULL || !mram_worker_start(&stripe->workers[d], devices[d], cpu)) {
+            mram_stripe_deinit(stripe);
+            return false;
+        }
+        stripe->count++;
+    }
+    return true;
+}
+
+void mram_stripe_deinit(struct mram_stripe* stripe) {
+    if (stripe == NULL) return;
+    for (uint32_t d = 0; d < stripe->count; d++) mram_worker_stop(&stripe->workers[d]);
+    stripe->count = 0;
+}
+
+bool mram_stripe_read(struct mram_stripe* stripe, uint32_t addr, void* buffer, size_t len) {
+    return stripe_transfer(stripe, addr, buffer, len, false);
+}
+
+bool mram_stripe_write(struct mram_stripe* stripe, uint32_t addr, const void* data, size_t len) {
+    return stripe_transfer(stripe, addr, (uint8_t*)data, len, true);
+}
+
+uint32_t mram_stripe_size(const struct mram_stripe* stripe) {
+    return stripe ? stripe->size : 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file mram_stripe.h
+ * @brief Striped (RAID-0) volume across several MRAM devices
+ *
+ * Presents N devices, each on its own bus, as one address space. The
+ * volume is cut into stripe units that are dealt round-robin across the
+ * devices. A request is split into one job per device it touches, and
+ * every device runs its job on its own worker thread, so large transfers
+ * keep all buses busy at once. The stripe units a request covers on one
+ * device are contiguous there, so each device serves its whole share with
+ * a single READ or WRITE frame.
+ *
+ * Address mapping for stripe unit u:
+ *   device = u % N, device address = base + (u / N) * stripe_unit
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_STRIPE_H
+#define MRAM_INTERFACE_MRAM_STRIPE_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram_worker.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Maximum number of devices in a volume */
+#define MRAM_STRIPE_MAX_DEVICES 16
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Striped volume configuration
+ */
+struct mram_stripe_config {
+    /** @brief Stripe unit in bytes */
+    uint32_t stripe_unit;
+    /** @brief First address used on every device */
+    uint32_t base;
+    /** @brief Bytes used on every device (0 = up to the end of the device) */
+    uint32_t device_size;
+    /** @brief CPU for each device's worker thread, or NULL for no affinity */
+    const int* cpus;
+};
+
+/**
+ * @brief Striped volume handle
+ */
+struct mram_stripe {
+    /** @brief One worker per device */
+    struct mram_worker workers[MRAM_STRIPE_MAX_DEVICES];
+    /** @brief Number of devices */
+    uint32_t count;
+    /** @brief Stripe unit */
+    uint32_t unit;
+    /** @brief First address used on every device */
+    uint32_t base;
+    /** @brief Volume size in bytes */
+    uint32_t size;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a striped volume and start its worker threads
+ *
+ * The volume holds as many whole stripe units as fit on every device, so
+ * its size is count * (device_size / stripe_unit) * stripe_unit.
+ *
+ * @param stripe Pointer to the handle to initialize
+ * @param devices Initialized MRAM devices, owned by the volume until deinit
+ * @param count Number of devices (1..MRAM_STRIPE_MAX_DEVICES)
+ * @param config Volume configuration
+ * @return true if successful, false if parameters are invalid or a worker
+ *         cannot be started
+ */
+bool mram_stripe_init(struct mram_stripe* stripe, struct mram* const* devices, uint32_t count,
+                      const struct mram_stripe_config* config);
+
+/**
+ * @brief Stop the worker threads
+ *
+ * @param stripe Pointer to the handle
+ */
+void mram_stripe_deinit(struct mram_stripe* stripe);
+
+/**
+ * @brief Read from the volume
+ *
+ * @param stripe Pointer to the handle
+ * @param addr Volume address
+ * @param buffer Destination buffer
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid, allocation
+ *         fails or any device fails
+ */
+bool mram_stripe_read(struct mram_stripe* stripe, uint32_t addr, void* buffer, size_t len);
+
+/**
+ * @brief Write to the volume
+ *
+ * @param stripe Pointer to the handle
+ * @param addr Volume address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if successful, false if the range is invalid, allocation
+ *         fails or any device fails (other devices may have been written)
+ */
+bool mram_stripe_write(struct mram_stripe* stripe, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Get the volume size
+ *
+ * @param stripe Pointer to the handle
+ * @return Size in bytes, 0 if stripe is NULL
+ */
+uint32_t mram_stripe_size(const struct mram_stripe* stripe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_STRIPE_H
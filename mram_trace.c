@@ -0,0 +1,418 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, clock_nanosleep
+#include "mram_trace.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static atomic_uint trace_threads;
+static _Thread_local uint16_t trace_thread;
+
+static uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t trace_saturate(uint64_t value) {
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+static bool trace_is_vector(uint8_t op) {
+    return op == MRAM_OP_READ_VECTOR || op == MRAM_OP_WRITE_VECTOR;
+}
+
+static void trace_enter(struct mram_hook* hook, struct mram_call* call) {
+    (void)hook;
+    call->cookie = trace_now();
+}
+
+static void trace_leave(struct mram_hook* hook, struct mram_call* call, bool ok) {
+    struct mram_trace* trace = (struct mram_trace*)hook;
+    uint64_t end = trace_now();
+    size_t count = call->iov ? call->count : 0;
+
+    if (trace_thread == 0) trace_thread = (uint16_t)(atomic_fetch_add(&trace_threads, 1) + 1);
+
+    struct mram_trace_record rec = { 0 };
+    rec.time_ns = call->cookie - trace->base_ns;
+    rec.duration_ns = trace_saturate(end - call->cookie);
+    rec.thread = trace_thread;
+    rec.op = call->op;
+    rec.flags = ok ? MRAM_TRACE_FLAG_OK : 0;
+    if (trace_is_vector(call->op)) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++) total += call->iov[i].len;
+        rec.addr = trace_saturate(count);
+        rec.len = trace_saturate(total);
+        count = rec.addr;
+    } else if (call->op == MRAM_OP_READ_STATUS || call->op == MRAM_OP_WRITE_STATUS) {
+        rec.addr = call->status;
+    } else {
+        rec.addr = call->addr;
+        rec.len = trace_saturate(call->len);
+    }
+
+    pthread_mutex_lock(&trace->lock);
+    bool written = fwrite(&rec, sizeof(rec), 1, trace->file) == 1;
+    for (size_t i = 0; written && trace_is_vector(rec.op) && i < count; i++) {
+        struct mram_trace_segment seg = { call->iov[i].addr, trace_saturate(call->iov[i].len) };
+        written = fwrite(&seg, sizeof(seg), 1, trace->file) == 1;
+    }
+    if (written) {
+        trace->records++;
+    } else {
+        trace->failed = true;
+    }
+    pthread_mutex_unlock(&trace->lock);
+}
+
+bool mram_trace_start(struct mram_trace* trace, struct mram* mram, const char* path) {
+    if (trace == NULL || mram == NULL || path == NULL || mram->hook != NULL) return false;
+
+    memset(trace, 0, sizeof(*trace));
+    trace->file = fopen(path, "wb");
+    if (trace->file == NULL) return false;
+    setvbuf(trace->file, NULL, _IOFBF, 64 * 1024);
+
+    struct mram_trace_file_header header = { MRAM_TRACE_MAGIC, MRAM_TRACE_VERSION, sizeof(struct mram_trace_record) };
+    if (fwrite(&header, sizeof(header), 1, trace->file) != 1 || pthread_mutex_init(&trace->lock, NULL) != 0) {
+        fclose(trace->file);
+        return false;
+    }
+
+    trace->hook.enter = trace_enter;
+    trace->hook.leave = trace_leave;
+    trace->mram = mram;
+    trace->base_ns = trace_now();
+    mram->hook = &trace->hook;
+    return true;
+}
+
+bool mram_trace_stop(struct mram_trace* trace) {
+    if (trace == NULL || trace->file == NULL) return false;
+
+    if (trace->mram->hook == &trace->hook) trace->mram->hook = NULL;
+    bool ok = !trace->failed && fflush(trace->file) == 0;
+    if (fclose(trace->file) != 0) ok = false;
+    pthread_mutex_destroy(&trace->lock);
+    trace->file = NULL;
+    return ok;
+}
+
+// Growable latency sample list of one operation
+struct replay_samples {
+    uint64_t* ns;
+    size_t count;
+    size_t cap;
+};
+
+static bool replay_sample(struct replay_samples* s, uint64_t ns) {
+    if (s->count == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 1024;
+        uint64_t* p = realloc(s->ns, cap * sizeof(*p));
+        if (p == NULL) return false;
+        s->ns = p;
+        s->cap = cap;
+    }
+    s->ns[s->count++] = ns;
+    return true;
+}
+
+static int replay_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void replay_percentiles(struct replay_samples* s, struct mram_replay_op_stats* stats) {
+    if (s->count == 0) return;
+    qsort(s->ns, s->count, sizeof(*s->ns), replay_compare);
+    stats->min_ns = s->ns[0];
+    stats->p50_ns = s->ns[(s->count - 1) * 50 / 100];
+    stats->p90_ns = s->ns[(s->count - 1) * 90 / 100];
+    stats->p99_ns = s->ns[(s->count - 1) * 99 / 100];
+    stats->max_ns = s->ns[s->count - 1];
+}
+
+static void replay_wait(uint64_t deadline_ns) {
+    if (trace_now() >= deadline_ns) return;
+    struct timespec ts = { (time_t)(deadline_ns / 1000000000u), (long)(deadline_ns % 1000000000u) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// Issue one captured call; every segment shares the scratch buffer
+static bool replay_call(struct mram* mram, const struct mram_trace_record* rec, uint8_t* buffer,
+                        const struct mram_trace_segment* segs, struct mram_iovec* iov) {
+    uint8_t status;
+
+    switch (rec->op) {
+        case MRAM_OP_WRITE_ENABLE:
+            return mram_write_enable(mram);
+        case MRAM_OP_WRITE_DISABLE:
+            return mram_write_disable(mram);
+        case MRAM_OP_READ:
+            return rec->len <= MRAM_SIZE_BYTES && mram_read(mram, rec->addr, buffer, rec->len);
+        case MRAM_OP_WRITE:
+            return rec->len <= MRAM_SIZE_BYTES && mram_write(mram, rec->addr, buffer, rec->len);
+        case MRAM_OP_READ_VECTOR:
+        case MRAM_OP_WRITE_VECTOR:
+            for (uint32_t i = 0; i < rec->addr; i++) {
+                if (segs[i].len > MRAM_SIZE_BYTES) return false;
+                iov[i] = (struct mram_iovec){ segs[i].addr, buffer, segs[i].len };
+            }
+            if (rec->op == MRAM_OP_READ_VECTOR) return mram_read_vector(mram, iov, rec->addr);
+            return mram_write_vector(mram, iov, rec->addr);
+        case MRAM_OP_SLEEP:
+            return mram_sleep(mram);
+        case MRAM_OP_WAKE:
+            return mram_wake(mram);
+        case MRAM_OP_READ_STATUS:
+            return mram_read_status_register(mram, &status);
+        case MRAM_OP_WRITE_STATUS:
+            return mram_write_status_register(mram, (uint8_t)rec->addr);
+        default:
+            return false;
+    }
+}
+
+// Trace loaded into memory; the segments of vector records follow each
+// other in segs, starting at seg_at[record]
+struct replay_trace {
+    struct mram_trace_record* recs;
+    size_t* seg_at;
+    size_t count;
+    struct mram_trace_segment* segs;
+    size_t seg_count;
+    uint64_t captured_ns;
+};
+
+// State every replay thread reads; lock serializes the device calls
+struct replay_shared {
+    struct mram* mram;
+    const struct replay_trace* trace;
+    uint8_t* buffer;
+    pthread_mutex_t lock;
+    bool paced;
+    uint64_t start;
+};
+
+// Calls of one captured thread, in file order, and what replaying them measured
+struct replay_stream {
+    struct replay_shared* shared;
+    uint16_t thread;
+    size_t* index;
+    size_t count;
+    struct mram_iovec* iov;
+    size_t iov_cap;
+    struct mram_replay_report report;
+    struct replay_samples samples[MRAM_TRACE_OPS];
+    bool ok;
+};
+
+static void replay_free_trace(struct replay_trace* trace) {
+    free(trace->recs);
+    free(trace->seg_at);
+    free(trace->segs);
+}
+
+static bool replay_load(FILE* file, struct replay_trace* trace) {
+    size_t cap = 0, seg_cap = 0;
+    struct mram_trace_record rec;
+
+    memset(trace, 0, sizeof(*trace));
+    // A partial record at the end (capture cut short) ends the trace
+    while (fread(&rec, sizeof(rec), 1, file) == 1) {
+        if (rec.op == 0 || rec.op >= MRAM_TRACE_OPS) return false;
+        size_t nsegs = trace_is_vector(rec.op) ? rec.addr : 0;
+        if (trace->count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            struct mram_trace_record* r = realloc(trace->recs, cap * sizeof(*r));
+            if (r) trace->recs = r;
+            size_t* a = r ? realloc(trace->seg_at, cap * sizeof(*a)) : NULL;
+            if (a) trace->seg_at = a;
+            if (r == NULL || a == NULL) return false;
+        }
+        if (trace->seg_count + nsegs > seg_cap) {
+            while (trace->seg_count + nsegs > seg_cap) seg_cap = seg_cap ? seg_cap * 2 : 1024;
+            struct mram_trace_segment* sg = realloc(trace->segs, seg_cap * sizeof(*sg));
+            if (sg == NULL) return false;
+            trace->segs = sg;
+        }
+        if (fread(trace->segs + trace->seg_count, sizeof(*trace->segs), nsegs, file) != nsegs) break;
+
+        trace->recs[trace->count] = rec;
+        trace->seg_at[trace->count++] = trace->seg_count;
+        trace->seg_count += nsegs;
+        if (rec.time_ns + rec.duration_ns > trace->captured_ns) trace->captured_ns = rec.time_ns + rec.duration_ns;
+    }
+    return true;
+}
+
+static void* replay_thread(void* arg) {
+    struct replay_stream* stream = arg;
+    struct replay_shared* shared = stream->shared;
+    const struct replay_trace* trace = shared->trace;
+
+    for (size_t i = 0; stream->ok && i < stream->count; i++) {
+        size_t n = stream->index[i];
+        const struct mram_trace_record* rec = &trace->recs[n];
+
+        if (shared->paced) replay_wait(shared->start + rec->time_ns);
+        // Waiting for the lock counts as latency, like contention on the device did
+        uint64_t t0 = trace_now();
+        pthread_mutex_lock(&shared->lock);
+        bool result = replay_call(shared->mram, rec, shared->buffer, trace->segs + trace->seg_at[n], stream->iov);
+        pthread_mutex_unlock(&shared->lock);
+        uint64_t t1 = trace_now();
+
+        struct mram_replay_op_stats* stats = &stream->report.ops[rec->op];
+        stats->count++;
+        stream->report.calls++;
+        if (result) {
+            stats->bytes += rec->len;
+            stream->report.bytes += rec->len;
+        } else {
+            stats->errors++;
+        }
+        if (result != ((rec->flags & MRAM_TRACE_FLAG_OK) != 0)) stream->report.mismatches++;
+        stream->ok = replay_sample(&stream->samples[rec->op], t1 - t0);
+    }
+    return NULL;
+}
+
+// Split the trace into one stream per captured thread
+static struct replay_stream* replay_split(const struct replay_trace* trace, struct replay_shared* shared,
+                                          size_t* count) {
+    uint32_t* slot = calloc(UINT16_MAX + 1, sizeof(*slot));
+    struct replay_stream* streams = NULL;
+    size_t n = 0;
+    bool ok = slot != NULL;
+
+    for (size_t i = 0; ok && i < trace->count; i++) {
+        const struct mram_trace_record* rec = &trace->recs[i];
+        if (slot[rec->thread] == 0) {
+            struct replay_stream* s = realloc(streams, (n + 1) * sizeof(*s));
+            if (s == NULL) {
+                ok = false;
+                break;
+            }
+            streams = s;
+            memset(&streams[n], 0, sizeof(streams[n]));
+            streams[n].shared = shared;
+            streams[n].thread = rec->thread;
+            streams[n].ok = true;
+            slot[rec->thread] = (uint32_t)++n;
+        }
+        struct replay_stream* stream = &streams[slot[rec->thread] - 1];
+        stream->count++;
+        if (trace_is_vector(rec->op) && rec->addr > stream->iov_cap) stream->iov_cap = rec->addr;
+    }
+    for (size_t s = 0; ok && s < n; s++) {
+        streams[s].index = malloc((streams[s].count ? streams[s].count : 1) * sizeof(size_t));
+        streams[s].iov = malloc((streams[s].iov_cap ? streams[s].iov_cap : 1) * sizeof(struct mram_iovec));
+        if (streams[s].index == NULL || streams[s].iov == NULL) ok = false;
+        streams[s].count = 0;
+    }
+    for (size_t i = 0; ok && i < trace->count; i++) {
+        struct replay_stream* stream = &streams[slot[trace->recs[i].thread] - 1];
+        stream->index[stream->count++] = i;
+    }
+    free(slot);
+
+    if (!ok) {
+        for (size_t s = 0; s < n; s++) {
+            free(streams[s].index);
+            free(streams[s].iov);
+        }
+        free(streams);
+        return NULL;
+    }
+    *count = n;
+    return streams;
+}
+
+// Add the results of a stream to the report and its samples to the totals
+static bool replay_merge(struct mram_replay_report* report, struct replay_samples* totals,
+                         const struct replay_stream* stream) {
+    report->calls += stream->report.calls;
+    report->bytes += stream->report.bytes;
+    report->mismatches += stream->report.mismatches;
+    for (size_t i = 0; i < MRAM_TRACE_OPS; i++) {
+        const struct mram_replay_op_stats* from = &stream->report.ops[i];
+        report->ops[i].count += from->count;
+        report->ops[i].bytes += from->bytes;
+        report->ops[i].errors += from->errors;
+        for (size_t k = 0; k < stream->samples[i].count; k++) {
+            if (!replay_sample(&totals[i], stream->samples[i].ns[k])) return false;
+        }
+    }
+    return true;
+}
+
+bool mram_trace_replay(struct mram* mram, const char* path, bool paced, struct mram_replay_report* report) {
+    if (mram == NULL || path == NULL || report == NULL) return false;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    struct mram_trace_file_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != MRAM_TRACE_MAGIC ||
+        header.version != MRAM_TRACE_VERSION || header.record_size != sizeof(struct mram_trace_record)) {
+        fclose(file);
+        return false;
+    }
+
+    struct replay_trace trace;
+    bool ok = replay_load(file, &trace);
+    fclose(file);
+
+    struct replay_shared shared = { .mram = mram, .trace = &trace, .paced = paced };
+    struct replay_stream* streams = NULL;
+    size_t count = 0;
+    shared.buffer = ok ? malloc(MRAM_SIZE_BYTES) : NULL;
+    bool locked = shared.buffer != NULL && pthread_mutex_init(&shared.lock, NULL) == 0;
+    ok = locked;
+    if (ok) {
+        memset(shared.buffer, 0xA5, MRAM_SIZE_BYTES);
+        streams = replay_split(&trace, &shared, &count);
+        if (streams == NULL && trace.count > 0) ok = false;
+    }
+
+    memset(report, 0, sizeof(*report));
+    report->captured_ns = trace.captured_ns;
+    pthread_t* threads = ok ? malloc((count ? count : 1) * sizeof(*threads)) : NULL;
+    size_t started = 0;
+    shared.start = trace_now();
+    if (threads == NULL) ok = false;
+    for (; ok && started < count; started++) {
+        if (pthread_create(&threads[started], NULL, replay_thread, &streams[started]) != 0) {
+            // Let the threads already running finish
+            ok = false;
+            break;
+        }
+    }
+    for (size_t s = 0; s < started; s++) pthread_join(threads[s], NULL);
+    report->elapsed_ns = trace_now() - shared.start;
+    report->threads = (uint32_t)started;
+
+    struct replay_samples samples[MRAM_TRACE_OPS] = { { 0 } };
+    for (size_t s = 0; s < count; s++) {
+        ok = ok && streams[s].ok && replay_merge(report, samples, &streams[s]);
+        for (size_t i = 0; i < MRAM_TRACE_OPS; i++) free(streams[s].samples[i].ns);
+        free(streams[s].index);
+        free(streams[s].iov);
+    }
+    for (size_t i = 0; i < MRAM_TRACE_OPS; i++) {
+        replay_percentiles(&samples[i], &report->ops[i]);
+        free(samples[i].ns);
+    }
+    if (locked) pthread_mutex_destroy(&shared.lock);
+    free(shared.buffer);
+    free(threads);
+    free(streams);
+    replay_free_trace(&trace);
+    return ok;
+}
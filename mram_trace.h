@@ -0,0 +1,204 @@
+/**
+ * @file mram_trace.h
+ * @brief Workload capture and replay
+ *
+ * mram_trace_start() installs a hook (see struct mram_hook) on a device and
+ * appends one record per public API call to a binary trace file. Each
+ * record holds the operation, address, length, start time, duration and
+ * calling thread. Vector calls are followed by their segment list. Only
+ * the access pattern is captured, not the data.
+ *
+ * mram_trace_replay() issues the calls of a trace against any struct
+ * mram: the simulator, the file backend or hardware. Every captured thread
+ * gets a replay thread of its own that issues that thread's calls in file
+ * order, so a multi-threaded workload contends for the device again. The
+ * calls reach the device one at a time through a mutex, and the time spent
+ * waiting for it is part of the measured latency. The replay runs either as
+ * fast as possible or at the original pace, and it reports throughput and
+ * latency percentiles per operation, so driver versions and cache settings
+ * can be compared on a real workload. The mram_replay tool wraps it for
+ * the command line.
+ *
+ * File layout: a struct mram_trace_file_header, then records. A record of
+ * a vector operation is followed by addr struct mram_trace_segment entries.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_TRACE_H
+#define MRAM_INTERFACE_MRAM_TRACE_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <pthread.h>
+#include <stdio.h>
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief File magic, "MRTR" in little-endian byte order */
+#define MRAM_TRACE_MAGIC 0x5254524Du
+/** @brief File format version */
+#define MRAM_TRACE_VERSION 1
+/** @brief Record flag: the call returned true */
+#define MRAM_TRACE_FLAG_OK 0x01
+/** @brief Size of the per-operation statistics table (indexed by enum mram_op) */
+#define MRAM_TRACE_OPS (MRAM_OP_WRITE_STATUS + 1)
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Trace file header
+ */
+struct mram_trace_file_header {
+    /** @brief MRAM_TRACE_MAGIC */
+    uint32_t magic;
+    /** @brief MRAM_TRACE_VERSION */
+    uint16_t version;
+    /** @brief sizeof(struct mram_trace_record) */
+    uint16_t record_size;
+};
+
+/**
+ * @brief One captured call
+ */
+struct mram_trace_record {
+    /** @brief Start time in nanoseconds since the capture started */
+    uint64_t time_ns;
+    /** @brief Call duration in nanoseconds (saturated) */
+    uint32_t duration_ns;
+    /** @brief Device address; status value for status ops; segment count for vector ops */
+    uint32_t addr;
+    /** @brief Bytes transferred (sum of the segments for vector ops) */
+    uint32_t len;
+    /** @brief Capturing thread, numbered from 1 in order of first call */
+    uint16_t thread;
+    /** @brief Operation (enum mram_op) */
+    uint8_t op;
+    /** @brief MRAM_TRACE_FLAG_* */
+    uint8_t flags;
+};
+
+/**
+ * @brief Segment of a captured vector call
+ */
+struct mram_trace_segment {
+    /** @brief Device address */
+    uint32_t addr;
+    /** @brief Length in bytes */
+    uint32_t len;
+};
+
+/**
+ * @brief Capture handle
+ */
+struct mram_trace {
+    /** @brief Hook installed on the device (must stay the first member) */
+    struct mram_hook hook;
+    /** @brief Traced device */
+    struct mram* mram;
+    /** @brief Trace file */
+    FILE* file;
+    /** @brief Serializes records from concurrent threads */
+    pthread_mutex_t lock;
+    /** @brief Monotonic clock at capture start */
+    uint64_t base_ns;
+    /** @brief Records written */
+    uint64_t records;
+    /** @brief Set if a write to the file failed */
+    bool failed;
+};
+
+/**
+ * @brief Replay statistics of one operation
+ */
+struct mram_replay_op_stats {
+    /** @brief Calls replayed */
+    uint64_t count;
+    /** @brief Bytes transferred */
+    uint64_t bytes;
+    /** @brief Calls that returned false */
+    uint64_t errors;
+    /** @brief Latency percentiles and extremes in nanoseconds */
+    uint64_t min_ns, p50_ns, p90_ns, p99_ns, max_ns;
+};
+
+/**
+ * @brief Replay report
+ */
+struct mram_replay_report {
+    /** @brief Calls replayed */
+    uint64_t calls;
+    /** @brief Bytes transferred */
+    uint64_t bytes;
+    /** @brief Wall time of the replay in nanoseconds */
+    uint64_t elapsed_ns;
+    /** @brief Span of the capture in nanoseconds (first start to last end) */
+    uint64_t captured_ns;
+    /** @brief Calls whose result differs from the captured one */
+    uint64_t mismatches;
+    /** @brief Threads the calls were replayed from, one per captured thread */
+    uint32_t threads;
+    /** @brief Per-operation statistics, indexed by enum mram_op */
+    struct mram_replay_op_stats ops[MRAM_TRACE_OPS];
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start capturing the API calls of a device
+ *
+ * @param trace Pointer to the handle to initialize
+ * @param mram Pointer to an initialized MRAM interface structure without a hook
+ * @param path Trace file to create (truncated if it exists)
+ * @return true if successful, false if parameters are invalid, the device
+ *         already has a hook or the file cannot be created
+ */
+bool mram_trace_start(struct mram_trace* trace, struct mram* mram, const char* path);
+
+/**
+ * @brief Stop capturing, remove the hook and close the file
+ *
+ * No call may be in progress on the device.
+ *
+ * @param trace Pointer to the handle
+ * @return true if every record reached the file, false otherwise
+ */
+bool mram_trace_stop(struct mram_trace* trace);
+
+/**
+ * @brief Replay a trace against a device
+ *
+ * Writes send placeholder data and reads land in a scratch buffer; only
+ * the access pattern is reproduced. The calls of each captured thread run
+ * on a thread of their own; the order between threads is not reproduced,
+ * except as far as pacing restores it. The trace is read into memory
+ * first.
+ *
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param path Trace file
+ * @param paced true to start each call at its captured time, false to run
+ *        calls back to back
+ * @param report Receives the results
+ * @return true if the trace was replayed, false if parameters are invalid,
+ *         the file is not a trace, memory runs out or a thread cannot be
+ *         created
+ */
+bool mram_trace_replay(struct mram* mram, const char* path, bool paced, struct mram_replay_report* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_TRACE_H
@@ -0,0 +1,183 @@
+#include "mram_txn.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TXN_MAGIC       0x4A58544Du  // "MTXJ"
+#define TXN_FNV_OFFSET  2166136261u
+#define TXN_FNV_PRIME   16777619u
+
+static const uint8_t txn_zero[4] = { 0 };
+
+static void txn_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t txn_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t txn_fnv(uint32_t h, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= TXN_FNV_PRIME;
+    }
+    return h;
+}
+
+static uint32_t txn_check(const uint8_t* payload, uint32_t payload_len, const uint8_t* trailer) {
+    return txn_fnv(txn_fnv(TXN_FNV_OFFSET, payload, payload_len), trailer, 8);
+}
+
+static uint32_t txn_trailer_addr(const struct mram_txn* txn) {
+    return txn->journal_addr + txn->journal_size - MRAM_TXN_TRAILER_SIZE;
+}
+
+static bool txn_overlaps_journal(const struct mram_txn* txn, uint32_t addr, size_t len) {
+    return addr < txn->journal_addr + txn->journal_size && txn->journal_addr < addr + len;
+}
+
+// Build the apply segments for the entries in buffer[0..payload_len), then
+// issue journal (optional), apply frames and completion marker under one WREN.
+static bool txn_apply(struct mram_txn* txn, uint32_t payload_len, bool write_journal) {
+    size_t n = 0;
+
+    if (write_journal) {
+        txn->iov[n].addr = txn_trailer_addr(txn) - payload_len;
+        txn->iov[n].buf = txn->buffer;
+        txn->iov[n].len = payload_len + MRAM_TXN_TRAILER_SIZE;
+        n++;
+    }
+
+    for (uint32_t pos = 0; pos < payload_len;) {
+        if (payload_len - pos < MRAM_TXN_ENTRY_HEADER_SIZE || n > MRAM_TXN_MAX_RANGES) return false;
+        uint32_t addr = txn_get_u32(txn->buffer + pos);
+        uint32_t len = txn_get_u32(txn->buffer + pos + 4);
+        pos += MRAM_TXN_ENTRY_HEADER_SIZE;
+        if (len == 0 || len > payload_len - pos) return false;
+
+        txn->iov[n].addr = addr;
+        txn->iov[n].buf = txn->buffer + pos;
+        txn->iov[n].len = len;
+        n++;
+        pos += len;
+    }
+
+    txn->iov[n].addr = txn_trailer_addr(txn) + 12;
+    txn->iov[n].buf = (void*)txn_zero;
+    txn->iov[n].len = sizeof(txn_zero);
+    n++;
+
+    return mram_write_vector(txn->mram, txn->iov, n);
+}
+
+// Replay a committed journal left behind by an interrupted commit.
+static bool txn_recover(struct mram_txn* txn) {
+    uint8_t trailer[MRAM_TXN_TRAILER_SIZE];
+    if (!mram_read(txn->mram, txn_trailer_addr(txn), trailer, sizeof(trailer))) return false;
+
+    txn->seq = txn_get_u32(trailer + 4) + 1;
+    if (txn_get_u32(trailer + 12) != TXN_MAGIC) return true;
+
+    uint32_t payload_len = txn_get_u32(trailer);
+    struct mram_iovec journal = {
+        .addr = txn_trailer_addr(txn) - payload_len,
+        .buf = txn->buffer,
+        .len = payload_len,
+    };
+    if (payload_len == 0 || payload_len > txn->journal_size - MRAM_TXN_TRAILER_SIZE ||
+        !mram_read_vector(txn->mram, &journal, 1) ||
+        txn_check(txn->buffer, payload_len, trailer) != txn_get_u32(trailer + 8)) {
+        // Not a journal this code wrote; retire it rather than replaying garbage
+        return mram_write(txn->mram, txn_trailer_addr(txn) + 12, txn_zero, sizeof(txn_zero));
+    }
+
+    return txn_apply(txn, payload_len, false);
+}
+
+bool mram_txn_init(struct mram_txn* txn, struct mram* mram, uint32_t journal_addr, uint32_t journal_size) {
+    if (txn == NULL || mram == NULL) return false;
+    if (journal_size <= MRAM_TXN_TRAILER_SIZE + MRAM_TXN_ENTRY_HEADER_SIZE ||
+        journal_addr > MRAM_MAX_ADDRESS || journal_size > MRAM_SIZE_BYTES - journal_addr)
+        return false;
+
+    memset(txn, 0, sizeof(*txn));
+    txn->mram = mram;
+    txn->journal_addr = journal_addr;
+    txn->journal_size = journal_size;
+    txn->buffer = malloc(journal_size);
+    if (txn->buffer == NULL) return false;
+
+    if (!txn_recover(txn)) {
+        mram_txn_deinit(txn);
+        return false;
+    }
+    return true;
+}
+
+void mram_txn_deinit(struct mram_txn* txn) {
+    if (txn == NULL) return;
+    free(txn->buffer);
+    txn->buffer = NULL;
+    txn->active = false;
+}
+
+bool mram_txn_begin(struct mram_txn* txn) {
+    if (txn == NULL || txn->buffer == NULL || txn->active) return false;
+
+    // Finish a failed commit before its journal can be overwritten
+    if (txn->pending) {
+        if (!txn_recover(txn)) return false;
+        txn->pending = false;
+    }
+    txn->used = 0;
+    txn->count = 0;
+    txn->active = true;
+    return true;
+}
+
+bool mram_txn_write(struct mram_txn* txn, uint32_t addr, const void* data, size_t len) {
+    if (txn == NULL || !txn->active || data == NULL || len == 0) return false;
+    if (addr > MRAM_MAX_ADDRESS || len - 1 > MRAM_MAX_ADDRESS - addr) return false;
+    if (txn_overlaps_journal(txn, addr, len)) return false;
+    if (txn->count >= MRAM_TXN_MAX_RANGES) return false;
+
+    uint32_t capacity = txn->journal_size - MRAM_TXN_TRAILER_SIZE;
+    if (len > capacity || txn->used + MRAM_TXN_ENTRY_HEADER_SIZE > capacity - len) return false;
+
+    uint8_t* entry = txn->buffer + txn->used;
+    txn_put_u32(entry, addr);
+    txn_put_u32(entry + 4, (uint32_t)len);
+    memcpy(entry + MRAM_TXN_ENTRY_HEADER_SIZE, data, len);
+    txn->used += MRAM_TXN_ENTRY_HEADER_SIZE + (uint32_t)len;
+    txn->count++;
+    return true;
+}
+
+bool mram_txn_commit(struct mram_txn* txn) {
+    if (txn == NULL || !txn->active) return false;
+    txn->active = false;
+    if (txn->count == 0) return true;
+
+    // Trailer goes right after the entries so the journal is one frame
+    uint8_t* trailer = txn->buffer + txn->used;
+    txn_put_u32(trailer, txn->used);
+    txn_put_u32(trailer + 4, txn->seq++);
+    txn_put_u32(trailer + 8, txn_check(txn->buffer, txn->used, trailer));
+    txn_put_u32(trailer + 12, TXN_MAGIC);
+
+    if (!txn_apply(txn, txn->used, true)) {
+        txn->pending = true;
+        return false;
+    }
+    return true;
+}
+
+void mram_txn_abort(struct mram_txn* txn) {
+    if (txn == NULL) return;
+    txn->active = false;
+    txn->used = 0;
+    txn->count = 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file mram_txn.h
+ * @brief Atomic multi-range transactions with an on-device redo journal
+ *
+ * A transaction stages writes to arbitrary, possibly discontiguous ranges in
+ * RAM. On commit the staged writes are serialized into a redo journal that
+ * is written to a reserved MRAM region, applied to their target ranges and
+ * then marked complete. If power is lost at any point, mram_txn_init()
+ * either finds no complete journal (nothing was applied) or replays the
+ * journal (everything is applied).
+ *
+ * Because the MRAM has no write cycle delay, the whole commit is issued as a
+ * single vectored write: one WREN, the journal frame, one frame per run of
+ * adjacent target ranges, the completion frame and one WRDI.
+ *
+ * Journal layout (the image is right-aligned to the end of the region):
+ * Field        | Size      | Description
+ * -------------|-----------|------------------------------------------
+ * Entries      | variable  | ADDR(4) LEN(4) DATA(LEN), repeated
+ * PAYLOAD_LEN  | 4         | Total size of the entries
+ * SEQ          | 4         | Transaction sequence number
+ * CHECK        | 4         | Check over entries, length and sequence
+ * MAGIC        | 4         | Set when committed, cleared when complete
+ *
+ * The magic is the last byte of the journal frame, so a torn journal write
+ * never looks committed.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_TXN_H
+#define MRAM_INTERFACE_MRAM_TXN_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Maximum number of staged ranges per transaction */
+#define MRAM_TXN_MAX_RANGES 32
+/** @brief Size of the journal trailer in bytes */
+#define MRAM_TXN_TRAILER_SIZE 16
+/** @brief Size of the per-range entry header in bytes */
+#define MRAM_TXN_ENTRY_HEADER_SIZE 8
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Transaction context
+ *
+ * One context owns one journal region and runs one transaction at a time.
+ */
+struct mram_txn {
+    /** @brief Underlying MRAM device */
+    struct mram* mram;
+    /** @brief Journal region start address */
+    uint32_t journal_addr;
+    /** @brief Journal region size in bytes */
+    uint32_t journal_size;
+    /** @brief RAM image of the journal (journal_size bytes) */
+    uint8_t* buffer;
+    /** @brief Bytes of entries staged in buffer */
+    uint32_t used;
+    /** @brief Number of staged ranges */
+    uint16_t count;
+    /** @brief Sequence number of the next commit */
+    uint32_t seq;
+    /** @brief True between mram_txn_begin() and commit or abort */
+    bool active;
+    /** @brief True after a failed commit until its journal is replayed */
+    bool pending;
+    /** @brief Write vector: journal, staged ranges and completion marker */
+    struct mram_iovec iov[MRAM_TXN_MAX_RANGES + 2];
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a transaction context and recover an interrupted commit
+ *
+ * If the journal region holds a committed but not completed transaction, it
+ * is replayed before this function returns.
+ *
+ * @param txn Pointer to the transaction context to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param journal_addr Start address of the reserved journal region
+ * @param journal_size Size of the journal region in bytes
+ * @return true if successful, false if parameters are invalid, allocation
+ *         fails or communication fails
+ */
+bool mram_txn_init(struct mram_txn* txn, struct mram* mram, uint32_t journal_addr, uint32_t journal_size);
+
+/**
+ * @brief Release a transaction context
+ *
+ * @param txn Pointer to the transaction context
+ */
+void mram_txn_deinit(struct mram_txn* txn);
+
+/**
+ * @brief Start a new transaction
+ *
+ * If the previous commit on this context failed, its journal is replayed
+ * first, so that transaction is fully applied before a new one can start.
+ *
+ * @param txn Pointer to the transaction context
+ * @return true if successful, false if txn is NULL, a transaction is active
+ *         or replaying a failed commit fails
+ */
+bool mram_txn_begin(struct mram_txn* txn);
+
+/**
+ * @brief Stage a write in the active transaction
+ *
+ * The data is copied, so the caller's buffer may be reused immediately.
+ * Ranges may overlap; later writes win.
+ *
+ * @param txn Pointer to the transaction context
+ * @param addr Target start address
+ * @param data Data to write
+ * @param len Number of bytes
+ * @return true if staged, false if no transaction is active, the range is
+ *         invalid or overlaps the journal, or the journal is full
+ */
+bool mram_txn_write(struct mram_txn* txn, uint32_t addr, const void* data, size_t len);
+
+/**
+ * @brief Atomically apply all staged writes
+ *
+ * @param txn Pointer to the transaction context
+ * @return true if the transaction is durable and applied, false if no
+ *         transaction is active or communication fails. After a failure the
+ *         transaction is either fully applied or not at all once
+ *         mram_txn_init() or the next mram_txn_begin() runs.
+ */
+bool mram_txn_commit(struct mram_txn* txn);
+
+/**
+ * @brief Discard all staged writes
+ *
+ * @param txn Pointer to the transaction context
+ */
+void mram_txn_abort(struct mram_txn* txn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_TXN_H
@@ -0,0 +1,325 @@
+#include "mram_uring.h"
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+// Reaper polls of an empty completion ring before it blocks
+#define URING_WAIT_SPINS 128
+
+static void uring_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+static bool uring_range_valid(const struct mram_uring_sqe* sqe) {
+    return sqe->buf != NULL && sqe->len != 0 && sqe->addr <= MRAM_MAX_ADDRESS &&
+           sqe->len - 1 <= (size_t)(MRAM_MAX_ADDRESS - sqe->addr);
+}
+
+static int32_t uring_execute_one(struct mram* mram, const struct mram_uring_sqe* sqe) {
+    uint8_t status;
+    switch (sqe->op) {
+        case MRAM_URING_OP_NOP:
+            return 0;
+        case MRAM_URING_OP_READ_STATUS:
+            return mram_read_status_register(mram, &status) ? status : -EIO;
+        case MRAM_URING_OP_WRITE_STATUS:
+            if (sqe->addr > UINT8_MAX) return -EINVAL;
+            return mram_write_status_register(mram, (uint8_t)sqe->addr) ? 0 : -EIO;
+        case MRAM_URING_OP_SLEEP:
+            return mram_sleep(mram) ? 0 : -EIO;
+        case MRAM_URING_OP_WAKE:
+            return mram_wake(mram) ? 0 : -EIO;
+        default:
+            return -EINVAL;
+    }
+}
+
+// Execute n entries starting at head, writing one result per entry
+static void uring_execute(struct mram_uring* ring, uint32_t head, uint32_t n, int32_t* res) {
+    uint32_t i = 0;
+
+    while (i < n) {
+        const struct mram_uring_sqe* sqe = &ring->sqes[(head + i) & ring->sq_mask];
+        if (sqe->op != MRAM_URING_OP_READ && sqe->op != MRAM_URING_OP_WRITE) {
+            res[i++] = uring_execute_one(ring->mram, sqe);
+            if (sqe->op != MRAM_URING_OP_NOP) ring->stats.bus_calls++;
+            continue;
+        }
+        if (!uring_range_valid(sqe)) {
+            res[i++] = -EINVAL;
+            continue;
+        }
+
+        // Gather the run of valid entries with the same direction
+        uint32_t j = i;
+        for (; j < n; j++) {
+            const struct mram_uring_sqe* next = &ring->sqes[(head + j) & ring->sq_mask];
+            if (next->op != sqe->op || !uring_range_valid(next)) break;
+            ring->iov[j - i].addr = next->addr;
+            ring->iov[j - i].buf = next->buf;
+            ring->iov[j - i].len = next->len;
+        }
+        bool ok = sqe->op == MRAM_URING_OP_READ ? mram_read_vector(ring->mram, ring->iov, j - i)
+                                                : mram_write_vector(ring->mram, ring->iov, j - i);
+        ring->stats.bus_calls++;
+        for (; i < j; i++) res[i] = ok ? 0 : -EIO;
+    }
+}
+
+static void uring_notify(struct mram_uring* ring) {
+#ifdef __linux__
+    if (ring->eventfd >= 0) {
+        uint64_t one = 1;
+        ssize_t ret = write(ring->eventfd, &one, sizeof(one));
+        (void)ret;  // EAGAIN only when the counter is saturated, which still reads as ready
+    }
+#endif
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->cq_need_wakeup, memory_order_relaxed)) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(&ring->cq_cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+// Block until the submitter publishes past head or the ring is stopped
+static void uring_sleep(struct mram_uring* ring, uint32_t head) {
+    atomic_store(&ring->sq_need_wakeup, true);
+    pthread_mutex_lock(&ring->lock);
+    while (!atomic_load(&ring->stop) && atomic_load(&ring->sq_tail) == head) {
+        pthread_cond_wait(&ring->sq_cond, &ring->lock);
+    }
+    pthread_mutex_unlock(&ring->lock);
+    atomic_store(&ring->sq_need_wakeup, false);
+    ring->stats.sleeps++;
+}
+
+static void* uring_thread(void* arg) {
+    struct mram_uring* ring = arg;
+    uint32_t sq_head = atomic_load_explicit(&ring->sq_head, memory_order_relaxed);
+    uint32_t cq_tail = atomic_load_explicit(&ring->cq_tail, memory_order_relaxed);
+    uint32_t cq_size = ring->cq_mask + 1;
+    int32_t* res = ring->res;
+    uint32_t idle = 0;
+
+    for (;;) {
+        uint32_t sq_tail = atomic_load_explicit(&ring->sq_tail, memory_order_acquire);
+        if (sq_tail == sq_head) {
+            if (atomic_load_explicit(&ring->stop, memory_order_acquire)) break;
+            if (++idle < ring->idle_spins) {
+                uring_relax();
+            } else {
+                uring_sleep(ring, sq_head);
+                idle = 0;
+            }
+            continue;
+        }
+        idle = 0;
+
+        // Never take more entries than there are free completion slots;
+        // completions are dropped only when stopping with a full ring
+        uint32_t n = sq_tail - sq_head;
+        uint32_t space = cq_size - (cq_tail - atomic_load_explicit(&ring->cq_head, memory_order_acquire));
+        bool drop = false;
+        if (space == 0) {
+            if (!atomic_load_explicit(&ring->stop, memory_order_acquire)) {
+                sched_yield();
+                continue;
+            }
+            drop = true;
+        } else if (n > space) {
+            n = space;
+        }
+
+        uring_execute(ring, sq_head, n, res);
+
+        if (!drop) {
+            for (uint32_t i = 0; i < n; i++) {
+                struct mram_uring_cqe* cqe = &ring->cqes[cq_tail++ & ring->cq_mask];
+                cqe->user_data = ring->sqes[(sq_head + i) & ring->sq_mask].user_data;
+                cqe->res = res[i];
+            }
+        }
+        ring->stats.completed += n;
+        sq_head += n;
+        atomic_store_explicit(&ring->sq_head, sq_head, memory_order_release);
+        if (!drop) {
+            atomic_store_explicit(&ring->cq_tail, cq_tail, memory_order_release);
+            uring_notify(ring);
+        }
+    }
+
+    return NULL;
+}
+
+static bool uring_pow2(uint32_t n) {
+    return n >= 2 && (n & (n - 1)) == 0;
+}
+
+static void uring_free(struct mram_uring* ring) {
+    free(ring->sqes);
+    free(ring->cqes);
+    free(ring->iov);
+    free(ring->res);
+    ring->sqes = NULL;
+    ring->cqes = NULL;
+    ring->iov = NULL;
+    ring->res = NULL;
+#ifdef __linux__
+    if (ring->eventfd >= 0) close(ring->eventfd);
+#endif
+    ring->eventfd = -1;
+}
+
+bool mram_uring_init(struct mram_uring* ring, struct mram* mram, const struct mram_uring_config* config) {
+    if (ring == NULL || mram == NULL) return false;
+
+    struct mram_uring_config cfg = { 0 };
+    if (config) cfg = *config;
+    if (cfg.sq_entries == 0) cfg.sq_entries = MRAM_URING_DEFAULT_ENTRIES;
+    if (cfg.cq_entries == 0) cfg.cq_entries = cfg.sq_entries * 2;
+    if (cfg.idle_spins == 0) cfg.idle_spins = MRAM_URING_DEFAULT_IDLE_SPINS;
+    if (!uring_pow2(cfg.sq_entries) || !uring_pow2(cfg.cq_entries)) return false;
+#ifndef __linux__
+    if (cfg.use_eventfd) return false;
+#endif
+
+    memset(ring, 0, sizeof(*ring));
+    ring->mram = mram;
+    ring->sq_mask = cfg.sq_entries - 1;
+    ring->cq_mask = cfg.cq_entries - 1;
+    ring->idle_spins = cfg.idle_spins;
+    ring->eventfd = -1;
+    atomic_init(&ring->sq_tail, 0);
+    atomic_init(&ring->sq_head, 0);
+    atomic_init(&ring->cq_tail, 0);
+    atomic_init(&ring->cq_head, 0);
+    atomic_init(&ring->sq_need_wakeup, false);
+    atomic_init(&ring->cq_need_wakeup, false);
+    atomic_init(&ring->stop, false);
+
+    ring->sqes = calloc(cfg.sq_entries, sizeof(*ring->sqes));
+    ring->cqes = calloc(cfg.cq_entries, sizeof(*ring->cqes));
+    ring->iov = malloc(cfg.sq_entries * sizeof(*ring->iov));
+    ring->res = malloc(cfg.sq_entries * sizeof(*ring->res));
+    if (ring->sqes == NULL || ring->cqes == NULL || ring->iov == NULL || ring->res == NULL) {
+        uring_free(ring);
+        return false;
+    }
+#ifdef __linux__
+    if (cfg.use_eventfd) {
+        ring->eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (ring->eventfd < 0) {
+            uring_free(ring);
+            return false;
+        }
+    }
+#endif
+
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->sq_cond, NULL);
+    pthread_cond_init(&ring->cq_cond, NULL);
+    if (pthread_create(&ring->thread, NULL, uring_thread, ring) != 0) {
+        pthread_cond_destroy(&ring->cq_cond);
+        pthread_cond_destroy(&ring->sq_cond);
+        pthread_mutex_destroy(&ring->lock);
+        uring_free(ring);
+        return false;
+    }
+    return true;
+}
+
+void mram_uring_deinit(struct mram_uring* ring) {
+    if (ring == NULL || ring->sqes == NULL) return;
+
+    mram_uring_submit(ring);
+    pthread_mutex_lock(&ring->lock);
+    atomic_store(&ring->stop, true);
+    pthread_cond_signal(&ring->sq_cond);
+    pthread_mutex_unlock(&ring->lock);
+    pthread_join(ring->thread, NULL);
+
+    pthread_cond_destroy(&ring->cq_cond);
+    pthread_cond_destroy(&ring->sq_cond);
+    pthread_mutex_destroy(&ring->lock);
+    uring_free(ring);
+}
+
+struct mram_uring_sqe* mram_uring_get_sqe(struct mram_uring* ring) {
+    if (ring == NULL || ring->sqes == NULL) return NULL;
+
+    uint32_t head = atomic_load_explicit(&ring->sq_head, memory_order_acquire);
+    if (ring->sq_local - head > ring->sq_mask) return NULL;
+
+    struct mram_uring_sqe* sqe = &ring->sqes[ring->sq_local++ & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+uint32_t mram_uring_submit(struct mram_uring* ring) {
+    if (ring == NULL || ring->sqes == NULL) return 0;
+
+    uint32_t published = atomic_load_explicit(&ring->sq_tail, memory_order_relaxed);
+    if (published == ring->sq_local) return 0;
+    atomic_store_explicit(&ring->sq_tail, ring->sq_local, memory_order_release);
+
+    // Pairs with the flag store in uring_sleep(): either the I/O thread sees
+    // the new tail before sleeping or we see its flag and wake it
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->sq_need_wakeup, memory_order_relaxed)) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(&ring->sq_cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+    return ring->sq_local - published;
+}
+
+struct mram_uring_cqe* mram_uring_peek_cqe(struct mram_uring* ring) {
+    if (ring == NULL || ring->cqes == NULL) return NULL;
+
+    uint32_t head = atomic_load_explicit(&ring->cq_head, memory_order_relaxed);
+    if (atomic_load_explicit(&ring->cq_tail, memory_order_acquire) == head) return NULL;
+    return &ring->cqes[head & ring->cq_mask];
+}
+
+struct mram_uring_cqe* mram_uring_wait_cqe(struct mram_uring* ring) {
+    if (ring == NULL || ring->cqes == NULL) return NULL;
+
+    for (unsigned spins = 0;; spins++) {
+        struct mram_uring_cqe* cqe = mram_uring_peek_cqe(ring);
+        if (cqe) return cqe;
+        if (spins < URING_WAIT_SPINS) {
+            uring_relax();
+            continue;
+        }
+
+        uint32_t head = atomic_load_explicit(&ring->cq_head, memory_order_relaxed);
+        atomic_store(&ring->cq_need_wakeup, true);
+        pthread_mutex_lock(&ring->lock);
+        while (atomic_load(&ring->cq_tail) == head) pthread_cond_wait(&ring->cq_cond, &ring->lock);
+        pthread_mutex_unlock(&ring->lock);
+        atomic_store(&ring->cq_need_wakeup, false);
+    }
+}
+
+void mram_uring_cqe_seen(struct mram_uring* ring) {
+    if (ring == NULL || ring->cqes == NULL) return;
+
+    uint32_t head = atomic_load_explicit(&ring->cq_head, memory_order_relaxed);
+    if (atomic_load_explicit(&ring->cq_tail, memory_order_acquire) == head) return;
+    atomic_store_explicit(&ring->cq_head, head + 1, memory_order_release);
+}
+
+int mram_uring_eventfd(const struct mram_uring* ring) {
+    return ring ? ring->eventfd : -1;
+}
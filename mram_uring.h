@@ -0,0 +1,256 @@
+/**
+ * @file mram_uring.h
+ * @brief io_uring-style submission and completion rings for a dedicated MRAM I/O thread
+ *
+ * A private I/O thread owns the struct mram. The application fills
+ * submission queue entries (SQEs) in place and publishes them with
+ * mram_uring_submit(), which is a release store of the tail index. The I/O
+ * thread turns each batch of queued entries into as few SPI transactions as
+ * it can: runs of reads or writes become one vector transfer, and adjacent
+ * ranges share a single frame. It then posts one completion queue entry
+ * (CQE) per SQE. Reaping is a wait-free acquire load of the completion
+ * tail.
+ *
+ * Both rings have a single producer and a single consumer: one application
+ * thread submits, and one application thread reaps (it may be the same
+ * thread). The I/O thread sleeps once it has been idle for a configurable
+ * number of polls. It sets a need-wakeup flag that the next submit checks,
+ * so a busy submitter never makes a system call. Completions can also be
+ * signalled through an eventfd for epoll-driven loops.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_URING_H
+#define MRAM_INTERFACE_MRAM_URING_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <pthread.h>
+#ifdef __cplusplus
+#include <atomic>
+using std::atomic_bool;
+using std::atomic_uint;
+#else
+#include <stdatomic.h>
+#endif
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Default submission ring size */
+#define MRAM_URING_DEFAULT_ENTRIES 64
+/** @brief Default number of empty polls before the I/O thread sleeps */
+#define MRAM_URING_DEFAULT_IDLE_SPINS 1000
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Submission operation codes
+ */
+enum mram_uring_op {
+    /** @brief No bus traffic, completes with 0 */
+    MRAM_URING_OP_NOP,
+    /** @brief Read len bytes at addr into buf */
+    MRAM_URING_OP_READ,
+    /** @brief Write len bytes from buf to addr */
+    MRAM_URING_OP_WRITE,
+    /** @brief Read the status register, the completion result carries its value */
+    MRAM_URING_OP_READ_STATUS,
+    /** @brief Write the status register with the value in addr */
+    MRAM_URING_OP_WRITE_STATUS,
+    /** @brief Enter sleep mode */
+    MRAM_URING_OP_SLEEP,
+    /** @brief Leave sleep mode */
+    MRAM_URING_OP_WAKE,
+};
+
+/**
+ * @brief Submission queue entry
+ */
+struct mram_uring_sqe {
+    /** @brief Operation (enum mram_uring_op) */
+    uint8_t op;
+    /** @brief Device address, or the status value for MRAM_URING_OP_WRITE_STATUS */
+    uint32_t addr;
+    /** @brief Data buffer, must stay valid until the completion is reaped */
+    void* buf;
+    /** @brief Data length */
+    size_t len;
+    /** @brief Opaque value copied to the completion */
+    uint64_t user_data;
+};
+
+/**
+ * @brief Completion queue entry
+ */
+struct mram_uring_cqe {
+    /** @brief user_data of the submission */
+    uint64_t user_data;
+    /** @brief 0 or the status register value on success, -EINVAL or -EIO on failure */
+    int32_t res;
+};
+
+/**
+ * @brief Ring configuration
+ */
+struct mram_uring_config {
+    /** @brief Submission ring size, a power of two (0 = MRAM_URING_DEFAULT_ENTRIES) */
+    uint32_t sq_entries;
+    /** @brief Completion ring size, a power of two (0 = twice sq_entries) */
+    uint32_t cq_entries;
+    /** @brief Empty polls before the I/O thread sleeps (0 = MRAM_URING_DEFAULT_IDLE_SPINS) */
+    uint32_t idle_spins;
+    /** @brief Signal completions through an eventfd (Linux only) */
+    bool use_eventfd;
+};
+
+/**
+ * @brief I/O thread statistics, read them once the ring is idle
+ */
+struct mram_uring_stats {
+    /** @brief Submissions completed */
+    uint64_t completed;
+    /** @brief Calls into the underlying driver */
+    uint64_t bus_calls;
+    /** @brief Times the I/O thread went to sleep */
+    uint64_t sleeps;
+};
+
+/**
+ * @brief Ring pair and I/O thread
+ */
+struct mram_uring {
+    /** @brief MRAM device owned by the I/O thread */
+    struct mram* mram;
+    /** @brief Submission entries */
+    struct mram_uring_sqe* sqes;
+    /** @brief Submission ring size minus one */
+    uint32_t sq_mask;
+    /** @brief Next entry the application fills (submitter only) */
+    uint32_t sq_local;
+    /** @brief Published submission tail */
+    atomic_uint sq_tail;
+    /** @brief Submission head, advanced by the I/O thread */
+    atomic_uint sq_head;
+    /** @brief Completion entries */
+    struct mram_uring_cqe* cqes;
+    /** @brief Completion ring size minus one */
+    uint32_t cq_mask;
+    /** @brief Completion tail, advanced by the I/O thread */
+    atomic_uint cq_tail;
+    /** @brief Completion head, advanced by the reaper */
+    atomic_uint cq_head;
+    /** @brief Set by the I/O thread before it sleeps on an empty submission ring */
+    atomic_bool sq_need_wakeup;
+    /** @brief Set by a reaper blocked in mram_uring_wait_cqe() */
+    atomic_bool cq_need_wakeup;
+    /** @brief Set to stop the I/O thread */
+    atomic_bool stop;
+    /** @brief Empty polls before sleeping */
+    uint32_t idle_spins;
+    /** @brief Completion eventfd, -1 if disabled */
+    int eventfd;
+    /** @brief Segments for merged transfers (I/O thread only) */
+    struct mram_iovec* iov;
+    /** @brief Per-entry results of the current batch (I/O thread only) */
+    int32_t* res;
+    /** @brief Protects sleeping on the condition variables */
+    pthread_mutex_t lock;
+    /** @brief Wakes the I/O thread */
+    pthread_cond_t sq_cond;
+    /** @brief Wakes a blocked reaper */
+    pthread_cond_t cq_cond;
+    /** @brief I/O thread */
+    pthread_t thread;
+    /** @brief Statistics */
+    struct mram_uring_stats stats;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the rings and start the I/O thread
+ *
+ * @param ring Pointer to the ring to initialize
+ * @param mram Pointer to an initialized MRAM interface structure; it must
+ *        not be used directly until mram_uring_deinit() returns
+ * @param config Ring configuration (NULL for defaults)
+ * @return true if successful, false if parameters are invalid, allocation
+ *         fails or the thread or eventfd cannot be created
+ */
+bool mram_uring_init(struct mram_uring* ring, struct mram* mram, const struct mram_uring_config* config);
+
+/**
+ * @brief Complete all published submissions, stop the I/O thread and free the rings
+ *
+ * @param ring Pointer to the ring
+ */
+void mram_uring_deinit(struct mram_uring* ring);
+
+/**
+ * @brief Get the next free submission entry
+ *
+ * @param ring Pointer to the ring
+ * @return Entry to fill in, or NULL if the submission ring is full
+ */
+struct mram_uring_sqe* mram_uring_get_sqe(struct mram_uring* ring);
+
+/**
+ * @brief Publish all entries obtained since the last submit
+ *
+ * @param ring Pointer to the ring
+ * @return Number of entries published
+ */
+uint32_t mram_uring_submit(struct mram_uring* ring);
+
+/**
+ * @brief Get the oldest unreaped completion without waiting
+ *
+ * @param ring Pointer to the ring
+ * @return Completion, or NULL if none is available
+ */
+struct mram_uring_cqe* mram_uring_peek_cqe(struct mram_uring* ring);
+
+/**
+ * @brief Wait until a completion is available
+ *
+ * @param ring Pointer to the ring
+ * @return Oldest unreaped completion, NULL if ring is NULL
+ */
+struct mram_uring_cqe* mram_uring_wait_cqe(struct mram_uring* ring);
+
+/**
+ * @brief Release the completion returned by peek or wait
+ *
+ * @param ring Pointer to the ring
+ */
+void mram_uring_cqe_seen(struct mram_uring* ring);
+
+/**
+ * @brief Get the completion eventfd
+ *
+ * The eventfd counter is incremented once per batch of completions; read it
+ * to reset it, then reap with mram_uring_peek_cqe() until it returns NULL.
+ *
+ * @param ring Pointer to the ring
+ * @return File descriptor, or -1 if the ring was created without one
+ */
+int mram_uring_eventfd(const struct mram_uring* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_URING_H
@@ -0,0 +1,129 @@
+#ifdef __linux__
+#define _GNU_SOURCE  // pthread_setaffinity_np
+#endif
+#include "mram_worker.h"
+#include <sched.h>
+
+static void worker_complete(struct mram_worker_job* job) {
+    struct mram_worker_batch* batch = job->batch;
+
+    pthread_mutex_lock(&batch->lock);
+    if (!job->result) batch->ok = false;
+    if (--batch->pending == 0) pthread_cond_signal(&batch->cond);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+static void* worker_thread(void* arg) {
+    struct mram_worker* worker = arg;
+
+    pthread_mutex_lock(&worker->lock);
+    for (;;) {
+        while (worker->head == NULL && !worker->stop) pthread_cond_wait(&worker->cond, &worker->lock);
+        struct mram_worker_job* job = worker->head;
+        if (job == NULL) break;
+        worker->head = job->next;
+        if (worker->head == NULL) worker->tail = NULL;
+        pthread_mutex_unlock(&worker->lock);
+
+        job->result = job->write ? mram_write_vector(worker->mram, job->iov, job->count)
+                                 : mram_read_vector(worker->mram, job->iov, job->count);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->depth--;
+        pthread_mutex_unlock(&worker->lock);
+        // The batch may be released as soon as it completes, so report last
+        worker_complete(job);
+        pthread_mutex_lock(&worker->lock);
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return NULL;
+}
+
+bool mram_worker_start(struct mram_worker* worker, struct mram* mram, int cpu) {
+    if (worker == NULL || mram == NULL) return false;
+#ifdef __linux__
+    if (cpu != MRAM_WORKER_ANY_CPU && (cpu < 0 || cpu >= CPU_SETSIZE)) return false;
+#else
+    if (cpu != MRAM_WORKER_ANY_CPU) return false;
+#endif
+
+    worker->mram = mram;
+    worker->head = NULL;
+    worker->tail = NULL;
+    worker->depth = 0;
+    worker->stop = false;
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->cond, NULL);
+    if (pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+        pthread_cond_destroy(&worker->cond);
+        pthread_mutex_destroy(&worker->lock);
+        return false;
+    }
+
+#ifdef __linux__
+    if (cpu != MRAM_WORKER_ANY_CPU) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(worker->thread, sizeof(set), &set) != 0) {
+            mram_worker_stop(worker);
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+void mram_worker_stop(struct mram_worker* worker) {
+    if (worker == NULL || worker->mram == NULL) return;
+
+    pthread_mutex_lock(&worker->lock);
+    worker->stop = true;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+    pthread_join(worker->thread, NULL);
+
+    pthread_cond_destroy(&worker->cond);
+    pthread_mutex_destroy(&worker->lock);
+    worker->mram = NULL;
+}
+
+void mram_worker_submit(struct mram_worker* worker, struct mram_worker_job* job) {
+    job->next = NULL;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->tail) {
+        worker->tail->next = job;
+    } else {
+        worker->head = job;
+    }
+    worker->tail = job;
+    worker->depth++;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+uint32_t mram_worker_depth(struct mram_worker* worker) {
+    pthread_mutex_lock(&worker->lock);
+    uint32_t depth = worker->depth;
+    pthread_mutex_unlock(&worker->lock);
+    return depth;
+}
+
+void mram_worker_batch_init(struct mram_worker_batch* batch, uint32_t jobs) {
+    pthread_mutex_init(&batch->lock, NULL);
+    pthread_cond_init(&batch->cond, NULL);
+    batch->pending = jobs;
+    batch->ok = true;
+}
+
+bool mram_worker_batch_wait(struct mram_worker_batch* batch) {
+    pthread_mutex_lock(&batch->lock);
+    while (batch->pending != 0) pthread_cond_wait(&batch->cond, &batch->lock);
+    bool ok = batch->ok;
+    pthread_mutex_unlock(&batch->lock);
+
+    pthread_cond_destroy(&batch->cond);
+    pthread_mutex_destroy(&batch->lock);
+    return ok;
+}
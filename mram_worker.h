@@ -0,0 +1,153 @@
+/**
+ * @file mram_worker.h
+ * @brief Per-bus worker thread for multi-device volumes
+ *
+ * A worker thread owns one struct mram and executes vector read and write
+ * jobs from a FIFO queue, so volumes that span several devices on
+ * independent buses can keep all of them busy at once. A caller posts one
+ * job to each device involved in a request and then waits on a batch,
+ * which completes when the last of its jobs does. The worker thread can
+ * optionally be pinned to a CPU, so a bus always uses the same core.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_MRAM_WORKER_H
+#define MRAM_INTERFACE_MRAM_WORKER_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <pthread.h>
+#include "mram.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief CPU value for a worker without affinity */
+#define MRAM_WORKER_ANY_CPU (-1)
+
+/*******************************************************************************
+ * Data Structures
+ ******************************************************************************/
+/**
+ * @brief Completion group of one or more jobs
+ */
+struct mram_worker_batch {
+    /** @brief Protects pending and ok */
+    pthread_mutex_t lock;
+    /** @brief Signalled when pending reaches zero */
+    pthread_cond_t cond;
+    /** @brief Jobs not yet completed */
+    uint32_t pending;
+    /** @brief False once any job of the batch failed */
+    bool ok;
+};
+
+/**
+ * @brief Vector transfer executed by a worker
+ */
+struct mram_worker_job {
+    /** @brief Next job in the worker queue */
+    struct mram_worker_job* next;
+    /** @brief True for a write, false for a read */
+    bool write;
+    /** @brief Segments on the worker's device */
+    const struct mram_iovec* iov;
+    /** @brief Number of segments */
+    size_t count;
+    /** @brief Result of the transfer */
+    bool result;
+    /** @brief Batch notified on completion */
+    struct mram_worker_batch* batch;
+};
+
+/**
+ * @brief Worker thread bound to one device
+ */
+struct mram_worker {
+    /** @brief Device owned by the worker */
+    struct mram* mram;
+    /** @brief Protects the queue */
+    pthread_mutex_t lock;
+    /** @brief Signalled when a job is queued or the worker is stopped */
+    pthread_cond_t cond;
+    /** @brief Oldest queued job */
+    struct mram_worker_job* head;
+    /** @brief Newest queued job */
+    struct mram_worker_job* tail;
+    /** @brief Jobs queued or running */
+    uint32_t depth;
+    /** @brief Set to stop the thread once the queue is empty */
+    bool stop;
+    /** @brief Worker thread */
+    pthread_t thread;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start a worker thread for a device
+ *
+ * @param worker Pointer to the worker to initialize
+ * @param mram Pointer to an initialized MRAM interface structure
+ * @param cpu CPU to pin the thread to, or MRAM_WORKER_ANY_CPU
+ * @return true if successful, false if parameters are invalid or the thread
+ *         cannot be created or pinned
+ */
+bool mram_worker_start(struct mram_worker* worker, struct mram* mram, int cpu);
+
+/**
+ * @brief Finish all queued jobs and stop the worker thread
+ *
+ * @param worker Pointer to the worker
+ */
+void mram_worker_stop(struct mram_worker* worker);
+
+/**
+ * @brief Queue a job
+ *
+ * The job, its segments and its batch must stay valid until the batch completes.
+ *
+ * @param worker Pointer to the worker
+ * @param job Job to run; its batch must have been counted by mram_worker_batch_init()
+ */
+void mram_worker_submit(struct mram_worker* worker, struct mram_worker_job* job);
+
+/**
+ * @brief Get the number of jobs queued or running on a worker
+ *
+ * @param worker Pointer to the worker
+ * @return Queue depth
+ */
+uint32_t mram_worker_depth(struct mram_worker* worker);
+
+/**
+ * @brief Prepare a batch for a number of jobs
+ *
+ * @param batch Pointer to the batch
+ * @param jobs Number of jobs that will be submitted against it
+ */
+void mram_worker_batch_init(struct mram_worker_batch* batch, uint32_t jobs);
+
+/**
+ * @brief Wait for every job of a batch and release it
+ *
+ * @param batch Pointer to the batch
+ * @return true if all jobs succeeded
+ */
+bool mram_worker_batch_wait(struct mram_worker_batch* batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MRAM_INTERFACE_MRAM_WORKER_H
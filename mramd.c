@@ -0,0 +1,75 @@
+/**
+ * @file mramd.c
+ * @brief MRAM sharing daemon
+ *
+ * Serves one MRAM device to local processes over a Unix-domain socket (see
+ * mram_proto.h and mram_client.h). The device is the MR25H40 simulator of
+ * mram_sim.h, held in RAM or, with -f, in a persistent image file (see
+ * mram_file.h); a board port replaces it with its own GPIO and SPI
+ * callbacks.
+ *
+ * Usage: mramd [-s socket_path] [-f image_file]
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // sigaction, getopt
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "mram_file.h"
+#include "mram_server.h"
+#include "mram_sim.h"
+
+static struct mram_server server;
+
+static void mramd_signal(int sig) {
+    (void)sig;
+    mram_server_stop(&server);
+}
+
+int main(int argc, char** argv) {
+    const char* path = MRAM_PROTO_DEFAULT_PATH;
+    const char* image = NULL;
+    struct mram_file file = { -1, NULL };
+    struct mram mram;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:f:")) != -1) {
+        switch (opt) {
+            case 's':
+                path = optarg;
+                break;
+            case 'f':
+                image = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-s socket_path] [-f image_file]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (image ? !mram_file_open(&file, &mram, image) : !mram_sim_init(&mram, NULL)) {
+        fprintf(stderr, "mramd: device initialization failed\n");
+        return 1;
+    }
+    if (!mram_server_init(&server, &mram, path)) {
+        perror("mramd: cannot listen");
+        mram_file_close(&file);
+        return 1;
+    }
+
+    struct sigaction sa = { 0 };
+    sa.sa_handler = mramd_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    bool ok = mram_server_run(&server);
+    mram_server_deinit(&server);
+    mram_file_close(&file);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file test_alloc.c
+ * @brief Persistent heap behavior and crash consistency on the simulator
+ *
+ * Checks slab and buddy allocation, frees with buddy merging, and that a
+ * reopened heap matches the synced one. A power cut at every write payload
+ * byte of two consecutive syncs must reopen as one of the synced states.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_alloc.h"
+#include "test_util.h"
+
+#define BASE 1024
+#define SIZE 65536
+
+static uint8_t baseline[BASE + SIZE];
+
+static bool same_meta(const struct mram_heap* heap, const struct mram_heap_page* meta) {
+    return memcmp(heap->meta, meta, heap->header.pages * sizeof(*meta)) == 0;
+}
+
+// Reopen the heap and check it against the RAM copy of the open handle
+static void check_reopen(struct mram* mram, const struct mram_heap* heap) {
+    struct mram_heap again;
+    CHECK(mram_heap_open(&again, mram, BASE, SIZE));
+    CHECK(again.header.pages == heap->header.pages && same_meta(&again, heap->meta));
+    mram_heap_deinit(&again);
+}
+
+static void test_basic(void) {
+    struct mram mram;
+    struct mram_heap heap;
+    uint32_t small[40], large[4], addr;
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_heap_format(&heap, &mram, BASE, SIZE));
+    CHECK(heap.heap % MRAM_HEAP_MIN_SLOT == 0 && heap.heap >= BASE);
+    CHECK(heap.heap + heap.header.pages * MRAM_HEAP_PAGE_SIZE <= BASE + SIZE);
+    check_reopen(&mram, &heap);
+
+    for (int i = 0; i < 40; i++) {
+        CHECK(mram_alloc(&heap, 1 + (size_t)i * 3, &small[i]));
+        for (int j = 0; j < i; j++) CHECK(small[j] != small[i]);
+    }
+    for (int i = 0; i < 4; i++) CHECK(mram_alloc(&heap, 300 + (size_t)i * 1000, &large[i]));
+    CHECK(large[0] % MRAM_HEAP_PAGE_SIZE == heap.heap % MRAM_HEAP_PAGE_SIZE);
+    CHECK(!mram_free(&heap, large[1] + 16));
+    CHECK(!mram_alloc(&heap, (size_t)SIZE * 2, &addr));
+    CHECK(mram_heap_sync(&heap));
+    check_reopen(&mram, &heap);
+
+    // Free everything: buddies merge back into the formatted layout
+    for (int i = 0; i < 40; i++) CHECK(mram_free(&heap, small[i]));
+    for (int i = 0; i < 4; i++) CHECK(mram_free(&heap, large[i]));
+    CHECK(!mram_free(&heap, small[0]));
+    CHECK(mram_heap_sync(&heap));
+    check_reopen(&mram, &heap);
+
+    struct mram_heap fresh;
+    CHECK(mram_heap_format(&fresh, &mram, BASE, SIZE));
+    CHECK(same_meta(&heap, fresh.meta));
+    mram_heap_deinit(&fresh);
+    mram_heap_deinit(&heap);
+}
+
+static void alloc_some(struct mram_heap* heap, uint32_t* addrs, int count, size_t size) {
+    for (int i = 0; i < count; i++) CHECK(mram_alloc(heap, size + (size_t)i * 5, &addrs[i]));
+}
+
+static void test_crash(void) {
+    struct mram mram;
+    struct mram_heap heap;
+    uint32_t first[12], second[6];
+
+    // Baseline: a synced heap with slabs and blocks in use
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_heap_format(&heap, &mram, BASE, SIZE));
+    alloc_some(&heap, first, 12, 20);
+    CHECK(mram_heap_sync(&heap));
+    memcpy(baseline, mram_sim_memory(), sizeof(baseline));
+
+    // Expected states after each of the two syncs under test
+    size_t meta_size = heap.header.pages * sizeof(struct mram_heap_page);
+    struct mram_heap_page* states[3] = { malloc(meta_size), malloc(meta_size), malloc(meta_size) };
+    CHECK(states[0] && states[1] && states[2]);
+    memcpy(states[0], heap.meta, meta_size);
+    for (int i = 0; i < 12; i += 2) CHECK(mram_free(&heap, first[i]));
+    alloc_some(&heap, second, 6, 600);
+    memcpy(states[1], heap.meta, meta_size);
+    for (int i = 1; i < 12; i += 2) CHECK(mram_free(&heap, first[i]));
+    alloc_some(&heap, second, 3, 40);
+    memcpy(states[2], heap.meta, meta_size);
+    mram_heap_deinit(&heap);
+
+    bool lost = true;
+    for (size_t budget = 0; lost; budget++) {
+        memcpy(mram_sim_memory(), baseline, sizeof(baseline));
+        test_power_on(&mram, budget);
+        CHECK(mram_heap_open(&heap, &mram, BASE, SIZE));
+        for (int i = 0; i < 12; i += 2) CHECK(mram_free(&heap, first[i]));
+        alloc_some(&heap, second, 6, 600);
+        if (mram_heap_sync(&heap)) {
+            for (int i = 1; i < 12; i += 2) CHECK(mram_free(&heap, first[i]));
+            alloc_some(&heap, second, 3, 40);
+            mram_heap_sync(&heap);
+        }
+        mram_heap_deinit(&heap);
+        lost = test_power_lost();
+
+        test_power_on(&mram, TEST_POWER_UNLIMITED);
+        CHECK(mram_heap_open(&heap, &mram, BASE, SIZE));
+        CHECK(same_meta(&heap, states[0]) || same_meta(&heap, states[1]) || same_meta(&heap, states[2]));
+        if (!lost) CHECK(same_meta(&heap, states[2]));
+
+        // The recovered heap keeps working over the following syncs
+        uint32_t addr;
+        CHECK(mram_alloc(&heap, 100, &addr));
+        CHECK(mram_heap_sync(&heap));
+        check_reopen(&mram, &heap);
+        CHECK(mram_free(&heap, addr));
+        CHECK(mram_heap_sync(&heap));
+        check_reopen(&mram, &heap);
+        mram_heap_deinit(&heap);
+    }
+    for (int i = 0; i < 3; i++) free(states[i]);
+}
+
+int main(void) {
+    test_basic();
+    test_crash();
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file test_blk.c
+ * @brief Block device request queue on the simulator
+ *
+ * Checks that a failed mram_blk_write() withdraws only its own request: a
+ * request queued earlier with mram_blk_submit() on the same buffer stays
+ * queued and lands on the next flush.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_blk.h"
+#include "test_util.h"
+
+#define SECTOR 512
+
+static const struct mram_blk_config config = {
+    .base = 0,
+    .sector_size = SECTOR,
+    .sector_count = 64,
+};
+
+// One-shot failure in front of the simulator: the next WRITE frame fails
+static struct {
+    struct mram sim;
+    bool armed;
+    bool frame_start;
+} glitch;
+
+static bool glitch_gpio(uint8_t pin, uint8_t value) {
+    if (value == MRAM_GPIO_LOW) glitch.frame_start = true;
+    return glitch.sim.gpio_write(pin, value);
+}
+
+static bool glitch_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    bool start = glitch.frame_start;
+    glitch.frame_start = false;
+    if (start && glitch.armed && tx_buf && len > 0 && tx_buf[0] == MRAM_CMD_WRITE) {
+        glitch.armed = false;
+        return false;
+    }
+    return glitch.sim.spi_transfer(tx_buf, rx_buf, len);
+}
+
+static void test_withdraw(void) {
+    struct mram mram;
+    struct mram_blk blk;
+    uint8_t buf[SECTOR], back[SECTOR], zero[SECTOR] = { 0 };
+
+    static uint8_t memory[MRAM_SIZE_BYTES];
+    CHECK(mram_sim_init(&glitch.sim, memory));
+    CHECK(mram_init(&mram, glitch_gpio, glitch_spi, MRAM_SIM_CS_PIN));
+    CHECK(mram_blk_init(&blk, &mram, &config));
+
+    // Both requests share one sweep, which fails on its first frame
+    memset(buf, 0xA5, sizeof(buf));
+    CHECK(mram_blk_submit(&blk, MRAM_BLK_WRITE, 1, 1, buf));
+    glitch.armed = true;
+    CHECK(!mram_blk_write(&blk, 7, 1, buf));
+    CHECK(blk.pending == 1 && blk.queue[0].addr == SECTOR);
+
+    CHECK(mram_blk_flush(&blk) && blk.pending == 0);
+    CHECK(mram_blk_read(&blk, 1, 1, back) && memcmp(back, buf, SECTOR) == 0);
+    CHECK(mram_blk_read(&blk, 7, 1, back) && memcmp(back, zero, SECTOR) == 0);
+
+    // A successful write leaves nothing behind
+    CHECK(mram_blk_submit(&blk, MRAM_BLK_WRITE, 2, 1, buf));
+    CHECK(mram_blk_write(&blk, 7, 1, buf) && blk.pending == 0);
+    CHECK(mram_blk_read(&blk, 2, 1, back) && memcmp(back, buf, SECTOR) == 0);
+    mram_blk_deinit(&blk);
+}
+
+int main(void) {
+    test_withdraw();
+    return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file test_compress.c
+ * @brief Compressed region behavior and crash consistency on the simulator
+ *
+ * Checks LZ4 round trips, reads and writes across block boundaries, the
+ * refusal to update a block when no second copy fits, and that a power cut
+ * at any write payload byte leaves every block at its old or new version.
+ * A store that reports failure after its data reached the device must not
+ * let later stores reuse those units.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_compress.h"
+#include "test_util.h"
+
+#define BLOCK 1024
+#define BLOCKS 8
+
+static const struct mram_cz_config config = {
+    .map_addr = 0,
+    .data_addr = 256,
+    .data_size = 16384,
+    .logical_size = BLOCKS * BLOCK,
+    .block_size = BLOCK,
+};
+
+#define AREA_SIZE (256 + 16384)
+
+static uint8_t baseline[AREA_SIZE];
+
+// One-shot failure in front of the simulator: the next WRDI fails, so a
+// write call reports failure after all of its data has landed
+static struct {
+    struct mram sim;
+    bool armed;
+    bool frame_start;
+} glitch;
+
+static bool glitch_gpio(uint8_t pin, uint8_t value) {
+    if (value == MRAM_GPIO_LOW) glitch.frame_start = true;
+    return glitch.sim.gpio_write(pin, value);
+}
+
+static bool glitch_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    bool start = glitch.frame_start;
+    glitch.frame_start = false;
+    if (start && glitch.armed && tx_buf && len > 0 && tx_buf[0] == MRAM_CMD_WRDI) {
+        glitch.armed = false;
+        return false;
+    }
+    return glitch.sim.spi_transfer(tx_buf, rx_buf, len);
+}
+
+// Compressible text, or noise that is stored raw
+static void fill(uint8_t* buf, size_t len, uint32_t seed, bool noise) {
+    uint32_t x = seed * 2654435761u + 1;
+    for (size_t i = 0; i < len; i++) {
+        x = x * 1103515245u + 12345u;
+        buf[i] = noise ? (uint8_t)(x >> 16) : (uint8_t)("mram block "[(i + seed) % 11]);
+    }
+}
+
+static bool block_is(struct mram_cz* cz, uint32_t b, uint32_t seed, bool noise) {
+    uint8_t expected[BLOCK], got[BLOCK];
+    fill(expected, BLOCK, seed, noise);
+    return mram_cz_read(cz, b * BLOCK, got, BLOCK) && memcmp(got, expected, BLOCK) == 0;
+}
+
+static void test_lz(void) {
+    static uint8_t src[4096], packed[MRAM_LZ_BOUND(4096)], out[4096];
+
+    for (int noise = 0; noise < 2; noise++) {
+        fill(src, sizeof(src), 5, noise);
+        size_t len = mram_lz_compress(src, sizeof(src), packed, sizeof(packed));
+        CHECK(len > 0);
+        if (!noise) CHECK(len < sizeof(src) / 4);
+        CHECK(mram_lz_decompress(packed, len, out, sizeof(out)));
+        CHECK(memcmp(src, out, sizeof(src)) == 0);
+        CHECK(!mram_lz_decompress(packed, len, out, sizeof(out) - 1));
+    }
+    CHECK(mram_lz_compress(src, sizeof(src), packed, 16) == 0);
+}
+
+// Blocks 0..5 written, 6 and 7 never written; odd blocks are noise
+static void make_baseline(void) {
+    struct mram mram;
+    struct mram_cz cz;
+    uint8_t data[BLOCK];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_cz_format(&mram, &config));
+    CHECK(mram_cz_open(&cz, &mram, &config));
+    for (uint32_t b = 0; b < 6; b++) {
+        fill(data, BLOCK, b, b & 1);
+        CHECK(mram_cz_write(&cz, b * BLOCK, data, BLOCK));
+    }
+    mram_cz_close(&cz);
+    memcpy(baseline, mram_sim_memory(), AREA_SIZE);
+}
+
+static void check_baseline(struct mram_cz* cz, uint32_t skip_lo, uint32_t skip_hi) {
+    uint8_t zero[BLOCK] = { 0 }, got[BLOCK];
+    for (uint32_t b = 0; b < BLOCKS; b++) {
+        if (b >= skip_lo && b <= skip_hi) continue;
+        if (b < 6) {
+            CHECK(block_is(cz, b, b, b & 1));
+        } else {
+            CHECK(mram_cz_read(cz, b * BLOCK, got, BLOCK) && memcmp(got, zero, BLOCK) == 0);
+        }
+    }
+}
+
+static void test_region(void) {
+    struct mram mram;
+    struct mram_cz cz;
+    uint8_t data[3 * BLOCK], got[3 * BLOCK];
+
+    make_baseline();
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_cz_open(&cz, &mram, &config));
+    check_baseline(&cz, BLOCKS, BLOCKS);
+
+    // Unaligned write across three blocks, read back before and after reopen
+    fill(data, sizeof(data), 77, false);
+    CHECK(mram_cz_write(&cz, BLOCK / 2, data, 2 * BLOCK + 100));
+    CHECK(mram_cz_read(&cz, BLOCK / 2, got, 2 * BLOCK + 100) && memcmp(got, data, 2 * BLOCK + 100) == 0);
+    mram_cz_close(&cz);
+    CHECK(mram_cz_open(&cz, &mram, &config));
+    CHECK(mram_cz_read(&cz, BLOCK / 2, got, 2 * BLOCK + 100) && memcmp(got, data, 2 * BLOCK + 100) == 0);
+    CHECK(!mram_cz_read(&cz, BLOCKS * BLOCK - 1, got, 2));
+    mram_cz_close(&cz);
+}
+
+// A full region refuses updates instead of overwriting the live copy
+static void test_full(void) {
+    static const struct mram_cz_config small = {
+        .map_addr = 0,
+        .data_addr = 64,
+        .data_size = 2 * BLOCK + 512,
+        .logical_size = 4 * BLOCK,
+        .block_size = BLOCK,
+    };
+    struct mram mram;
+    struct mram_cz cz;
+    uint8_t data[BLOCK];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_cz_format(&mram, &small));
+    CHECK(mram_cz_open(&cz, &mram, &small));
+    fill(data, BLOCK, 1, true);
+    CHECK(mram_cz_write(&cz, 0, data, BLOCK));
+    fill(data, BLOCK, 2, true);
+    CHECK(mram_cz_write(&cz, BLOCK, data, BLOCK));
+
+    uint32_t used = mram_cz_physical_used(&cz);
+    fill(data, BLOCK, 3, true);
+    CHECK(!mram_cz_write(&cz, 0, data, BLOCK));
+    CHECK(mram_cz_physical_used(&cz) == used);
+    mram_cz_close(&cz);
+    CHECK(mram_cz_open(&cz, &mram, &small));
+    CHECK(block_is(&cz, 0, 1, true));
+
+    // A smaller compressed version still fits next to the old one
+    fill(data, BLOCK, 3, false);
+    CHECK(mram_cz_write(&cz, 0, data, BLOCK));
+    CHECK(mram_cz_physical_used(&cz) < used);
+    mram_cz_close(&cz);
+    CHECK(mram_cz_open(&cz, &mram, &small));
+    CHECK(block_is(&cz, 0, 3, false));
+    mram_cz_close(&cz);
+}
+
+// Rewrite blocks 1 (noise to text) and 2 (text to noise) in one call
+static void test_crash(void) {
+    uint8_t data[2 * BLOCK];
+    fill(data, BLOCK, 50, false);
+    fill(data + BLOCK, BLOCK, 51, true);
+
+    make_baseline();
+    bool lost = true;
+    for (size_t budget = 0; lost; budget++) {
+        struct mram mram;
+        struct mram_cz cz;
+
+        memcpy(mram_sim_memory(), baseline, AREA_SIZE);
+        test_power_on(&mram, budget);
+        if (mram_cz_open(&cz, &mram, &config)) {
+            mram_cz_write(&cz, BLOCK, data, sizeof(data));
+            mram_cz_close(&cz);
+        }
+        lost = test_power_lost();
+
+        test_power_on(&mram, TEST_POWER_UNLIMITED);
+        CHECK(mram_cz_open(&cz, &mram, &config));
+        check_baseline(&cz, 1, 2);
+        CHECK(block_is(&cz, 1, 1, true) || block_is(&cz, 1, 50, false));
+        CHECK(block_is(&cz, 2, 2, false) || block_is(&cz, 2, 51, true));
+        if (!lost) CHECK(block_is(&cz, 1, 50, false) && block_is(&cz, 2, 51, true));
+        mram_cz_close(&cz);
+    }
+}
+
+// Block 1 is stored but reported failed, then block 3 is rewritten until
+// the allocator has wrapped around the region several times
+static void test_failed_store(void) {
+    struct mram mram;
+    struct mram_cz cz;
+    uint8_t data[BLOCK];
+
+    make_baseline();
+    CHECK(mram_sim_init(&glitch.sim, mram_sim_memory()));
+    CHECK(mram_init(&mram, glitch_gpio, glitch_spi, MRAM_SIM_CS_PIN));
+    CHECK(mram_cz_open(&cz, &mram, &config));
+    glitch.armed = true;
+    fill(data, BLOCK, 60, true);
+    CHECK(!mram_cz_write(&cz, BLOCK, data, BLOCK));
+    CHECK(!glitch.armed);
+    for (uint32_t i = 0; i < 40; i++) {
+        fill(data, BLOCK, 100 + i, true);
+        CHECK(mram_cz_write(&cz, 3 * BLOCK, data, BLOCK));
+    }
+    mram_cz_close(&cz);
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_cz_open(&cz, &mram, &config));
+    CHECK(block_is(&cz, 1, 1, true) || block_is(&cz, 1, 60, true));
+    CHECK(block_is(&cz, 3, 139, true));
+    check_baseline(&cz, 1, 3);
+    mram_cz_close(&cz);
+}
+
+int main(void) {
+    test_lz();
+    test_region();
+    test_full();
+    test_crash();
+    test_failed_store();
+    return 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file test_cpp.cpp
+ * @brief C++ headers instantiated and exercised on the simulator
+ *
+ * Builds device<Transport> over the C function pointers and over a policy
+ * type of its own, the span and range overloads on both device kinds, the
+ * persistent containers across a reopen, and async_device with more
+ * coroutines in flight than its submission ring holds. The C layers are
+ * called from here too, so a header without C linkage fails to link.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#include "mram_alloc.h"
+#include "mram_blk.h"
+#include "mram_client.h"
+#include "mram_compress.h"
+#include "mram_container.hpp"
+#include "mram_coro.hpp"
+#include "mram_delta.h"
+#include "mram_device.hpp"
+#include "mram_integrity.h"
+#include "mram_kv.h"
+#include "mram_mirror.h"
+#include "mram_mt.h"
+#include "mram_sched.h"
+#include "mram_server.h"
+#include "mram_snapshot.h"
+#include "mram_span.hpp"
+#include "mram_stripe.h"
+#include "mram_txn.h"
+#include "test_util.h"
+
+using namespace mram_interface;
+
+namespace {
+
+// Transport policy that forwards to the simulator and counts frames
+struct counting_transport {
+    explicit counting_transport(::mram& dev) : inner(dev) {}
+
+    bool select() {
+        frames++;
+        return inner.select();
+    }
+    bool deselect() { return inner.deselect(); }
+    bool transfer(const uint8_t* tx, uint8_t* rx, size_t len) { return inner.transfer(tx, rx, len); }
+
+    pointer_transport inner;
+    size_t frames = 0;
+};
+
+struct record {
+    uint32_t id;
+    uint16_t flags;
+    uint8_t name[10];
+};
+
+void test_device(::mram& sim) {
+    device<pointer_transport> dev(sim);
+    uint8_t out[100], in[100], status;
+
+    CHECK(dev.init());
+    for (size_t i = 0; i < sizeof(out); i++) out[i] = static_cast<uint8_t>(i * 3);
+    CHECK(dev.write(500, out, sizeof(out)));
+    CHECK(dev.read(500, in, sizeof(in)) && std::memcmp(in, out, sizeof(in)) == 0);
+    CHECK(std::memcmp(mram_sim_memory() + 500, out, sizeof(out)) == 0);
+    CHECK(!dev.read(MRAM_MAX_ADDRESS, in, 2));
+
+    // Typed addresses are range checked at compile time
+    record r = { 42, 7, { 'm', 'r', 'a', 'm' } }, back{};
+    CHECK(dev.write(at<0x1000>, r));
+    CHECK(dev.read(at<0x1000>, back) && std::memcmp(&r, &back, sizeof(r)) == 0);
+    CHECK(dev.read(at<0x1000>.offset<4>(), back.flags) && back.flags == 7);
+
+    CHECK(dev.read_status_register(status));
+    CHECK(dev.sleep() && dev.wake());
+
+    // A policy type of our own: adjacent segments share one frame
+    device<counting_transport> counted(sim);
+    CHECK(counted.init());
+    mram_iovec iov[2] = { { 2000, out, 50 }, { 2050, out + 50, 50 } };
+    size_t before = counted.transport().frames;
+    CHECK(counted.write_vector(iov, 2));
+    CHECK(counted.transport().frames - before == 3);  // WREN, data, WRDI
+    CHECK(std::memcmp(mram_sim_memory() + 2000, out, sizeof(out)) == 0);
+}
+
+template <class Device>
+void test_span(Device& dev) {
+    std::vector<uint32_t> words(64);
+    std::iota(words.begin(), words.end(), 1000u);
+    CHECK(write(dev, 4096, words));
+    std::array<uint32_t, 64> got{};
+    CHECK(read(dev, 4096, got) && std::equal(got.begin(), got.end(), words.begin()));
+
+    std::byte a[8], b[24];
+    std::memset(a, 0, sizeof(a));
+    std::memset(b, 0, sizeof(b));
+    std::array<std::span<std::byte>, 2> buffers = { std::span(a), std::span(b) };
+    CHECK(read(dev, 4096, buffers));
+    CHECK(std::memcmp(a, words.data(), sizeof(a)) == 0 && std::memcmp(b, words.data() + 2, sizeof(b)) == 0);
+
+    const std::byte x[4] = { std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 }, std::byte{ 4 } };
+    std::vector<write_segment> out = { { 8000, x }, { 9000, x } };
+    CHECK(write(dev, out));
+    std::byte y[4], z[4];
+    std::vector<read_segment> in = { { 9000, y }, { 8000, z } };
+    CHECK(read(dev, in));
+    CHECK(std::memcmp(y, x, 4) == 0 && std::memcmp(z, x, 4) == 0);
+
+    CHECK(!read(dev, MRAM_MAX_ADDRESS, std::span(y)));
+}
+
+void test_containers(::mram& sim) {
+    device<pointer_transport> dev(sim);
+    CHECK(dev.init());
+
+    {
+        array<record, 40> table(dev, 0x8000, 64);
+        vector<uint64_t> log(dev, 0x9000, 500);
+        ring<uint16_t> recent(dev, 0xC000, 8);
+        CHECK(table.format() && log.format() && recent.format());
+        for (size_t i = 0; i < table.size(); i++) table[i] = record{ static_cast<uint32_t>(i), 0, {} };
+        for (uint64_t i = 0; i < 300; i++) log.push_back(i * i);
+        for (uint16_t i = 0; i < 20; i++) recent.push_back(i);
+        CHECK(table.flush() && log.flush() && recent.flush());
+    }
+
+    // Reopened from the device; iteration goes through the block cache
+    array<record, 40> table(dev, 0x8000, 64);
+    vector<uint64_t> log(dev, 0x9000, 500);
+    ring<uint16_t> recent(dev, 0xC000, 8);
+    CHECK(table.open() && log.open() && recent.open());
+    CHECK(static_cast<record>(table[17]).id == 17);
+    CHECK(log.size() == 300 && log.get(299) == 299u * 299u);
+    uint64_t sum = std::accumulate(log.begin(), log.end(), uint64_t{ 0 });
+    CHECK(sum == 299u * 300u * 599u / 6);
+    CHECK(recent.size() == 8 && recent.get(0) == 12 && recent.back() == 19);
+    log.pop_back();
+    CHECK(log.flush());
+
+    bool threw = false;
+    try {
+        vector<uint64_t> tiny(dev, 0xD000, 1);
+        CHECK(tiny.format());
+        tiny.push_back(1);
+        tiny.push_back(2);
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+// Fire-and-forget coroutine; completion is reported through a counter
+struct task {
+    struct promise_type {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+task round_trip(async_device& dev, uint32_t addr, std::atomic<int>& passed, std::atomic<int>& done) {
+    std::array<std::byte, 16> out, in{};
+    out.fill(static_cast<std::byte>(addr >> 4));
+    bool ok = co_await dev.write(addr, out);
+    ok = ok && co_await dev.read(addr, in);
+    std::optional<uint8_t> status = co_await dev.read_status();
+    if (ok && in == out && status) passed++;
+    done++;
+    done.notify_all();
+}
+
+void test_coro(::mram& sim) {
+    constexpr int count = 200;
+    std::atomic<int> passed = 0, done = 0;
+    {
+        // A ring of 8 entries forces most operations through the overflow list
+        async_device dev(sim, 8);
+        for (int i = 0; i < count; i++) round_trip(dev, 0x10000 + i * 16u, passed, done);
+        for (int n = done.load(); n != count; n = done.load()) done.wait(n);
+    }
+    CHECK(passed == count);
+    CHECK(mram_sim_memory()[0x10000 + 5 * 16] == static_cast<uint8_t>((0x10000 + 5 * 16) >> 4));
+}
+
+void test_c_layers(::mram& sim) {
+    const mram_kv_config kv_config = { 0x20000, 8192, 16, 0 };
+    mram_kv kv;
+    char value[8];
+    size_t len;
+    CHECK(mram_kv_format(&sim, &kv_config) && mram_kv_open(&kv, &sim, &kv_config));
+    CHECK(mram_kv_put(&kv, "cpp", "linked", 6));
+    CHECK(mram_kv_get(&kv, "cpp", value, sizeof(value), &len) && len == 6);
+    CHECK(mram_kv_close(&kv));
+
+    uint8_t out[32], in[32];
+    std::memset(out, 0x6C, sizeof(out));
+    mram_sched sched;
+    CHECK(mram_sched_init(&sched, &sim, nullptr));
+    CHECK(mram_sched_write(&sched, 0x22000, out, sizeof(out)));
+    mram_sched_deinit(&sched);
+
+    mram_mt mt;
+    CHECK(mram_mt_init(&mt, &sim, MRAM_MT_DEFAULT_CAPACITY));
+    CHECK(mram_mt_read(&mt, 0x22000, in, sizeof(in)) && std::memcmp(in, out, sizeof(in)) == 0);
+    mram_mt_deinit(&mt);
+    CHECK(mram_crc32c(0, "123456789", 9) == 0xE3069283u);
+}
+
+}  // namespace
+
+int main() {
+    ::mram sim;
+    CHECK(mram_sim_init(&sim, nullptr));
+
+    test_device(sim);
+    test_span(sim);
+    device<pointer_transport> dev(sim);
+    test_span(dev);
+    test_containers(sim);
+    test_coro(sim);
+    test_c_layers(sim);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file test_delta.c
+ * @brief Delta writes and the shadow writer on the simulator
+ *
+ * Checks which runs are sent, how short unchanged gaps are merged, how the
+ * last frame is stretched once MRAM_DELTA_MAX_RUNS is reached, that
+ * statistics only change when the write succeeds, and that a shadow write
+ * cut part-way by power loss is read back from the device once it answers.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_delta.h"
+#include "test_util.h"
+
+#define BASE 4096
+#define SIZE 1024
+
+static uint8_t old_data[SIZE];
+static uint8_t new_data[SIZE];
+
+// Start from identical contents on the device and in both buffers
+static void reset(uint8_t seed) {
+    for (size_t i = 0; i < SIZE; i++) old_data[i] = (uint8_t)(seed + i * 3);
+    memcpy(new_data, old_data, SIZE);
+    memcpy(mram_sim_memory() + BASE, old_data, SIZE);
+}
+
+static void change(size_t pos, size_t len) {
+    for (size_t i = pos; i < pos + len; i++) new_data[i] ^= 0x5A;
+}
+
+// Delta-write new_data over old_data and check frames, bytes and contents
+static void check_delta(struct mram* mram, uint64_t frames, uint64_t bytes_sent) {
+    struct mram_delta_stats stats = { 0 };
+    struct mram_sim_stats before, after;
+
+    mram_sim_stats(&before);
+    CHECK(mram_write_delta_stats(mram, BASE, new_data, old_data, SIZE, &stats));
+    mram_sim_stats(&after);
+    CHECK(stats.bytes_requested == SIZE);
+    CHECK(stats.frames == frames && stats.bytes_sent == bytes_sent);
+    CHECK(memcmp(mram_sim_memory() + BASE, new_data, SIZE) == 0);
+
+    // One WREN/WRDI pair around the WRITE frames
+    CHECK(after.frames - before.frames == (frames ? frames + 2 : 0));
+    CHECK(after.write_enables - before.write_enables == (frames ? 1 : 0));
+}
+
+static void test_runs(struct mram* mram) {
+    // Nothing changed: no bus traffic
+    reset(1);
+    check_delta(mram, 0, 0);
+
+    // Separate runs, including ones that straddle the 16-byte scan steps
+    reset(2);
+    change(0, 1);
+    change(10, 20);
+    change(100, 5);
+    change(SIZE - 3, 3);
+    check_delta(mram, 4, 1 + 20 + 5 + 3);
+
+    // A gap of MRAM_DELTA_MERGE_GAP is resent, one byte more is not
+    reset(3);
+    change(200, 4);
+    change(204 + MRAM_DELTA_MERGE_GAP, 4);
+    check_delta(mram, 1, 4 + MRAM_DELTA_MERGE_GAP + 4);
+
+    reset(4);
+    change(200, 4);
+    change(204 + MRAM_DELTA_MERGE_GAP + 1, 4);
+    check_delta(mram, 2, 8);
+}
+
+static void test_max_runs(struct mram* mram) {
+    // Single changed bytes too far apart to merge, more than there are frames
+    enum { STEP = MRAM_DELTA_MERGE_GAP + 4, RUNS = MRAM_DELTA_MAX_RUNS + 6 };
+    _Static_assert(STEP * RUNS <= SIZE, "runs must fit the range");
+
+    reset(5);
+    for (size_t i = 0; i < RUNS; i++) change(i * STEP, 1);
+
+    // The last frame covers everything from its run to the last change
+    size_t stretched = (RUNS - MRAM_DELTA_MAX_RUNS) * STEP + 1;
+    check_delta(mram, MRAM_DELTA_MAX_RUNS, MRAM_DELTA_MAX_RUNS - 1 + stretched);
+}
+
+static void test_shadow(struct mram* mram) {
+    struct mram_shadow sh;
+    uint8_t data[32], back[32];
+
+    reset(6);
+    CHECK(mram_shadow_init(&sh, mram, BASE, SIZE));
+    memset(data, 0xC3, sizeof(data));
+    CHECK(mram_shadow_write(&sh, BASE + 64, data, sizeof(data)));
+    CHECK(sh.stats.frames == 1 && sh.stats.bytes_sent == sizeof(data));
+    CHECK(mram_shadow_read(&sh, BASE + 64, back, sizeof(back)) && memcmp(back, data, sizeof(data)) == 0);
+    CHECK(memcmp(mram_sim_memory() + BASE + 64, data, sizeof(data)) == 0);
+    CHECK(!mram_shadow_write(&sh, BASE + SIZE - 8, data, 16));
+
+    // Power is lost inside the second of four runs. The first run is on the
+    // device, so the range is unknown until it can be read back
+    enum { AT = 256, LEN = 128, RUN = 8, STEP = 32 };
+    struct mram_delta_stats stats = sh.stats;
+    uint8_t runs[LEN];
+    memcpy(runs, sh.shadow + AT, LEN);
+    for (size_t i = 0; i < LEN; i += STEP) memset(runs + i, 0x5A, RUN);
+    test_power.budget = RUN + RUN / 2;
+    CHECK(!mram_shadow_write(&sh, BASE + AT, runs, LEN));
+    CHECK(test_power_lost());
+    CHECK(memcmp(mram_sim_memory() + BASE + AT, runs, RUN + RUN / 2) == 0);
+    CHECK(memcmp(mram_sim_memory() + BASE + AT + STEP, runs + STEP, RUN) != 0);
+    CHECK(memcmp(&sh.stats, &stats, sizeof(stats)) == 0);
+    CHECK(!mram_shadow_read(&sh, BASE + AT + LEN - 4, back, 8));
+    CHECK(mram_shadow_read(&sh, BASE + 64, back, sizeof(back)) && memcmp(back, data, sizeof(data)) == 0);
+    CHECK(!mram_shadow_resync(&sh));
+    CHECK(!mram_shadow_write(&sh, BASE, data, sizeof(data)));
+
+    // Back on power the shadow takes the device's contents, and the retry
+    // sends only what the cut write did not
+    test_power_on(mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_shadow_resync(&sh));
+    CHECK(memcmp(sh.shadow, mram_sim_memory() + BASE, SIZE) == 0);
+    CHECK(mram_shadow_write(&sh, BASE + AT, runs, LEN));
+    CHECK(sh.stats.frames - stats.frames == LEN / STEP - 1);
+    CHECK(sh.stats.bytes_sent - stats.bytes_sent == LEN / STEP * RUN - RUN - RUN / 2);
+    CHECK(memcmp(sh.shadow, mram_sim_memory() + BASE, SIZE) == 0);
+    mram_shadow_deinit(&sh);
+}
+
+int main(void) {
+    struct mram mram;
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    test_runs(&mram);
+    test_max_runs(&mram);
+    test_shadow(&mram);
+    return 0;
+}
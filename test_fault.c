@@ -0,0 +1,215 @@
+/**
+ * @file test_fault.c
+ * @brief Fault and latency injection in front of the simulator
+ *
+ * Checks that one seed always injects the same faults, that each fault
+ * lands in its call class and files the API call under the right outcome,
+ * and that bit flips only ever hit data bytes, never the command or
+ * address of a frame, and are only counted when a byte changed.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_fault.h"
+#include "test_util.h"
+
+#define AREA  0x1000
+#define SPAN  4096
+#define OPS   400
+#define BYTES 64
+
+static struct mram sim;
+static struct mram mram;
+
+static uint8_t pattern(uint32_t addr) {
+    return (uint8_t)(addr * 31 + (addr >> 8));
+}
+
+static void reset_memory(void) {
+    for (uint32_t a = 0; a < SPAN; a++) mram_sim_memory()[AREA + a] = pattern(AREA + a);
+}
+
+// Pass everything through and close a frame an injected failure left open
+static void clear_rules(void) {
+    for (uint8_t c = 0; c < MRAM_FAULT_CLASSES; c++) CHECK(mram_fault_set_rule(c, NULL));
+    CHECK(mram.gpio_write(mram.cs_pin, MRAM_GPIO_HIGH));
+}
+
+// Results, data read back and counters of a fixed workload under one seed
+struct run {
+    bool results[OPS];
+    uint8_t data[OPS][BYTES];
+    struct mram_fault_stats stats;
+};
+
+static void run_workload(uint64_t seed, struct run* run) {
+    const struct mram_fault_rule rule = { .fail_ppm = 200000, .flip_ppm = 300000 };
+
+    reset_memory();
+    clear_rules();
+    CHECK(mram_fault_set_rule(MRAM_FAULT_READ, &rule));
+    CHECK(mram_fault_set_rule(MRAM_FAULT_WRITE, &rule));
+    mram_fault_seed(seed);
+    mram_fault_reset_stats();
+
+    // Failed calls may leave CS low, so every call starts a fresh frame
+    memset(run, 0, sizeof(*run));
+    for (uint32_t i = 0; i < OPS; i++) {
+        uint32_t addr = AREA + (i * 97) % (SPAN - BYTES);
+        CHECK(mram.gpio_write(mram.cs_pin, MRAM_GPIO_HIGH));
+        if (i % 3 == 0) {
+            uint8_t data[BYTES];
+            memset(data, (int)i, sizeof(data));
+            run->results[i] = mram_write(&mram, addr, data, sizeof(data));
+        } else {
+            run->results[i] = mram_read(&mram, addr, run->data[i], BYTES);
+        }
+    }
+    mram_fault_stats(&run->stats);
+}
+
+static void test_seed(void) {
+    static struct run a, b, c;
+
+    run_workload(1234, &a);
+    run_workload(1234, &b);
+    run_workload(5678, &c);
+    CHECK(memcmp(a.results, b.results, sizeof(a.results)) == 0);
+    CHECK(memcmp(a.data, b.data, sizeof(a.data)) == 0);
+    CHECK(memcmp(a.stats.classes, b.stats.classes, sizeof(a.stats.classes)) == 0);
+    for (int o = 0; o < MRAM_FAULT_OUTCOMES; o++) {
+        CHECK(a.stats.outcomes[o].count == b.stats.outcomes[o].count);
+        CHECK(a.stats.outcomes[o].errors == b.stats.outcomes[o].errors);
+    }
+    CHECK(a.stats.classes[MRAM_FAULT_READ].failures > 0 && a.stats.classes[MRAM_FAULT_READ].flips > 0);
+    CHECK(a.stats.classes[MRAM_FAULT_WRITE].failures > 0 && a.stats.classes[MRAM_FAULT_WRITE].flips > 0);
+    CHECK(memcmp(a.results, c.results, sizeof(a.results)) != 0);
+}
+
+// Apply one rule to one class, make one API call and check where it was filed
+static void check_outcome(uint8_t cls, const struct mram_fault_rule* rule, int op, bool ok, uint8_t outcome) {
+    struct mram_fault_stats stats;
+    uint8_t buf[16] = { 0 };
+    uint8_t status;
+
+    reset_memory();
+    clear_rules();
+    CHECK(mram_fault_set_rule(cls, rule));
+    mram_fault_reset_stats();
+
+    bool result;
+    if (op == MRAM_FAULT_READ) {
+        result = mram_read(&mram, AREA, buf, sizeof(buf));
+    } else if (op == MRAM_FAULT_WRITE) {
+        result = mram_write(&mram, AREA, buf, sizeof(buf));
+    } else {
+        result = mram_read_status_register(&mram, &status);
+    }
+    CHECK(result == ok);
+
+    mram_fault_stats(&stats);
+    for (int o = 0; o < MRAM_FAULT_OUTCOMES; o++) {
+        CHECK(stats.outcomes[o].count == (o == outcome ? 1u : 0u));
+        CHECK(stats.outcomes[o].errors == (o == outcome && !ok ? 1u : 0u));
+    }
+
+    // Only the class the rule belongs to injected anything
+    for (int c = 0; c < MRAM_FAULT_CLASSES; c++) {
+        const struct mram_fault_class_stats* s = &stats.classes[c];
+        uint64_t injected = s->delayed + s->stalls + s->failures + s->flips;
+        CHECK(c == cls ? injected > 0 : injected == 0);
+    }
+    clear_rules();
+}
+
+static void test_classes(void) {
+    const struct mram_fault_rule fail = { .fail_ppm = 1000000 };
+    const struct mram_fault_rule flip = { .flip_ppm = 1000000 };
+    const struct mram_fault_rule delay = { .dist = MRAM_FAULT_DIST_FIXED, .latency_us = 1 };
+    const struct mram_fault_rule stall = { .stall_ppm = 1000000, .stall_us = 1 };
+    const struct mram_fault_rule worst = { .dist = MRAM_FAULT_DIST_FIXED, .latency_us = 1, .stall_ppm = 1000000,
+                                           .stall_us = 1, .fail_ppm = 1000000, .flip_ppm = 1000000 };
+
+    check_outcome(MRAM_FAULT_READ, &fail, MRAM_FAULT_READ, false, MRAM_FAULT_FAILED);
+    check_outcome(MRAM_FAULT_WRITE, &fail, MRAM_FAULT_WRITE, false, MRAM_FAULT_FAILED);
+    check_outcome(MRAM_FAULT_STATUS, &fail, MRAM_FAULT_STATUS, false, MRAM_FAULT_FAILED);
+    check_outcome(MRAM_FAULT_CONTROL, &fail, MRAM_FAULT_WRITE, false, MRAM_FAULT_FAILED);
+    check_outcome(MRAM_FAULT_GPIO, &fail, MRAM_FAULT_READ, false, MRAM_FAULT_FAILED);
+    check_outcome(MRAM_FAULT_READ, &flip, MRAM_FAULT_READ, true, MRAM_FAULT_FLIPPED);
+    check_outcome(MRAM_FAULT_WRITE, &flip, MRAM_FAULT_WRITE, true, MRAM_FAULT_FLIPPED);
+    check_outcome(MRAM_FAULT_STATUS, &flip, MRAM_FAULT_STATUS, true, MRAM_FAULT_FLIPPED);
+    check_outcome(MRAM_FAULT_READ, &delay, MRAM_FAULT_READ, true, MRAM_FAULT_DELAYED);
+    check_outcome(MRAM_FAULT_GPIO, &stall, MRAM_FAULT_WRITE, true, MRAM_FAULT_STALLED);
+    check_outcome(MRAM_FAULT_READ, &worst, MRAM_FAULT_READ, false, MRAM_FAULT_FAILED);
+
+    // Flips are not planned for frames without data
+    check_outcome(MRAM_FAULT_CONTROL, &delay, MRAM_FAULT_WRITE, true, MRAM_FAULT_DELAYED);
+}
+
+static unsigned bits_set(uint8_t v) {
+    return (unsigned)__builtin_popcount(v);
+}
+
+static void test_flip_placement(void) {
+    const struct mram_fault_rule flip = { .flip_ppm = 1000000 };
+    struct mram_fault_stats stats;
+    uint8_t data[BYTES], buf[BYTES];
+
+    clear_rules();
+    CHECK(mram_fault_set_rule(MRAM_FAULT_WRITE, &flip));
+    CHECK(mram_fault_set_rule(MRAM_FAULT_READ, &flip));
+
+    for (uint64_t seed = 0; seed < 200; seed++) {
+        uint32_t addr = AREA + (uint32_t)(seed * 13) % (SPAN - BYTES);
+        mram_fault_seed(seed);
+
+        // A written frame differs from the data in exactly one bit, at its
+        // own address; a flipped command or address would land elsewhere
+        reset_memory();
+        memset(data, 0, sizeof(data));
+        CHECK(mram_write(&mram, addr, data, sizeof(data)));
+        unsigned flipped = 0;
+        for (uint32_t a = AREA; a < AREA + SPAN; a++) {
+            uint8_t v = mram_sim_memory()[a];
+            if (a >= addr && a < addr + BYTES) {
+                flipped += bits_set(v);
+            } else {
+                CHECK(v == pattern(a));
+            }
+        }
+        CHECK(flipped == 1);
+
+        // A read returns the bytes of its own address with one bit inverted
+        reset_memory();
+        CHECK(mram_read(&mram, addr, buf, sizeof(buf)));
+        flipped = 0;
+        for (uint32_t i = 0; i < BYTES; i++) flipped += bits_set((uint8_t)(buf[i] ^ pattern(addr + i)));
+        CHECK(flipped == 1);
+    }
+
+    // Read data clocked without a receive buffer cannot be flipped, so
+    // nothing is counted
+    static const uint8_t header[4] = { MRAM_CMD_READ, 0, (AREA >> 8) & 0xFF, AREA & 0xFF };
+    uint8_t dummy[16];
+    memset(dummy, 0xFF, sizeof(dummy));
+    mram_fault_reset_stats();
+    CHECK(mram.gpio_write(mram.cs_pin, MRAM_GPIO_LOW));
+    CHECK(mram.spi_transfer(header, NULL, sizeof(header)));
+    CHECK(mram.spi_transfer(dummy, NULL, sizeof(dummy)));
+    CHECK(mram.gpio_write(mram.cs_pin, MRAM_GPIO_HIGH));
+    mram_fault_stats(&stats);
+    CHECK(stats.classes[MRAM_FAULT_READ].calls == 2 && stats.classes[MRAM_FAULT_READ].flips == 0);
+    clear_rules();
+}
+
+int main(void) {
+    CHECK(mram_sim_init(&sim, NULL));
+    CHECK(mram_fault_init(&mram, &sim, 1));
+    test_seed();
+    test_classes();
+    test_flip_placement();
+    return 0;
+}
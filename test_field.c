@@ -0,0 +1,173 @@
+/**
+ * @file test_field.c
+ * @brief Field-granular struct access on the simulator
+ *
+ * Checks the MRAM_FIELD_* address and size macros against offsetof(), that
+ * member accesses touch only the member's bytes and ranges leaving a member
+ * are refused without bus traffic, and that a batch sends adjacent members
+ * in one frame while an overlapping later write still wins. Frames are
+ * counted by the simulator.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_field.h"
+#include "test_util.h"
+
+#define BASE 0x2000
+
+struct record {
+    uint32_t counter;
+    uint16_t flags;
+    uint16_t kind;
+    uint8_t name[16];
+    uint64_t stamp;
+    uint8_t payload[200];
+};
+
+static uint8_t expected[sizeof(struct record)];
+
+static uint64_t frames(void) {
+    struct mram_sim_stats stats;
+    mram_sim_stats(&stats);
+    return stats.frames;
+}
+
+static bool record_is_expected(void) {
+    return memcmp(mram_sim_memory() + BASE, expected, sizeof(expected)) == 0;
+}
+
+static void test_macros(struct mram* mram) {
+    CHECK(MRAM_FIELD_ADDR(struct record, BASE, counter) == BASE);
+    CHECK(MRAM_FIELD_ADDR(struct record, BASE, stamp) == BASE + offsetof(struct record, stamp));
+    CHECK(MRAM_FIELD_ADDR(struct record, BASE, payload) == BASE + offsetof(struct record, payload));
+    CHECK(MRAM_FIELD_SIZE(struct record, flags) == 2 && MRAM_FIELD_SIZE(struct record, name) == 16);
+    CHECK(MRAM_FIELD_SIZE(struct record, payload) == 200);
+
+    // A member write moves only the member's bytes: WREN, WRITE, WRDI
+    uint32_t counter = 0x11223344u;
+    uint64_t before = frames();
+    CHECK(MRAM_FIELD_WRITE(mram, struct record, BASE, counter, &counter));
+    CHECK(frames() - before == 3);
+    memcpy(expected + offsetof(struct record, counter), &counter, sizeof(counter));
+    CHECK(record_is_expected());
+
+    uint64_t stamp = 0x0102030405060708ull;
+    CHECK(MRAM_FIELD_WRITE(mram, struct record, BASE, stamp, &stamp));
+    memcpy(expected + offsetof(struct record, stamp), &stamp, sizeof(stamp));
+    CHECK(record_is_expected());
+
+    uint16_t flags = 0;
+    uint64_t stamp_back = 0;
+    CHECK(MRAM_FIELD_READ(mram, struct record, BASE, flags, &flags));
+    CHECK(flags == 0xA5A5);
+    CHECK(MRAM_FIELD_READ(mram, struct record, BASE, stamp, &stamp_back) && stamp_back == stamp);
+}
+
+static void test_ranges(struct mram* mram) {
+    uint8_t buf[32];
+    memset(buf, 0x77, sizeof(buf));
+
+    CHECK(MRAM_FIELD_WRITE_RANGE(mram, struct record, BASE, name, 4, buf, 8));
+    memset(expected + offsetof(struct record, name) + 4, 0x77, 8);
+    CHECK(MRAM_FIELD_WRITE_RANGE(mram, struct record, BASE, name, 0, buf, 16));
+    memset(expected + offsetof(struct record, name), 0x77, 16);
+    CHECK(record_is_expected());
+    CHECK(MRAM_FIELD_READ_RANGE(mram, struct record, BASE, payload, 190, buf, 10));
+    CHECK(memcmp(buf, expected + offsetof(struct record, payload) + 190, 10) == 0);
+
+    // Ranges that leave the member are refused before anything is sent
+    uint64_t before = frames();
+    CHECK(!MRAM_FIELD_WRITE_RANGE(mram, struct record, BASE, name, 10, buf, 8));
+    CHECK(!MRAM_FIELD_WRITE_RANGE(mram, struct record, BASE, name, 17, buf, 0));
+    CHECK(!MRAM_FIELD_READ_RANGE(mram, struct record, BASE, flags, 1, buf, 2));
+    CHECK(!MRAM_FIELD_READ_RANGE(mram, struct record, BASE, payload, 0, buf, 201));
+    CHECK(!mram_field_read(mram, MRAM_MAX_ADDRESS, buf, 2));
+    CHECK(!mram_field_write(mram, MRAM_MAX_ADDRESS, buf, 2));
+    CHECK(frames() == before);
+    CHECK(record_is_expected());
+}
+
+static void test_batch(struct mram* mram) {
+    struct mram_field_batch batch;
+    uint32_t counter = 7;
+    uint16_t flags = 0x0101;
+    uint16_t kind = 0x0202;
+    uint64_t stamp = 42;
+
+    // Added out of order; counter, flags and kind are adjacent, stamp is not
+    mram_field_batch_init(&batch);
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, stamp, &stamp));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, kind, &kind));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, counter, &counter));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, flags, &flags));
+    CHECK(batch.count == 4);
+    for (size_t i = 1; i < batch.count; i++) CHECK(batch.iov[i - 1].addr < batch.iov[i].addr);
+
+    uint64_t before = frames();
+    CHECK(mram_field_batch_write(mram, &batch));
+    CHECK(frames() - before == 4);
+    memcpy(expected + offsetof(struct record, counter), &counter, sizeof(counter));
+    memcpy(expected + offsetof(struct record, flags), &flags, sizeof(flags));
+    memcpy(expected + offsetof(struct record, kind), &kind, sizeof(kind));
+    memcpy(expected + offsetof(struct record, stamp), &stamp, sizeof(stamp));
+    CHECK(record_is_expected());
+
+    // With name in between, every member up to stamp is one READ frame
+    struct record back;
+    memset(&back, 0, sizeof(back));
+    mram_field_batch_init(&batch);
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, stamp, &back.stamp));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, name, &back.name));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, flags, &back.flags));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, counter, &back.counter));
+    CHECK(MRAM_FIELD_BATCH_ADD(&batch, struct record, BASE, kind, &back.kind));
+    before = frames();
+    CHECK(mram_field_batch_read(mram, &batch));
+    CHECK(frames() - before == 1);
+    CHECK(memcmp(&back, expected, offsetof(struct record, payload)) == 0);
+
+    // An overlapping later write at a lower address stays after the earlier one
+    uint8_t first[10], second[20], third[4];
+    uint32_t payload = MRAM_FIELD_ADDR(struct record, BASE, payload);
+    memset(first, 0x10, sizeof(first));
+    memset(second, 0x20, sizeof(second));
+    memset(third, 0x30, sizeof(third));
+    mram_field_batch_init(&batch);
+    CHECK(mram_field_batch_add(&batch, payload + 50, first, sizeof(first)));
+    CHECK(mram_field_batch_add(&batch, payload + 40, second, sizeof(second)));
+    CHECK(mram_field_batch_add(&batch, payload + 58, third, sizeof(third)));
+    CHECK(mram_field_batch_add(&batch, payload + 10, third, sizeof(third)));
+    CHECK(batch.iov[0].addr == payload + 10);
+    CHECK(mram_field_batch_write(mram, &batch));
+    uint8_t* p = expected + offsetof(struct record, payload);
+    memcpy(p + 50, first, sizeof(first));
+    memcpy(p + 40, second, sizeof(second));
+    memcpy(p + 58, third, sizeof(third));
+    memcpy(p + 10, third, sizeof(third));
+    CHECK(record_is_expected());
+
+    // Full and invalid additions are refused
+    mram_field_batch_init(&batch);
+    for (int i = 0; i < MRAM_FIELD_MAX_BATCH; i++) CHECK(mram_field_batch_add(&batch, payload + i, first, 1));
+    CHECK(!mram_field_batch_add(&batch, payload, first, 1));
+    mram_field_batch_init(&batch);
+    CHECK(!mram_field_batch_add(&batch, payload, first, 0));
+    CHECK(!mram_field_batch_add(&batch, MRAM_MAX_ADDRESS, first, 2));
+    CHECK(mram_field_batch_write(mram, &batch));
+}
+
+int main(void) {
+    struct mram mram;
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    memset(mram_sim_memory() + BASE, 0xA5, sizeof(struct record));
+    memset(expected, 0xA5, sizeof(expected));
+    test_macros(&mram);
+    test_ranges(&mram);
+    test_batch(&mram);
+    return 0;
+}
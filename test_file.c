@@ -0,0 +1,103 @@
+/**
+ * @file test_file.c
+ * @brief Nonvolatile status register on the simulator and the file device
+ *
+ * Sets block protection, power-cycles the simulated device and reopens an
+ * image file, and checks that BP0, BP1 and WPEN survive both while the
+ * write enable latch does not. Images from before the status byte are
+ * extended on open; images of any other size are refused.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // ftruncate
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mram_file.h"
+#include "test_util.h"
+
+static char path[64];
+
+static void test_power_cycle(void) {
+    struct mram mram;
+    uint8_t status, data[16], back[16];
+
+    CHECK(mram_sim_init(&mram, NULL));
+    CHECK(mram_write_status_register(&mram, MRAM_STATUS_BP1 | MRAM_STATUS_BP0));
+    CHECK(mram_write_enable(&mram));
+
+    CHECK(mram_sim_init(&mram, mram_sim_memory()));
+    CHECK(mram_read_status_register(&mram, &status));
+    CHECK(status == (MRAM_STATUS_BP1 | MRAM_STATUS_BP0));
+    memset(data, 0x5A, sizeof(data));
+    CHECK(mram_write(&mram, 0, data, sizeof(data)));
+    CHECK(mram_read(&mram, 0, back, sizeof(back)) && back[0] != 0x5A);
+
+    // Another array is another device
+    static uint8_t other[MRAM_SIZE_BYTES];
+    CHECK(mram_sim_init(&mram, other));
+    CHECK(mram_read_status_register(&mram, &status) && status == 0);
+}
+
+static void test_reopen(void) {
+    struct mram_file file;
+    struct mram mram;
+    uint8_t status, data[16], back[16];
+    struct stat st;
+
+    unlink(path);
+    CHECK(mram_file_open(&file, &mram, path));
+    CHECK(stat(path, &st) == 0 && st.st_size == MRAM_FILE_IMAGE_SIZE);
+    memset(data, 0x33, sizeof(data));
+    CHECK(mram_write(&mram, MRAM_MAX_ADDRESS - 15, data, sizeof(data)));
+    CHECK(mram_write_status_register(&mram, MRAM_STATUS_WPEN | MRAM_STATUS_BP0));
+    mram_file_close(&file);
+
+    CHECK(mram_file_open(&file, &mram, path));
+    CHECK(mram_read_status_register(&mram, &status));
+    CHECK(status == (MRAM_STATUS_WPEN | MRAM_STATUS_BP0));
+    memset(back, 0x44, sizeof(back));
+    CHECK(mram_write(&mram, MRAM_MAX_ADDRESS - 15, back, sizeof(back)));
+    CHECK(mram_read(&mram, MRAM_MAX_ADDRESS - 15, back, sizeof(back)) && memcmp(back, data, 16) == 0);
+    CHECK(mram_write_status_register(&mram, 0));
+    mram_file_close(&file);
+
+    CHECK(mram_file_open(&file, &mram, path));
+    CHECK(mram_read_status_register(&mram, &status) && status == 0);
+    mram_file_close(&file);
+}
+
+static void test_image_size(void) {
+    struct mram_file file;
+    struct mram mram;
+    uint8_t status;
+    struct stat st;
+
+    // An image without the status byte opens unprotected and is extended
+    int fd = open(path, O_RDWR | O_TRUNC);
+    CHECK(fd >= 0 && ftruncate(fd, MRAM_SIZE_BYTES) == 0);
+    close(fd);
+    CHECK(mram_file_open(&file, &mram, path));
+    CHECK(mram_read_status_register(&mram, &status) && status == 0);
+    mram_file_close(&file);
+    CHECK(stat(path, &st) == 0 && st.st_size == MRAM_FILE_IMAGE_SIZE);
+
+    fd = open(path, O_RDWR);
+    CHECK(fd >= 0 && ftruncate(fd, MRAM_FILE_IMAGE_SIZE + 1) == 0);
+    close(fd);
+    CHECK(!mram_file_open(&file, &mram, path));
+}
+
+int main(void) {
+    snprintf(path, sizeof(path), "/tmp/test_file_%d.img", (int)getpid());
+
+    test_power_cycle();
+    test_reopen();
+    test_image_size();
+    unlink(path);
+    return 0;
+}
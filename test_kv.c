@@ -0,0 +1,252 @@
+/**
+ * @file test_kv.c
+ * @brief Key-value store behavior and crash consistency on the simulator
+ *
+ * Cuts power after every write payload byte of an update, a delete and a
+ * compaction, and checks after each reopen that the other keys are intact
+ * and that the key being changed holds its old or its new value. A read
+ * error while loading the index snapshot has to fall back to a clean scan.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_kv.h"
+#include "test_util.h"
+
+static const struct mram_kv_config config = { .base = 4096, .size = 8192, .max_entries = 32 };
+
+static uint8_t baseline[8192];
+
+// One-shot failure in front of the simulator: READ frame number fail_read
+// (counted from 1) fails, everything else goes through
+static struct {
+    struct mram sim;
+    uint32_t reads;
+    uint32_t fail_read;
+    bool frame_start;
+} flaky;
+
+static bool flaky_gpio(uint8_t pin, uint8_t value) {
+    if (value == MRAM_GPIO_LOW) flaky.frame_start = true;
+    return flaky.sim.gpio_write(pin, value);
+}
+
+static bool flaky_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    bool start = flaky.frame_start;
+    flaky.frame_start = false;
+    if (start && tx_buf && len > 0 && tx_buf[0] == MRAM_CMD_READ && ++flaky.reads == flaky.fail_read) return false;
+    return flaky.sim.spi_transfer(tx_buf, rx_buf, len);
+}
+
+static void save_baseline(void) {
+    memcpy(baseline, mram_sim_memory() + config.base, sizeof(baseline));
+}
+
+static void restore_baseline(void) {
+    memcpy(mram_sim_memory() + config.base, baseline, sizeof(baseline));
+}
+
+static void fill_value(char* value, size_t len, int seed) {
+    for (size_t i = 0; i < len; i++) value[i] = (char)('a' + (seed + i) % 26);
+}
+
+static bool value_is(struct mram_kv* kv, const char* key, size_t len, int seed) {
+    char expected[MRAM_KV_MAX_VALUE_LEN];
+    char value[MRAM_KV_MAX_VALUE_LEN];
+    size_t got;
+    fill_value(expected, len, seed);
+    return mram_kv_get(kv, key, value, sizeof(value), &got) && got == len && memcmp(value, expected, len) == 0;
+}
+
+static bool absent(struct mram_kv* kv, const char* key) {
+    char value[MRAM_KV_MAX_VALUE_LEN];
+    return !mram_kv_get(kv, key, value, sizeof(value), NULL);
+}
+
+static bool put_value(struct mram_kv* kv, const char* key, size_t len, int seed) {
+    char value[MRAM_KV_MAX_VALUE_LEN];
+    fill_value(value, len, seed);
+    return mram_kv_put(kv, key, value, len);
+}
+
+// Keys k0..k7 with 40-byte values; k1, k3 and k5 deleted to leave dead space
+static void make_baseline(void) {
+    struct mram mram;
+    struct mram_kv kv;
+    char key[16];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_kv_format(&mram, &config));
+    CHECK(mram_kv_open(&kv, &mram, &config));
+    for (int i = 0; i < 8; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        CHECK(put_value(&kv, key, 40, i));
+    }
+    CHECK(mram_kv_delete(&kv, "k1"));
+    CHECK(mram_kv_delete(&kv, "k3"));
+    CHECK(mram_kv_delete(&kv, "k5"));
+    CHECK(mram_kv_close(&kv));
+    save_baseline();
+}
+
+static void check_untouched(struct mram_kv* kv, const char* skip) {
+    char key[16];
+    for (int i = 0; i < 8; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        if (skip && strcmp(key, skip) == 0) continue;
+        if (i == 1 || i == 3 || i == 5) {
+            CHECK(absent(kv, key));
+        } else {
+            CHECK(value_is(kv, key, 40, i));
+        }
+    }
+}
+
+enum crash_op {
+    CRASH_APPEND,    // k2 grows past its record and is appended
+    CRASH_IN_PLACE,  // k4 is rewritten inside its record
+    CRASH_DELETE,    // k6 is deleted
+    CRASH_COMPACT,   // dead records are reclaimed
+};
+
+// Run op with power lost after each payload byte in turn until it completes
+static void crash_sweep(enum crash_op op) {
+    bool lost = true;
+    for (size_t budget = 0; lost; budget++) {
+        struct mram mram;
+        struct mram_kv kv;
+
+        restore_baseline();
+        test_power_on(&mram, budget);
+        if (mram_kv_open(&kv, &mram, &config)) {
+            switch (op) {
+                case CRASH_APPEND:
+                    put_value(&kv, "k2", 200, 100);
+                    break;
+                case CRASH_IN_PLACE:
+                    put_value(&kv, "k4", 40, 200);
+                    break;
+                case CRASH_DELETE:
+                    mram_kv_delete(&kv, "k6");
+                    break;
+                case CRASH_COMPACT:
+                    mram_kv_compact(&kv);
+                    break;
+            }
+            mram_kv_close(&kv);
+        }
+        lost = test_power_lost();
+
+        test_power_on(&mram, TEST_POWER_UNLIMITED);
+        CHECK(mram_kv_open(&kv, &mram, &config));
+        switch (op) {
+            case CRASH_APPEND:
+                check_untouched(&kv, "k2");
+                CHECK(value_is(&kv, "k2", 40, 2) || value_is(&kv, "k2", 200, 100));
+                if (!lost) CHECK(value_is(&kv, "k2", 200, 100));
+                break;
+            case CRASH_IN_PLACE:
+                // A torn in-place write is finished from the staging slot
+                check_untouched(&kv, "k4");
+                CHECK(value_is(&kv, "k4", 40, 4) || value_is(&kv, "k4", 40, 200));
+                if (!lost) CHECK(value_is(&kv, "k4", 40, 200));
+                break;
+            case CRASH_DELETE:
+                check_untouched(&kv, "k6");
+                CHECK(value_is(&kv, "k6", 40, 6) || absent(&kv, "k6"));
+                if (!lost) CHECK(absent(&kv, "k6"));
+                break;
+            case CRASH_COMPACT:
+                check_untouched(&kv, NULL);
+                CHECK(mram_kv_count(&kv) == 5);
+                break;
+        }
+        // The recovered store must accept new writes
+        CHECK(put_value(&kv, "new", 30, 7));
+        CHECK(value_is(&kv, "new", 30, 7));
+        CHECK(mram_kv_close(&kv));
+    }
+}
+
+static void test_basic(void) {
+    struct mram mram;
+    struct mram_kv kv;
+    char value[64];
+    size_t len;
+
+    make_baseline();
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_kv_open(&kv, &mram, &config));
+    CHECK(mram_kv_count(&kv) == 5);
+    check_untouched(&kv, NULL);
+    CHECK(!mram_kv_get(&kv, "k0", value, 8, &len));
+    CHECK(mram_kv_put(&kv, "k0", "short", 5));
+    CHECK(mram_kv_get(&kv, "k0", value, sizeof(value), &len) && len == 5 && memcmp(value, "short", 5) == 0);
+
+    // An empty value round-trips without a buffer on either side
+    CHECK(mram_kv_put(&kv, "empty", NULL, 0));
+    CHECK(mram_kv_get(&kv, "empty", NULL, 0, &len) && len == 0);
+    CHECK(mram_kv_delete(&kv, "empty"));
+    CHECK(mram_kv_compact(&kv));
+    CHECK(mram_kv_count(&kv) == 5);
+    CHECK(mram_kv_close(&kv));
+
+    // Lose power before the close: the log scan finds the same contents
+    CHECK(mram_kv_open(&kv, &mram, &config));
+    CHECK(mram_kv_delete(&kv, "k0"));
+    test_power_on(&mram, 0);
+    CHECK(!mram_kv_close(&kv));
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_kv_open(&kv, &mram, &config));
+    CHECK(absent(&kv, "k0"));
+    CHECK(value_is(&kv, "k2", 40, 2));
+    CHECK(mram_kv_close(&kv));
+}
+
+// A read error part way through a multi-chunk snapshot falls back to the
+// log scan, which must not build on the entries loaded before the error
+static void test_snapshot_read_error(void) {
+    static const struct mram_kv_config big = { .base = 65536, .size = 65536, .max_entries = 256 };
+    struct mram mram;
+    struct mram_kv kv;
+    char key[16];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_kv_format(&mram, &big));
+    CHECK(mram_kv_open(&kv, &mram, &big));
+    for (int i = 0; i < 250; i++) {
+        snprintf(key, sizeof(key), "s%d", i);
+        CHECK(put_value(&kv, key, 8, i));
+    }
+    CHECK(mram_kv_close(&kv));
+
+    // Superblocks, first snapshot chunk, then the second chunk fails
+    CHECK(mram_sim_init(&flaky.sim, mram_sim_memory()));
+    CHECK(mram_init(&mram, flaky_gpio, flaky_spi, MRAM_SIM_CS_PIN));
+    flaky.reads = 0;
+    flaky.fail_read = 3;
+    CHECK(mram_kv_open(&kv, &mram, &big));
+    CHECK(flaky.reads > 3);
+    CHECK(mram_kv_count(&kv) == 250);
+    for (int i = 0; i < 250; i++) {
+        snprintf(key, sizeof(key), "s%d", i);
+        CHECK(value_is(&kv, key, 8, i));
+    }
+    CHECK(mram_kv_delete(&kv, "s7") && mram_kv_count(&kv) == 249);
+    CHECK(mram_kv_close(&kv));
+}
+
+int main(void) {
+    test_basic();
+    test_snapshot_read_error();
+
+    make_baseline();
+    crash_sweep(CRASH_APPEND);
+    crash_sweep(CRASH_IN_PLACE);
+    crash_sweep(CRASH_DELETE);
+    crash_sweep(CRASH_COMPACT);
+    return 0;
+}
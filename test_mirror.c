@@ -0,0 +1,240 @@
+/**
+ * @file test_mirror.c
+ * @brief Mirrored volume ordering, degradation and resync
+ *
+ * The simulator is one device per process, so the replicas here are small
+ * memory-backed MR25H40 models told apart by their chip select pin. Every
+ * replica is driven only by its own worker thread, which keeps the selected
+ * pin in thread-local state.
+ *
+ * Checks that concurrent overlapping writes leave every replica identical,
+ * that a replica whose bus fails is degraded out while the volume keeps
+ * serving, and that it is copied back to ACTIVE under write load once it
+ * answers again.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // nanosleep
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include "mram_mirror.h"
+#include "test_util.h"
+
+#define REPLICAS 3
+#define RANGE    65536
+#define WRITERS  8
+
+// Minimal replica model: WREN, WRDI, RDSR, READ and WRITE
+struct replica {
+    uint8_t mem[RANGE];
+    uint32_t pos;
+    uint32_t addr;
+    uint8_t cmd;
+    bool wel;
+    atomic_bool down;
+};
+
+static struct replica replicas[REPLICAS];
+static _Thread_local struct replica* selected;
+
+static bool replica_gpio(uint8_t pin, uint8_t value) {
+    if (pin >= REPLICAS) return false;
+    struct replica* r = &replicas[pin];
+    if (atomic_load(&r->down)) return false;
+    selected = value == MRAM_GPIO_LOW ? r : NULL;
+    r->pos = 0;
+    return true;
+}
+
+static bool replica_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    struct replica* r = selected;
+    if (r == NULL || atomic_load(&r->down)) return false;
+
+    for (size_t i = 0; i < len; i++, r->pos++) {
+        uint8_t in = tx_buf ? tx_buf[i] : 0xFF;
+        uint8_t out = 0xFF;
+        if (r->pos == 0) {
+            r->cmd = in;
+            r->addr = 0;
+            if (in == MRAM_CMD_WREN) r->wel = true;
+            if (in == MRAM_CMD_WRDI) r->wel = false;
+        } else if (r->cmd == MRAM_CMD_RDSR) {
+            out = r->wel ? 0x02 : 0x00;
+        } else if (r->pos < 4) {
+            r->addr = (r->addr << 8) | in;
+        } else if (r->cmd == MRAM_CMD_READ) {
+            out = r->mem[r->addr++ % RANGE];
+        } else if (r->cmd == MRAM_CMD_WRITE && r->wel) {
+            r->mem[r->addr++ % RANGE] = in;
+        }
+        if (rx_buf) rx_buf[i] = out;
+    }
+    return true;
+}
+
+static struct mram devices[REPLICAS];
+static struct mram* const device_list[REPLICAS] = { &devices[0], &devices[1], &devices[2] };
+
+static const struct mram_mirror_config config = { .base = 0, .size = RANGE, .split_threshold = 1024, .probe_ms = 2 };
+
+static void setup(struct mram_mirror* mirror) {
+    for (uint8_t r = 0; r < REPLICAS; r++) {
+        memset(replicas[r].mem, 0, RANGE);
+        atomic_store(&replicas[r].down, false);
+        CHECK(mram_init(&devices[r], replica_gpio, replica_spi, r));
+    }
+    CHECK(mram_mirror_init(mirror, device_list, REPLICAS, &config));
+}
+
+static bool replicas_identical(void) {
+    for (int r = 1; r < REPLICAS; r++) {
+        if (memcmp(replicas[0].mem, replicas[r].mem, RANGE) != 0) return false;
+    }
+    return true;
+}
+
+static bool wait_state(struct mram_mirror* mirror, uint32_t replica, enum mram_mirror_state state) {
+    struct timespec tick = { 0, 1000000 };
+    for (int i = 0; i < 5000; i++) {
+        if (mram_mirror_replica_state(mirror, replica) == state) return true;
+        nanosleep(&tick, NULL);
+    }
+    return false;
+}
+
+// Writers hammer overlapping ranges with their own patterns until they
+// reach their limit (0 = none) or are told to stop
+struct writer {
+    struct mram_mirror* mirror;
+    atomic_bool* stop;
+    uint32_t seed;
+    uint32_t limit;
+    uint32_t writes;
+};
+
+static void* writer_thread(void* arg) {
+    struct writer* w = arg;
+    uint8_t data[64];
+    uint32_t x = w->seed;
+
+    while (!atomic_load(w->stop)) {
+        x = x * 1103515245u + 12345u;
+        uint32_t len = 1 + (x >> 8) % sizeof(data);
+        x = x * 1103515245u + 12345u;
+        // Short writes inside the first 256 bytes all overlap, so any
+        // difference in order between replicas shows in their contents
+        uint32_t addr = (x >> 8) % (256 - len + 1);
+        memset(data, (int)(w->seed + w->writes), len);
+        CHECK(mram_mirror_write(w->mirror, addr, data, len));
+        if (++w->writes == w->limit) break;
+    }
+    return NULL;
+}
+
+static void run_writers(struct mram_mirror* mirror, atomic_bool* stop, uint32_t limit, pthread_t* threads,
+                        struct writer* writers) {
+    for (uint32_t i = 0; i < WRITERS; i++) {
+        writers[i] = (struct writer){ .mirror = mirror, .stop = stop, .seed = limit + i + 1, .limit = limit };
+        CHECK(pthread_create(&threads[i], NULL, writer_thread, &writers[i]) == 0);
+    }
+}
+
+static void join_writers(pthread_t* threads) {
+    for (int i = 0; i < WRITERS; i++) pthread_join(threads[i], NULL);
+}
+
+static void test_basic(void) {
+    struct mram_mirror mirror;
+    static uint8_t data[8192], got[8192];
+
+    setup(&mirror);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 31 + 7);
+    CHECK(mram_mirror_write(&mirror, 1000, data, sizeof(data)));
+    CHECK(replicas_identical());
+    CHECK(memcmp(replicas[1].mem + 1000, data, sizeof(data)) == 0);
+
+    // Small reads go to one replica, large ones are split across all three
+    for (int i = 0; i < 30; i++) {
+        memset(got, 0, 100);
+        CHECK(mram_mirror_read(&mirror, 1000 + (uint32_t)i, got, 100) && memcmp(got, data + i, 100) == 0);
+    }
+    CHECK(mram_mirror_read(&mirror, 1000, got, sizeof(got)) && memcmp(got, data, sizeof(got)) == 0);
+    for (int r = 0; r < REPLICAS; r++) CHECK(mirror.stats.reads[r] > 0);
+
+    CHECK(!mram_mirror_write(&mirror, RANGE - 10, data, 11));
+    CHECK(!mram_mirror_read(&mirror, RANGE, got, 1));
+    CHECK(!mram_mirror_resync(&mirror, REPLICAS));
+    mram_mirror_deinit(&mirror);
+}
+
+// Concurrent overlapping writes must be applied in the same order everywhere
+static void test_ordering(void) {
+    struct mram_mirror mirror;
+    pthread_t threads[WRITERS];
+    struct writer writers[WRITERS];
+    atomic_bool stop = false;
+
+    for (int round = 0; round < 10; round++) {
+        setup(&mirror);
+        run_writers(&mirror, &stop, 2000, threads, writers);
+        join_writers(threads);
+        CHECK(replicas_identical());
+        CHECK(mirror.stats.failures == 0);
+        mram_mirror_deinit(&mirror);
+    }
+}
+
+// A replica drops out under load, misses writes, and is resynced back
+static void test_failover(void) {
+    struct mram_mirror mirror;
+    pthread_t threads[WRITERS];
+    struct writer writers[WRITERS];
+    atomic_bool stop = false;
+    static uint8_t data[4096], got[4096];
+
+    setup(&mirror);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i ^ 0x5A);
+    CHECK(mram_mirror_write(&mirror, 20000, data, sizeof(data)));
+
+    atomic_store(&replicas[1].down, true);
+    CHECK(mram_mirror_write(&mirror, 30000, data, sizeof(data)));
+    CHECK(mram_mirror_replica_state(&mirror, 1) == MRAM_MIRROR_FAILED);
+    CHECK(mirror.stats.failures == 1);
+    CHECK(memcmp(replicas[1].mem + 30000, data, sizeof(data)) != 0);
+    for (int i = 0; i < 20; i++) {
+        CHECK(mram_mirror_read(&mirror, 30000, got, sizeof(got)) && memcmp(got, data, sizeof(got)) == 0);
+    }
+
+    // The replica comes back while writers keep the volume busy
+    run_writers(&mirror, &stop, 0, threads, writers);
+    atomic_store(&replicas[1].down, false);
+    CHECK(wait_state(&mirror, 1, MRAM_MIRROR_ACTIVE));
+    atomic_store(&stop, true);
+    join_writers(threads);
+    CHECK(mirror.stats.resyncs == 1);
+    CHECK(replicas_identical());
+
+    // A replaced device is copied over on request
+    memset(replicas[2].mem, 0xEE, RANGE);
+    CHECK(mram_mirror_resync(&mirror, 2));
+    CHECK(wait_state(&mirror, 2, MRAM_MIRROR_ACTIVE));
+    CHECK(replicas_identical());
+
+    // With every replica gone the volume fails instead of losing writes silently
+    for (int r = 0; r < REPLICAS; r++) atomic_store(&replicas[r].down, true);
+    CHECK(!mram_mirror_write(&mirror, 0, data, 16));
+    CHECK(!mram_mirror_read(&mirror, 0, got, 16));
+    CHECK(!mram_mirror_resync(&mirror, 0));
+    mram_mirror_deinit(&mirror);
+}
+
+int main(void) {
+    test_basic();
+    test_ordering();
+    test_failover();
+    return 0;
+}
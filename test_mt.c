@@ -0,0 +1,146 @@
+/**
+ * @file test_mt.c
+ * @brief Single-flight reads of the thread-safe handle on the simulator
+ *
+ * A gate in front of the simulator holds the drainer inside its first bus
+ * transfer while a leader read of a hot block and follower reads of its
+ * sub-ranges queue up behind it. Opening the gate drains them as one run:
+ * every follower must get its bytes from the leader's transfer, or fail
+ * with it when that transfer fails, and only served followers count as
+ * saved reads.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "mram_mt.h"
+#include "test_util.h"
+
+#define HOT       4096
+#define HOT_SIZE  256
+#define FOLLOWERS 8
+
+// Gate in front of the simulator; holds or fails transfers of the drainer
+static struct {
+    struct mram sim;
+    atomic_bool closed;
+    atomic_bool held;
+    atomic_bool fail;
+} gate;
+
+static bool gate_gpio(uint8_t pin, uint8_t value) {
+    return gate.sim.gpio_write(pin, value);
+}
+
+static bool gate_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    while (atomic_load(&gate.closed)) {
+        atomic_store(&gate.held, true);
+        sched_yield();
+    }
+    if (atomic_load(&gate.fail)) return false;
+    return gate.sim.spi_transfer(tx_buf, rx_buf, len);
+}
+
+struct reader {
+    struct mram_mt* mt;
+    uint32_t addr;
+    size_t len;
+    uint8_t buf[HOT_SIZE];
+    bool result;
+    pthread_t thread;
+};
+
+static void* reader_thread(void* arg) {
+    struct reader* r = arg;
+    r->result = mram_mt_read(r->mt, r->addr, r->buf, r->len);
+    return NULL;
+}
+
+static void start(struct reader* r, struct mram_mt* mt, uint32_t addr, size_t len) {
+    r->mt = mt;
+    r->addr = addr;
+    r->len = len;
+    memset(r->buf, 0xEE, sizeof(r->buf));
+    CHECK(pthread_create(&r->thread, NULL, reader_thread, r) == 0);
+}
+
+// Wait until every position up to tail is claimed and published
+static void wait_queued(struct mram_mt* mt, size_t tail) {
+    while (atomic_load(&mt->tail) < tail) sched_yield();
+    for (size_t pos = mt->head; pos < tail; pos++) {
+        while (atomic_load(&mt->ring[pos & mt->mask].seq) != pos + 1) sched_yield();
+    }
+}
+
+// Hold the drainer on a read elsewhere, queue leader and followers behind
+// it, then open the gate
+static void run(struct mram_mt* mt, struct reader* drainer, struct reader* leader, struct reader* followers,
+                bool fail) {
+    size_t tail = atomic_load(&mt->tail);
+
+    atomic_store(&gate.held, false);
+    atomic_store(&gate.closed, true);
+    start(drainer, mt, 0, 16);
+    while (!atomic_load(&gate.held)) sched_yield();
+
+    start(leader, mt, HOT, HOT_SIZE);
+    wait_queued(mt, tail + 2);
+    for (int i = 0; i < FOLLOWERS; i++) {
+        // Overlapping sub-ranges, including both ends of the block
+        uint32_t offset = i == FOLLOWERS - 1 ? HOT_SIZE - 40 : (uint32_t)i * 24;
+        start(&followers[i], mt, HOT + offset, 40);
+        wait_queued(mt, tail + 3 + (size_t)i);
+    }
+
+    atomic_store(&gate.fail, fail);
+    atomic_store(&gate.closed, false);
+    pthread_join(drainer->thread, NULL);
+    pthread_join(leader->thread, NULL);
+    for (int i = 0; i < FOLLOWERS; i++) pthread_join(followers[i].thread, NULL);
+}
+
+int main(void) {
+    static uint8_t memory[MRAM_SIZE_BYTES];
+    static struct reader drainer, leader, followers[FOLLOWERS];
+    struct mram mram;
+    struct mram_mt mt;
+
+    for (size_t i = 0; i < MRAM_SIZE_BYTES; i++) memory[i] = (uint8_t)(i * 13 + (i >> 8));
+    CHECK(mram_sim_init(&gate.sim, memory));
+    CHECK(mram_init(&mram, gate_gpio, gate_spi, MRAM_SIM_CS_PIN));
+    CHECK(mram_mt_init(&mt, &mram, 0));
+
+    // Followers share the leader's transfer and get their own bytes
+    run(&mt, &drainer, &leader, followers, false);
+    CHECK(drainer.result && leader.result);
+    CHECK(memcmp(leader.buf, memory + HOT, HOT_SIZE) == 0);
+    uint64_t bytes = 0;
+    for (int i = 0; i < FOLLOWERS; i++) {
+        CHECK(followers[i].result);
+        CHECK(memcmp(followers[i].buf, memory + followers[i].addr, followers[i].len) == 0);
+        bytes += followers[i].len;
+    }
+    CHECK(mt.stats.requests == FOLLOWERS + 2 && mt.stats.bus_calls == 2);
+    CHECK(mt.stats.reads_saved == FOLLOWERS && mt.stats.bytes_saved == bytes);
+
+    // Followers of a failed leader fail too, and nothing counts as saved
+    run(&mt, &drainer, &leader, followers, true);
+    CHECK(!drainer.result && !leader.result);
+    for (int i = 0; i < FOLLOWERS; i++) {
+        CHECK(!followers[i].result);
+        CHECK(followers[i].buf[0] == 0xEE && followers[i].buf[followers[i].len - 1] == 0xEE);
+    }
+    CHECK(mt.stats.requests == 2 * (FOLLOWERS + 2) && mt.stats.bus_calls == 4);
+    CHECK(mt.stats.reads_saved == FOLLOWERS && mt.stats.bytes_saved == bytes);
+
+    // The handle keeps working once the bus does
+    atomic_store(&gate.fail, false);
+    uint8_t buf[32];
+    CHECK(mram_mt_read(&mt, HOT + 7, buf, sizeof(buf)) && memcmp(buf, memory + HOT + 7, sizeof(buf)) == 0);
+    mram_mt_deinit(&mt);
+    return 0;
+}
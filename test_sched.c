@@ -0,0 +1,327 @@
+/**
+ * @file test_sched.c
+ * @brief Scheduler merging and ordering rules on the simulator
+ *
+ * Queues bursts of overlapping reads and writes within one batching window
+ * and checks every read against a model that applies the requests one by
+ * one in submission order, so merging and reordering must be invisible.
+ * Also checks that adjacent requests actually share frames and a WREN.
+ *
+ * Fences and dependency edges are checked by stamping every byte with the
+ * number of the bus call that transferred it, and against power loss: a
+ * commit flag written after a fence must never be on the device without
+ * the data before it, and against a single failed transfer: what depends
+ * on the failed write, or sits behind a fence after it, is not issued.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // nanosleep
+#include <string.h>
+#include <time.h>
+#include "mram_sched.h"
+#include "test_util.h"
+
+#define SPAN 2048
+#define BURST 48
+
+// Long window and large batches, so a whole burst is dispatched together
+static const struct mram_sched_config config = { .max_delay_us = 200000, .max_merge = 4096, .max_batch = 256 };
+
+static uint8_t model[SPAN];
+
+// Bus call number that last wrote or read each byte
+static uint32_t write_stamp[SPAN];
+static uint32_t read_stamp[SPAN];
+static uint32_t bus_calls;
+
+static void stamp_enter(struct mram_hook* hook, struct mram_call* call) {
+    (void)hook;
+    (void)call;
+}
+
+static void stamp_leave(struct mram_hook* hook, struct mram_call* call, bool ok) {
+    (void)hook;
+    if (!ok || (call->op != MRAM_OP_READ_VECTOR && call->op != MRAM_OP_WRITE_VECTOR)) return;
+    bus_calls++;
+    uint32_t* stamp = call->op == MRAM_OP_WRITE_VECTOR ? write_stamp : read_stamp;
+    for (size_t i = 0; i < call->count; i++) {
+        for (size_t j = 0; j < call->iov[i].len && call->iov[i].addr + j < SPAN; j++) {
+            stamp[call->iov[i].addr + j] = bus_calls;
+        }
+    }
+}
+
+static struct mram_hook stamp_hook = { .enter = stamp_enter, .leave = stamp_leave };
+
+// One-shot failure in front of the simulator: the next WRITE frame to
+// glitch.addr fails before any of it reaches the device, slowly, so that
+// later requests queue up meanwhile. Everything else goes through.
+static struct {
+    struct mram sim;
+    uint32_t addr;
+    bool armed;
+    bool frame_start;
+} glitch;
+
+static bool glitch_gpio(uint8_t pin, uint8_t value) {
+    if (value == MRAM_GPIO_LOW) glitch.frame_start = true;
+    return glitch.sim.gpio_write(pin, value);
+}
+
+static bool glitch_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    bool start = glitch.frame_start;
+    glitch.frame_start = false;
+    if (start && glitch.armed && tx_buf && len >= 4 && tx_buf[0] == MRAM_CMD_WRITE &&
+        ((uint32_t)tx_buf[1] << 16 | (uint32_t)tx_buf[2] << 8 | tx_buf[3]) == glitch.addr) {
+        struct timespec ts = { 0, 100000000 };
+        glitch.armed = false;
+        nanosleep(&ts, NULL);
+        return false;
+    }
+    return glitch.sim.spi_transfer(tx_buf, rx_buf, len);
+}
+
+static void glitch_on(struct mram* mram, uint32_t addr) {
+    CHECK(mram_sim_init(&glitch.sim, mram_sim_memory()));
+    glitch.addr = addr;
+    glitch.armed = true;
+    CHECK(mram_init(mram, glitch_gpio, glitch_spi, MRAM_SIM_CS_PIN));
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(uint32_t bound) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (rng_state >> 8) % bound;
+}
+
+static void test_merge(void) {
+    struct mram mram;
+    struct mram_sched sched;
+    struct mram_sched_request reqs[16];
+    static uint8_t data[16][64];
+    struct mram_sim_stats before, after;
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    mram_sim_stats(&before);
+    for (int i = 0; i < 16; i++) {
+        memset(data[i], i + 1, sizeof(data[i]));
+        // Submitted out of address order, adjacent once sorted
+        int slot = (i * 7) % 16;
+        reqs[i] = (struct mram_sched_request){ .op = MRAM_SCHED_WRITE, .addr = 4096 + slot * 64u,
+                                               .buf = data[i], .len = 64 };
+        CHECK(mram_sched_submit(&sched, &reqs[i]));
+    }
+    mram_sched_deinit(&sched);
+    mram_sim_stats(&after);
+
+    for (int i = 0; i < 16; i++) {
+        CHECK(reqs[i].result);
+        CHECK(memcmp(mram_sim_memory() + reqs[i].addr, data[i], 64) == 0);
+    }
+    CHECK(sched.stats.requests == 16 && sched.stats.batches == 1);
+    CHECK(sched.stats.frames == 1 && sched.stats.bus_calls == 1);
+    CHECK(after.write_enables - before.write_enables == 1);
+}
+
+// Random bursts of overlapping requests, each read checked against the
+// model state at its submission
+static void test_model(void) {
+    struct mram mram;
+    struct mram_sched sched;
+    static struct mram_sched_request reqs[BURST];
+    static uint8_t bufs[BURST][256];
+    static uint8_t expected[BURST][256];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    memcpy(model, mram_sim_memory(), SPAN);
+    for (int round = 0; round < 200; round++) {
+        CHECK(mram_sched_init(&sched, &mram, &config));
+        for (int i = 0; i < BURST; i++) {
+            uint32_t len = 1 + rng(256);
+            uint32_t addr = rng(SPAN - len + 1);
+            bool write = rng(2) == 0;
+            reqs[i] = (struct mram_sched_request){ .op = write ? MRAM_SCHED_WRITE : MRAM_SCHED_READ, .addr = addr,
+                                                   .buf = bufs[i], .len = len };
+            if (write) {
+                for (uint32_t j = 0; j < len; j++) bufs[i][j] = (uint8_t)rng(256);
+                memcpy(model + addr, bufs[i], len);
+            } else {
+                memset(bufs[i], 0xEE, len);
+                memcpy(expected[i], model + addr, len);
+            }
+            CHECK(mram_sched_submit(&sched, &reqs[i]));
+        }
+        mram_sched_deinit(&sched);
+
+        for (int i = 0; i < BURST; i++) {
+            CHECK(reqs[i].result);
+            if (reqs[i].op == MRAM_SCHED_READ) CHECK(memcmp(bufs[i], expected[i], reqs[i].len) == 0);
+        }
+        CHECK(memcmp(mram_sim_memory(), model, SPAN) == 0);
+        CHECK(sched.stats.bus_calls < BURST);
+    }
+}
+
+static void test_blocking(void) {
+    struct mram mram;
+    struct mram_sched sched;
+    uint8_t out[32], in[32];
+    struct mram_sched_request bad = { .op = MRAM_SCHED_READ, .addr = MRAM_MAX_ADDRESS, .buf = in, .len = 2 };
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_sched_init(&sched, &mram, NULL));
+    memset(out, 0x5A, sizeof(out));
+    CHECK(mram_sched_write(&sched, 100, out, sizeof(out)));
+    CHECK(mram_sched_read(&sched, 100, in, sizeof(in)));
+    CHECK(memcmp(in, out, sizeof(in)) == 0);
+    CHECK(!mram_sched_submit(&sched, &bad));
+    mram_sched_deinit(&sched);
+}
+
+static struct mram_sched_request request(uint8_t op, uint32_t addr, void* buf, size_t len) {
+    return (struct mram_sched_request){ .op = op, .addr = addr, .buf = buf, .len = len };
+}
+
+static void test_fence_and_deps(void) {
+    struct mram mram;
+    struct mram_sched sched;
+    uint8_t buf[8][64];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    mram.hook = &stamp_hook;
+
+    // Without a fence adjacent writes share a call; with one they do not
+    struct mram_sched_request a = request(MRAM_SCHED_WRITE, 0, buf[0], 64);
+    struct mram_sched_request b = request(MRAM_SCHED_WRITE, 64, buf[1], 64);
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    CHECK(mram_sched_submit(&sched, &a) && mram_sched_submit(&sched, &b));
+    mram_sched_deinit(&sched);
+    CHECK(write_stamp[0] == write_stamp[64]);
+
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    CHECK(mram_sched_submit(&sched, &a) && mram_sched_fence(&sched) && mram_sched_submit(&sched, &b));
+    mram_sched_deinit(&sched);
+    CHECK(write_stamp[0] < write_stamp[64]);
+
+    // The fence also holds back later requests at lower addresses and reads
+    struct mram_sched_request low = request(MRAM_SCHED_WRITE, 256, buf[2], 16);
+    struct mram_sched_request high = request(MRAM_SCHED_WRITE, 1024, buf[3], 16);
+    struct mram_sched_request rd = request(MRAM_SCHED_READ, 1536, buf[4], 16);
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    CHECK(mram_sched_submit(&sched, &high) && mram_sched_fence(&sched));
+    CHECK(mram_sched_submit(&sched, &low) && mram_sched_submit(&sched, &rd));
+    mram_sched_deinit(&sched);
+    CHECK(write_stamp[1024] < write_stamp[256] && write_stamp[1024] < read_stamp[1536]);
+
+    // An edge orders only its own request: unrelated traffic stays at level 0
+    struct mram_sched_request first = request(MRAM_SCHED_WRITE, 512, buf[5], 16);
+    struct mram_sched_request then = request(MRAM_SCHED_WRITE, 128, buf[6], 16);
+    struct mram_sched_request other = request(MRAM_SCHED_WRITE, 768, buf[7], 16);
+    struct mram_sched_request after_read = request(MRAM_SCHED_READ, 1600, buf[4], 16);
+    then.deps[0] = &first;
+    after_read.deps[0] = &first;
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    CHECK(mram_sched_submit(&sched, &first) && mram_sched_submit(&sched, &then));
+    CHECK(mram_sched_submit(&sched, &other) && mram_sched_submit(&sched, &after_read));
+    mram_sched_deinit(&sched);
+    CHECK(write_stamp[512] < write_stamp[128] && write_stamp[512] < read_stamp[1600]);
+    CHECK(write_stamp[768] == write_stamp[512]);
+    CHECK(first.result && then.result && other.result && after_read.result);
+}
+
+// Data, fence, commit flag at a lower address: under a power cut at any
+// byte the flag is only ever set with all of the data in place
+static void test_fence_crash(void) {
+    static uint8_t data[2][200];
+    static uint8_t flag = 0xC3;
+    memset(data[0], 0x11, sizeof(data[0]));
+    memset(data[1], 0x22, sizeof(data[1]));
+
+    bool lost = true;
+    for (size_t budget = 0; lost; budget++) {
+        struct mram mram;
+        struct mram_sched sched;
+        struct mram_sched_request d0 = request(MRAM_SCHED_WRITE, 1000, data[0], sizeof(data[0]));
+        struct mram_sched_request d1 = request(MRAM_SCHED_WRITE, 1400, data[1], sizeof(data[1]));
+        struct mram_sched_request commit = request(MRAM_SCHED_WRITE, 10, &flag, 1);
+
+        memset(mram_sim_memory(), 0, SPAN);
+        test_power_on(&mram, budget);
+        CHECK(mram_sched_init(&sched, &mram, &config));
+        CHECK(mram_sched_submit(&sched, &d0) && mram_sched_submit(&sched, &d1));
+        CHECK(mram_sched_fence(&sched) && mram_sched_submit(&sched, &commit));
+        mram_sched_deinit(&sched);
+        lost = test_power_lost();
+
+        const uint8_t* mem = mram_sim_memory();
+        if (mem[10] == flag) {
+            CHECK(memcmp(mem + 1000, data[0], sizeof(data[0])) == 0);
+            CHECK(memcmp(mem + 1400, data[1], sizeof(data[1])) == 0);
+        }
+        CHECK(lost || mem[10] == flag);
+        CHECK(commit.result == (mem[10] == flag));
+    }
+}
+
+// Data, fence, commit flag again, but the second data write fails once
+static void test_fence_failure(void) {
+    static uint8_t data[2][200], extra[16];
+    static uint8_t flag = 0xC3;
+    static const struct mram_sched_config small = { .max_delay_us = 200000, .max_batch = 2 };
+    struct mram mram;
+    struct mram_sched sched;
+    const uint8_t* mem = mram_sim_memory();
+    memset(data[0], 0x11, sizeof(data[0]));
+    memset(data[1], 0x22, sizeof(data[1]));
+    memset(extra, 0x33, sizeof(extra));
+
+    // In one batch: the dependent write and the commit are not issued. The
+    // data writes share one call, so both report the failure.
+    struct mram_sched_request d0 = request(MRAM_SCHED_WRITE, 1000, data[0], sizeof(data[0]));
+    struct mram_sched_request d1 = request(MRAM_SCHED_WRITE, 1400, data[1], sizeof(data[1]));
+    struct mram_sched_request dep = request(MRAM_SCHED_WRITE, 1800, extra, sizeof(extra));
+    struct mram_sched_request commit = request(MRAM_SCHED_WRITE, 10, &flag, 1);
+    dep.deps[0] = &d1;
+    memset(mram_sim_memory(), 0, SPAN);
+    glitch_on(&mram, 1400);
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    CHECK(mram_sched_submit(&sched, &d0) && mram_sched_submit(&sched, &d1));
+    CHECK(mram_sched_submit(&sched, &dep));
+    CHECK(mram_sched_fence(&sched) && mram_sched_submit(&sched, &commit));
+    mram_sched_deinit(&sched);
+    CHECK(!glitch.armed);
+    CHECK(!d0.result && !d1.result && !dep.result && !commit.result);
+    CHECK(mem[10] == 0 && mem[1800] == 0);
+
+    // A retry submitted once the failure is known goes through
+    CHECK(mram_sched_init(&sched, &mram, &config));
+    CHECK(mram_sched_submit(&sched, &d1) && mram_sched_fence(&sched) && mram_sched_submit(&sched, &commit));
+    mram_sched_deinit(&sched);
+    CHECK(d1.result && commit.result && mem[10] == flag);
+    CHECK(memcmp(mem + 1400, data[1], sizeof(data[1])) == 0);
+
+    // The data and the commit flag in different batches
+    memset(mram_sim_memory(), 0, SPAN);
+    glitch_on(&mram, 1400);
+    CHECK(mram_sched_init(&sched, &mram, &small));
+    CHECK(mram_sched_submit(&sched, &d0) && mram_sched_submit(&sched, &d1));
+    CHECK(mram_sched_fence(&sched) && mram_sched_submit(&sched, &commit));
+    mram_sched_deinit(&sched);
+    CHECK(sched.stats.batches == 2);
+    CHECK(!d1.result && !commit.result && mem[10] == 0);
+}
+
+int main(void) {
+    test_merge();
+    test_model();
+    test_blocking();
+    test_fence_and_deps();
+    test_fence_crash();
+    test_fence_failure();
+    return 0;
+}
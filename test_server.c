@@ -0,0 +1,334 @@
+/**
+ * @file test_server.c
+ * @brief Client and server round trips on the simulator
+ *
+ * Runs the server on the simulated device in a thread of the test and
+ * drives it through the client library: blocking calls, a deep pipeline
+ * of overlapping reads and writes, inline and SHM vector operations, and
+ * the status register. Shared memory the server must refuse, bad segments
+ * and malformed requests have to fail cleanly and leave the server
+ * serving. Requests pipelined past the server's backlog limit must all be
+ * answered. A peer that hangs up or answers out of order mid-call must
+ * fail every request in flight and leave the client closed.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _GNU_SOURCE  // memfd_create
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "mram_client.h"
+#include "mram_server.h"
+#include "test_util.h"
+
+#define PIPELINE 64
+#define BACKLOG  1024
+
+static struct mram_server server;
+static char path[64];
+
+static void* server_thread(void* arg) {
+    (void)arg;
+    CHECK(mram_server_run(&server));
+    return NULL;
+}
+
+static void fill(uint8_t* buf, size_t len, uint8_t seed) {
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(seed * 13 + i * 7);
+}
+
+static void test_blocking(struct mram_client* client) {
+    uint8_t out[300], in[300], status;
+
+    fill(out, sizeof(out), 1);
+    CHECK(mram_client_write(client, 1000, out, sizeof(out)));
+    CHECK(mram_client_read(client, 1000, in, sizeof(in)) && memcmp(in, out, sizeof(in)) == 0);
+    CHECK(!mram_client_read(client, MRAM_MAX_ADDRESS, in, 2));
+
+    // Block protection set over the socket takes effect on the device
+    CHECK(mram_client_write(client, MRAM_MAX_ADDRESS - 99, out, 100));
+    CHECK(mram_client_write_status_register(client, 0x04));
+    CHECK(mram_client_read_status_register(client, &status) && (status & 0x0C) == 0x04);
+    fill(in, 100, 2);
+    CHECK(mram_client_write(client, MRAM_MAX_ADDRESS - 99, in, 100));
+    CHECK(memcmp(mram_sim_memory() + MRAM_MAX_ADDRESS - 99, out, 100) == 0);
+    CHECK(mram_client_write_status_register(client, 0x00));
+
+    CHECK(mram_client_sleep(client) && mram_client_wake(client));
+    CHECK(mram_client_read(client, 1000, in, sizeof(in)) && memcmp(in, out, sizeof(in)) == 0);
+}
+
+// Overlapping writes and reads in flight at once complete in order, and
+// every read sees exactly the writes submitted before it
+static void test_pipeline(struct mram_client* client) {
+    static struct mram_client_op ops[PIPELINE];
+    static uint8_t bufs[PIPELINE][512], expected[PIPELINE][512];
+    static uint8_t model[4096];
+
+    memcpy(model, mram_sim_memory(), sizeof(model));
+    for (int i = 0; i < PIPELINE; i++) {
+        uint32_t addr = (uint32_t)(i * 97) % 3584;
+        size_t len = 1 + (size_t)(i * 61) % 512;
+        if (i % 3 != 2) {
+            fill(bufs[i], len, (uint8_t)i);
+            memcpy(model + addr, bufs[i], len);
+            mram_client_prep_write(&ops[i], addr, bufs[i], len);
+        } else {
+            memcpy(expected[i], model + addr, len);
+            mram_client_prep_read(&ops[i], addr, bufs[i], len);
+        }
+        CHECK(mram_client_submit(client, &ops[i]));
+    }
+    for (int i = 0; i < PIPELINE; i++) {
+        struct mram_client_op* op;
+        CHECK(mram_client_complete(client, &op) && op == &ops[i] && op->done && op->result);
+        if (i % 3 == 2) CHECK(memcmp(bufs[i], expected[i], op->req.len) == 0);
+    }
+    CHECK(!mram_client_complete(client, NULL));
+    CHECK(memcmp(mram_sim_memory(), model, sizeof(model)) == 0);
+}
+
+static void test_vector(struct mram_client* client) {
+    uint8_t a[100], b[50], c[200], got[350];
+    struct mram_iovec iov[3] = { { 8000, a, sizeof(a) }, { 8100, b, sizeof(b) }, { 9000, c, sizeof(c) } };
+
+    fill(a, sizeof(a), 3);
+    fill(b, sizeof(b), 4);
+    fill(c, sizeof(c), 5);
+    CHECK(mram_client_write_vector(client, iov, 3));
+    CHECK(memcmp(mram_sim_memory() + 8100, b, sizeof(b)) == 0);
+    CHECK(memcmp(mram_sim_memory() + 9000, c, sizeof(c)) == 0);
+
+    struct mram_iovec back[3] = { { 9000, got, 200 }, { 8000, got + 200, 100 }, { 8100, got + 300, 50 } };
+    CHECK(mram_client_read_vector(client, back, 3));
+    CHECK(memcmp(got, c, 200) == 0 && memcmp(got + 200, a, 100) == 0 && memcmp(got + 300, b, 50) == 0);
+
+    struct mram_iovec bad[2] = { { 0, a, 10 }, { MRAM_MAX_ADDRESS, b, 2 } };
+    CHECK(!mram_client_read_vector(client, bad, 2));
+}
+
+static void test_shm(struct mram_client* client) {
+    uint8_t* shm;
+    uint8_t expected[1024];
+
+    CHECK(mram_client_attach_shm(client, 65536, (void**)&shm));
+    fill(shm, 1024, 6);
+    memcpy(expected, shm, sizeof(expected));
+    struct mram_proto_segment segs[2] = { { 20000, 512, 0 }, { 30000, 512, 512 } };
+    CHECK(mram_client_shm_write(client, segs, 2));
+    CHECK(memcmp(mram_sim_memory() + 20000, expected, 512) == 0);
+    CHECK(memcmp(mram_sim_memory() + 30000, expected + 512, 512) == 0);
+
+    struct mram_proto_segment back[2] = { { 30000, 512, 40000 }, { 20000, 512, 40512 } };
+    CHECK(mram_client_shm_read(client, back, 2));
+    CHECK(memcmp(shm + 40000, expected + 512, 512) == 0 && memcmp(shm + 40512, expected, 512) == 0);
+
+    // Segments must stay inside the shared memory and the device
+    struct mram_proto_segment outside[1] = { { 0, 512, 65536 - 100 } };
+    CHECK(!mram_client_shm_read(client, outside, 1));
+    struct mram_proto_segment wrap[1] = { { 0, 16, UINT32_MAX - 8 } };
+    CHECK(!mram_client_shm_write(client, wrap, 1));
+    struct mram_proto_segment past[1] = { { MRAM_MAX_ADDRESS, 16, 0 } };
+    CHECK(!mram_client_shm_write(client, past, 1));
+}
+
+// Attach a memfd of the given size and seals while claiming claim bytes
+static bool attach_raw(struct mram_client* client, size_t size, size_t claim, bool seal) {
+    int fd = memfd_create("test_server", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    CHECK(fd >= 0 && ftruncate(fd, (off_t)size) == 0);
+    if (seal) CHECK(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) == 0);
+
+    struct mram_client_op op = { .fd = fd };
+    struct mram_client_op* done;
+    op.req.op = MRAM_PROTO_ATTACH_SHM;
+    op.req.len = (uint32_t)claim;
+    CHECK(mram_client_submit(client, &op));
+    CHECK(mram_client_complete(client, &done) && done == &op);
+    close(fd);
+    return op.result;
+}
+
+static void test_hostile(struct mram_client* client) {
+    uint8_t buf[16];
+
+    // Memory that is smaller than claimed, or could shrink later, is refused
+    CHECK(!attach_raw(client, 4096, 1 << 20, true));
+    CHECK(!attach_raw(client, 65536, 65536, false));
+    CHECK(attach_raw(client, 65536, 65536, true));
+
+    // An attach without a descriptor and unknown operations fail cleanly
+    struct mram_client_op op;
+    struct mram_client_op* done;
+    memset(&op, 0, sizeof(op));
+    op.fd = -1;
+    op.req.op = MRAM_PROTO_ATTACH_SHM;
+    op.req.len = 4096;
+    CHECK(mram_client_submit(client, &op) && mram_client_complete(client, &done) && !op.result);
+    memset(&op, 0, sizeof(op));
+    op.fd = -1;
+    op.req.op = 200;
+    CHECK(mram_client_submit(client, &op) && mram_client_complete(client, &done) && !op.result);
+
+    // Requests the client library would not build are refused locally
+    mram_client_prep_read(&op, 0, buf, (size_t)MRAM_PROTO_MAX_PAYLOAD + 1);
+    CHECK(!mram_client_submit(client, &op));
+
+    CHECK(mram_client_read(client, 1000, buf, sizeof(buf)));
+
+    // A length the server cannot skip costs only the offending connection
+    struct mram_client rogue;
+    CHECK(mram_client_connect(&rogue, path));
+    memset(&op, 0, sizeof(op));
+    op.fd = -1;
+    op.req.op = MRAM_PROTO_READ_STATUS;
+    op.req.len = UINT32_MAX;
+    CHECK(mram_client_submit(&rogue, &op));
+    CHECK(!mram_client_complete(&rogue, &done));
+    mram_client_close(&rogue);
+    CHECK(mram_client_read(client, 1000, buf, sizeof(buf)));
+}
+
+// Reads sent in one write whose responses exceed the backlog limit are all
+// answered, including those parsed after the server has sent the rest
+static void test_backlog(void) {
+    enum { COUNT = 32, LEN = 256 };
+    struct mram_proto_request reqs[COUNT];
+    static uint8_t in[COUNT * (sizeof(struct mram_proto_response) + LEN)];
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    _Static_assert(COUNT * LEN > 2 * BACKLOG, "responses must cross the limit");
+
+    snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    CHECK(fd >= 0 && connect(fd, (struct sockaddr*)&sa, sizeof(sa)) == 0);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        reqs[i] = (struct mram_proto_request){ .id = i, .op = MRAM_PROTO_READ, .addr = 1000 + i * 64, .len = LEN };
+    }
+    CHECK(write(fd, reqs, sizeof(reqs)) == (ssize_t)sizeof(reqs));
+
+    // A stalled server shows up as a timeout rather than a hung test
+    size_t got = 0;
+    while (got < sizeof(in)) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        CHECK(poll(&pfd, 1, 5000) == 1);
+        ssize_t n = read(fd, in + got, sizeof(in) - got);
+        CHECK(n > 0);
+        got += (size_t)n;
+    }
+    for (uint32_t i = 0; i < COUNT; i++) {
+        const uint8_t* p = in + i * (sizeof(struct mram_proto_response) + LEN);
+        struct mram_proto_response resp;
+        memcpy(&resp, p, sizeof(resp));
+        CHECK(resp.id == i && resp.result == MRAM_PROTO_OK && resp.len == LEN);
+        CHECK(memcmp(p + sizeof(resp), mram_sim_memory() + reqs[i].addr, LEN) == 0);
+    }
+    close(fd);
+}
+
+// Peer that reads request headers and then hangs up, or first answers the
+// last of them with the wrong id
+struct peer {
+    int listener;
+    int requests;
+    bool wrong_id;
+};
+
+static void* peer_thread(void* arg) {
+    struct peer* p = arg;
+    int fd = accept(p->listener, NULL, NULL);
+    CHECK(fd >= 0);
+
+    struct mram_proto_request req;
+    for (int i = 0; i < p->requests; i++) CHECK(read(fd, &req, sizeof(req)) == (ssize_t)sizeof(req));
+    if (p->wrong_id) {
+        struct mram_proto_response resp = { .id = req.id + 1, .result = MRAM_PROTO_OK };
+        CHECK(write(fd, &resp, sizeof(resp)) == (ssize_t)sizeof(resp));
+        // Wait for the client to give up on the connection
+        while (read(fd, &req, sizeof(req)) > 0) {
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static void test_broken(bool wrong_id) {
+    struct mram_client client;
+    struct mram_client_op ops[3];
+    struct peer peer = { .requests = 4, .wrong_id = wrong_id };
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    uint8_t buf[16];
+    pthread_t thread;
+
+    snprintf(sa.sun_path, sizeof(sa.sun_path), "%s.peer", path);
+    unlink(sa.sun_path);
+    peer.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    CHECK(peer.listener >= 0 && bind(peer.listener, (struct sockaddr*)&sa, sizeof(sa)) == 0);
+    CHECK(listen(peer.listener, 1) == 0);
+    CHECK(pthread_create(&thread, NULL, peer_thread, &peer) == 0);
+    CHECK(mram_client_connect(&client, sa.sun_path));
+
+    // The blocking call fails and takes the requests queued ahead of it
+    // along, so its own descriptor is not left linked once it returns
+    mram_client_prep_read(&ops[0], 0, buf, sizeof(buf));
+    mram_client_prep_read_status(&ops[1]);
+    mram_client_prep_sleep(&ops[2]);
+    for (int i = 0; i < 3; i++) CHECK(mram_client_submit(&client, &ops[i]));
+    CHECK(!mram_client_read(&client, 0, buf, sizeof(buf)));
+    CHECK(client.head == NULL && client.tail == NULL && client.fd < 0);
+    for (int i = 0; i < 3; i++) CHECK(ops[i].done && !ops[i].result);
+
+    // The handle stays closed instead of reusing the stream
+    CHECK(!mram_client_read(&client, 0, buf, sizeof(buf)));
+    CHECK(!mram_client_complete(&client, NULL));
+    mram_client_close(&client);
+
+    pthread_join(thread, NULL);
+    close(peer.listener);
+    unlink(sa.sun_path);
+}
+
+int main(void) {
+    struct mram mram;
+    struct mram_client client, other;
+    pthread_t thread;
+
+    signal(SIGPIPE, SIG_IGN);
+    snprintf(path, sizeof(path), "/tmp/test_server_%d.sock", (int)getpid());
+    CHECK(mram_sim_init(&mram, NULL));
+    CHECK(mram_server_init(&server, &mram, path));
+    server.max_backlog = BACKLOG;
+    CHECK(pthread_create(&thread, NULL, server_thread, NULL) == 0);
+    CHECK(mram_client_connect(&client, path));
+    CHECK(mram_client_connect(&other, path));
+
+    test_blocking(&client);
+    test_pipeline(&client);
+    test_vector(&client);
+    test_shm(&client);
+    test_hostile(&client);
+    test_backlog();
+    test_broken(false);
+    test_broken(true);
+
+    // A second client shares the same device
+    uint8_t buf[300];
+    CHECK(mram_client_read(&other, 1000, buf, sizeof(buf)));
+    CHECK(memcmp(buf, mram_sim_memory() + 1000, sizeof(buf)) == 0);
+    mram_client_close(&other);
+    mram_client_close(&client);
+
+    mram_server_stop(&server);
+    pthread_join(thread, NULL);
+    CHECK(server.stats.connections == 4 && server.stats.errors > 0);
+    mram_server_deinit(&server);
+    CHECK(access(path, F_OK) != 0);
+    return 0;
+}
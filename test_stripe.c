@@ -0,0 +1,169 @@
+/**
+ * @file test_stripe.c
+ * @brief Striped volume address mapping on per-bus device models
+ *
+ * The simulator is one device per process, so the devices here are small
+ * memory-backed MR25H40 models told apart by their chip select pin, as in
+ * test_mirror.c. Every device is driven only by its own worker thread.
+ *
+ * For two to four devices, checks that every volume byte lands on device
+ * u % N at base + (u / N) * unit for stripe unit u, that unaligned reads and
+ * writes spanning several units round-trip, and that an out-of-range worker
+ * CPU is refused before the volume starts.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_stripe.h"
+#include "test_util.h"
+
+#define DEVICES     4
+#define RANGE       8192
+#define BASE        256
+#define DEVICE_SIZE 4000
+
+// Minimal device model: WREN, WRDI, READ and WRITE
+struct device {
+    uint8_t mem[RANGE];
+    uint32_t pos;
+    uint32_t addr;
+    uint8_t cmd;
+    bool wel;
+};
+
+static struct device models[DEVICES];
+static _Thread_local struct device* selected;
+
+static bool device_gpio(uint8_t pin, uint8_t value) {
+    if (pin >= DEVICES) return false;
+    selected = value == MRAM_GPIO_LOW ? &models[pin] : NULL;
+    models[pin].pos = 0;
+    return true;
+}
+
+static bool device_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    struct device* d = selected;
+    if (d == NULL) return false;
+
+    for (size_t i = 0; i < len; i++, d->pos++) {
+        uint8_t in = tx_buf ? tx_buf[i] : 0xFF;
+        uint8_t out = 0xFF;
+        if (d->pos == 0) {
+            d->cmd = in;
+            d->addr = 0;
+            if (in == MRAM_CMD_WREN) d->wel = true;
+            if (in == MRAM_CMD_WRDI) d->wel = false;
+        } else if (d->pos < 4) {
+            d->addr = (d->addr << 8) | in;
+        } else if (d->cmd == MRAM_CMD_READ) {
+            out = d->mem[d->addr++ % RANGE];
+        } else if (d->cmd == MRAM_CMD_WRITE && d->wel) {
+            d->mem[d->addr++ % RANGE] = in;
+        }
+        if (rx_buf) rx_buf[i] = out;
+    }
+    return true;
+}
+
+static struct mram devices[DEVICES];
+static struct mram* const device_list[DEVICES] = { &devices[0], &devices[1], &devices[2], &devices[3] };
+static uint8_t expected[DEVICES * DEVICE_SIZE];
+
+static void setup(void) {
+    for (uint8_t d = 0; d < DEVICES; d++) {
+        memset(models[d].mem, 0, RANGE);
+        CHECK(mram_init(&devices[d], device_gpio, device_spi, d));
+    }
+}
+
+static void fill(uint8_t* buf, size_t len, uint8_t seed) {
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(seed + i * 7 + (i >> 8));
+}
+
+// Every volume byte sits where the mapping says, and nothing else is touched
+static void check_mapping(uint32_t count, uint32_t unit, uint32_t size) {
+    static uint8_t image[DEVICES][RANGE];
+    memset(image, 0, sizeof(image));
+
+    for (uint32_t a = 0; a < size; a++) {
+        uint32_t u = a / unit;
+        image[u % count][BASE + (u / count) * unit + a % unit] = expected[a];
+    }
+    for (uint32_t d = 0; d < DEVICES; d++) CHECK(memcmp(models[d].mem, image[d], RANGE) == 0);
+}
+
+static void test_volume(uint32_t count, uint32_t unit) {
+    struct mram_stripe stripe;
+    static uint8_t back[DEVICES * DEVICE_SIZE];
+    const struct mram_stripe_config config = { .stripe_unit = unit, .base = BASE, .device_size = DEVICE_SIZE };
+
+    setup();
+    CHECK(mram_stripe_init(&stripe, device_list, count, &config));
+    uint32_t size = mram_stripe_size(&stripe);
+    CHECK(size == count * (DEVICE_SIZE / unit) * unit);
+
+    // Whole volume in one request
+    fill(expected, size, (uint8_t)count);
+    CHECK(mram_stripe_write(&stripe, 0, expected, size));
+    check_mapping(count, unit, size);
+
+    // Unaligned at both ends, spanning several rounds of the devices
+    uint32_t addr = unit + 13;
+    uint32_t len = (2 * count + 1) * unit + 29;
+    fill(expected + addr, len, 0xA0);
+    CHECK(mram_stripe_write(&stripe, addr, expected + addr, len));
+    check_mapping(count, unit, size);
+
+    // Inside a single unit, and ending exactly at the end of the volume
+    fill(expected + 5 * unit + 1, unit - 2, 0x51);
+    CHECK(mram_stripe_write(&stripe, 5 * unit + 1, expected + 5 * unit + 1, unit - 2));
+    fill(expected + size - unit - 3, unit + 3, 0x62);
+    CHECK(mram_stripe_write(&stripe, size - unit - 3, expected + size - unit - 3, unit + 3));
+    check_mapping(count, unit, size);
+
+    memset(back, 0, sizeof(back));
+    CHECK(mram_stripe_read(&stripe, addr - 7, back, len + 20));
+    CHECK(memcmp(back, expected + addr - 7, len + 20) == 0);
+    CHECK(mram_stripe_read(&stripe, 0, back, size));
+    CHECK(memcmp(back, expected, size) == 0);
+
+    CHECK(!mram_stripe_read(&stripe, size - 4, back, 8));
+    CHECK(!mram_stripe_write(&stripe, size, back, 1));
+    CHECK(!mram_stripe_read(&stripe, 0, back, 0));
+    mram_stripe_deinit(&stripe);
+}
+
+static void test_cpus(void) {
+    struct mram_worker worker;
+    struct mram_stripe stripe;
+    static const int bad_low[DEVICES] = { MRAM_WORKER_ANY_CPU, -2, MRAM_WORKER_ANY_CPU, MRAM_WORKER_ANY_CPU };
+    static const int bad_high[DEVICES] = { MRAM_WORKER_ANY_CPU, MRAM_WORKER_ANY_CPU, 1 << 20, MRAM_WORKER_ANY_CPU };
+    struct mram_stripe_config config = { .stripe_unit = 64, .base = BASE, .device_size = DEVICE_SIZE };
+
+    setup();
+    CHECK(!mram_worker_start(&worker, &devices[0], -2));
+    CHECK(!mram_worker_start(&worker, &devices[0], 1 << 20));
+
+    // Workers already started for earlier devices are stopped again
+    config.cpus = bad_low;
+    CHECK(!mram_stripe_init(&stripe, device_list, DEVICES, &config));
+    CHECK(stripe.count == 0);
+    config.cpus = bad_high;
+    CHECK(!mram_stripe_init(&stripe, device_list, DEVICES, &config));
+    CHECK(stripe.count == 0);
+
+    config.cpus = NULL;
+    CHECK(mram_stripe_init(&stripe, device_list, DEVICES, &config));
+    mram_stripe_deinit(&stripe);
+}
+
+int main(void) {
+    test_volume(2, 64);
+    test_volume(3, 100);
+    test_volume(4, 32);
+    test_cpus();
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_trace.c
+ * @brief Workload capture and threaded replay on the simulator
+ *
+ * Captures calls from several threads, then replays the trace and checks
+ * that every call is issued once, from as many threads as were captured,
+ * with the captured results and per-operation statistics.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include "mram_trace.h"
+#include "test_util.h"
+
+#define THREADS 4
+#define ROUNDS  200
+
+static struct mram mram;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint seen_threads;
+static _Thread_local bool seen;
+
+static void* capture_thread(void* arg) {
+    uint32_t base = (uint32_t)(uintptr_t)arg * 4096;
+    uint8_t buf[64] = { 0 };
+    struct mram_iovec iov[2] = { { base + 1000, buf, 16 }, { base + 2000, buf, 32 } };
+
+    for (int i = 0; i < ROUNDS; i++) {
+        pthread_mutex_lock(&lock);
+        CHECK(mram_write(&mram, base + (uint32_t)i, buf, sizeof(buf)));
+        CHECK(mram_read(&mram, base, buf, sizeof(buf)));
+        CHECK(mram_write_vector(&mram, iov, 2));
+        CHECK(!mram_read(&mram, MRAM_MAX_ADDRESS, buf, 2));
+        pthread_mutex_unlock(&lock);
+    }
+    return NULL;
+}
+
+static void count_enter(struct mram_hook* hook, struct mram_call* call) {
+    (void)hook;
+    (void)call;
+    if (!seen) {
+        seen = true;
+        atomic_fetch_add(&seen_threads, 1);
+    }
+}
+
+static void count_leave(struct mram_hook* hook, struct mram_call* call, bool ok) {
+    (void)hook;
+    (void)call;
+    (void)ok;
+}
+
+int main(void) {
+    struct mram_trace trace;
+    struct mram_replay_report report;
+    pthread_t threads[THREADS];
+    char path[64];
+
+    snprintf(path, sizeof(path), "/tmp/test_trace_%d.bin", (int)getpid());
+    CHECK(mram_sim_init(&mram, NULL));
+    CHECK(mram_trace_start(&trace, &mram, path));
+    for (uintptr_t t = 0; t < THREADS; t++) CHECK(pthread_create(&threads[t], NULL, capture_thread, (void*)t) == 0);
+    for (int t = 0; t < THREADS; t++) pthread_join(threads[t], NULL);
+    CHECK(mram_trace_stop(&trace));
+    CHECK(trace.records == THREADS * ROUNDS * 4);
+
+    // The hook counts the threads the replay issues calls from
+    struct mram_hook hook = { count_enter, count_leave };
+    CHECK(mram_sim_init(&mram, NULL));
+    mram.hook = &hook;
+    CHECK(mram_trace_replay(&mram, path, false, &report));
+    CHECK(report.threads == THREADS && atomic_load(&seen_threads) == THREADS);
+    CHECK(report.calls == trace.records && report.mismatches == 0);
+    CHECK(report.ops[MRAM_OP_WRITE].count == THREADS * ROUNDS);
+    CHECK(report.ops[MRAM_OP_WRITE].bytes == THREADS * ROUNDS * 64);
+    CHECK(report.ops[MRAM_OP_WRITE_VECTOR].bytes == THREADS * ROUNDS * 48);
+    CHECK(report.ops[MRAM_OP_READ].errors == THREADS * ROUNDS);
+    CHECK(report.ops[MRAM_OP_READ].min_ns <= report.ops[MRAM_OP_READ].p50_ns);
+    CHECK(report.ops[MRAM_OP_READ].p50_ns <= report.ops[MRAM_OP_READ].max_ns);
+
+    // Paced replay is held to the captured timeline
+    CHECK(mram_trace_replay(&mram, path, true, &report));
+    CHECK(report.calls == trace.records && report.elapsed_ns >= report.captured_ns / 2);
+
+    CHECK(!mram_trace_replay(&mram, "/tmp/test_trace_missing.bin", false, &report));
+    unlink(path);
+    return 0;
+}
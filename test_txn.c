@@ -0,0 +1,171 @@
+/**
+ * @file test_txn.c
+ * @brief Transaction atomicity across power loss on the simulator
+ *
+ * Cuts power after every write payload byte of a multi-range commit, and
+ * again during the recovery replay, and checks that recovery always ends
+ * with either none or all of the staged writes applied. A commit that
+ * fails during apply is finished by the next begin on the same context.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#include <string.h>
+#include "mram_txn.h"
+#include "test_util.h"
+
+#define DATA_SIZE    4096
+#define JOURNAL_ADDR 8192
+#define JOURNAL_SIZE 2048
+#define AREA_SIZE    (JOURNAL_ADDR + JOURNAL_SIZE)
+
+static uint8_t baseline[AREA_SIZE];
+static uint8_t before[DATA_SIZE];
+static uint8_t after[DATA_SIZE];
+
+static void fill(uint8_t* buf, size_t len, uint8_t seed) {
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(seed + i * 7);
+}
+
+// Stage the writes of the transaction under test and mirror them in after[]
+static void stage(struct mram_txn* txn) {
+    static const struct { uint32_t addr; uint32_t len; uint8_t seed; } ranges[] = {
+        { 100, 200, 1 },
+        { 3000, 64, 2 },
+        { 150, 10, 3 },  // overlaps the first range and wins
+        { 300, 1, 4 },   // adjacent to the first range
+        { 4000, 96, 5 },
+    };
+    uint8_t data[256];
+
+    for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+        fill(data, ranges[i].len, ranges[i].seed);
+        CHECK(mram_txn_write(txn, ranges[i].addr, data, ranges[i].len));
+        memcpy(after + ranges[i].addr, data, ranges[i].len);
+    }
+}
+
+// One committed transaction leaves a completed journal behind
+static void make_baseline(void) {
+    struct mram mram;
+    struct mram_txn txn;
+    uint8_t data[32];
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    fill(mram_sim_memory(), AREA_SIZE, 9);
+    CHECK(mram_txn_init(&txn, &mram, JOURNAL_ADDR, JOURNAL_SIZE));
+    CHECK(mram_txn_begin(&txn));
+    fill(data, sizeof(data), 11);
+    CHECK(mram_txn_write(&txn, 2000, data, sizeof(data)));
+    CHECK(mram_txn_commit(&txn));
+    mram_txn_deinit(&txn);
+
+    memcpy(baseline, mram_sim_memory(), AREA_SIZE);
+    memcpy(before, baseline, DATA_SIZE);
+    memcpy(after, before, DATA_SIZE);
+}
+
+static void restore_baseline(void) {
+    memcpy(mram_sim_memory(), baseline, AREA_SIZE);
+}
+
+static bool data_is(const uint8_t* expected) {
+    return memcmp(mram_sim_memory(), expected, DATA_SIZE) == 0;
+}
+
+// Power on with a budget, recover and run the transaction
+static bool run_commit(size_t budget) {
+    struct mram mram;
+    struct mram_txn txn;
+
+    test_power_on(&mram, budget);
+    if (mram_txn_init(&txn, &mram, JOURNAL_ADDR, JOURNAL_SIZE)) {
+        CHECK(mram_txn_begin(&txn));
+        stage(&txn);
+        mram_txn_commit(&txn);
+        mram_txn_deinit(&txn);
+    }
+    return test_power_lost();
+}
+
+// Power on with a budget and only recover
+static bool run_recovery(size_t budget) {
+    struct mram mram;
+    struct mram_txn txn;
+
+    test_power_on(&mram, budget);
+    if (mram_txn_init(&txn, &mram, JOURNAL_ADDR, JOURNAL_SIZE)) mram_txn_deinit(&txn);
+    return test_power_lost();
+}
+
+int main(void) {
+    struct mram mram;
+    struct mram_txn txn;
+
+    make_baseline();
+    CHECK(!run_commit(TEST_POWER_UNLIMITED));
+    CHECK(data_is(after));
+
+    // Abort discards, and the journal stays usable afterwards
+    restore_baseline();
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_txn_init(&txn, &mram, JOURNAL_ADDR, JOURNAL_SIZE));
+    CHECK(mram_txn_begin(&txn));
+    stage(&txn);
+    mram_txn_abort(&txn);
+    CHECK(!mram_txn_write(&txn, 0, "x", 1));
+    mram_txn_deinit(&txn);
+    CHECK(data_is(before));
+
+    size_t replays = 0;
+    bool lost = true;
+    for (size_t budget = 0; lost; budget++) {
+        restore_baseline();
+        lost = run_commit(budget);
+
+        // A cut between journal and completion marker leaves a replay pending
+        uint8_t cut[AREA_SIZE];
+        memcpy(cut, mram_sim_memory(), AREA_SIZE);
+        CHECK(!run_recovery(TEST_POWER_UNLIMITED));
+        CHECK(data_is(before) || data_is(after));
+        if (!lost) CHECK(data_is(after));
+        if (!data_is(after) || memcmp(cut, mram_sim_memory(), DATA_SIZE) == 0) continue;
+
+        // Lose power again during every byte of that replay
+        replays++;
+        bool again = true;
+        for (size_t budget2 = 0; again; budget2++) {
+            memcpy(mram_sim_memory(), cut, AREA_SIZE);
+            again = run_recovery(budget2);
+            CHECK(!run_recovery(TEST_POWER_UNLIMITED));
+            CHECK(data_is(after));
+        }
+    }
+    CHECK(replays > 0);
+
+    // Cut power during apply and commit again on the same context: begin
+    // refuses while the replay cannot run, then finishes the first commit
+    restore_baseline();
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_txn_init(&txn, &mram, JOURNAL_ADDR, JOURNAL_SIZE));
+    CHECK(mram_txn_begin(&txn));
+    stage(&txn);
+    test_power.budget = txn.used + MRAM_TXN_TRAILER_SIZE + 50;
+    CHECK(!mram_txn_commit(&txn));
+    CHECK(test_power_lost() && !data_is(before) && !data_is(after));
+    CHECK(!mram_txn_begin(&txn));
+
+    test_power_on(&mram, TEST_POWER_UNLIMITED);
+    CHECK(mram_txn_begin(&txn));
+    CHECK(data_is(after));
+    uint8_t data[16];
+    fill(data, sizeof(data), 6);
+    CHECK(mram_txn_write(&txn, 3500, data, sizeof(data)));
+    memcpy(after + 3500, data, sizeof(data));
+    CHECK(mram_txn_commit(&txn));
+    mram_txn_deinit(&txn);
+    CHECK(data_is(after));
+    return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_uring.c
+ * @brief Submission and completion rings on the simulator
+ *
+ * Round-trips writes, reads and status commands through the I/O thread,
+ * including a submit that has to wake it from sleep, and checks results,
+ * completion order and the eventfd. A full submission ring refuses more
+ * entries, and a full completion ring holds submissions back until
+ * completions are reaped.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L  // nanosleep
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mram_uring.h"
+#include "test_util.h"
+
+static struct mram mram;
+
+static void pause_ms(long ms) {
+    struct timespec ts = { 0, ms * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void prep(struct mram_uring* ring, uint8_t op, uint32_t addr, void* buf, size_t len, uint64_t user_data) {
+    struct mram_uring_sqe* sqe = mram_uring_get_sqe(ring);
+    CHECK(sqe != NULL);
+    sqe->op = op;
+    sqe->addr = addr;
+    sqe->buf = buf;
+    sqe->len = len;
+    sqe->user_data = user_data;
+}
+
+static int32_t reap(struct mram_uring* ring, uint64_t user_data) {
+    struct mram_uring_cqe* cqe = mram_uring_wait_cqe(ring);
+    CHECK(cqe != NULL && cqe->user_data == user_data);
+    int32_t res = cqe->res;
+    mram_uring_cqe_seen(ring);
+    return res;
+}
+
+static void test_round_trip(void) {
+    struct mram_uring ring;
+    const struct mram_uring_config config = { .sq_entries = 16, .idle_spins = 10, .use_eventfd = true };
+    uint8_t a[100], b[100], back[200];
+    uint64_t events;
+
+    CHECK(mram_uring_init(&ring, &mram, &config));
+    CHECK(mram_uring_eventfd(&ring) >= 0);
+    memset(a, 0x11, sizeof(a));
+    memset(b, 0x22, sizeof(b));
+
+    // Two adjacent writes, a read of both and an out-of-range write
+    prep(&ring, MRAM_URING_OP_WRITE, 1000, a, sizeof(a), 1);
+    prep(&ring, MRAM_URING_OP_WRITE, 1100, b, sizeof(b), 2);
+    prep(&ring, MRAM_URING_OP_READ, 1000, back, sizeof(back), 3);
+    prep(&ring, MRAM_URING_OP_WRITE, MRAM_MAX_ADDRESS, a, 2, 4);
+    prep(&ring, MRAM_URING_OP_NOP, 0, NULL, 0, 5);
+    CHECK(mram_uring_submit(&ring) == 5);
+    CHECK(mram_uring_submit(&ring) == 0);
+    CHECK(reap(&ring, 1) == 0 && reap(&ring, 2) == 0 && reap(&ring, 3) == 0);
+    CHECK(reap(&ring, 4) == -EINVAL && reap(&ring, 5) == 0);
+    CHECK(mram_uring_peek_cqe(&ring) == NULL);
+    CHECK(memcmp(back, a, 100) == 0 && memcmp(back + 100, b, 100) == 0);
+    CHECK(ring.stats.completed == 5);
+    CHECK(read(mram_uring_eventfd(&ring), &events, sizeof(events)) == sizeof(events) && events > 0);
+
+    // Let the I/O thread go to sleep; the next submit has to wake it
+    pause_ms(50);
+    prep(&ring, MRAM_URING_OP_WRITE_STATUS, MRAM_STATUS_BP0, NULL, 0, 6);
+    prep(&ring, MRAM_URING_OP_READ_STATUS, 0, NULL, 0, 7);
+    prep(&ring, MRAM_URING_OP_WRITE_STATUS, 0, NULL, 0, 8);
+    CHECK(mram_uring_submit(&ring) == 3);
+    CHECK(reap(&ring, 6) == 0 && reap(&ring, 7) == MRAM_STATUS_BP0 && reap(&ring, 8) == 0);
+    CHECK(ring.stats.sleeps > 0);
+    mram_uring_deinit(&ring);
+}
+
+static void test_full_rings(void) {
+    struct mram_uring ring;
+    const struct mram_uring_config config = { .sq_entries = 8, .cq_entries = 8 };
+    uint8_t data[8][16];
+
+    CHECK(mram_uring_init(&ring, &mram, &config));
+
+    // Unpublished entries fill the submission ring
+    for (uint64_t i = 0; i < 8; i++) {
+        memset(data[i], (int)i, sizeof(data[i]));
+        prep(&ring, MRAM_URING_OP_WRITE, 4096 + (uint32_t)i * 32, data[i], sizeof(data[i]), i);
+    }
+    CHECK(mram_uring_get_sqe(&ring) == NULL);
+    CHECK(mram_uring_submit(&ring) == 8);
+
+    // Nothing is reaped, so the second batch waits for completion slots
+    // and its entries are not released for reuse
+    struct mram_uring_sqe* sqe;
+    while ((sqe = mram_uring_get_sqe(&ring)) == NULL) pause_ms(1);
+    sqe->op = MRAM_URING_OP_NOP;
+    sqe->user_data = 8;
+    for (uint64_t i = 9; i < 16; i++) prep(&ring, MRAM_URING_OP_NOP, 0, NULL, 0, i);
+    CHECK(mram_uring_submit(&ring) == 8);
+    pause_ms(20);
+    CHECK(mram_uring_get_sqe(&ring) == NULL);
+    CHECK(ring.stats.completed == 8);
+
+    for (uint64_t i = 0; i < 16; i++) CHECK(reap(&ring, i) == 0);
+    CHECK(mram_uring_peek_cqe(&ring) == NULL);
+
+    uint8_t back[16];
+    prep(&ring, MRAM_URING_OP_READ, 4096 + 7 * 32, back, sizeof(back), 16);
+    CHECK(mram_uring_submit(&ring) == 1);
+    CHECK(reap(&ring, 16) == 0 && memcmp(back, data[7], sizeof(back)) == 0);
+    mram_uring_deinit(&ring);
+}
+
+int main(void) {
+    CHECK(mram_sim_init(&mram, NULL));
+
+    test_round_trip();
+    test_full_rings();
+    return 0;
+}
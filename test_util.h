@@ -0,0 +1,109 @@
+/**
+ * @file test_util.h
+ * @brief Shared helpers for the simulator-backed tests
+ *
+ * Tests are plain executables registered with CTest: they return 0 when
+ * every CHECK holds and stop at the first one that fails.
+ *
+ * The power-cut transport sits in front of the simulator and lets a test
+ * lose power after a chosen number of write payload bytes. The transfer
+ * that crosses the limit reaches the device only up to the limit, as the
+ * MR25H40 stores each byte as it is clocked in, and every callback fails
+ * from then on. Powering on again keeps the simulated contents, so a test
+ * can sweep the cut over every byte of an operation and check what the
+ * layer under test recovers at each point.
+ *
+ * @version 1.0.0
+ * @author Orkun Acar
+ * @date 16.10.2026
+ */
+
+#ifndef MRAM_INTERFACE_TEST_UTIL_H
+#define MRAM_INTERFACE_TEST_UTIL_H
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mram_sim.h"
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/** @brief Stop the test with a message if cond is false */
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                                  \
+        }                                                                             \
+    } while (0)
+
+/** @brief Power budget that is never exhausted */
+#define TEST_POWER_UNLIMITED SIZE_MAX
+
+/*******************************************************************************
+ * Power-cut transport
+ ******************************************************************************/
+
+// One transport per process, like the simulator it wraps
+static struct {
+    struct mram sim;
+    size_t budget;
+    size_t frame_pos;
+    uint8_t cmd;
+    bool cut;
+} test_power;
+
+static inline bool test_power_gpio(uint8_t pin, uint8_t value) {
+    if (test_power.cut) return false;
+    if (value == MRAM_GPIO_LOW) test_power.frame_pos = 0;
+    return test_power.sim.gpio_write(pin, value);
+}
+
+static inline bool test_power_spi(const uint8_t* tx_buf, uint8_t* rx_buf, size_t len) {
+    if (test_power.cut) return false;
+    if (test_power.frame_pos == 0 && len > 0) test_power.cmd = tx_buf ? tx_buf[0] : 0xFF;
+
+    // Payload bytes of a WRITE frame follow its command and address
+    size_t header = test_power.frame_pos < 4 ? 4 - test_power.frame_pos : 0;
+    size_t payload = test_power.cmd == MRAM_CMD_WRITE && len > header ? len - header : 0;
+    test_power.frame_pos += len;
+    if (payload <= test_power.budget) {
+        if (test_power.budget != TEST_POWER_UNLIMITED) test_power.budget -= payload;
+        return test_power.sim.spi_transfer(tx_buf, rx_buf, len);
+    }
+
+    size_t allowed = header + test_power.budget;
+    if (allowed > 0) test_power.sim.spi_transfer(tx_buf, rx_buf, allowed);
+    test_power.budget = 0;
+    test_power.cut = true;
+    return false;
+}
+
+/**
+ * @brief Power the simulated device on behind the power-cut transport
+ *
+ * The simulator keeps its contents from the previous power cycle.
+ *
+ * @param mram Receives the MRAM interface
+ * @param budget Write payload bytes until power is lost, or TEST_POWER_UNLIMITED
+ */
+static inline void test_power_on(struct mram* mram, size_t budget) {
+    CHECK(mram_sim_init(&test_power.sim, mram_sim_memory()));
+    test_power.budget = budget;
+    test_power.frame_pos = 0;
+    test_power.cut = false;
+    CHECK(mram_init(mram, test_power_gpio, test_power_spi, MRAM_SIM_CS_PIN));
+}
+
+/**
+ * @brief Whether power has been lost since test_power_on()
+ */
+static inline bool test_power_lost(void) {
+    return test_power.cut;
+}
+
+#endif //MRAM_INTERFACE_TEST_UTIL_H